@@ -82,7 +82,7 @@ int main (int argc, char *argv[])
   Config::SetDefault ("ns3::QueueBase::MaxSize",
                       QueueSizeValue (QueueSize (QueueSizeUnit::PACKETS, maxPackets)));
 
-  if (modeBytes)
+  if (!modeBytes)
     {
       Config::SetDefault ("ns3::PhantomQueueDisc::MaxSize",
                           QueueSizeValue (QueueSize (QueueSizeUnit::PACKETS, queueDiscLimitPackets)));
@@ -25,7 +25,10 @@
 #include "names.h"
 #include "pointer.h"
 #include "log.h"
+#include "simple-ref-count.h"
 
+#include <algorithm>
+#include <map>
 #include <sstream>
 
 /**
@@ -150,6 +153,9 @@ MatchContainer::DisconnectWithoutContext (std::string name, const CallbackBase &
 /**
  * \ingroup config-impl
  * Helper to test if an array entry matches a config path specification.
+ *
+ * The specification is parsed once, when the matcher is built, into the
+ * ranges of indices it matches.
  */
 class ArrayMatcher
 {
@@ -167,7 +173,23 @@ public:
    * \returns \c true if the index matches the Config Path.
    */
   bool Matches (std::size_t i) const;
+  /**
+   * Get the indices matching the Config Path, when they are few enough
+   * to be looked up one by one in a container.
+   *
+   * \param [in] n The number of objects in the container.
+   * \param [out] indices The matching indices, in increasing order.
+   * \returns \c false if the Config Path matches more than \p n indices,
+   *   or an index which is not smaller than \p n.
+   */
+  bool GetIndices (std::size_t n, std::vector<std::size_t> *indices) const;
 private:
+  /**
+   * Add the indices matched by a Config path specification.
+   *
+   * \param [in] element The Config path specification.
+   */
+  void Parse (std::string element);
   /**
    * Convert a string to an \c uint32_t.
    *
@@ -178,78 +200,110 @@ private:
   bool StringToUint32 (std::string str, uint32_t *value) const;
   /** The Config path element. */
   std::string m_element;
+  /** \c true if the Config path element matches any index. */
+  bool m_all;
+  /** Container type to hold the ranges of matching indices. */
+  typedef std::vector<std::pair<uint32_t, uint32_t> > Ranges;
+  /** The inclusive ranges of matching indices. */
+  Ranges m_ranges;
 
 };  // class ArrayMatcher
 
 
 ArrayMatcher::ArrayMatcher (std::string element)
-  : m_element (element)
+  : m_element (element),
+    m_all (false)
 {
   NS_LOG_FUNCTION (this << element);
+  Parse (element);
 }
-bool
-ArrayMatcher::Matches (std::size_t i) const
+void
+ArrayMatcher::Parse (std::string element)
 {
-  NS_LOG_FUNCTION (this << i);
-  if (m_element == "*")
+  NS_LOG_FUNCTION (this << element);
+  if (element == "*")
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches *");
-      return true;
+      m_all = true;
+      return;
     }
   std::string::size_type tmp;
-  tmp = m_element.find ("|");
+  tmp = element.find ("|");
   if (tmp != std::string::npos)
     {
-      std::string left = m_element.substr (0, tmp-0);
-      std::string right = m_element.substr (tmp+1, m_element.size () - (tmp + 1));
-      ArrayMatcher matcher = ArrayMatcher (left);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<left);
-          return true;
-        }
-      matcher = ArrayMatcher (right);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<right);
-          return true;
-        }
-      NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
-      return false;
+      std::string left = element.substr (0, tmp-0);
+      std::string right = element.substr (tmp+1, element.size () - (tmp + 1));
+      Parse (left);
+      Parse (right);
+      return;
     }
-  std::string::size_type leftBracket = m_element.find ("[");
-  std::string::size_type rightBracket = m_element.find ("]");
-  std::string::size_type dash = m_element.find ("-");
-  if (leftBracket == 0 && rightBracket == m_element.size () - 1 &&
+  std::string::size_type leftBracket = element.find ("[");
+  std::string::size_type rightBracket = element.find ("]");
+  std::string::size_type dash = element.find ("-");
+  if (leftBracket == 0 && rightBracket == element.size () - 1 &&
       dash > leftBracket && dash < rightBracket)
     {
-      std::string lowerBound = m_element.substr (leftBracket + 1, dash - (leftBracket + 1));
-      std::string upperBound = m_element.substr (dash + 1, rightBracket - (dash + 1));
+      std::string lowerBound = element.substr (leftBracket + 1, dash - (leftBracket + 1));
+      std::string upperBound = element.substr (dash + 1, rightBracket - (dash + 1));
       uint32_t min;
       uint32_t max;
       if (StringToUint32 (lowerBound, &min) && 
           StringToUint32 (upperBound, &max) &&
-          i >= min && i <= max)
+          min <= max)
         {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
-          return true;
-        }
-      else
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" does not "<<m_element);
-          return false;
+          m_ranges.push_back (std::make_pair (min, max));
         }
+      return;
     }
   uint32_t value;
-  if (StringToUint32 (m_element, &value) &&
-      i == value)
+  if (StringToUint32 (element, &value))
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
+      m_ranges.push_back (std::make_pair (value, value));
+    }
+}
+bool
+ArrayMatcher::Matches (std::size_t i) const
+{
+  NS_LOG_FUNCTION (this << i);
+  if (m_all)
+    {
+      NS_LOG_DEBUG ("Array "<<i<<" matches *");
       return true;
     }
+  for (Ranges::const_iterator range = m_ranges.begin (); range != m_ranges.end (); range++)
+    {
+      if (i >= range->first && i <= range->second)
+        {
+          NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
+          return true;
+        }
+    }
   NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
   return false;
 }
+bool
+ArrayMatcher::GetIndices (std::size_t n, std::vector<std::size_t> *indices) const
+{
+  NS_LOG_FUNCTION (this << n << indices);
+  if (m_all)
+    {
+      return false;
+    }
+  indices->clear ();
+  for (Ranges::const_iterator range = m_ranges.begin (); range != m_ranges.end (); range++)
+    {
+      if (range->second >= n || indices->size () + (range->second - range->first) >= n)
+        {
+          return false;
+        }
+      for (std::size_t i = range->first; i <= range->second; i++)
+        {
+          indices->push_back (i);
+        }
+    }
+  std::sort (indices->begin (), indices->end ());
+  indices->erase (std::unique (indices->begin (), indices->end ()), indices->end ());
+  return true;
+}
 
 bool
 ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
@@ -261,6 +315,89 @@ ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
   return !iss.bad () && !iss.fail ();
 }
 
+/**
+ * \ingroup config-impl
+ * A Config path, split once into the elements followed by a Resolver.
+ *
+ * The ConfigImpl keeps the paths it resolves, so that a path used again
+ * is not parsed again.
+ */
+class ConfigPath : public SimpleRefCount<ConfigPath>
+{
+public:
+  /**
+   * Split a Config path into its elements.
+   *
+   * \param [in] path The Config path.
+   */
+  ConfigPath (std::string path);
+
+  /** An element of a Config path. */
+  struct Element
+  {
+    /**
+     * Parse an element.
+     *
+     * \param [in] item The element.
+     */
+    Element (std::string item);
+
+    std::string item;     //!< The element.
+    bool names;           //!< \c true if the element may start the "/Names" namespace.
+    bool getObject;       //!< \c true if the element is a call to GetObject.
+    bool tidFound;        //!< \c true if the TypeId of a call to GetObject is registered.
+    TypeId tid;           //!< The TypeId of a call to GetObject.
+    ArrayMatcher matcher; //!< The element, as an index in an object container.
+  };
+
+  /** The elements of the Config path. */
+  std::vector<Element> m_elements;
+
+};  // class ConfigPath
+
+ConfigPath::Element::Element (std::string item)
+  : item (item),
+    names (item.compare (0, 5, "Names") == 0),
+    getObject (item.find ("$") == 0),
+    tidFound (false),
+    matcher (item)
+{
+  NS_LOG_FUNCTION (this << item);
+  if (getObject)
+    {
+      // A TypeId which is not registered yet is looked up again, when
+      // the path reaches an object, to report the error
+      tidFound = TypeId::LookupByNameFailSafe (item.substr (1, item.size () - 1), &tid);
+    }
+}
+
+ConfigPath::ConfigPath (std::string path)
+{
+  NS_LOG_FUNCTION (this << path);
+
+  // ensure that we start and end with a '/'
+  std::string::size_type tmp = path.find ("/");
+  if (tmp != 0)
+    {
+      // no slash at start
+      path = "/" + path;
+    }
+  tmp = path.find_last_of ("/");
+  if (tmp != (path.size () - 1))
+    {
+      // no slash at end
+      path = path + "/";
+    }
+
+  std::string::size_type start = 1;
+  std::string::size_type next;
+  while ((next = path.find ("/", start)) != std::string::npos)
+    {
+      m_elements.push_back (Element (path.substr (start, next - start)));
+      start = next + 1;
+    }
+}
+
 /**
  * \ingroup config-impl
  * Abstract class to parse Config paths into object references.
@@ -273,7 +410,7 @@ public:
    *
    * \param [in] path The Config path.
    */
-  Resolver (std::string path);
+  Resolver (Ptr<const ConfigPath> path);
   /** Destructor. */
   virtual ~Resolver ();
 
@@ -287,23 +424,44 @@ public:
   void Resolve (Ptr<Object> root);
   
 private:
-  /** Ensure the Config path starts and ends with a '/'. */
-  void Canonicalize (void);
+  /** An attribute of an object through which a Config path goes on. */
+  struct PathAttribute
+  {
+    std::string name; //!< The attribute name.
+    bool pointer;     //!< \c true for a Pointer, \c false for an object container.
+    /** The accessor of an object container, if it is an ObjectPtrContainerAccessor. */
+    Ptr<const ObjectPtrContainerAccessor> container;
+  };
+  /** Container type to hold the attributes matching a path element. */
+  typedef std::vector<PathAttribute> PathAttributes;
+
+  /**
+   * Get the attributes of a type, or of its parents, through which a
+   * Config path element goes on.  They are searched once per type and
+   * element, and kept for the next lookups.
+   *
+   * \param [in] tid The type of the current object on the Config path.
+   * \param [in] item The Config path element.
+   * \returns The Pointer and object container attributes named \p item,
+   *   or all of them if \p item is "*".
+   */
+  static const PathAttributes &GetPathAttributes (TypeId tid, const std::string &item);
   /**
    * Parse the next element in the Config path.
    *
-   * \param [in] path The remaining portion of the Config path.
+   * \param [in] next The index of the next element of the Config path.
    * \param [in] root The object corresponding to the current position
    *                  in the Config path.
    */
-  void DoResolve (std::string path, Ptr<Object> root);
+  void DoResolve (std::size_t next, Ptr<Object> root);
   /**
    * Parse an index on the Config path.
    *
-   * \param [in] path The remaining Config path.
-   * \param [in,out] vector The resulting list of matching objects.
+   * \param [in] next The index of the next element of the Config path.
+   * \param [in] root The object holding the object container.
+   * \param [in] attribute The object container attribute.
    */
-  void DoArrayResolve (std::string path, const ObjectPtrContainerValue &vector);
+  void DoArrayResolve (std::size_t next, Ptr<Object> root, const PathAttribute &attribute);
   /**
    * Handle one object found on the path.
    *
@@ -327,46 +485,26 @@ private:
   /** Current list of path tokens. */
   std::vector<std::string> m_workStack;
   /** The Config path. */
-  std::string m_path;
+  Ptr<const ConfigPath> m_path;
 
 };  // class Resolver
 
-Resolver::Resolver (std::string path)
+Resolver::Resolver (Ptr<const ConfigPath> path)
   : m_path (path)
 {
   NS_LOG_FUNCTION (this << path);
-  Canonicalize ();
 }
 Resolver::~Resolver ()
 {
   NS_LOG_FUNCTION (this);
 }
-void
-Resolver::Canonicalize (void)
-{
-  NS_LOG_FUNCTION (this);
-
-  // ensure that we start and end with a '/'
-  std::string::size_type tmp = m_path.find ("/");
-  if (tmp != 0)
-    {
-      // no slash at start
-      m_path = "/" + m_path;
-    }
-  tmp = m_path.find_last_of ("/");
-  if (tmp != (m_path.size () - 1))
-    {
-      // no slash at end
-      m_path = m_path + "/";
-    }
-}
 
 void 
 Resolver::Resolve (Ptr<Object> root)
 {
   NS_LOG_FUNCTION (this << root);
 
-  DoResolve (m_path, root);
+  DoResolve (0, root);
 }
 
 std::string
@@ -391,14 +529,70 @@ Resolver::DoResolveOne (Ptr<Object> object)
   DoOne (object, GetResolvedPath ());
 }
 
+const Resolver::PathAttributes &
+Resolver::GetPathAttributes (TypeId tid, const std::string &item)
+{
+  NS_LOG_FUNCTION (tid << item);
+  static std::map<std::pair<uint16_t, std::string>, PathAttributes> cache;
+  std::pair<uint16_t, std::string> key = std::make_pair (tid.GetUid (), item);
+  std::map<std::pair<uint16_t, std::string>, PathAttributes>::iterator found = cache.find (key);
+  if (found != cache.end ())
+    {
+      return found->second;
+    }
+
+  PathAttributes &attributes = cache[key];
+  TypeId instanceTid = tid;
+  TypeId nextTid = tid;
+  do
+    {
+      tid = nextTid;
+
+      for (uint32_t i = 0; i < tid.GetAttributeN(); i++)
+        {
+          struct TypeId::AttributeInformation info;
+          info = tid.GetAttribute(i);
+          if (info.name != item && item != "*")
+            {
+              continue;
+            }
+          PathAttribute attribute;
+          attribute.name = info.name;
+          // attempt to cast to a pointer checker.
+          const PointerChecker *pChecker = dynamic_cast<const PointerChecker *> (PeekPointer(info.checker));
+          if (pChecker != 0)
+            {
+              attribute.pointer = true;
+              attributes.push_back (attribute);
+            }
+          // attempt to cast to an object vector.
+          const ObjectPtrContainerChecker *vectorChecker = 
+            dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker));
+          if (vectorChecker != 0)
+            {
+              // The container is read through the attribute found by
+              // name, as ObjectBase::GetAttribute does
+              struct TypeId::AttributeInformation named;
+              instanceTid.LookupAttributeByName (info.name, &named);
+              attribute.pointer = false;
+              attribute.container = dynamic_cast<const ObjectPtrContainerAccessor *> (PeekPointer (named.accessor));
+              attributes.push_back (attribute);
+            }
+          // this could be anything else and we don't know what to do with it.
+          // So, we just ignore it.
+        }
+
+      nextTid = tid.GetParent ();
+    } while (nextTid != tid);
+  return attributes;
+}
+
 void
-Resolver::DoResolve (std::string path, Ptr<Object> root)
+Resolver::DoResolve (std::size_t next, Ptr<Object> root)
 {
-  NS_LOG_FUNCTION (this << path << root);
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
+  NS_LOG_FUNCTION (this << next << root);
 
-  if (next == std::string::npos)
+  if (next == m_path->m_elements.size ())
     {
       //
       // If root is zero, we're beginning to see if we can use the object name 
@@ -414,8 +608,8 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
         }
       return;
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
+  const ConfigPath::Element &element = m_path->m_elements[next];
+  const std::string &item = element.item;
 
   //
   // If root is zero, we're beginning to see if we can use the object name 
@@ -426,11 +620,10 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
   //
   if (root == 0)
     {
-      std::string::size_type offset = path.find ("/Names");
-      if (offset == 0)
+      if (element.names)
         {
           m_workStack.push_back (item);
-          DoResolve (pathLeft, root);
+          DoResolve (next + 1, root);
           m_workStack.pop_back ();
           return;
         }
@@ -447,7 +640,7 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     {
       NS_LOG_DEBUG ("Name system resolved item = " << item << " to " << namedObject);
       m_workStack.push_back (item);
-      DoResolve (pathLeft, namedObject);
+      DoResolve (next + 1, namedObject);
       m_workStack.pop_back ();
       return;
     }
@@ -463,13 +656,12 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     {
       return;
     }
-  std::string::size_type dollarPos = item.find ("$");
-  if (dollarPos == 0)
+  if (element.getObject)
     {
       // This is a call to GetObject
       std::string tidString = item.substr (1, item.size () - 1);
       NS_LOG_DEBUG ("GetObject="<<tidString<<" on path="<<GetResolvedPath ());
-      TypeId tid = TypeId::LookupByName (tidString);
+      TypeId tid = element.tidFound ? element.tid : TypeId::LookupByName (tidString);
       Ptr<Object> object = root->GetObject<Object> (tid);
       if (object == 0)
         {
@@ -477,67 +669,44 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
           return;
         }
       m_workStack.push_back (item);
-      DoResolve (pathLeft, object);
+      DoResolve (next + 1, object);
       m_workStack.pop_back ();
     }
   else 
     {
       // this is a normal attribute.
-      TypeId tid;
-      TypeId nextTid = root->GetInstanceTypeId ();
+      const PathAttributes &attributes = GetPathAttributes (root->GetInstanceTypeId (), item);
       bool foundMatch = false;
-      
-      do
+
+      for (PathAttributes::const_iterator i = attributes.begin (); i != attributes.end (); i++)
         {
-          tid = nextTid;
-          
-          for (uint32_t i = 0; i < tid.GetAttributeN(); i++)
+          if (i->pointer)
             {
-              struct TypeId::AttributeInformation info;
-              info = tid.GetAttribute(i);
-              if (info.name != item && item != "*")
+              NS_LOG_DEBUG ("GetAttribute(ptr)="<<i->name<<" on path="<<GetResolvedPath ());
+              PointerValue pValue;
+              root->GetAttribute (i->name, pValue);
+              Ptr<Object> object = pValue.Get<Object> ();
+              if (object == 0)
                 {
+                  NS_LOG_ERROR ("Requested object name=\""<<item<<
+                                "\" exists on path=\""<<GetResolvedPath ()<<"\""
+                                " but is null.");
                   continue;
                 }
-              // attempt to cast to a pointer checker.
-              const PointerChecker *pChecker = dynamic_cast<const PointerChecker *> (PeekPointer(info.checker));
-              if (pChecker != 0)
-                {
-                  NS_LOG_DEBUG ("GetAttribute(ptr)="<<info.name<<" on path="<<GetResolvedPath ());
-                  PointerValue pValue;
-                  root->GetAttribute (info.name, pValue);
-                  Ptr<Object> object = pValue.Get<Object> ();
-                  if (object == 0)
-                    {
-                      NS_LOG_ERROR ("Requested object name=\""<<item<<
-                                    "\" exists on path=\""<<GetResolvedPath ()<<"\""
-                                    " but is null.");
-                      continue;
-                    }
-                  foundMatch = true;
-                  m_workStack.push_back (info.name);
-                  DoResolve (pathLeft, object);
-                  m_workStack.pop_back ();
-                }
-              // attempt to cast to an object vector.
-              const ObjectPtrContainerChecker *vectorChecker = 
-                dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker));
-              if (vectorChecker != 0)
-                {
-                  NS_LOG_DEBUG ("GetAttribute(vector)="<<info.name<<" on path="<<GetResolvedPath () << pathLeft);
-                  foundMatch = true;
-                  ObjectPtrContainerValue vector;
-                  root->GetAttribute (info.name, vector);
-                  m_workStack.push_back (info.name);
-                  DoArrayResolve (pathLeft, vector);
-                  m_workStack.pop_back ();
-                }
-              // this could be anything else and we don't know what to do with it.
-              // So, we just ignore it.
+              foundMatch = true;
+              m_workStack.push_back (i->name);
+              DoResolve (next + 1, object);
+              m_workStack.pop_back ();
             }
-
-          nextTid = tid.GetParent ();
-        } while (nextTid != tid);
+          else
+            {
+              NS_LOG_DEBUG ("GetAttribute(vector)="<<i->name<<" on path="<<GetResolvedPath ());
+              foundMatch = true;
+              m_workStack.push_back (i->name);
+              DoArrayResolve (next + 1, root, *i);
+              m_workStack.pop_back ();
+            }
+        }
       
       if (!foundMatch)
         {
@@ -548,20 +717,55 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
 }
 
 void 
-Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &container)
+Resolver::DoArrayResolve (std::size_t next, Ptr<Object> root, const PathAttribute &attribute)
 {
-  NS_LOG_FUNCTION(this << path << &container);
-  NS_ASSERT (path != "");
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
-  if (next == std::string::npos)
+  NS_LOG_FUNCTION(this << next << root << attribute.name);
+  if (next == m_path->m_elements.size ())
     {
       return;
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
+  const ArrayMatcher &matcher = m_path->m_elements[next].matcher;
 
-  ArrayMatcher matcher = ArrayMatcher (item);
+  //
+  // When the path selects a few indices, such as "/NodeList/3/", look them
+  // up directly rather than copying the whole container.  This works as
+  // long as the indices are the positions of the objects in the container,
+  // which is always the case of an ObjectVector; otherwise, such as for an
+  // ObjectMap, fall back to a search of the whole container.
+  //
+  std::size_t n;
+  std::vector<std::size_t> indices;
+  if (attribute.container != 0
+      && attribute.container->GetItemN (PeekPointer (root), &n)
+      && matcher.GetIndices (n, &indices))
+    {
+      std::vector<Ptr<Object> > objects;
+      for (std::vector<std::size_t>::const_iterator i = indices.begin (); i != indices.end (); i++)
+        {
+          std::size_t index;
+          Ptr<Object> object = attribute.container->GetItem (PeekPointer (root), *i, &index);
+          if (index != *i)
+            {
+              break;
+            }
+          objects.push_back (object);
+        }
+      if (objects.size () == indices.size ())
+        {
+          for (std::size_t i = 0; i < indices.size (); i++)
+            {
+              std::ostringstream oss;
+              oss << indices[i];
+              m_workStack.push_back (oss.str ());
+              DoResolve (next + 1, objects[i]);
+              m_workStack.pop_back ();
+            }
+          return;
+        }
+    }
+
+  ObjectPtrContainerValue container;
+  root->GetAttribute (attribute.name, container);
   ObjectPtrContainerValue::Iterator it;
   for (it = container.Begin (); it != container.End (); ++it)
     {
@@ -570,7 +774,7 @@ Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &conta
           std::ostringstream oss;
           oss << (*it).first;
           m_workStack.push_back (oss.str ());
-          DoResolve (pathLeft, (*it).second);
+          DoResolve (next + 1, (*it).second);
           m_workStack.pop_back ();
         }
     }
@@ -615,12 +819,26 @@ private:
    * \param [in,out] leaf The trailing part of the \p path.
    */
   void ParsePath (std::string path, std::string *root, std::string *leaf) const;
+  /**
+   * Get a Config path split into its elements, splitting it only the first
+   * time it is resolved.
+   * \param [in] path The Config path.
+   * \returns The split Config path.
+   */
+  Ptr<const ConfigPath> GetConfigPath (std::string path);
 
   /** Container type to hold the root Config path tokens. */
   typedef std::vector<Ptr<Object> > Roots;
+  /** Container type to hold the split Config paths, by path. */
+  typedef std::map<std::string, Ptr<const ConfigPath> > ConfigPaths;
+
+  /** The maximum number of split Config paths kept. */
+  static const std::size_t MAX_CONFIG_PATHS = 4096;
 
   /** The list of Config path roots. */
   Roots m_roots;
+  /** The Config paths already resolved. */
+  ConfigPaths m_configPaths;
 
 };  // class ConfigImpl
 
@@ -636,6 +854,27 @@ ConfigImpl::ParsePath (std::string path, std::string *root, std::string *leaf) c
   NS_LOG_FUNCTION (path << *root << *leaf);
 }
 
+Ptr<const ConfigPath>
+ConfigImpl::GetConfigPath (std::string path)
+{
+  NS_LOG_FUNCTION (this << path);
+
+  ConfigPaths::const_iterator i = m_configPaths.find (path);
+  if (i != m_configPaths.end ())
+    {
+      return i->second;
+    }
+  // Scenarios building a path per object, such as "/NodeList/3/...", would
+  // otherwise keep them all
+  if (m_configPaths.size () >= MAX_CONFIG_PATHS)
+    {
+      m_configPaths.clear ();
+    }
+  Ptr<const ConfigPath> configPath = Create<ConfigPath> (path);
+  m_configPaths[path] = configPath;
+  return configPath;
+}
+
 void 
 ConfigImpl::Set (std::string path, const AttributeValue &value)
 {
@@ -720,7 +959,7 @@ ConfigImpl::LookupMatches (std::string path)
   class LookupMatchesResolver : public Resolver 
   {
   public:
-    LookupMatchesResolver (std::string path)
+    LookupMatchesResolver (Ptr<const ConfigPath> path)
       : Resolver (path)
     {}
     virtual void DoOne (Ptr<Object> object, std::string path)
@@ -730,7 +969,7 @@ ConfigImpl::LookupMatches (std::string path)
     }
     std::vector<Ptr<Object> > m_objects;
     std::vector<std::string> m_contexts;
-  } resolver = LookupMatchesResolver (path);
+  } resolver = LookupMatchesResolver (GetConfigPath (path));
   for (Roots::const_iterator i = m_roots.begin (); i != m_roots.end (); i++)
     {
       resolver.Resolve (*i);
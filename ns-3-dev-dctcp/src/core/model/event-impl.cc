@@ -20,6 +20,7 @@
 
 #include "event-impl.h"
 #include "log.h"
+#include <new>
 
 /**
  * \file
@@ -31,6 +32,115 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("EventImpl");
 
+namespace {
+
+/** Granularity, in bytes, of the size classes of the event free lists. */
+const std::size_t EVENT_POOL_GRANULARITY = 16;
+/** Number of size classes, hence largest pooled event of 128 bytes. */
+const std::size_t EVENT_POOL_CLASSES = 8;
+/** Maximum number of free blocks kept in each size class. */
+const uint32_t EVENT_POOL_MAX_FREE = 65536;
+
+/**
+ * Free blocks, linked through their first word, for each size class.
+ *
+ * The free lists are per thread, so that no lock is needed when events are
+ * scheduled from multiple threads (e.g., with the realtime simulator). They
+ * are trivially destructible, so that events can still be freed while
+ * static objects are being destroyed: EventFreeListDrain releases their
+ * blocks when the thread exits.
+ */
+thread_local void *g_eventFreeList[EVENT_POOL_CLASSES];
+/** Number of blocks in each free list. */
+thread_local uint32_t g_eventNFree[EVENT_POOL_CLASSES];
+/** Whether the free lists of the thread are in use. */
+thread_local bool g_eventFreeListUsed;
+/** Whether the free lists of the thread were drained, as the thread exits. */
+thread_local bool g_eventFreeListDrained;
+
+/**
+ * Release the blocks of the free lists of a thread when it exits, so that
+ * the threads created by every run of a multithreaded simulator do not
+ * leak them.
+ */
+struct EventFreeListDrain
+{
+  /** Destructor, run when the thread exits. */
+  ~EventFreeListDrain ()
+  {
+    for (std::size_t c = 0; c < EVENT_POOL_CLASSES; c++)
+      {
+        while (g_eventFreeList[c] != 0)
+          {
+            void *p = g_eventFreeList[c];
+            g_eventFreeList[c] = *static_cast<void **> (p);
+            ::operator delete (p);
+          }
+        g_eventNFree[c] = 0;
+      }
+    // the events freed later by the thread go back to the heap
+    g_eventFreeListDrained = true;
+  }
+};
+
+/** Drains the free lists of the thread when it exits. */
+thread_local EventFreeListDrain g_eventFreeListDrain;
+
+/**
+ * Get the size class of an event.
+ *
+ * \param [in] size The size of the event.
+ * \returns The size class, or EVENT_POOL_CLASSES if it is too large.
+ */
+inline std::size_t
+GetEventSizeClass (std::size_t size)
+{
+  std::size_t sizeClass = (size - 1) / EVENT_POOL_GRANULARITY;
+  return sizeClass < EVENT_POOL_CLASSES ? sizeClass : EVENT_POOL_CLASSES;
+}
+
+} // unnamed namespace
+
+void *
+EventImpl::operator new (std::size_t size)
+{
+  std::size_t sizeClass = GetEventSizeClass (size);
+  if (sizeClass == EVENT_POOL_CLASSES)
+    {
+      return ::operator new (size);
+    }
+  void *p = g_eventFreeList[sizeClass];
+  if (p == 0)
+    {
+      return ::operator new ((sizeClass + 1) * EVENT_POOL_GRANULARITY);
+    }
+  g_eventFreeList[sizeClass] = *static_cast<void **> (p);
+  g_eventNFree[sizeClass]--;
+  return p;
+}
+
+void
+EventImpl::operator delete (void *p, std::size_t size)
+{
+  std::size_t sizeClass = GetEventSizeClass (size);
+  if (sizeClass == EVENT_POOL_CLASSES || g_eventNFree[sizeClass] >= EVENT_POOL_MAX_FREE
+      || g_eventFreeListDrained)
+    {
+      ::operator delete (p);
+      return;
+    }
+  if (!g_eventFreeListUsed)
+    {
+      // thread_local objects are only constructed, and so destroyed with
+      // their thread, once used
+      (void) &g_eventFreeListDrain;
+      g_eventFreeListUsed = true;
+    }
+  *static_cast<void **> (p) = g_eventFreeList[sizeClass];
+  g_eventFreeList[sizeClass] = p;
+  g_eventNFree[sizeClass]++;
+}
+
 EventImpl::~EventImpl ()
 {
   NS_LOG_FUNCTION (this);
@@ -21,6 +21,7 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
 #include "simple-ref-count.h"
 
 /**
@@ -40,6 +41,12 @@ namespace ns3 {
  * when it reaches the time associated to this event. Most subclasses
  * are usually created by one of the many Simulator::Schedule
  * methods.
+ *
+ * Events are allocated from per-thread free lists of fixed size blocks
+ * rather than from the heap: once a simulation has reached its peak event
+ * population, scheduling an event (e.g., a member function with up to
+ * three arguments bound by MakeEvent) does not call malloc at all.
+ * Subclasses larger than the largest block size are allocated as usual.
  */
 class EventImpl : public SimpleRefCount<EventImpl>
 {
@@ -66,6 +73,21 @@ public:
    */
   bool IsCancelled (void);
 
+  /**
+   * Allocate an event from the free list of its size class.
+   *
+   * \param [in] size The size of the event.
+   * \returns The memory for the event.
+   */
+  static void * operator new (std::size_t size);
+  /**
+   * Return an event to the free list of its size class.
+   *
+   * \param [in] p The memory of the event.
+   * \param [in] size The size of the event.
+   */
+  static void operator delete (void *p, std::size_t size);
+
 protected:
   /**
    * Implementation for Invoke().
@@ -0,0 +1,326 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+#include "event-impl.h"
+#include "assert.h"
+#include "log.h"
+#include <algorithm>
+#include <limits>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Implementation of ns3::LadderScheduler class.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler);
+
+TypeId
+LadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<LadderScheduler> ()
+  ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_topStart (0),
+    m_rungs (MAX_RUNGS),
+    m_nRungs (0),
+    m_bottomLimit (THRESHOLD)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LadderScheduler::~LadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint64_t
+LadderScheduler::GetCurrentStart (const Rung &rung)
+{
+  return rung.m_start + rung.m_current * rung.m_width;
+}
+
+LadderScheduler::Bucket *
+LadderScheduler::FindBucket (uint64_t ts)
+{
+  if (ts >= m_topStart)
+    {
+      return &m_top;
+    }
+  for (uint32_t i = 0; i < m_nRungs; i++)
+    {
+      Rung &rung = m_rungs[i];
+      if (ts >= GetCurrentStart (rung))
+        {
+          return &rung.m_buckets[(ts - rung.m_start) / rung.m_width];
+        }
+    }
+  return 0;
+}
+
+void
+LadderScheduler::InsertInBottom (const Scheduler::Event &ev)
+{
+  // new events are usually the latest ones, so search from the end
+  std::deque<Scheduler::Event>::iterator it = m_bottom.end ();
+  if (!m_bottom.empty () && ev < m_bottom.back ())
+    {
+      it = std::upper_bound (m_bottom.begin (), m_bottom.end (), ev);
+    }
+  m_bottom.insert (it, ev);
+
+  if (m_bottom.size () > m_bottomLimit && m_nRungs < MAX_RUNGS
+      && m_bottom.front ().key.m_ts != m_bottom.back ().key.m_ts)
+    {
+      BottomToLadder ();
+    }
+}
+
+void
+LadderScheduler::Insert (const Scheduler::Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  Bucket *bucket = FindBucket (ev.key.m_ts);
+  if (bucket == 0)
+    {
+      InsertInBottom (ev);
+      return;
+    }
+  bucket->push_back (ev);
+  FillBottom ();
+}
+
+bool
+LadderScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_bottom.empty ();
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  return m_bottom.front ();
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  Scheduler::Event ev = m_bottom.front ();
+  m_bottom.pop_front ();
+  FillBottom ();
+  NS_LOG_DEBUG ("remove " << ev.impl << " ts=" << ev.key.m_ts << " uid=" << ev.key.m_uid);
+  return ev;
+}
+
+void
+LadderScheduler::Remove (const Scheduler::Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  NS_ASSERT (!IsEmpty ());
+  Bucket *bucket = FindBucket (ev.key.m_ts);
+  if (bucket == 0)
+    {
+      std::deque<Scheduler::Event>::iterator it = std::lower_bound (m_bottom.begin (), m_bottom.end (), ev);
+      NS_ASSERT (it != m_bottom.end () && it->key.m_uid == ev.key.m_uid);
+      m_bottom.erase (it);
+    }
+  else
+    {
+      // searching the bucket would cost O(n) for the events in the top,
+      // which are most of the events removed (far away timeouts)
+      m_removed.insert (ev.key.m_uid);
+    }
+  FillBottom ();
+}
+
+void
+LadderScheduler::Purge (Bucket &bucket)
+{
+  if (m_removed.empty ())
+    {
+      return;
+    }
+  std::size_t i = 0;
+  while (i < bucket.size ())
+    {
+      std::unordered_set<uint32_t>::iterator it = m_removed.find (bucket[i].key.m_uid);
+      if (it == m_removed.end ())
+        {
+          i++;
+          continue;
+        }
+      m_removed.erase (it);
+      bucket[i] = bucket.back ();
+      bucket.pop_back ();
+    }
+}
+
+void
+LadderScheduler::TopToLadder (void)
+{
+  NS_LOG_FUNCTION (this << m_top.size ());
+  NS_ASSERT (m_nRungs == 0);
+  NS_ASSERT (!m_top.empty ());
+  // the bounds of the top are only computed now, as removed events are
+  // only discarded now
+  uint64_t topMin = std::numeric_limits<uint64_t>::max ();
+  uint64_t topMax = 0;
+  for (Bucket::const_iterator it = m_top.begin (); it != m_top.end (); ++it)
+    {
+      topMin = std::min (topMin, it->key.m_ts);
+      topMax = std::max (topMax, it->key.m_ts);
+    }
+  // one event per bucket on average
+  uint64_t width = std::max<uint64_t> ((topMax - topMin) / m_top.size (), 1);
+  uint64_t nBuckets = (topMax - topMin) / width + 1;
+
+  Rung &rung = m_rungs[0];
+  rung.m_buckets.resize (nBuckets);
+  rung.m_start = topMin;
+  rung.m_width = width;
+  rung.m_current = 0;
+  for (Bucket::const_iterator it = m_top.begin (); it != m_top.end (); ++it)
+    {
+      rung.m_buckets[(it->key.m_ts - rung.m_start) / width].push_back (*it);
+    }
+  m_nRungs = 1;
+
+  m_topStart = rung.m_start + nBuckets * width;
+  m_top.clear ();
+}
+
+void
+LadderScheduler::SpawnRung (Bucket &bucket, uint64_t start, uint64_t width)
+{
+  NS_LOG_FUNCTION (this << bucket.size () << start << width);
+  NS_ASSERT (m_nRungs < MAX_RUNGS);
+  uint64_t newWidth = std::max<uint64_t> (width / bucket.size (), 1);
+
+  Rung &rung = m_rungs[m_nRungs];
+  rung.m_buckets.resize ((width + newWidth - 1) / newWidth);
+  rung.m_start = start;
+  rung.m_width = newWidth;
+  rung.m_current = 0;
+  for (Bucket::const_iterator it = bucket.begin (); it != bucket.end (); ++it)
+    {
+      rung.m_buckets[(it->key.m_ts - start) / newWidth].push_back (*it);
+    }
+  m_nRungs++;
+  bucket.clear ();
+}
+
+void
+LadderScheduler::BottomToLadder (void)
+{
+  NS_LOG_FUNCTION (this << m_bottom.size ());
+  NS_ASSERT (m_nRungs < MAX_RUNGS);
+  // the bottom holds the events which are earlier than the lowest rung
+  uint64_t start = m_bottom.front ().key.m_ts;
+  uint64_t end = (m_nRungs > 0 ? GetCurrentStart (m_rungs[m_nRungs - 1]) : m_topStart);
+  uint64_t width = std::max<uint64_t> ((end - start) / m_bottom.size (), 1);
+
+  Rung &rung = m_rungs[m_nRungs];
+  rung.m_buckets.resize ((end - start + width - 1) / width);
+  rung.m_start = start;
+  rung.m_width = width;
+  rung.m_current = 0;
+  for (std::deque<Scheduler::Event>::const_iterator it = m_bottom.begin (); it != m_bottom.end (); ++it)
+    {
+      rung.m_buckets[(it->key.m_ts - start) / width].push_back (*it);
+    }
+  m_nRungs++;
+  m_bottom.clear ();
+  FillBottom ();
+  // if the events could not be spread, do not try again before the
+  // bottom has doubled, to keep insertion O(1) amortized
+  m_bottomLimit = std::max<std::size_t> (THRESHOLD, 2 * m_bottom.size ());
+}
+
+void
+LadderScheduler::BucketToBottom (Bucket &bucket)
+{
+  NS_LOG_FUNCTION (this << bucket.size ());
+  NS_ASSERT (m_bottom.empty ());
+  m_bottom.assign (bucket.begin (), bucket.end ());
+  bucket.clear ();
+  std::sort (m_bottom.begin (), m_bottom.end ());
+  m_bottomLimit = std::max<std::size_t> (THRESHOLD, 2 * m_bottom.size ());
+}
+
+void
+LadderScheduler::FillBottom (void)
+{
+  while (m_bottom.empty ())
+    {
+      if (m_nRungs == 0)
+        {
+          Purge (m_top);
+          if (m_top.empty ())
+            {
+              return;
+            }
+          TopToLadder ();
+        }
+
+      Rung &rung = m_rungs[m_nRungs - 1];
+      while (rung.m_current < rung.m_buckets.size ()
+             && rung.m_buckets[rung.m_current].empty ())
+        {
+          rung.m_current++;
+        }
+      if (rung.m_current == rung.m_buckets.size ())
+        {
+          // the rung is exhausted: go back to the one above
+          m_nRungs--;
+          continue;
+        }
+
+      Bucket &bucket = rung.m_buckets[rung.m_current];
+      uint64_t start = GetCurrentStart (rung);
+      rung.m_current++;
+      Purge (bucket);
+      if (bucket.empty ())
+        {
+          continue;
+        }
+      if (bucket.size () > THRESHOLD && rung.m_width > 1 && m_nRungs < MAX_RUNGS)
+        {
+          SpawnRung (bucket, start, rung.m_width);
+        }
+      else
+        {
+          BucketToBottom (bucket);
+        }
+    }
+}
+
+} // namespace ns3
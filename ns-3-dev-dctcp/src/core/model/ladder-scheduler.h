@@ -0,0 +1,171 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+#include <deque>
+#include <unordered_set>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler is an implementation of the Ladder Queue described in
+ * "Ladder queue: An O(1) priority queue structure for large-scale discrete
+ * event simulation", W. T. Tang, R. S. M. Goh and I. L.-J. Thng,
+ * ACM TOMACS, 2005.
+ *
+ * The events are split in three tiers:
+ *  - the top, an unsorted list of the events which are far in the future;
+ *  - the ladder, made of up to MAX_RUNGS rungs of unsorted buckets. When
+ *    the bottom is empty, the top is spread over a first rung whose bucket
+ *    width is chosen so that each bucket holds one event on average; a
+ *    bucket which is still too crowded is spread over a new, finer rung;
+ *  - the bottom, a small sorted list of the earliest events. If events
+ *    keep being inserted in the bottom until it holds more than THRESHOLD
+ *    events, it is spread over a new rung as well.
+ *
+ * Events are only sorted once they reach the bottom, in small batches, so
+ * insertion and removal take O(1) amortized time whatever the distribution
+ * of the timestamps and without any explicit resize step. Events removed
+ * from the top or the ladder are not searched for: their uid is recorded,
+ * and they are discarded when their bucket is spread or sorted. Buckets of a rung
+ * which cannot be split any further (all the events have the same
+ * timestamp, or the maximum number of rungs is reached) are sorted into the
+ * bottom as a whole.
+ *
+ * The bottom is never empty unless the scheduler is, so that PeekNext is
+ * a constant time operation.
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  LadderScheduler ();
+  /** Destructor. */
+  virtual ~LadderScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+private:
+  /** Unsorted list of events. */
+  typedef std::vector<Scheduler::Event> Bucket;
+
+  /** A rung of the ladder. */
+  struct Rung
+  {
+    std::vector<Bucket> m_buckets; /**< The buckets. */
+    uint64_t m_start;              /**< Timestamp of the start of the first bucket. */
+    uint64_t m_width;              /**< Width of the buckets. */
+    uint32_t m_current;            /**< Index of the first bucket not yet sent down. */
+  };
+
+  /**
+   * Discard the removed events of a bucket.
+   *
+   * \param [in,out] bucket The bucket.
+   */
+  void Purge (Bucket &bucket);
+  /**
+   * Spread the events in the top over the first rung.
+   */
+  void TopToLadder (void);
+  /**
+   * Create a new rung holding the events of a bucket of the lowest rung.
+   *
+   * \param [in,out] bucket The bucket to spread, emptied on return.
+   * \param [in] start The timestamp of the start of the bucket.
+   * \param [in] width The width of the bucket.
+   */
+  void SpawnRung (Bucket &bucket, uint64_t start, uint64_t width);
+  /**
+   * Sort the events of a bucket into the bottom.
+   *
+   * \param [in,out] bucket The bucket to sort, emptied on return.
+   */
+  void BucketToBottom (Bucket &bucket);
+  /**
+   * Refill the bottom from the ladder and the top, if it is empty.
+   */
+  void FillBottom (void);
+  /**
+   * Spread the events in the bottom over a new rung.
+   */
+  void BottomToLadder (void);
+  /**
+   * Insert an event in the sorted bottom.
+   *
+   * \param [in] ev The event to insert.
+   */
+  void InsertInBottom (const Scheduler::Event &ev);
+  /**
+   * Find the bucket an event belongs to.
+   *
+   * \param [in] ts The timestamp of the event.
+   * \returns The bucket in the top or the ladder, or 0 if the event belongs
+   *          to the bottom.
+   */
+  Bucket * FindBucket (uint64_t ts);
+  /**
+   * Get the start of the first bucket of a rung not yet sent down.
+   *
+   * \param [in] rung The rung.
+   * \returns The timestamp below which events do not belong to the rung.
+   */
+  static uint64_t GetCurrentStart (const Rung &rung);
+
+  /** Maximum number of rungs. */
+  static const uint32_t MAX_RUNGS = 8;
+  /** Number of events above which a bucket is spread over a new rung. */
+  static const uint32_t THRESHOLD = 50;
+
+  Bucket m_top;             /**< Events far in the future. */
+  uint64_t m_topStart;      /**< Timestamp from which events belong to the top. */
+  std::vector<Rung> m_rungs; /**< The rungs, allocated once. */
+  uint32_t m_nRungs;        /**< Number of rungs in use. */
+  std::deque<Scheduler::Event> m_bottom; /**< The earliest events, sorted. */
+  /** Size above which the bottom is spread over a new rung. */
+  std::size_t m_bottomLimit;
+  /** Uids of the events removed from the top or the ladder, not yet discarded. */
+  std::unordered_set<uint32_t> m_removed;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
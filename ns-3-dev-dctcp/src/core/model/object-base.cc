@@ -81,6 +81,10 @@ ObjectBase::ConstructSelf (const AttributeConstructionList &attributes)
 {
   // loop over the inheritance tree back to the Object base class.
   NS_LOG_FUNCTION (this << &attributes);
+#ifdef HAVE_GETENV
+  // The environment is read once per object, rather than for every attribute
+  char *envVar = getenv ("NS_ATTRIBUTE_DEFAULT");
+#endif /* HAVE_GETENV */
   TypeId tid = GetInstanceTypeId ();
   do {
       // loop over all attributes in object type
@@ -126,7 +130,6 @@ ObjectBase::ConstructSelf (const AttributeConstructionList &attributes)
 
 #ifdef HAVE_GETENV
           // No matching attribute value so we try to look at the env var.
-          char *envVar = getenv ("NS_ATTRIBUTE_DEFAULT");
           if (envVar != 0)
             {
               std::string env = std::string (envVar);
@@ -220,6 +220,27 @@ public:
   virtual bool Get (const ObjectBase * object, AttributeValue &value) const;
   virtual bool HasGetter (void) const;
   virtual bool HasSetter (void) const;
+  /**
+   * Get the number of instances in the container, without copying them
+   * as Get does.
+   *
+   * \param [in] object The container object.
+   * \param [out] n The number of instances in the container.
+   * \returns true if the value could be obtained successfully.
+   */
+  bool GetItemN (const ObjectBase *object, std::size_t *n) const;
+  /**
+   * Get one instance from the container, without copying the others
+   * as Get does.
+   *
+   * \param [in] object The container object, whose number of instances
+   *             was obtained successfully by GetItemN.
+   * \param [in] i The position of the instance, smaller than the number
+   *             of instances.
+   * \param [out] index The index of the instance in the container.
+   * \returns The instance.
+   */
+  Ptr<Object> GetItem (const ObjectBase *object, std::size_t i, std::size_t *index) const;
 private:
   /**
    * Get the number of instances in the container.
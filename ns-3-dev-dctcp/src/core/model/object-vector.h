@@ -20,6 +20,7 @@
 #ifndef OBJECT_VECTOR_H
 #define OBJECT_VECTOR_H
 
+#include <iterator>
 #include "object.h"
 #include "ptr.h"
 #include "attribute.h"
@@ -93,21 +94,13 @@ MakeObjectVectorAccessor (U T::*memberVector)
     }
     virtual Ptr<Object> DoGet(const ObjectBase *object, std::size_t i, std::size_t *index) const {
       const T *obj = static_cast<const T *> (object);
-      typename U::const_iterator begin = (obj->*m_memberVector).begin ();
-      typename U::const_iterator end = (obj->*m_memberVector).end ();
-      std::size_t k = 0;
-      for (typename U::const_iterator j = begin; j != end; j++, k++)
-        {
-          if (k == i)
-            {
-              *index = k;
-              return *j;
-              break;
-            }
-        }
-      NS_ASSERT (false);
-      // quiet compiler.
-      return 0;
+      NS_ASSERT (i < (obj->*m_memberVector).size ());
+      // Constant time for the random access containers, so that getting
+      // all the objects of a large container is not quadratic
+      typename U::const_iterator j = (obj->*m_memberVector).begin ();
+      std::advance (j, i);
+      *index = i;
+      return *j;
     }
     U T::*m_memberVector;
   } *spec = new MemberStdContainer ();
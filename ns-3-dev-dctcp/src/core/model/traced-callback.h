@@ -21,7 +21,7 @@
 #ifndef TRACED_CALLBACK_H
 #define TRACED_CALLBACK_H
 
-#include <list>
+#include <vector>
 #include "callback.h"
 
 /**
@@ -46,6 +46,18 @@ namespace ns3 {
  * calling one of the \c operator() forms with the appropriate
  * number of arguments.
  *
+ * Most trace sources have no Callback connected, or a single one, and
+ * they are hit for every packet: the first Callback is therefore kept
+ * inline, and the others in a vector allocated on demand.  Invoking a
+ * trace source with no Callback costs a null pointer test or two.
+ *
+ * A Callback may connect Callbacks to the chain while it is invoked, or
+ * disconnect any Callback, including itself.  Callbacks connected while
+ * the chain is invoked are appended to it, hence invoked by the current
+ * invocation.  Callbacks disconnected while the chain is invoked are not
+ * invoked any more, and are only released, and the chain compacted, once
+ * the outermost invocation of the chain ends.
+ *
  * \tparam T1 \explicit Type of the first argument to the functor.
  * \tparam T2 \explicit Type of the second argument to the functor.
  * \tparam T3 \explicit Type of the third argument to the functor.
@@ -64,6 +76,21 @@ class TracedCallback
 public:
   /** Constructor. */
   TracedCallback ();
+  /**
+   * Copy constructor.
+   *
+   * \param [in] o The TracedCallback to copy.
+   */
+  TracedCallback (const TracedCallback &o);
+  /**
+   * Assignment.
+   *
+   * \param [in] o The TracedCallback to copy.
+   * \returns This TracedCallback.
+   */
+  TracedCallback &operator = (const TracedCallback &o);
+  /** Destructor. */
+  ~TracedCallback ();
   /**
    * Append a Callback to the chain (without a context).
    *
@@ -93,6 +120,15 @@ public:
    * \param [in] path Context path which was used to connect the Callback.
    */
   void Disconnect (const CallbackBase & callback, std::string path);
+  /**
+   * Check whether any Callback is connected.
+   *
+   * This lets a caller skip building the arguments of a trace
+   * nobody listens to.
+   *
+   * \returns \c true if the chain of Callbacks is empty.
+   */
+  bool IsEmpty (void) const;
   /**
    * \name Functors taking various numbers of arguments.
    *
@@ -223,7 +259,7 @@ public:
   
 private:
   /**
-   * Container type for holding the chain of Callbacks.
+   * Container type for holding the Callbacks after the first one.
    *
    * \tparam T1 \deduced Type of the first argument to the functor.
    * \tparam T2 \deduced Type of the second argument to the functor.
@@ -234,9 +270,43 @@ private:
    * \tparam T7 \deduced Type of the seventh argument to the functor.
    * \tparam T8 \deduced Type of the eighth argument to the functor.
    */
-  typedef std::list<Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> > CallbackList;
-  /** The chain of Callbacks. */
-  CallbackList m_callbackList;
+  typedef std::vector<Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> > CallbackList;
+  /** The Callbacks of the chain after the first one. */
+  struct More
+  {
+    /** The Callbacks, null if disconnected while the chain is invoked. */
+    CallbackList callbacks;
+    /** The Callbacks disconnected while the chain is invoked. */
+    CallbackList released;
+  };
+  /**
+   * Append a Callback to the chain.
+   *
+   * \param [in] callback Callback to add to chain.
+   */
+  void Append (const Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> &callback);
+  /**
+   * Remove a Callback from the chain, leaving a null Callback in its slot.
+   *
+   * If the chain is being invoked, the Callback is kept alive until the
+   * invocation ends, as it may be the one running.
+   *
+   * \param [in,out] callback The slot of the Callback to remove.
+   */
+  void Release (Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> &callback);
+  /**
+   * Release the Callbacks disconnected while the chain was invoked, and
+   * move the remaining Callbacks to the first slots of the chain.
+   */
+  void Compact (void);
+  /** Mark the end of an invocation of the chain. */
+  void EndInvoke (void) const;
+  /** The first Callback of the chain, null if the chain is empty. */
+  Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> m_first;
+  /** The next Callbacks of the chain, if any. */
+  More *m_more;
+  /** Number of the invocations of the chain in progress. */
+  mutable uint32_t m_invoking;
 };
 
 } // namespace ns3
@@ -253,8 +323,142 @@ template<typename T1, typename T2,
          typename T5, typename T6,
          typename T7, typename T8>
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::TracedCallback ()
-  : m_callbackList () 
+  : m_first (),
+    m_more (0),
+    m_invoking (0)
+{
+}
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::TracedCallback (const TracedCallback &o)
+  : m_first (),
+    m_more (0),
+    m_invoking (0)
+{
+  *this = o;
+}
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8> &
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator = (const TracedCallback &o)
+{
+  if (this != &o)
+    {
+      NS_ASSERT_MSG (m_invoking == 0, "TracedCallback assigned while it is invoked");
+      m_first = Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> ();
+      delete m_more;
+      m_more = 0;
+      // the Callbacks disconnected from o are not copied
+      if (!o.m_first.IsNull ())
+        {
+          Append (o.m_first);
+        }
+      if (o.m_more != 0)
+        {
+          for (typename CallbackList::const_iterator i = o.m_more->callbacks.begin ();
+               i != o.m_more->callbacks.end (); i++)
+            {
+              if (!(*i).IsNull ())
+                {
+                  Append (*i);
+                }
+            }
+        }
+    }
+  return *this;
+}
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::~TracedCallback ()
+{
+  delete m_more;
+}
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Append (const Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> &callback)
+{
+  // while the chain is invoked, the first slot may have been released:
+  // the Callback must still be appended at the end of the chain
+  if (m_first.IsNull () && m_more == 0)
+    {
+      m_first = callback;
+    }
+  else
+    {
+      if (m_more == 0)
+        {
+          m_more = new More ();
+        }
+      m_more->callbacks.push_back (callback);
+    }
+}
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Release (Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> &callback)
+{
+  if (m_invoking > 0)
+    {
+      if (m_more == 0)
+        {
+          m_more = new More ();
+        }
+      m_more->released.push_back (callback);
+    }
+  callback = Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> ();
+}
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Compact (void)
+{
+  if (m_more == 0)
+    {
+      return;
+    }
+  More *more = m_more;
+  m_more = 0;
+  Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> first = m_first;
+  m_first = Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> ();
+  if (!first.IsNull ())
+    {
+      Append (first);
+    }
+  for (typename CallbackList::const_iterator i = more->callbacks.begin ();
+       i != more->callbacks.end (); i++)
+    {
+      if (!(*i).IsNull ())
+        {
+          Append (*i);
+        }
+    }
+  delete more;
+}
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+inline void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::EndInvoke (void) const
 {
+  if (--m_invoking == 0 && m_more != 0 && !m_more->released.empty ())
+    {
+      // a Callback was disconnected, hence the chain is not a const object
+      const_cast<TracedCallback *> (this)->Compact ();
+    }
 }
 template<typename T1, typename T2,
          typename T3, typename T4,
@@ -266,7 +470,7 @@ TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::ConnectWithoutContext (const CallbackBa
   Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> cb;
   if (!cb.Assign (callback))
     NS_FATAL_ERROR_NO_MSG();
-  m_callbackList.push_back (cb);
+  Append (cb);
 }
 template<typename T1, typename T2,
          typename T3, typename T4,
@@ -279,7 +483,7 @@ TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Connect (const CallbackBase & callback,
   if (!cb.Assign (callback))
     NS_FATAL_ERROR ("when connecting to " << path);
   Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> realCb = cb.Bind (path);
-  m_callbackList.push_back (realCb);
+  Append (realCb);
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
@@ -288,18 +492,26 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::DisconnectWithoutContext (const CallbackBase & callback)
 {
-  for (typename CallbackList::iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); /* empty */)
+  if (!m_first.IsNull () && m_first.IsEqual (callback))
     {
-      if ((*i).IsEqual (callback))
-        {
-          i = m_callbackList.erase (i);
-        }
-      else
+      Release (m_first);
+    }
+  if (m_more != 0)
+    {
+      for (typename CallbackList::iterator i = m_more->callbacks.begin ();
+           i != m_more->callbacks.end (); i++)
         {
-          i++;
+          if (!(*i).IsNull () && (*i).IsEqual (callback))
+            {
+              Release (*i);
+            }
         }
     }
+  // while the chain is invoked, the slots of the Callbacks must not move
+  if (m_invoking == 0)
+    {
+      Compact ();
+    }
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
@@ -314,122 +526,257 @@ TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Disconnect (const CallbackBase & callba
   Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> realCb = cb.Bind (path);
   DisconnectWithoutContext (realCb);
 }
-template<typename T1, typename T2, 
+template<typename T1, typename T2,
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+bool
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::IsEmpty (void) const
+{
+  return m_first.IsNull () && m_more == 0;
+}
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+inline void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (void) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_first.IsNull () && m_more == 0)
+    {
+      return;
+    }
+  m_invoking++;
+  if (!m_first.IsNull ())
     {
-      (*i)();
+      m_first ();
     }
+  // the Callbacks may connect or disconnect Callbacks, which leaves the
+  // slots of the chain in place
+  for (std::size_t i = 0; m_more != 0 && i < m_more->callbacks.size (); i++)
+    {
+      if (!m_more->callbacks[i].IsNull ())
+        {
+          m_more->callbacks[i] ();
+        }
+    }
+  EndInvoke ();
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+inline void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_first.IsNull () && m_more == 0)
     {
-      (*i)(a1);
+      return;
     }
+  m_invoking++;
+  if (!m_first.IsNull ())
+    {
+      m_first (a1);
+    }
+  // the Callbacks may connect or disconnect Callbacks, which leaves the
+  // slots of the chain in place
+  for (std::size_t i = 0; m_more != 0 && i < m_more->callbacks.size (); i++)
+    {
+      if (!m_more->callbacks[i].IsNull ())
+        {
+          m_more->callbacks[i] (a1);
+        }
+    }
+  EndInvoke ();
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+inline void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_first.IsNull () && m_more == 0)
+    {
+      return;
+    }
+  m_invoking++;
+  if (!m_first.IsNull ())
+    {
+      m_first (a1, a2);
+    }
+  // the Callbacks may connect or disconnect Callbacks, which leaves the
+  // slots of the chain in place
+  for (std::size_t i = 0; m_more != 0 && i < m_more->callbacks.size (); i++)
     {
-      (*i)(a1, a2);
+      if (!m_more->callbacks[i].IsNull ())
+        {
+          m_more->callbacks[i] (a1, a2);
+        }
     }
+  EndInvoke ();
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+inline void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_first.IsNull () && m_more == 0)
+    {
+      return;
+    }
+  m_invoking++;
+  if (!m_first.IsNull ())
     {
-      (*i)(a1, a2, a3);
+      m_first (a1, a2, a3);
     }
+  // the Callbacks may connect or disconnect Callbacks, which leaves the
+  // slots of the chain in place
+  for (std::size_t i = 0; m_more != 0 && i < m_more->callbacks.size (); i++)
+    {
+      if (!m_more->callbacks[i].IsNull ())
+        {
+          m_more->callbacks[i] (a1, a2, a3);
+        }
+    }
+  EndInvoke ();
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+inline void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_first.IsNull () && m_more == 0)
     {
-      (*i)(a1, a2, a3, a4);
+      return;
     }
+  m_invoking++;
+  if (!m_first.IsNull ())
+    {
+      m_first (a1, a2, a3, a4);
+    }
+  // the Callbacks may connect or disconnect Callbacks, which leaves the
+  // slots of the chain in place
+  for (std::size_t i = 0; m_more != 0 && i < m_more->callbacks.size (); i++)
+    {
+      if (!m_more->callbacks[i].IsNull ())
+        {
+          m_more->callbacks[i] (a1, a2, a3, a4);
+        }
+    }
+  EndInvoke ();
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+inline void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_first.IsNull () && m_more == 0)
+    {
+      return;
+    }
+  m_invoking++;
+  if (!m_first.IsNull ())
+    {
+      m_first (a1, a2, a3, a4, a5);
+    }
+  // the Callbacks may connect or disconnect Callbacks, which leaves the
+  // slots of the chain in place
+  for (std::size_t i = 0; m_more != 0 && i < m_more->callbacks.size (); i++)
     {
-      (*i)(a1, a2, a3, a4, a5);
+      if (!m_more->callbacks[i].IsNull ())
+        {
+          m_more->callbacks[i] (a1, a2, a3, a4, a5);
+        }
     }
+  EndInvoke ();
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+inline void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_first.IsNull () && m_more == 0)
+    {
+      return;
+    }
+  m_invoking++;
+  if (!m_first.IsNull ())
     {
-      (*i)(a1, a2, a3, a4, a5, a6);
+      m_first (a1, a2, a3, a4, a5, a6);
     }
+  // the Callbacks may connect or disconnect Callbacks, which leaves the
+  // slots of the chain in place
+  for (std::size_t i = 0; m_more != 0 && i < m_more->callbacks.size (); i++)
+    {
+      if (!m_more->callbacks[i].IsNull ())
+        {
+          m_more->callbacks[i] (a1, a2, a3, a4, a5, a6);
+        }
+    }
+  EndInvoke ();
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+inline void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_first.IsNull () && m_more == 0)
     {
-      (*i)(a1, a2, a3, a4, a5, a6, a7);
+      return;
     }
+  m_invoking++;
+  if (!m_first.IsNull ())
+    {
+      m_first (a1, a2, a3, a4, a5, a6, a7);
+    }
+  // the Callbacks may connect or disconnect Callbacks, which leaves the
+  // slots of the chain in place
+  for (std::size_t i = 0; m_more != 0 && i < m_more->callbacks.size (); i++)
+    {
+      if (!m_more->callbacks[i].IsNull ())
+        {
+          m_more->callbacks[i] (a1, a2, a3, a4, a5, a6, a7);
+        }
+    }
+  EndInvoke ();
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+inline void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7, T8 a8) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_first.IsNull () && m_more == 0)
+    {
+      return;
+    }
+  m_invoking++;
+  if (!m_first.IsNull ())
+    {
+      m_first (a1, a2, a3, a4, a5, a6, a7, a8);
+    }
+  // the Callbacks may connect or disconnect Callbacks, which leaves the
+  // slots of the chain in place
+  for (std::size_t i = 0; m_more != 0 && i < m_more->callbacks.size (); i++)
     {
-      (*i)(a1, a2, a3, a4, a5, a6, a7, a8);
+      if (!m_more->callbacks[i].IsNull ())
+        {
+          m_more->callbacks[i] (a1, a2, a3, a4, a5, a6, a7, a8);
+        }
     }
+  EndInvoke ();
 }
 
 } // namespace ns3
@@ -23,7 +23,9 @@
 #include "singleton.h"
 #include "trace-source-accessor.h"
 
+#include <algorithm>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <sstream>
 #include <iomanip>
@@ -270,6 +272,22 @@ public:
    * \returns \c true if this TypeId should be hidden from the user.
    */
   bool MustHideFromDocumentation (uint16_t uid) const;
+  /**
+   * Find an Attribute of a type id, or of its parents, by name.
+   * \param [in] uid The id.
+   * \param [in] name The Attribute name.
+   * \returns The Attribute, or 0 if \p uid has no Attribute \p name.
+   *   The pointer is valid until another Attribute is registered.
+   */
+  const struct TypeId::AttributeInformation *FindAttribute (uint16_t uid, const std::string &name) const;
+  /**
+   * Find a TraceSource of a type id, or of its parents, by name.
+   * \param [in] uid The id.
+   * \param [in] name The TraceSource name.
+   * \returns The TraceSource, or 0 if \p uid has no TraceSource \p name.
+   *   The pointer is valid until another TraceSource is registered.
+   */
+  const struct TypeId::TraceSourceInformation *FindTraceSource (uint16_t uid, const std::string &name) const;
 
 private:
   /**
@@ -293,6 +311,13 @@ private:
    */
   static TypeId::hash_t Hasher (const std::string name);
 
+  /**
+   * Type of the by-name index of the Attributes, or of the TraceSources,
+   * of a type id and of its parents: the type id of each item, and its
+   * index in this type id.
+   */
+  typedef std::unordered_map<std::string, std::pair<uint16_t, std::size_t> > itemmap_t;
+
   /** The information record about a single type id. */
   struct IidInformation {
     /** The type id name. */
@@ -315,6 +340,12 @@ private:
     std::vector<struct TypeId::AttributeInformation> attributes;
     /** The container of TraceSources. */
     std::vector<struct TypeId::TraceSourceInformation> traceSources;
+    /** The Attributes of this type id and of its parents, by name. */
+    itemmap_t attributeIndex;
+    /** The TraceSources of this type id and of its parents, by name. */
+    itemmap_t traceSourceIndex;
+    /** The type ids whose parent is this type id. */
+    std::vector<uint16_t> children;
     /** Support level/deprecation. */
     TypeId::SupportLevel supportLevel;
     /** Support message. */
@@ -323,6 +354,23 @@ private:
   /** Iterator type. */
   typedef std::vector<struct IidInformation>::const_iterator Iterator;
 
+  /**
+   * Add an Attribute or a TraceSource to the index of a type id, and to
+   * those of its children, unless they have an item of the same name.
+   * \param [in] index The index to update.
+   * \param [in] uid The id.
+   * \param [in] name The item name.
+   * \param [in] item The type id of the item, and its index in this type id.
+   */
+  void AddToIndex (itemmap_t IidInformation::*index, uint16_t uid,
+                   const std::string &name, std::pair<uint16_t, std::size_t> item);
+  /**
+   * Build the indices of a type id, and those of its children, from
+   * the index of its parent.
+   * \param [in] uid The id.
+   */
+  void UpdateIndices (uint16_t uid);
+
   /**
    * Retrieve the information record for a type.
    * \param [in] uid The id.
@@ -466,7 +514,17 @@ IidManager::SetParent (uint16_t uid, uint16_t parent)
   NS_LOG_FUNCTION (IID << uid << parent);
   NS_ASSERT (parent <= m_information.size ());
   struct IidInformation *information = LookupInformation (uid);
+  if (information->parent != 0 && information->parent != uid)
+    {
+      std::vector<uint16_t> &siblings = LookupInformation (information->parent)->children;
+      siblings.erase (std::find (siblings.begin (), siblings.end (), uid));
+    }
   information->parent = parent;
+  if (parent != 0 && parent != uid)
+    {
+      LookupInformation (parent)->children.push_back (uid);
+    }
+  UpdateIndices (uid);
 }
 void 
 IidManager::SetGroupName (uint16_t uid, std::string groupName)
@@ -613,30 +671,9 @@ IidManager::HasAttribute (uint16_t uid,
                           std::string name)
 {
   NS_LOG_FUNCTION (IID << uid << name);
-  struct IidInformation *information  = LookupInformation (uid);
-  while (true)
-    {
-      for (std::vector<struct TypeId::AttributeInformation>::const_iterator i = information->attributes.begin ();
-           i != information->attributes.end (); ++i)
-        {
-          if (i->name == name)
-            {
-              NS_LOG_LOGIC (IIDL << true);
-              return true;
-            }
-        }
-      struct IidInformation *parent = LookupInformation (information->parent);
-      if (parent == information)
-        {
-          // top of inheritance tree
-          NS_LOG_LOGIC (IIDL << false);
-          return false;
-        }
-      // check parent
-      information = parent;
-    }
-  NS_LOG_LOGIC (IIDL << false);
-  return false;
+  bool found = FindAttribute (uid, name) != 0;
+  NS_LOG_LOGIC (IIDL << found);
+  return found;
 }
 
 void 
@@ -676,6 +713,8 @@ IidManager::AddAttribute (uint16_t uid,
   info.supportLevel = supportLevel;
   info.supportMsg = supportMsg;
   information->attributes.push_back (info);
+  AddToIndex (&IidInformation::attributeIndex, uid, name,
+              std::make_pair (uid, information->attributes.size () - 1));
   NS_LOG_LOGIC (IIDL << information->attributes.size () - 1);
 }
 void 
@@ -715,30 +754,9 @@ IidManager::HasTraceSource (uint16_t uid,
                             std::string name)
 {
   NS_LOG_FUNCTION (IID << uid << name);
-  struct IidInformation *information  = LookupInformation (uid);
-  while (true)
-    {
-      for (std::vector<struct TypeId::TraceSourceInformation>::const_iterator i = information->traceSources.begin ();
-           i != information->traceSources.end (); ++i)
-        {
-          if (i->name == name)
-            {
-              NS_LOG_LOGIC (IIDL << true);
-              return true ;
-            }
-        }
-      struct IidInformation *parent = LookupInformation (information->parent);
-      if (parent == information)
-        {
-          // top of inheritance tree
-          NS_LOG_LOGIC (IIDL << false);
-          return false;
-        }
-      // check parent
-      information = parent;
-    }
-  NS_LOG_LOGIC (IIDL << false);
-  return false;
+  bool found = FindTraceSource (uid, name) != 0;
+  NS_LOG_LOGIC (IIDL << found);
+  return found;
 }
 
 void 
@@ -767,6 +785,8 @@ IidManager::AddTraceSource (uint16_t uid,
   source.supportLevel = supportLevel;
   source.supportMsg = supportMsg;
   information->traceSources.push_back (source);
+  AddToIndex (&IidInformation::traceSourceIndex, uid, name,
+              std::make_pair (uid, information->traceSources.size () - 1));
   NS_LOG_LOGIC (IIDL << information->traceSources.size () - 1);
 }
 std::size_t
@@ -797,6 +817,80 @@ IidManager::MustHideFromDocumentation (uint16_t uid) const
   return hide;
 }
 
+const struct TypeId::AttributeInformation *
+IidManager::FindAttribute (uint16_t uid, const std::string &name) const
+{
+  NS_LOG_FUNCTION (IID << uid << name);
+  struct IidInformation *information = LookupInformation (uid);
+  itemmap_t::const_iterator i = information->attributeIndex.find (name);
+  if (i == information->attributeIndex.end ())
+    {
+      return 0;
+    }
+  return &LookupInformation (i->second.first)->attributes[i->second.second];
+}
+
+const struct TypeId::TraceSourceInformation *
+IidManager::FindTraceSource (uint16_t uid, const std::string &name) const
+{
+  NS_LOG_FUNCTION (IID << uid << name);
+  struct IidInformation *information = LookupInformation (uid);
+  itemmap_t::const_iterator i = information->traceSourceIndex.find (name);
+  if (i == information->traceSourceIndex.end ())
+    {
+      return 0;
+    }
+  return &LookupInformation (i->second.first)->traceSources[i->second.second];
+}
+
+void
+IidManager::AddToIndex (itemmap_t IidInformation::*index, uint16_t uid,
+                        const std::string &name, std::pair<uint16_t, std::size_t> item)
+{
+  NS_LOG_FUNCTION (IID << uid << name << item.first << item.second);
+  struct IidInformation *information = LookupInformation (uid);
+  // An item of the type id itself hides the items of its parents
+  if (!(information->*index).insert (std::make_pair (name, item)).second)
+    {
+      return;
+    }
+  for (std::size_t i = 0; i < information->children.size (); i++)
+    {
+      AddToIndex (index, information->children[i], name, item);
+    }
+}
+
+void
+IidManager::UpdateIndices (uint16_t uid)
+{
+  NS_LOG_FUNCTION (IID << uid);
+  struct IidInformation *information = LookupInformation (uid);
+  information->attributeIndex.clear ();
+  information->traceSourceIndex.clear ();
+  for (std::size_t i = 0; i < information->attributes.size (); i++)
+    {
+      information->attributeIndex.insert (std::make_pair (information->attributes[i].name,
+                                                          std::make_pair (uid, i)));
+    }
+  for (std::size_t i = 0; i < information->traceSources.size (); i++)
+    {
+      information->traceSourceIndex.insert (std::make_pair (information->traceSources[i].name,
+                                                            std::make_pair (uid, i)));
+    }
+  if (information->parent != 0 && information->parent != uid)
+    {
+      struct IidInformation *parent = LookupInformation (information->parent);
+      information->attributeIndex.insert (parent->attributeIndex.begin (),
+                                          parent->attributeIndex.end ());
+      information->traceSourceIndex.insert (parent->traceSourceIndex.begin (),
+                                            parent->traceSourceIndex.end ());
+    }
+  for (std::size_t i = 0; i < information->children.size (); i++)
+    {
+      UpdateIndices (information->children[i]);
+    }
+}
+
 } // namespace ns3
 
 namespace ns3 {
@@ -877,37 +971,29 @@ bool
 TypeId::LookupAttributeByName (std::string name, struct TypeId::AttributeInformation *info) const
 {
   NS_LOG_FUNCTION (this << name << info);
-  TypeId tid;
-  TypeId nextTid = *this;
-  do {
-      tid = nextTid;
-      for (std::size_t i = 0; i < tid.GetAttributeN (); i++)
-        {
-          struct TypeId::AttributeInformation tmp = tid.GetAttribute (i);
-          if (tmp.name == name)
-            {
-              if (tmp.supportLevel == TypeId::SUPPORTED)
-                {
-                  *info = tmp;
-                  return true;
-                }
-              else if (tmp.supportLevel == TypeId::DEPRECATED)
-                {
-                  std::cerr << "Attribute '" << name << "' is deprecated: "
-                                 << tmp.supportMsg << std::endl;
-                  *info = tmp;
-                  return true;
-                }
-              else if (tmp.supportLevel == TypeId::OBSOLETE)
-                {
-                  NS_FATAL_ERROR ("Attribute '" << name
-                                  << "' is obsolete, with no fallback: "
-                                  << tmp.supportMsg);
-                }
-            }
-        }
-      nextTid = tid.GetParent ();
-    } while (nextTid != tid);
+  const struct TypeId::AttributeInformation *tmp = IidManager::Get ()->FindAttribute (m_tid, name);
+  if (tmp == 0)
+    {
+      return false;
+    }
+  if (tmp->supportLevel == TypeId::SUPPORTED)
+    {
+      *info = *tmp;
+      return true;
+    }
+  else if (tmp->supportLevel == TypeId::DEPRECATED)
+    {
+      std::cerr << "Attribute '" << name << "' is deprecated: "
+                     << tmp->supportMsg << std::endl;
+      *info = *tmp;
+      return true;
+    }
+  else if (tmp->supportLevel == TypeId::OBSOLETE)
+    {
+      NS_FATAL_ERROR ("Attribute '" << name
+                      << "' is obsolete, with no fallback: "
+                      << tmp->supportMsg);
+    }
   return false;
 }
 
@@ -1137,38 +1223,29 @@ TypeId::LookupTraceSourceByName (std::string name,
                                  struct TraceSourceInformation *info) const
 {
   NS_LOG_FUNCTION (this << name);
-  TypeId tid;
-  TypeId nextTid = *this;
-  struct TypeId::TraceSourceInformation tmp;
-  do {
-      tid = nextTid;
-      for (std::size_t i = 0; i < tid.GetTraceSourceN(); i++)
-        {
-          tmp = tid.GetTraceSource (i);
-          if (tmp.name == name)
-            {
-              if (tmp.supportLevel == TypeId::SUPPORTED)
-                {
-                  *info = tmp;
-                   return tmp.accessor;
-                }
-              else if (tmp.supportLevel == TypeId::DEPRECATED)
-                {
-                  std::cerr << "TraceSource '" << name << "' is deprecated: "
-                                 << tmp.supportMsg << std::endl;
-                  *info = tmp;
-                  return tmp.accessor;
-                }
-              else  if (tmp.supportLevel == TypeId::OBSOLETE)
-                {
-                  NS_FATAL_ERROR ("TraceSource '" << name
-                                  << "' is obsolete, with no fallback: "
-                                  << tmp.supportMsg);
-                }
-            }
-        }
-      nextTid = tid.GetParent ();
-    } while (nextTid != tid);
+  const struct TypeId::TraceSourceInformation *tmp = IidManager::Get ()->FindTraceSource (m_tid, name);
+  if (tmp == 0)
+    {
+      return 0;
+    }
+  if (tmp->supportLevel == TypeId::SUPPORTED)
+    {
+      *info = *tmp;
+      return tmp->accessor;
+    }
+  else if (tmp->supportLevel == TypeId::DEPRECATED)
+    {
+      std::cerr << "TraceSource '" << name << "' is deprecated: "
+                     << tmp->supportMsg << std::endl;
+      *info = *tmp;
+      return tmp->accessor;
+    }
+  else  if (tmp->supportLevel == TypeId::OBSOLETE)
+    {
+      NS_FATAL_ERROR ("TraceSource '" << name
+                      << "' is obsolete, with no fallback: "
+                      << tmp->supportMsg);
+    }
   return 0;
 }
 
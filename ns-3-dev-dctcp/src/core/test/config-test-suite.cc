@@ -27,6 +27,7 @@
 #include "ns3/singleton.h"
 #include "ns3/object.h"
 #include "ns3/object-vector.h"
+#include "ns3/object-map.h"
 #include "ns3/names.h"
 #include "ns3/pointer.h"
 #include "ns3/log.h"
@@ -76,6 +77,12 @@ public:
    * \param b test object b
    */
   void AddNodeB (Ptr<ConfigTestObject> b);
+  /**
+   * Add node C function
+   * \param index the index of the object
+   * \param c test object c
+   */
+  void AddNodeC (uint32_t index, Ptr<ConfigTestObject> c);
 
   /**
    * Set node A function
@@ -102,6 +109,7 @@ public:
 private:
   std::vector<Ptr<ConfigTestObject> > m_nodesA; //!< NodesA attribute target.
   std::vector<Ptr<ConfigTestObject> > m_nodesB; //!< NodesB attribute target.
+  std::map<uint32_t, Ptr<ConfigTestObject> > m_nodesC; //!< NodesC attribute target.
   Ptr<ConfigTestObject> m_nodeA;  //!< NodeA attribute target.
   Ptr<ConfigTestObject> m_nodeB;  //!< NodeB attribute target.
   int8_t m_a;                     //!< A attribute target.
@@ -122,6 +130,10 @@ ConfigTestObject::GetTypeId (void)
                    ObjectVectorValue (),
                    MakeObjectVectorAccessor (&ConfigTestObject::m_nodesB),
                    MakeObjectVectorChecker<ConfigTestObject> ())
+    .AddAttribute ("NodesC", "",
+                   ObjectMapValue (),
+                   MakeObjectMapAccessor (&ConfigTestObject::m_nodesC),
+                   MakeObjectMapChecker<ConfigTestObject> ())
     .AddAttribute ("NodeA", "",
                    PointerValue (),
                    MakePointerAccessor (&ConfigTestObject::m_nodeA),
@@ -173,6 +185,12 @@ ConfigTestObject::AddNodeB (Ptr<ConfigTestObject> b)
   m_nodesB.push_back (b);
 }
 
+void 
+ConfigTestObject::AddNodeC (uint32_t index, Ptr<ConfigTestObject> c)
+{
+  m_nodesC[index] = c;
+}
+
 int8_t 
 ConfigTestObject::GetA (void) const
 {
@@ -775,6 +793,88 @@ ObjectVectorTraceConfigTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_path, "/NodeA/NodeB/NodesB/1/Source", "Trace 1 did not provide expected context");
 }
 
+/**
+ * \ingroup config-tests
+ * Test the paths matched through containers of Object whose indices
+ * are not the positions of the objects, and paths resolved again.
+ */
+class ObjectMapConfigTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  ObjectMapConfigTestCase ();
+  /** Destructor. */
+  virtual ~ObjectMapConfigTestCase () {}
+
+private:
+  virtual void DoRun (void);
+};
+
+ObjectMapConfigTestCase::ObjectMapConfigTestCase ()
+  : TestCase ("Check the paths matched through maps and vectors of Object")
+{
+}
+
+void
+ObjectMapConfigTestCase::DoRun (void)
+{
+  Ptr<ConfigTestObject> root = CreateObject<ConfigTestObject> ();
+  Config::RegisterRootNamespaceObject (root);
+
+  //
+  // The objects of the map are at positions 0, 1 and 2, but have indices
+  // 1, 3 and 5.
+  //
+  Ptr<ConfigTestObject> obj1 = CreateObject<ConfigTestObject> ();
+  Ptr<ConfigTestObject> obj3 = CreateObject<ConfigTestObject> ();
+  Ptr<ConfigTestObject> obj5 = CreateObject<ConfigTestObject> ();
+  root->AddNodeC (1, obj1);
+  root->AddNodeC (3, obj3);
+  root->AddNodeC (5, obj5);
+
+  Config::MatchContainer matches = Config::LookupMatches ("/NodesC/1");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 1, "Expected one match of index 1");
+  NS_TEST_ASSERT_MSG_EQ (matches.Get (0), obj1, "Object at position 1 matched instead of index 1");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetMatchedPath (0), "/NodesC/1/", "Unexpected context");
+
+  matches = Config::LookupMatches ("/NodesC/3|5");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 2, "Expected two matches of indices 3 and 5");
+  NS_TEST_ASSERT_MSG_EQ (matches.Get (0), obj3, "Object of index 3 not matched");
+  NS_TEST_ASSERT_MSG_EQ (matches.Get (1), obj5, "Object of index 5 not matched");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetMatchedPath (1), "/NodesC/5/", "Unexpected context");
+
+  matches = Config::LookupMatches ("/NodesC/2");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 0, "Index 2 unexpectedly matched");
+
+  //
+  // Objects of a vector are looked up by position.
+  //
+  std::vector<Ptr<ConfigTestObject> > objects;
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      objects.push_back (CreateObject<ConfigTestObject> ());
+      root->AddNodeA (objects.back ());
+    }
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      // The same path, resolved again, gives the same matches
+      matches = Config::LookupMatches ("/NodesA/[7-8]|2|8");
+      NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 3, "Expected three matches");
+      NS_TEST_ASSERT_MSG_EQ (matches.Get (0), objects[2], "Object 2 not matched first");
+      NS_TEST_ASSERT_MSG_EQ (matches.Get (1), objects[7], "Object 7 not matched second");
+      NS_TEST_ASSERT_MSG_EQ (matches.Get (2), objects[8], "Object 8 not matched third");
+      NS_TEST_ASSERT_MSG_EQ (matches.GetMatchedPath (2), "/NodesA/8/", "Unexpected context");
+    }
+  matches = Config::LookupMatches ("/NodesA/[5-12]");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 5, "Expected matches of objects 5 to 9");
+  matches = Config::LookupMatches ("/NodesA/10");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 0, "Index 10 unexpectedly matched");
+  matches = Config::LookupMatches ("/NodesC/*");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 3, "Expected matches of all the objects of the map");
+
+  Config::UnregisterRootNamespaceObject (root);
+}
+
 /**
  * \ingroup config-tests
  * Test for the ability to search attributes of parent classes
@@ -847,6 +947,7 @@ ConfigTestSuite::ConfigTestSuite ()
   AddTestCase (new RootNamespaceConfigTestCase);
   AddTestCase (new UnderRootNamespaceConfigTestCase);
   AddTestCase (new ObjectVectorConfigTestCase);
+  AddTestCase (new ObjectMapConfigTestCase);
   AddTestCase (new SearchAttributesOfParentObjectsTestCase);
 }
 
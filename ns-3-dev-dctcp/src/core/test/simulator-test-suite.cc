@@ -23,6 +23,10 @@
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/ladder-scheduler.h"
+#include "ns3/make-event.h"
+#include "ns3/event-impl.h"
+#include <vector>
 
 using namespace ns3;
 
@@ -170,6 +174,238 @@ SimulatorEventsTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_destroy, true, "Event should have run");
 }
 
+class SimulatorOrderTestCase : public TestCase
+{
+public:
+  SimulatorOrderTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+  void Event (uint32_t id);
+  void ScheduleEvent (Time delay);
+  uint32_t Random (uint32_t max);
+  ObjectFactory m_schedulerFactory;
+  std::vector<EventId> m_ids;
+  uint32_t m_seed;
+  uint32_t m_nRemoved;
+  uint32_t m_nExecuted;
+  uint32_t m_lastId;
+  Time m_last;
+  bool m_ordered;
+};
+
+SimulatorOrderTestCase::SimulatorOrderTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check the order of many clustered events with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+
+uint32_t
+SimulatorOrderTestCase::Random (uint32_t max)
+{
+  m_seed = m_seed * 1103515245 + 12345;
+  return (m_seed >> 8) % max;
+}
+
+void
+SimulatorOrderTestCase::ScheduleEvent (Time delay)
+{
+  uint32_t id = m_ids.size ();
+  m_ids.push_back (Simulator::Schedule (delay, &SimulatorOrderTestCase::Event, this, id));
+}
+
+void
+SimulatorOrderTestCase::Event (uint32_t id)
+{
+  // events with the same timestamp run in the order they were scheduled
+  if (Now () < m_last || (Now () == m_last && id < m_lastId))
+    {
+      m_ordered = false;
+    }
+  m_last = Now ();
+  m_lastId = id;
+  m_nExecuted++;
+  if (m_ids.size () >= 20000)
+    {
+      return;
+    }
+  // bursts of events a few nanoseconds apart, some at the current time
+  ScheduleEvent (NanoSeconds (Random (100)));
+  if (Random (4) == 0)
+    {
+      ScheduleEvent (NanoSeconds (Random (5)));
+    }
+  if (Random (10) == 0)
+    {
+      EventId &victim = m_ids[m_ids.size () - 1 - Random (m_ids.size () / 2)];
+      if (!victim.IsExpired ())
+        {
+          Simulator::Remove (victim);
+          m_nRemoved++;
+        }
+    }
+}
+
+void
+SimulatorOrderTestCase::DoRun (void)
+{
+  m_seed = 1;
+  m_nRemoved = 0;
+  m_nExecuted = 0;
+  m_lastId = 0;
+  m_last = Seconds (0);
+  m_ordered = true;
+  m_ids.clear ();
+
+  Simulator::SetScheduler (m_schedulerFactory);
+  // half of the events spread over 10 us, half within 20 ns, and a
+  // single event far in the future
+  for (uint32_t i = 0; i < 5000; i++)
+    {
+      ScheduleEvent (NanoSeconds (i % 2 ? Random (10000) : 5000 + Random (20)));
+    }
+  ScheduleEvent (MilliSeconds (1));
+  for (uint32_t i = 0; i < 5000; i += 7)
+    {
+      Simulator::Remove (m_ids[i]);
+      m_nRemoved++;
+    }
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_ordered, true, "Events were not executed in order");
+  NS_TEST_EXPECT_MSG_EQ (m_nExecuted + m_nRemoved, m_ids.size (), "Some events were lost");
+  Simulator::Destroy ();
+}
+
+class SimulatorRemoveTestCase : public TestCase
+{
+public:
+  SimulatorRemoveTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+  void Tick (uint32_t tick);
+  void Timeout (uint32_t i);
+  ObjectFactory m_schedulerFactory;
+  std::vector<EventId> m_timers;
+  std::vector<Time> m_due;
+  uint32_t m_nTimeouts;
+  bool m_wrongTime;
+};
+
+SimulatorRemoveTestCase::SimulatorRemoveTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check many removals of far away timeouts with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+
+void
+SimulatorRemoveTestCase::Tick (uint32_t tick)
+{
+  // like retransmission timeouts, a timeout far in the future is removed
+  // and scheduled again at every tick
+  uint32_t i = tick % m_timers.size ();
+  Simulator::Remove (m_timers[i]);
+  Time delay = MilliSeconds (1) + NanoSeconds (tick % 7);
+  m_timers[i] = Simulator::Schedule (delay, &SimulatorRemoveTestCase::Timeout, this, i);
+  m_due[i] = Now () + delay;
+  if (tick + 1 < 50 * m_timers.size ())
+    {
+      Simulator::Schedule (MicroSeconds (1), &SimulatorRemoveTestCase::Tick, this, tick + 1);
+    }
+}
+
+void
+SimulatorRemoveTestCase::Timeout (uint32_t i)
+{
+  if (Now () != m_due[i])
+    {
+      m_wrongTime = true;
+    }
+  m_nTimeouts++;
+}
+
+void
+SimulatorRemoveTestCase::DoRun (void)
+{
+  m_nTimeouts = 0;
+  m_wrongTime = false;
+  m_timers.assign (500, EventId ());
+  m_due.assign (500, Seconds (0));
+
+  Simulator::SetScheduler (m_schedulerFactory);
+  Simulator::Schedule (MicroSeconds (1), &SimulatorRemoveTestCase::Tick, this, 0);
+  Simulator::Run ();
+  // the timeouts are scheduled again before they expire, but the last time
+  NS_TEST_EXPECT_MSG_EQ (m_wrongTime, false, "A removed timeout was executed");
+  NS_TEST_EXPECT_MSG_EQ (m_nTimeouts, m_timers.size (), "Every timeout should expire once");
+  Simulator::Destroy ();
+}
+
+/// An argument too large for the event pool
+struct LargeArgument
+{
+  uint8_t m_data[256]; //!< payload
+};
+
+class SimulatorEventPoolTestCase : public TestCase
+{
+public:
+  SimulatorEventPoolTestCase ();
+  virtual void DoRun (void);
+  void Event3 (uint32_t a, double b, uint64_t c);
+  void EventLarge (LargeArgument large, std::vector<uint64_t> v);
+  uint32_t m_a;
+  double m_b;
+  uint64_t m_c;
+  std::size_t m_vSize;
+};
+
+SimulatorEventPoolTestCase::SimulatorEventPoolTestCase ()
+  : TestCase ("Check that events are recycled through the event pool")
+{
+}
+
+void
+SimulatorEventPoolTestCase::Event3 (uint32_t a, double b, uint64_t c)
+{
+  m_a = a;
+  m_b = b;
+  m_c = c;
+}
+
+void
+SimulatorEventPoolTestCase::EventLarge (LargeArgument large, std::vector<uint64_t> v)
+{
+  m_vSize = v.size () + large.m_data[255];
+}
+
+void
+SimulatorEventPoolTestCase::DoRun (void)
+{
+  EventImpl *ev = MakeEvent (&SimulatorEventPoolTestCase::Event3, this, 1, 2.5, 3);
+  void *block = ev;
+  ev->Invoke ();
+  NS_TEST_EXPECT_MSG_EQ (m_a, 1, "Wrong first argument");
+  NS_TEST_EXPECT_MSG_EQ (m_b, 2.5, "Wrong second argument");
+  NS_TEST_EXPECT_MSG_EQ (m_c, 3, "Wrong third argument");
+  ev->Unref ();
+
+  // an event of the same size reuses the block just freed
+  ev = MakeEvent (&SimulatorEventPoolTestCase::Event3, this, 4, 5.5, 6);
+  NS_TEST_EXPECT_MSG_EQ (static_cast<void *> (ev), block, "Event block not recycled");
+  ev->Unref ();
+
+  // events larger than the largest size class are still supported
+  LargeArgument large;
+  large.m_data[255] = 5;
+  std::vector<uint64_t> v (10, 1);
+  Simulator::Schedule (Seconds (1), &SimulatorEventPoolTestCase::EventLarge, this, large, v);
+  Simulator::Schedule (Seconds (2), &SimulatorEventPoolTestCase::Event3, this, 7, 8.5, 9);
+  m_vSize = 0;
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_vSize, 15, "Wrong large arguments");
+  NS_TEST_EXPECT_MSG_EQ (m_a, 7, "Wrong first argument");
+  Simulator::Destroy ();
+}
+
 class SimulatorTemplateTestCase : public TestCase
 {
 public:
@@ -477,5 +713,30 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+
+    factory.SetTypeId (ListScheduler::GetTypeId ());
+    AddTestCase (new SimulatorOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (MapScheduler::GetTypeId ());
+    AddTestCase (new SimulatorOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (HeapScheduler::GetTypeId ());
+    AddTestCase (new SimulatorOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (CalendarScheduler::GetTypeId ());
+    AddTestCase (new SimulatorOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorOrderTestCase (factory), TestCase::QUICK);
+
+    factory.SetTypeId (ListScheduler::GetTypeId ());
+    AddTestCase (new SimulatorRemoveTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (MapScheduler::GetTypeId ());
+    AddTestCase (new SimulatorRemoveTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (HeapScheduler::GetTypeId ());
+    AddTestCase (new SimulatorRemoveTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (CalendarScheduler::GetTypeId ());
+    AddTestCase (new SimulatorRemoveTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorRemoveTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SimulatorEventPoolTestCase (), TestCase::QUICK);
   }
 } g_simulatorTestSuite;
@@ -19,6 +19,7 @@
 #include "ns3/test.h"
 #include "ns3/traced-callback.h"
 #include "ns3/unused.h"
+#include <vector>
 
 using namespace ns3;
 
@@ -113,6 +114,148 @@ BasicTracedCallbackTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_two, true, "Callback CbTwo not called");
 }
 
+class ReentrantTracedCallbackTestCase : public TestCase
+{
+public:
+  ReentrantTracedCallbackTestCase ();
+  virtual ~ReentrantTracedCallbackTestCase () {}
+
+private:
+  virtual void DoRun (void);
+
+  void Sink (uint32_t id, int value);
+  void Reset (void);
+  std::vector<uint32_t> Invoke (void);
+
+  TracedCallback<int> m_trace;
+  std::vector<Callback<void, int> > m_sinks;
+  // sinks disconnected by each sink, when it is invoked
+  std::vector<std::vector<uint32_t> > m_disconnect;
+  // sink connected by each sink, when it is invoked, if any
+  std::vector<int> m_connect;
+  std::vector<uint32_t> m_calls;
+};
+
+ReentrantTracedCallbackTestCase::ReentrantTracedCallbackTestCase ()
+  : TestCase ("Check TracedCallback sinks connecting and disconnecting sinks")
+{
+}
+
+void
+ReentrantTracedCallbackTestCase::Sink (uint32_t id, int value)
+{
+  NS_UNUSED (value);
+  m_calls.push_back (id);
+  std::vector<uint32_t> disconnect = m_disconnect[id];
+  m_disconnect[id].clear ();
+  for (std::vector<uint32_t>::const_iterator i = disconnect.begin (); i != disconnect.end (); ++i)
+    {
+      // the chain holds the last reference to the sink, which may be running
+      Callback<void, int> sink = m_sinks[*i];
+      m_sinks[*i] = Callback<void, int> ();
+      m_trace.DisconnectWithoutContext (sink);
+    }
+  if (m_connect[id] >= 0)
+    {
+      m_trace.ConnectWithoutContext (m_sinks[m_connect[id]]);
+      m_connect[id] = -1;
+    }
+}
+
+void
+ReentrantTracedCallbackTestCase::Reset (void)
+{
+  m_trace = TracedCallback<int> ();
+  m_sinks.clear ();
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      m_sinks.push_back (MakeCallback (&ReentrantTracedCallbackTestCase::Sink, this).Bind (i));
+    }
+  m_disconnect.assign (5, std::vector<uint32_t> ());
+  m_connect.assign (5, -1);
+  // sinks 0 to 3 are connected, sink 4 is not
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      m_trace.ConnectWithoutContext (m_sinks[i]);
+    }
+}
+
+std::vector<uint32_t>
+ReentrantTracedCallbackTestCase::Invoke (void)
+{
+  m_calls.clear ();
+  m_trace (0);
+  return m_calls;
+}
+
+void
+ReentrantTracedCallbackTestCase::DoRun (void)
+{
+  std::vector<uint32_t> calls;
+
+  //
+  // The first sink disconnects itself and a later sink: the sinks after it
+  // are still called, but the disconnected one.  The first sink is only
+  // released once the invocation ends.
+  //
+  Reset ();
+  m_disconnect[0].push_back (0);
+  m_disconnect[0].push_back (2);
+  calls = Invoke ();
+  NS_TEST_ASSERT_MSG_EQ (calls.size (), 3, "Unexpected number of sinks called");
+  NS_TEST_EXPECT_MSG_EQ (calls[0], 0, "Sink 0 not called");
+  NS_TEST_EXPECT_MSG_EQ (calls[1], 1, "Sink 1 not called");
+  NS_TEST_EXPECT_MSG_EQ (calls[2], 3, "Sink 3 not called");
+  calls = Invoke ();
+  NS_TEST_ASSERT_MSG_EQ (calls.size (), 2, "Unexpected number of sinks called after the disconnections");
+  NS_TEST_EXPECT_MSG_EQ (calls[0], 1, "Sink 1 not called after the disconnections");
+  NS_TEST_EXPECT_MSG_EQ (calls[1], 3, "Sink 3 not called after the disconnections");
+
+  //
+  // A sink disconnects an earlier sink and itself: the next sink must not
+  // be skipped.
+  //
+  Reset ();
+  m_disconnect[1].push_back (0);
+  m_disconnect[1].push_back (1);
+  calls = Invoke ();
+  NS_TEST_ASSERT_MSG_EQ (calls.size (), 4, "Unexpected number of sinks called");
+  NS_TEST_EXPECT_MSG_EQ (calls[2], 2, "Sink 2 skipped");
+  NS_TEST_EXPECT_MSG_EQ (calls[3], 3, "Sink 3 skipped");
+  calls = Invoke ();
+  NS_TEST_ASSERT_MSG_EQ (calls.size (), 2, "Unexpected number of sinks called after the disconnections");
+  NS_TEST_EXPECT_MSG_EQ (calls[0], 2, "Sink 2 not called after the disconnections");
+  NS_TEST_EXPECT_MSG_EQ (calls[1], 3, "Sink 3 not called after the disconnections");
+
+  //
+  // A sink connected while the chain is invoked is called by the same
+  // invocation, at the end of the chain, even if the first sink was
+  // disconnected before.
+  //
+  Reset ();
+  m_disconnect[0].push_back (0);
+  m_connect[1] = 4;
+  calls = Invoke ();
+  NS_TEST_ASSERT_MSG_EQ (calls.size (), 5, "Unexpected number of sinks called");
+  NS_TEST_EXPECT_MSG_EQ (calls[4], 4, "Sink 4 not called");
+  calls = Invoke ();
+  NS_TEST_ASSERT_MSG_EQ (calls.size (), 4, "Unexpected number of sinks called after the changes");
+  NS_TEST_EXPECT_MSG_EQ (calls[0], 1, "Sink 1 not called first");
+  NS_TEST_EXPECT_MSG_EQ (calls[3], 4, "Sink 4 not called last");
+
+  //
+  // Every sink disconnects itself: the chain is empty afterwards.
+  //
+  Reset ();
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      m_disconnect[i].push_back (i);
+    }
+  calls = Invoke ();
+  NS_TEST_EXPECT_MSG_EQ (calls.size (), 4, "Unexpected number of sinks called");
+  NS_TEST_EXPECT_MSG_EQ (m_trace.IsEmpty (), true, "The chain should be empty");
+}
+
 class TracedCallbackTestSuite : public TestSuite
 {
 public:
@@ -123,6 +266,7 @@ TracedCallbackTestSuite::TracedCallbackTestSuite ()
   : TestSuite ("traced-callback", UNIT)
 {
   AddTestCase (new BasicTracedCallbackTestCase, TestCase::QUICK);
+  AddTestCase (new ReentrantTracedCallbackTestCase, TestCase::QUICK);
 }
 
 static TracedCallbackTestSuite tracedCallbackTestSuite;
@@ -325,6 +325,98 @@ DeprecatedAttributeTestCase::DoRun (void)
        << endl;
 }
 
+
+//----------------------------
+//
+// Inherited Attribute test
+
+class InheritedAttributeTestCase : public TestCase
+{
+public:
+  InheritedAttributeTestCase ();
+  virtual ~InheritedAttributeTestCase ();
+private:
+  virtual void DoRun (void);
+
+};
+
+InheritedAttributeTestCase::InheritedAttributeTestCase ()
+  : TestCase ("Check the lookup of inherited Attributes and TraceSources")
+{
+}
+
+InheritedAttributeTestCase::~InheritedAttributeTestCase ()
+{
+}
+
+void
+InheritedAttributeTestCase::DoRun (void)
+{
+  // Register the types once per process, since TypeIds cannot be removed
+  TypeId parent;
+  TypeId child;
+  TypeId grandChild;
+  if (!TypeId::LookupByNameFailSafe ("InheritedAttributeParent", &parent))
+    {
+      parent = TypeId ("InheritedAttributeParent")
+        .SetParent<Object> ()
+        .AddAttribute ("parentAttribute", "an Attribute of the parent",
+                       EmptyAttributeValue (),
+                       MakeEmptyAttributeAccessor (),
+                       MakeEmptyAttributeChecker ())
+        .AddTraceSource ("parentTrace", "a TraceSource of the parent",
+                         MakeEmptyTraceSourceAccessor (),
+                         "ns3::TracedValueCallback::Void");
+      child = TypeId ("InheritedAttributeChild")
+        .SetParent (parent)
+        .AddAttribute ("childAttribute", "an Attribute of the child",
+                       EmptyAttributeValue (),
+                       MakeEmptyAttributeAccessor (),
+                       MakeEmptyAttributeChecker ());
+      grandChild = TypeId ("InheritedAttributeGrandChild")
+        .SetParent (child);
+      // Attributes and TraceSources added to a parent once its children
+      // are registered are inherited too
+      parent
+        .AddAttribute ("lateAttribute", "an Attribute added to the parent",
+                       EmptyAttributeValue (),
+                       MakeEmptyAttributeAccessor (),
+                       MakeEmptyAttributeChecker ())
+        .AddTraceSource ("lateTrace", "a TraceSource added to the parent",
+                         MakeEmptyTraceSourceAccessor (),
+                         "ns3::TracedValueCallback::Void");
+    }
+  else
+    {
+      child = TypeId::LookupByName ("InheritedAttributeChild");
+      grandChild = TypeId::LookupByName ("InheritedAttributeGrandChild");
+    }
+
+  struct TypeId::AttributeInformation ainfo;
+  NS_TEST_ASSERT_MSG_EQ (grandChild.LookupAttributeByName ("childAttribute", &ainfo), true,
+                         "lookup attribute of the parent");
+  NS_TEST_ASSERT_MSG_EQ (ainfo.name, "childAttribute", "wrong attribute");
+  NS_TEST_ASSERT_MSG_EQ (grandChild.LookupAttributeByName ("parentAttribute", &ainfo), true,
+                         "lookup attribute of the grand parent");
+  NS_TEST_ASSERT_MSG_EQ (grandChild.LookupAttributeByName ("lateAttribute", &ainfo), true,
+                         "lookup attribute added to the grand parent");
+  NS_TEST_ASSERT_MSG_EQ (grandChild.LookupAttributeByName ("Attribute", &ainfo), false,
+                         "lookup missing attribute");
+  NS_TEST_ASSERT_MSG_EQ (parent.LookupAttributeByName ("childAttribute", &ainfo), false,
+                         "lookup attribute of a child");
+
+  // The empty accessors are null, so the lookups are checked through
+  // the information they return
+  struct TypeId::TraceSourceInformation tinfo;
+  grandChild.LookupTraceSourceByName ("parentTrace", &tinfo);
+  NS_TEST_ASSERT_MSG_EQ (tinfo.name, "parentTrace", "lookup trace source of the grand parent");
+  child.LookupTraceSourceByName ("lateTrace", &tinfo);
+  NS_TEST_ASSERT_MSG_EQ (tinfo.name, "lateTrace", "lookup trace source added to the parent");
+  tinfo.name = "";
+  child.LookupTraceSourceByName ("childTrace", &tinfo);
+  NS_TEST_ASSERT_MSG_EQ (tinfo.name, "", "lookup missing trace source");
+}
+
   
 //----------------------------
 //
@@ -437,6 +529,7 @@ TypeIdTestSuite::TypeIdTestSuite ()
   AddTestCase (new UniqueTypeIdTestCase, QUICK);
   AddTestCase (new CollisionTestCase, QUICK);
   AddTestCase (new DeprecatedAttributeTestCase, QUICK);
+  AddTestCase (new InheritedAttributeTestCase, QUICK);
 }
 
 static TypeIdTestSuite g_TypeIdTestSuite;  
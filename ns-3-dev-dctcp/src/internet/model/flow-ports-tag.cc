@@ -0,0 +1,95 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "flow-ports-tag.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FlowPortsTag");
+
+NS_OBJECT_ENSURE_REGISTERED (FlowPortsTag);
+
+TypeId
+FlowPortsTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::FlowPortsTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<FlowPortsTag> ()
+  ;
+  return tid;
+}
+TypeId
+FlowPortsTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+uint32_t
+FlowPortsTag::GetSerializedSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return 4;
+}
+void
+FlowPortsTag::Serialize (TagBuffer buf) const
+{
+  NS_LOG_FUNCTION (this << &buf);
+  buf.WriteU16 (m_sourcePort);
+  buf.WriteU16 (m_destinationPort);
+}
+void
+FlowPortsTag::Deserialize (TagBuffer buf)
+{
+  NS_LOG_FUNCTION (this << &buf);
+  m_sourcePort = buf.ReadU16 ();
+  m_destinationPort = buf.ReadU16 ();
+}
+void
+FlowPortsTag::Print (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  os << "SourcePort=" << m_sourcePort << " DestinationPort=" << m_destinationPort;
+}
+FlowPortsTag::FlowPortsTag ()
+  : Tag (),
+    m_sourcePort (0),
+    m_destinationPort (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+FlowPortsTag::FlowPortsTag (uint16_t sourcePort, uint16_t destinationPort)
+  : Tag (),
+    m_sourcePort (sourcePort),
+    m_destinationPort (destinationPort)
+{
+  NS_LOG_FUNCTION (this << sourcePort << destinationPort);
+}
+
+uint16_t
+FlowPortsTag::GetSourcePort (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_sourcePort;
+}
+uint16_t
+FlowPortsTag::GetDestinationPort (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_destinationPort;
+}
+
+} // namespace ns3
@@ -0,0 +1,73 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef FLOW_PORTS_TAG_H
+#define FLOW_PORTS_TAG_H
+
+#include "ns3/tag.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup internet
+ *
+ * \brief The transport ports of a packet whose transport header is not
+ * added yet.
+ *
+ * The transport protocols ask for a route before adding their header in
+ * some cases, e.g., the UDP sockets not bound to a local address and the
+ * TCP sockets looking up their source address. They tag the packet given
+ * to RouteOutput with this tag, so that the routing protocols which pick a
+ * route from the flow of the packet do not have to read the ports from the
+ * front of the packet. The tag is removed once the route is found.
+ */
+class FlowPortsTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer buf) const;
+  virtual void Deserialize (TagBuffer buf);
+  virtual void Print (std::ostream &os) const;
+  FlowPortsTag ();
+
+  /**
+   * Constructs a FlowPortsTag with the given ports
+   *
+   * \param sourcePort the source port
+   * \param destinationPort the destination port
+   */
+  FlowPortsTag (uint16_t sourcePort, uint16_t destinationPort);
+  /**
+   * \returns the source port
+   */
+  uint16_t GetSourcePort (void) const;
+  /**
+   * \returns the destination port
+   */
+  uint16_t GetDestinationPort (void) const;
+private:
+  uint16_t m_sourcePort;      //!< Source port
+  uint16_t m_destinationPort; //!< Destination port
+};
+
+} // namespace ns3
+
+#endif /* FLOW_PORTS_TAG_H */
@@ -712,8 +712,10 @@ GlobalRouteManagerImpl::InitializeRoutes ()
         node->GetObject<GlobalRouter> ();
 
       uint32_t systemId = MpiInterface::GetSystemId ();
-      // Ignore nodes that are not assigned to our systemId (distributed sim)
-      if (node->GetSystemId () != systemId) 
+      // Ignore nodes that are not assigned to our systemId (distributed sim);
+      // without MPI, all the nodes are run by this process, whatever their
+      // systemId (see MultithreadedSimulatorImpl)
+      if (MpiInterface::IsEnabled () && node->GetSystemId () != systemId) 
         {
           continue;
         }
@@ -22,6 +22,7 @@
 #include "ipv4-end-point.h"
 #include "ipv4-interface-address.h"
 #include "ns3/log.h"
+#include <algorithm>
 
 
 namespace ns3 {
@@ -49,20 +50,17 @@ bool
 Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
 {
   NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
-    {
-      if ((*i)->GetLocalPort  () == port) 
-        {
-          return true;
-        }
-    }
-  return false;
+  return m_ports.find (port) != m_ports.end ();
 }
 
 bool
 Ipv4EndPointDemux::LookupLocal (Ptr<NetDevice> boundNetDevice, Ipv4Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
+  if (!LookupPortLocal (port))
+    {
+      return false;
+    }
   for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
     {
       if ((*i)->GetLocalPort () == port &&
@@ -87,6 +85,8 @@ Ipv4EndPointDemux::Allocate (void)
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (Ipv4Address::GetAny (), port);
   m_endPoints.push_back (endPoint);
+  endPoint->SetDemux (this);
+  Index (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -103,6 +103,8 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address)
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
   m_endPoints.push_back (endPoint);
+  endPoint->SetDemux (this);
+  Index (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -126,6 +128,8 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice, Ipv4Address address,
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
   m_endPoints.push_back (endPoint);
+  endPoint->SetDemux (this);
+  Index (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -136,21 +140,45 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
                              Ipv4Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort << boundNetDevice);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  // The end points with this 4-tuple are either connections, or wildcards
+  // of the local port
+  const std::vector<Ipv4EndPoint *> *candidates = 0;
+  if (localAddress != Ipv4Address::GetAny () && peerAddress != Ipv4Address::GetAny () && peerPort != 0)
     {
-      if ((*i)->GetLocalPort () == localPort &&
-          (*i)->GetLocalAddress () == localAddress &&
-          (*i)->GetPeerPort () == peerPort &&
-          (*i)->GetPeerAddress () == peerAddress &&
-          ((*i)->GetBoundNetDevice () == boundNetDevice || (*i)->GetBoundNetDevice () == 0))
+      ConnectionIndex::const_iterator c = m_connections.find (ConnectionKey (localAddress, localPort, peerAddress, peerPort));
+      if (c != m_connections.end ())
         {
-          NS_LOG_WARN ("Duplicated endpoint.");
-          return 0;
+          candidates = &c->second;
+        }
+    }
+  else
+    {
+      PortIndex::const_iterator p = m_ports.find (localPort);
+      if (p != m_ports.end ())
+        {
+          candidates = &p->second.wildcards;
+        }
+    }
+  if (candidates != 0)
+    {
+      for (std::vector<Ipv4EndPoint *>::const_iterator i = candidates->begin (); i != candidates->end (); i++)
+        {
+          if ((*i)->GetLocalPort () == localPort &&
+              (*i)->GetLocalAddress () == localAddress &&
+              (*i)->GetPeerPort () == peerPort &&
+              (*i)->GetPeerAddress () == peerAddress &&
+              ((*i)->GetBoundNetDevice () == boundNetDevice || (*i)->GetBoundNetDevice () == 0))
+            {
+              NS_LOG_WARN ("Duplicated endpoint.");
+              return 0;
+            }
         }
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
   m_endPoints.push_back (endPoint);
+  endPoint->SetDemux (this);
+  Index (endPoint);
 
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
 
@@ -165,6 +193,7 @@ Ipv4EndPointDemux::DeAllocate (Ipv4EndPoint *endPoint)
     {
       if (*i == endPoint)
         {
+          Unindex (endPoint);
           delete endPoint;
           m_endPoints.erase (i);
           break;
@@ -208,7 +237,42 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
   EndPoints retval4; // Exact match on all 4
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr << ":" << dport);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  // The candidates are the connections with the 4-tuple of the packet, and
+  // the end points of the destination port which are not connections.  A
+  // connection bound to a subnet address is thus not matched by case 3.
+  ConnectionIndex::const_iterator c = m_connections.find (ConnectionKey (daddr, dport, saddr, sport));
+  if (c != m_connections.end ())
+    {
+      MatchEndPoints (c->second, daddr, dport, saddr, sport, incomingInterface,
+                      retval1, retval2, retval3, retval4);
+    }
+  PortIndex::const_iterator p = m_ports.find (dport);
+  if (p != m_ports.end ())
+    {
+      MatchEndPoints (p->second.wildcards, daddr, dport, saddr, sport, incomingInterface,
+                      retval1, retval2, retval3, retval4);
+    }
+
+  // Here we find the most exact match
+  EndPoints retval;
+  if (!retval4.empty ()) retval = retval4;
+  else if (!retval3.empty ()) retval = retval3;
+  else if (!retval2.empty ()) retval = retval2;
+  else retval = retval1;
+
+  NS_ABORT_MSG_IF (retval.size () > 1, "Too many endpoints - perhaps you created too many sockets without binding them to different NetDevices.");
+  return retval;  // might be empty if no matches
+}
+
+void
+Ipv4EndPointDemux::MatchEndPoints (const std::vector<Ipv4EndPoint *> &endPoints,
+                                   Ipv4Address daddr, uint16_t dport,
+                                   Ipv4Address saddr, uint16_t sport,
+                                   Ptr<Ipv4Interface> incomingInterface,
+                                   EndPoints &retval1, EndPoints &retval2,
+                                   EndPoints &retval3, EndPoints &retval4)
+{
+  for (std::vector<Ipv4EndPoint *>::const_iterator i = endPoints.begin (); i != endPoints.end (); i++) 
     {
       Ipv4EndPoint* endP = *i;
 
@@ -323,16 +387,6 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
           retval1.push_back (endP);
         }
     }
-
-  // Here we find the most exact match
-  EndPoints retval;
-  if (!retval4.empty ()) retval = retval4;
-  else if (!retval3.empty ()) retval = retval3;
-  else if (!retval2.empty ()) retval = retval2;
-  else retval = retval1;
-
-  NS_ABORT_MSG_IF (retval.size () > 1, "Too many endpoints - perhaps you created too many sockets without binding them to different NetDevices.");
-  return retval;  // might be empty if no matches
 }
 
 Ipv4EndPoint *
@@ -400,5 +454,84 @@ Ipv4EndPointDemux::AllocateEphemeralPort (void)
   return port;
 }
 
-} // namespace ns3
+Ipv4EndPointDemux::ConnectionKey::ConnectionKey (Ipv4Address localAddress, uint16_t localPort,
+                                                 Ipv4Address peerAddress, uint16_t peerPort)
+  : localAddress (localAddress.Get ()),
+    peerAddress (peerAddress.Get ()),
+    localPort (localPort),
+    peerPort (peerPort)
+{
+}
+
+bool
+Ipv4EndPointDemux::ConnectionKey::operator == (const ConnectionKey &other) const
+{
+  return localAddress == other.localAddress && peerAddress == other.peerAddress
+         && localPort == other.localPort && peerPort == other.peerPort;
+}
+
+std::size_t
+Ipv4EndPointDemux::ConnectionKeyHash::operator () (const ConnectionKey &key) const
+{
+  uint64_t addresses = (static_cast<uint64_t> (key.localAddress) << 32) | key.peerAddress;
+  uint64_t ports = (static_cast<uint64_t> (key.localPort) << 16) | key.peerPort;
+  uint64_t h = (addresses ^ (ports * 0x9e3779b97f4a7c15ULL)) * 0x9e3779b97f4a7c15ULL;
+  return static_cast<std::size_t> (h ^ (h >> 32));
+}
+
+bool
+Ipv4EndPointDemux::IsConnection (Ipv4EndPoint *endPoint)
+{
+  return endPoint->GetLocalAddress () != Ipv4Address::GetAny ()
+         && endPoint->GetPeerAddress () != Ipv4Address::GetAny ()
+         && endPoint->GetPeerPort () != 0;
+}
 
+void
+Ipv4EndPointDemux::Index (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  PortEndPoints &port = m_ports[endPoint->GetLocalPort ()];
+  port.nEndPoints++;
+  if (IsConnection (endPoint))
+    {
+      ConnectionKey key (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+                         endPoint->GetPeerAddress (), endPoint->GetPeerPort ());
+      m_connections[key].push_back (endPoint);
+    }
+  else
+    {
+      port.wildcards.push_back (endPoint);
+    }
+}
+
+void
+Ipv4EndPointDemux::Unindex (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  PortIndex::iterator port = m_ports.find (endPoint->GetLocalPort ());
+  NS_ASSERT (port != m_ports.end ());
+  if (IsConnection (endPoint))
+    {
+      ConnectionKey key (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+                         endPoint->GetPeerAddress (), endPoint->GetPeerPort ());
+      ConnectionIndex::iterator c = m_connections.find (key);
+      NS_ASSERT (c != m_connections.end ());
+      c->second.erase (std::find (c->second.begin (), c->second.end (), endPoint));
+      if (c->second.empty ())
+        {
+          m_connections.erase (c);
+        }
+    }
+  else
+    {
+      std::vector<Ipv4EndPoint *> &wildcards = port->second.wildcards;
+      wildcards.erase (std::find (wildcards.begin (), wildcards.end (), endPoint));
+    }
+  if (--port->second.nEndPoints == 0)
+    {
+      m_ports.erase (port);
+    }
+}
+
+} // namespace ns3
@@ -23,6 +23,8 @@
 
 #include <stdint.h>
 #include <list>
+#include <vector>
+#include <unordered_map>
 #include "ns3/ipv4-address.h"
 #include "ipv4-interface.h"
 
@@ -40,6 +42,10 @@ class Ipv4EndPoint;
  * of endpoints, and has APIs to add and find endpoints in this demux.  This
  * code is shared in common to TCP and UDP protocols in ns3.  This demux
  * sits between ns3's layer four and the socket layer
+ *
+ * The connected endpoints are indexed by their four-tuple and the other
+ * endpoints by their local port, so that the lookup of a packet does not
+ * depend on the number of connections.
  */
 
 class Ipv4EndPointDemux {
@@ -192,6 +198,120 @@ private:
    * \brief A list of IPv4 end points.
    */
   EndPoints m_endPoints;
+
+  friend class Ipv4EndPoint;
+
+  /**
+   * \brief Index an end point, once allocated or once its addresses or
+   * ports are set.
+   * \param endPoint the end point
+   */
+  void Index (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Remove an end point from the index, before it is deallocated or
+   * its addresses or ports are set.
+   * \param endPoint the end point
+   */
+  void Unindex (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Check if an end point is a connection, indexed by its 4-tuple.
+   * \param endPoint the end point
+   * \return true if the local address, peer address and peer port of the end
+   * point are all set
+   */
+  static bool IsConnection (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Classify the end points matching a packet by how exactly they
+   * match it, as Lookup does.
+   * \param endPoints the end points to check
+   * \param daddr destination address of the packet
+   * \param dport destination port of the packet
+   * \param saddr source address of the packet
+   * \param sport source port of the packet
+   * \param incomingInterface the incoming interface
+   * \param retval1 end points matching exactly on the local port only
+   * \param retval2 end points matching exactly on the local port and address only
+   * \param retval3 end points matching on all but the local address
+   * \param retval4 end points matching exactly on all 4
+   */
+  void MatchEndPoints (const std::vector<Ipv4EndPoint *> &endPoints,
+                       Ipv4Address daddr, uint16_t dport,
+                       Ipv4Address saddr, uint16_t sport,
+                       Ptr<Ipv4Interface> incomingInterface,
+                       EndPoints &retval1, EndPoints &retval2,
+                       EndPoints &retval3, EndPoints &retval4);
+
+  /**
+   * \brief The 4-tuple of a connection.
+   */
+  struct ConnectionKey
+  {
+    /**
+     * \brief Constructor.
+     * \param localAddress local address
+     * \param localPort local port
+     * \param peerAddress peer address
+     * \param peerPort peer port
+     */
+    ConnectionKey (Ipv4Address localAddress, uint16_t localPort,
+                   Ipv4Address peerAddress, uint16_t peerPort);
+    /**
+     * \brief Equality operator.
+     * \param other the other 4-tuple
+     * \return true if the 4-tuples are equal
+     */
+    bool operator == (const ConnectionKey &other) const;
+
+    uint32_t localAddress;  //!< local address
+    uint32_t peerAddress;   //!< peer address
+    uint16_t localPort;     //!< local port
+    uint16_t peerPort;      //!< peer port
+  };
+
+  /**
+   * \brief Hash function of the 4-tuples.
+   */
+  struct ConnectionKeyHash
+  {
+    /**
+     * \param key a 4-tuple
+     * \return the hash of the 4-tuple
+     */
+    std::size_t operator () (const ConnectionKey &key) const;
+  };
+
+  /**
+   * \brief The end points of a local port.
+   */
+  struct PortEndPoints
+  {
+    uint32_t nEndPoints;                      //!< number of end points of the port
+    std::vector<Ipv4EndPoint *> wildcards;    //!< end points of the port which are not connections
+  };
+
+  /**
+   * \brief Container of the connections, indexed by 4-tuple.
+   */
+  typedef std::unordered_map<ConnectionKey, std::vector<Ipv4EndPoint *>, ConnectionKeyHash> ConnectionIndex;
+
+  /**
+   * \brief Container of the end points, indexed by local port.
+   */
+  typedef std::unordered_map<uint16_t, PortEndPoints> PortIndex;
+
+  /**
+   * \brief The connections, indexed by 4-tuple.  Several end points may
+   * share a 4-tuple if they are bound to different NetDevices.
+   */
+  ConnectionIndex m_connections;
+
+  /**
+   * \brief The end points, indexed by local port.
+   */
+  PortIndex m_ports;
 };
 
 } // namespace ns3
@@ -32,6 +32,7 @@ namespace ns3 {
 
 class Header;
 class Packet;
+class Ipv4EndPointDemux;
 
 /**
  * \ingroup ipv4
@@ -182,6 +183,16 @@ public:
    */
   bool IsRxEnabled (void);
 
+  /**
+   * \brief Set the demux which indexes this end point.
+   *
+   * The demux is notified when the addresses or the ports of the end point
+   * change, so that it can update its index.
+   *
+   * \param demux the demux, or 0
+   */
+  void SetDemux (Ipv4EndPointDemux *demux);
+
 private:
   /**
    * \brief The local address.
@@ -227,6 +238,11 @@ private:
    * \brief true if the endpoint can receive packets.
    */
   bool m_rxEnabled;
+
+  /**
+   * \brief The demux which indexes the endpoint, if any.
+   */
+  Ipv4EndPointDemux *m_demux;
 };
 
 } // namespace ns3
@@ -17,6 +17,8 @@
 //
 
 #include <vector>
+#include <algorithm>
+#include <cstring>
 #include <iomanip>
 #include "ns3/names.h"
 #include "ns3/log.h"
@@ -29,6 +31,9 @@
 #include "ns3/boolean.h"
 #include "ns3/node.h"
 #include "ipv4-global-routing.h"
+#include "flow-ports-tag.h"
+#include "tcp-l4-protocol.h"
+#include "udp-l4-protocol.h"
 #include "global-route-manager.h"
 
 namespace ns3 {
@@ -48,6 +53,13 @@ Ipv4GlobalRouting::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&Ipv4GlobalRouting::m_randomEcmpRouting),
                    MakeBooleanChecker ())
+    .AddAttribute ("FlowEcmpRouting",
+                   "Set to true if packets are routed among ECMP according to the hash of their "
+                   "addresses, protocol and ports, so that the packets of a flow follow the same route; "
+                   "takes precedence over RandomEcmpRouting",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&Ipv4GlobalRouting::m_flowEcmpRouting),
+                   MakeBooleanChecker ())
     .AddAttribute ("RespondToInterfaceEvents",
                    "Set to true if you want to dynamically recompute the global routes upon Interface notification events (up/down, or add/remove address)",
                    BooleanValue (false),
@@ -59,7 +71,10 @@ Ipv4GlobalRouting::GetTypeId (void)
 
 Ipv4GlobalRouting::Ipv4GlobalRouting () 
   : m_randomEcmpRouting (false),
-    m_respondToInterfaceEvents (false)
+    m_flowEcmpRouting (false),
+    m_respondToInterfaceEvents (false),
+    m_flowHashSalt (0),
+    m_flowHashSaltSet (false)
 {
   NS_LOG_FUNCTION (this);
 
@@ -80,6 +95,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, nextHop, interface);
   m_hostRoutes.push_back (route);
+  m_hostIndex[dest.Get ()].push_back (route);
 }
 
 void 
@@ -90,6 +106,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, interface);
   m_hostRoutes.push_back (route);
+  m_hostIndex[dest.Get ()].push_back (route);
 }
 
 void 
@@ -105,6 +122,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (route);
+  AddToIndex (m_networkIndex, route);
 }
 
 void 
@@ -118,6 +136,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (route);
+  AddToIndex (m_networkIndex, route);
 }
 
 void 
@@ -133,102 +152,202 @@ Ipv4GlobalRouting::AddASExternalRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_ASexternalRoutes.push_back (route);
+  AddToIndex (m_ASexternalIndex, route);
 }
 
 
-Ptr<Ipv4Route>
-Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
+void
+Ipv4GlobalRouting::AddToIndex (PrefixIndex &index, Ipv4RoutingTableEntry *route)
 {
-  NS_LOG_FUNCTION (this << dest << oif);
-  NS_LOG_LOGIC ("Looking for route for destination " << dest);
-  Ptr<Ipv4Route> rtentry = 0;
-  // store all available routes that bring packets to their destination
-  typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
-  RouteVec_t allRoutes;
+  Ipv4Mask mask = route->GetDestNetworkMask ();
+  uint16_t prefixLength = mask.GetPrefixLength ();
+  PrefixIndex::iterator i = index.begin ();
+  while (i != index.end () && i->mask != mask.Get () && i->prefixLength >= prefixLength)
+    {
+      i++;
+    }
+  if (i == index.end () || i->mask != mask.Get ())
+    {
+      MaskRoutes maskRoutes;
+      maskRoutes.mask = mask.Get ();
+      maskRoutes.prefixLength = prefixLength;
+      i = index.insert (i, maskRoutes);
+    }
+  i->routes[route->GetDestNetwork ().Get () & i->mask].push_back (route);
+}
 
-  NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
-  for (HostRoutesCI i = m_hostRoutes.begin (); 
-       i != m_hostRoutes.end (); 
-       i++) 
+void
+Ipv4GlobalRouting::RemoveFromIndex (PrefixIndex &index, Ipv4RoutingTableEntry *route)
+{
+  uint32_t mask = route->GetDestNetworkMask ().Get ();
+  for (PrefixIndex::iterator i = index.begin (); i != index.end (); i++)
     {
-      NS_ASSERT ((*i)->IsHost ());
-      if ((*i)->GetDest ().IsEqual (dest)) 
+      if (i->mask != mask)
         {
-          if (oif != 0)
-            {
-              if (oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
-                {
-                  NS_LOG_LOGIC ("Not on requested interface, skipping");
-                  continue;
-                }
-            }
-          allRoutes.push_back (*i);
-          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i); 
+          continue;
         }
-    }
-  if (allRoutes.size () == 0) // if no host route is found
-    {
-      NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
-      for (NetworkRoutesI j = m_networkRoutes.begin (); 
-           j != m_networkRoutes.end (); 
-           j++) 
+      RouteIndex::iterator j = i->routes.find (route->GetDestNetwork ().Get () & mask);
+      NS_ASSERT (j != i->routes.end ());
+      j->second.erase (std::find (j->second.begin (), j->second.end (), route));
+      if (j->second.empty ())
         {
-          Ipv4Mask mask = (*j)->GetDestNetworkMask ();
-          Ipv4Address entry = (*j)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry)) 
+          i->routes.erase (j);
+          if (i->routes.empty ())
             {
-              if (oif != 0)
-                {
-                  if (oif != m_ipv4->GetNetDevice ((*j)->GetInterface ()))
-                    {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
-                    }
-                }
-              allRoutes.push_back (*j);
-              NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
+              index.erase (i);
             }
         }
+      return;
     }
-  if (allRoutes.size () == 0)  // consider external if no host/network found
+  NS_ASSERT_MSG (false, "Route not indexed");
+}
+
+uint32_t
+Ipv4GlobalRouting::GetFlowHash (const Ipv4Header &header, Ptr<const Packet> p)
+{
+  if (!m_flowHashSaltSet)
     {
-      for (ASExternalRoutesI k = m_ASexternalRoutes.begin ();
-           k != m_ASexternalRoutes.end ();
-           k++)
+      // The same hash at every node would make the choices of the
+      // successive hops of a flow dependent on each other
+      Ptr<Node> node = m_ipv4->GetObject<Node> ();
+      m_flowHashSalt = (node != 0 ? node->GetId () : 0);
+      m_flowHashSaltSet = true;
+    }
+  uint8_t protocol = header.GetProtocol ();
+  // The ports are the first four bytes of the TCP and UDP headers, which are
+  // only in the first fragment of a packet. The transport protocols which
+  // ask for a route before adding their header give the ports in a tag
+  // instead, in the same byte order as in the header.
+  uint8_t ports[4] = { 0, 0, 0, 0 };
+  FlowPortsTag tag;
+  if (p != 0 && p->PeekPacketTag (tag))
+    {
+      ports[0] = tag.GetSourcePort () >> 8;
+      ports[1] = tag.GetSourcePort () & 0xff;
+      ports[2] = tag.GetDestinationPort () >> 8;
+      ports[3] = tag.GetDestinationPort () & 0xff;
+    }
+  else if (p != 0 && header.GetFragmentOffset () == 0 && p->GetSize () >= sizeof (ports)
+           && (protocol == TcpL4Protocol::PROT_NUMBER || protocol == UdpL4Protocol::PROT_NUMBER))
+    {
+      p->CopyData (ports, sizeof (ports));
+    }
+  char buffer[4 + 4 + 4 + 1 + 4];
+  uint32_t source = header.GetSource ().Get ();
+  uint32_t destination = header.GetDestination ().Get ();
+  std::memcpy (buffer, &m_flowHashSalt, 4);
+  std::memcpy (buffer + 4, &source, 4);
+  std::memcpy (buffer + 8, &destination, 4);
+  buffer[12] = protocol;
+  std::memcpy (buffer + 13, ports, 4);
+  return m_hasher.clear ().GetHash32 (buffer, sizeof (buffer));
+}
+
+Ipv4RoutingTableEntry *
+Ipv4GlobalRouting::SelectRoute (const RouteSet &routes, Ptr<NetDevice> oif, bool ecmp,
+                                const Ipv4Header &header, Ptr<const Packet> p)
+{
+  // Count the routes which go through the requested interface, if any
+  uint32_t nRoutes = routes.size ();
+  if (oif != 0)
+    {
+      nRoutes = 0;
+      for (RouteSet::const_iterator i = routes.begin (); i != routes.end (); i++)
         {
-          Ipv4Mask mask = (*k)->GetDestNetworkMask ();
-          Ipv4Address entry = (*k)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry))
+          if (oif == m_ipv4->GetNetDevice ((*i)->GetInterface ()))
             {
-              NS_LOG_LOGIC ("Found external route" << *k);
-              if (oif != 0)
-                {
-                  if (oif != m_ipv4->GetNetDevice ((*k)->GetInterface ()))
-                    {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
-                    }
-                }
-              allRoutes.push_back (*k);
-              break;
+              nRoutes++;
             }
         }
     }
-  if (allRoutes.size () > 0 ) // if route(s) is found
+  if (nRoutes == 0)
+    {
+      NS_LOG_LOGIC ("Not on requested interface, skipping");
+      return 0;
+    }
+  if (!ecmp)
     {
-      // pick up one of the routes uniformly at random if random
-      // ECMP routing is enabled, or always select the first route
-      // consistently if random ECMP routing is disabled
-      uint32_t selectIndex;
-      if (m_randomEcmpRouting)
+      nRoutes = 1;
+    }
+
+  // pick up one of the routes according to the flow of the packet if
+  // flow ECMP routing is enabled, uniformly at random if random ECMP
+  // routing is enabled, or always select the first route consistently
+  uint32_t selectIndex;
+  if (m_flowEcmpRouting)
+    {
+      selectIndex = (nRoutes > 1 ? GetFlowHash (header, p) % nRoutes : 0);
+    }
+  else if (m_randomEcmpRouting)
+    {
+      selectIndex = m_rand->GetInteger (0, nRoutes - 1);
+    }
+  else
+    {
+      selectIndex = 0;
+    }
+  for (RouteSet::const_iterator i = routes.begin (); i != routes.end (); i++)
+    {
+      if (oif != 0 && oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
+        {
+          continue;
+        }
+      if (selectIndex-- == 0)
         {
-          selectIndex = m_rand->GetInteger (0, allRoutes.size ()-1);
+          NS_LOG_LOGIC ("Found global route " << *i << " among " << nRoutes);
+          return *i;
         }
-      else 
+    }
+  NS_ASSERT (false);
+  return 0;
+}
+
+Ipv4RoutingTableEntry *
+Ipv4GlobalRouting::LookupPrefix (const PrefixIndex &index, Ptr<NetDevice> oif, bool ecmp,
+                                 const Ipv4Header &header, Ptr<const Packet> p)
+{
+  uint32_t dest = header.GetDestination ().Get ();
+  for (PrefixIndex::const_iterator i = index.begin (); i != index.end (); i++)
+    {
+      RouteIndex::const_iterator j = i->routes.find (dest & i->mask);
+      if (j != i->routes.end ())
         {
-          selectIndex = 0;
+          Ipv4RoutingTableEntry *route = SelectRoute (j->second, oif, ecmp, header, p);
+          if (route != 0)
+            {
+              return route;
+            }
         }
-      Ipv4RoutingTableEntry* route = allRoutes.at (selectIndex); 
+    }
+  return 0;
+}
+
+Ptr<Ipv4Route>
+Ipv4GlobalRouting::LookupGlobal (const Ipv4Header &header, Ptr<const Packet> p, Ptr<NetDevice> oif)
+{
+  Ipv4Address dest = header.GetDestination ();
+  NS_LOG_FUNCTION (this << dest << oif);
+  NS_LOG_LOGIC ("Looking for route for destination " << dest);
+  Ptr<Ipv4Route> rtentry = 0;
+  Ipv4RoutingTableEntry *route = 0;
+
+  NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
+  RouteIndex::const_iterator i = m_hostIndex.find (dest.Get ());
+  if (i != m_hostIndex.end ())
+    {
+      route = SelectRoute (i->second, oif, true, header, p);
+    }
+  if (route == 0) // if no host route is found
+    {
+      NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
+      route = LookupPrefix (m_networkIndex, oif, true, header, p);
+    }
+  if (route == 0)  // consider external if no host/network found
+    {
+      route = LookupPrefix (m_ASexternalIndex, oif, false, header, p);
+    }
+  if (route != 0) // if route(s) is found
+    {
       // create a Ipv4Route object from the selected routing table entry
       rtentry = Create<Ipv4Route> ();
       rtentry->SetDestination (route->GetDest ());
@@ -319,6 +438,12 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
           if (tmp  == index)
             {
               NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_hostRoutes.size ());
+              RouteIndex::iterator host = m_hostIndex.find ((*i)->GetDest ().Get ());
+              host->second.erase (std::find (host->second.begin (), host->second.end (), *i));
+              if (host->second.empty ())
+                {
+                  m_hostIndex.erase (host);
+                }
               delete *i;
               m_hostRoutes.erase (i);
               NS_LOG_LOGIC ("Done removing host route " << index << "; host route remaining size = " << m_hostRoutes.size ());
@@ -336,6 +461,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
       if (tmp == index)
         {
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_networkRoutes.size ());
+          RemoveFromIndex (m_networkIndex, *j);
           delete *j;
           m_networkRoutes.erase (j);
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
@@ -352,6 +478,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
       if (tmp == index)
         {
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_ASexternalRoutes.size ());
+          RemoveFromIndex (m_ASexternalIndex, *k);
           delete *k;
           m_ASexternalRoutes.erase (k);
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
@@ -392,6 +519,9 @@ Ipv4GlobalRouting::DoDispose (void)
     {
       delete (*l);
     }
+  m_hostIndex.clear ();
+  m_networkIndex.clear ();
+  m_ASexternalIndex.clear ();
 
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -468,7 +598,7 @@ Ipv4GlobalRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<Net
 // See if this is a unicast packet we have a route for.
 //
   NS_LOG_LOGIC ("Unicast destination- looking up");
-  Ptr<Ipv4Route> rtentry = LookupGlobal (header.GetDestination (), oif);
+  Ptr<Ipv4Route> rtentry = LookupGlobal (header, p, oif);
   if (rtentry)
     {
       sockerr = Socket::ERROR_NOTERROR;
@@ -517,7 +647,7 @@ Ipv4GlobalRouting::RouteInput  (Ptr<const Packet> p, const Ipv4Header &header, P
     }
   // Next, try to find a route
   NS_LOG_LOGIC ("Unicast destination- looking up global route");
-  Ptr<Ipv4Route> rtentry = LookupGlobal (header.GetDestination ());
+  Ptr<Ipv4Route> rtentry = LookupGlobal (header, p);
   if (rtentry != 0)
     {
       NS_LOG_LOGIC ("Found unicast destination- calling unicast callback");
@@ -21,6 +21,8 @@
 #define IPV4_GLOBAL_ROUTING_H
 
 #include <list>
+#include <vector>
+#include <unordered_map>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
@@ -28,6 +30,7 @@
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/hash.h"
 
 namespace ns3 {
 
@@ -65,6 +68,17 @@ class Node;
  *
  * This class deals with Ipv4 unicast routes only.
  *
+ * The routes are kept in lists, in the order in which they were added, and
+ * indexed for the lookups: the host routes by destination, and the network
+ * and AS-external routes by mask, from the longest prefix, then by
+ * destination network.  A lookup thus costs a hash table probe per distinct
+ * mask of the table, whatever the number of routes.  A host route is
+ * preferred to a network route, itself preferred to an AS-external route,
+ * and among the network (or AS-external) routes the longest matching prefix
+ * is used.  When several routes lead to the destination (ECMP), the first
+ * added is used, unless the RandomEcmpRouting or FlowEcmpRouting
+ * attributes are set.
+ *
  * \see Ipv4RoutingProtocol
  * \see GlobalRouteManager
  */
@@ -234,10 +248,18 @@ protected:
 private:
   /// Set to true if packets are randomly routed among ECMP; set to false for using only one route consistently
   bool m_randomEcmpRouting;
+  /// Set to true if packets are routed among ECMP according to the hash of their flow
+  bool m_flowEcmpRouting;
   /// Set to true if this interface should respond to interface events by globallly recomputing routes 
   bool m_respondToInterfaceEvents;
   /// A uniform random number generator for randomly routing packets among ECMP 
   Ptr<UniformRandomVariable> m_rand;
+  /// The hash function of the flows routed among ECMP
+  Hasher m_hasher;
+  /// Perturbation of the flow hashes, which differs between nodes
+  uint32_t m_flowHashSalt;
+  /// True once m_flowHashSalt is set
+  bool m_flowHashSaltSet;
 
   /// container of Ipv4RoutingTableEntry (routes to hosts)
   typedef std::list<Ipv4RoutingTableEntry *> HostRoutes;
@@ -260,18 +282,81 @@ private:
   /// iterator of container of Ipv4RoutingTableEntry (routes to external AS)
   typedef std::list<Ipv4RoutingTableEntry *>::iterator ASExternalRoutesI;
 
+  /// Routes to the same destination, in the order in which they were added
+  typedef std::vector<Ipv4RoutingTableEntry *> RouteSet;
+  /// Routes indexed by destination (host or network) address
+  typedef std::unordered_map<uint32_t, RouteSet> RouteIndex;
+  /// Routes to networks of the same mask
+  struct MaskRoutes
+  {
+    uint32_t mask;          //!< The network mask
+    uint16_t prefixLength;  //!< The number of leading ones of the mask
+    RouteIndex routes;      //!< The routes, indexed by network address
+  };
+  /// Routes to networks indexed by mask, from the longest prefix
+  typedef std::vector<MaskRoutes> PrefixIndex;
+
   /**
    * \brief Lookup in the forwarding table for destination.
-   * \param dest destination address
+   * \param header the IP header of the packet, whose destination is looked up
+   * \param p the packet, starting with its transport header unless it
+   * carries a FlowPortsTag, or 0
    * \param oif output interface if any (put 0 otherwise)
    * \return Ipv4Route to route the packet to reach dest address
    */
-  Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif = 0);
+  Ptr<Ipv4Route> LookupGlobal (const Ipv4Header &header, Ptr<const Packet> p, Ptr<NetDevice> oif = 0);
+  /**
+   * \brief Select a route among the routes to the destination of a packet
+   * \param routes the routes
+   * \param oif output interface if any (put 0 otherwise)
+   * \param ecmp false if only the first route may be selected
+   * \param header the IP header of the packet
+   * \param p the packet, or 0
+   * \return the route, or 0 if none goes through \p oif
+   */
+  Ipv4RoutingTableEntry *SelectRoute (const RouteSet &routes, Ptr<NetDevice> oif, bool ecmp,
+                                      const Ipv4Header &header, Ptr<const Packet> p);
+  /**
+   * \brief Select a route in a prefix index, from the longest matching prefix
+   * \param index the index
+   * \param oif output interface if any (put 0 otherwise)
+   * \param ecmp false if only the first route of a prefix may be selected
+   * \param header the IP header of the packet
+   * \param p the packet, or 0
+   * \return the route, or 0 if none is found
+   */
+  Ipv4RoutingTableEntry *LookupPrefix (const PrefixIndex &index, Ptr<NetDevice> oif, bool ecmp,
+                                       const Ipv4Header &header, Ptr<const Packet> p);
+  /**
+   * \brief Hash the flow of a packet, for ECMP
+   * \param header the IP header of the packet
+   * \param p the packet, starting with its transport header unless it
+   * carries a FlowPortsTag, or 0
+   * \return the hash of the addresses, protocol and ports of the packet
+   */
+  uint32_t GetFlowHash (const Ipv4Header &header, Ptr<const Packet> p);
+
+  /**
+   * \brief Index a route to a network
+   * \param index the index
+   * \param route the route
+   */
+  static void AddToIndex (PrefixIndex &index, Ipv4RoutingTableEntry *route);
+  /**
+   * \brief Remove a route to a network from an index
+   * \param index the index
+   * \param route the route
+   */
+  static void RemoveFromIndex (PrefixIndex &index, Ipv4RoutingTableEntry *route);
 
   HostRoutes m_hostRoutes;             //!< Routes to hosts
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
   ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
 
+  RouteIndex m_hostIndex;              //!< Routes to hosts, by destination
+  PrefixIndex m_networkIndex;          //!< Routes to networks, by prefix
+  PrefixIndex m_ASexternalIndex;       //!< External routes imported, by prefix
+
   Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
 
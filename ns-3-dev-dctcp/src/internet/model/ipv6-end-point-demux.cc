@@ -21,6 +21,7 @@
 #include "ipv6-end-point-demux.h"
 #include "ipv6-end-point.h"
 #include "ns3/log.h"
+#include <algorithm>
 
 namespace ns3 {
 
@@ -48,19 +49,16 @@ Ipv6EndPointDemux::~Ipv6EndPointDemux ()
 bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
 {
   NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
-    {
-      if ((*i)->GetLocalPort  () == port)
-        {
-          return true;
-        }
-    }
-  return false;
+  return m_ports.find (port) != m_ports.end ();
 }
 
 bool Ipv6EndPointDemux::LookupLocal (Ptr<NetDevice> boundNetDevice, Ipv6Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
+  if (!LookupPortLocal (port))
+    {
+      return false;
+    }
   for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
     {
       if ((*i)->GetLocalPort () == port &&
@@ -84,6 +82,8 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate ()
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (Ipv6Address::GetAny (), port);
   m_endPoints.push_back (endPoint);
+  endPoint->SetDemux (this);
+  Index (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -99,6 +99,8 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address)
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
   m_endPoints.push_back (endPoint);
+  endPoint->SetDemux (this);
+  Index (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -120,6 +122,8 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice, Ipv6Ad
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
   m_endPoints.push_back (endPoint);
+  endPoint->SetDemux (this);
+  Index (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -129,21 +133,45 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
                                            Ipv6Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << boundNetDevice << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  // The end points with this 4-tuple are either connections, or wildcards
+  // of the local port
+  const std::vector<Ipv6EndPoint *> *candidates = 0;
+  if (localAddress != Ipv6Address::GetAny () && peerAddress != Ipv6Address::GetAny () && peerPort != 0)
     {
-      if ((*i)->GetLocalPort () == localPort &&
-          (*i)->GetLocalAddress () == localAddress &&
-          (*i)->GetPeerPort () == peerPort &&
-          (*i)->GetPeerAddress () == peerAddress &&
-          ((*i)->GetBoundNetDevice () == boundNetDevice || (*i)->GetBoundNetDevice () == 0))
+      ConnectionIndex::const_iterator c = m_connections.find (ConnectionKey (localAddress, localPort, peerAddress, peerPort));
+      if (c != m_connections.end ())
         {
-          NS_LOG_WARN ("Duplicated endpoint.");
-          return 0;
+          candidates = &c->second;
+        }
+    }
+  else
+    {
+      PortIndex::const_iterator p = m_ports.find (localPort);
+      if (p != m_ports.end ())
+        {
+          candidates = &p->second.wildcards;
+        }
+    }
+  if (candidates != 0)
+    {
+      for (std::vector<Ipv6EndPoint *>::const_iterator i = candidates->begin (); i != candidates->end (); i++)
+        {
+          if ((*i)->GetLocalPort () == localPort &&
+              (*i)->GetLocalAddress () == localAddress &&
+              (*i)->GetPeerPort () == peerPort &&
+              (*i)->GetPeerAddress () == peerAddress &&
+              ((*i)->GetBoundNetDevice () == boundNetDevice || (*i)->GetBoundNetDevice () == 0))
+            {
+              NS_LOG_WARN ("Duplicated endpoint.");
+              return 0;
+            }
         }
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
   m_endPoints.push_back (endPoint);
+  endPoint->SetDemux (this);
+  Index (endPoint);
 
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
 
@@ -157,6 +185,7 @@ void Ipv6EndPointDemux::DeAllocate (Ipv6EndPoint *endPoint)
     {
       if (*i == endPoint)
         {
+          Unindex (endPoint);
           delete endPoint;
           m_endPoints.erase (i);
           break;
@@ -181,7 +210,40 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
   EndPoints retval4; /* Exact match on all 4 */
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  // The candidates are the connections with the 4-tuple of the packet, and
+  // the end points of the destination port which are not connections
+  ConnectionIndex::const_iterator c = m_connections.find (ConnectionKey (daddr, dport, saddr, sport));
+  if (c != m_connections.end ())
+    {
+      MatchEndPoints (c->second, daddr, dport, saddr, sport, incomingInterface,
+                      retval1, retval2, retval3, retval4);
+    }
+  PortIndex::const_iterator p = m_ports.find (dport);
+  if (p != m_ports.end ())
+    {
+      MatchEndPoints (p->second.wildcards, daddr, dport, saddr, sport, incomingInterface,
+                      retval1, retval2, retval3, retval4);
+    }
+
+  // Here we find the most exact match
+  EndPoints retval;
+  if (!retval4.empty ()) retval = retval4;
+  else if (!retval3.empty ()) retval = retval3;
+  else if (!retval2.empty ()) retval = retval2;
+  else retval = retval1;
+
+  NS_ABORT_MSG_IF (retval.size () > 1, "Too many endpoints - perhaps you created too many sockets without binding them to different NetDevices.");
+  return retval;  // might be empty if no matches
+}
+
+void Ipv6EndPointDemux::MatchEndPoints (const std::vector<Ipv6EndPoint *> &endPoints,
+                                        Ipv6Address daddr, uint16_t dport,
+                                        Ipv6Address saddr, uint16_t sport,
+                                        Ptr<Ipv6Interface> incomingInterface,
+                                        EndPoints &retval1, EndPoints &retval2,
+                                        EndPoints &retval3, EndPoints &retval4)
+{
+  for (std::vector<Ipv6EndPoint *>::const_iterator i = endPoints.begin (); i != endPoints.end (); i++)
     {
       Ipv6EndPoint* endP = *i;
 
@@ -276,16 +338,6 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
           retval4.push_back (endP);
         }
     }
-
-  // Here we find the most exact match
-  EndPoints retval;
-  if (!retval4.empty ()) retval = retval4;
-  else if (!retval3.empty ()) retval = retval3;
-  else if (!retval2.empty ()) retval = retval2;
-  else retval = retval1;
-
-  NS_ABORT_MSG_IF (retval.size () > 1, "Too many endpoints - perhaps you created too many sockets without binding them to different NetDevices.");
-  return retval;  // might be empty if no matches
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::SimpleLookup (Ipv6Address dst, uint16_t dport, Ipv6Address src, uint16_t sport)
@@ -355,5 +407,85 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::GetEndPoints () const
   return m_endPoints;
 }
 
-} /* namespace ns3 */
+Ipv6EndPointDemux::ConnectionKey::ConnectionKey (Ipv6Address localAddress, uint16_t localPort,
+                                                 Ipv6Address peerAddress, uint16_t peerPort)
+  : localAddress (localAddress),
+    peerAddress (peerAddress),
+    localPort (localPort),
+    peerPort (peerPort)
+{
+}
+
+bool
+Ipv6EndPointDemux::ConnectionKey::operator == (const ConnectionKey &other) const
+{
+  return localAddress == other.localAddress && peerAddress == other.peerAddress
+         && localPort == other.localPort && peerPort == other.peerPort;
+}
+
+std::size_t
+Ipv6EndPointDemux::ConnectionKeyHash::operator () (const ConnectionKey &key) const
+{
+  Ipv6AddressHash addressHash;
+  uint64_t ports = (static_cast<uint64_t> (key.localPort) << 16) | key.peerPort;
+  uint64_t h = addressHash (key.localAddress) * 0x9e3779b97f4a7c15ULL;
+  h = (h ^ addressHash (key.peerAddress) ^ ports) * 0x9e3779b97f4a7c15ULL;
+  return static_cast<std::size_t> (h ^ (h >> 32));
+}
+
+bool
+Ipv6EndPointDemux::IsConnection (Ipv6EndPoint *endPoint)
+{
+  return endPoint->GetLocalAddress () != Ipv6Address::GetAny ()
+         && endPoint->GetPeerAddress () != Ipv6Address::GetAny ()
+         && endPoint->GetPeerPort () != 0;
+}
+
+void
+Ipv6EndPointDemux::Index (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  PortEndPoints &port = m_ports[endPoint->GetLocalPort ()];
+  port.nEndPoints++;
+  if (IsConnection (endPoint))
+    {
+      ConnectionKey key (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+                         endPoint->GetPeerAddress (), endPoint->GetPeerPort ());
+      m_connections[key].push_back (endPoint);
+    }
+  else
+    {
+      port.wildcards.push_back (endPoint);
+    }
+}
+
+void
+Ipv6EndPointDemux::Unindex (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  PortIndex::iterator port = m_ports.find (endPoint->GetLocalPort ());
+  NS_ASSERT (port != m_ports.end ());
+  if (IsConnection (endPoint))
+    {
+      ConnectionKey key (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+                         endPoint->GetPeerAddress (), endPoint->GetPeerPort ());
+      ConnectionIndex::iterator c = m_connections.find (key);
+      NS_ASSERT (c != m_connections.end ());
+      c->second.erase (std::find (c->second.begin (), c->second.end (), endPoint));
+      if (c->second.empty ())
+        {
+          m_connections.erase (c);
+        }
+    }
+  else
+    {
+      std::vector<Ipv6EndPoint *> &wildcards = port->second.wildcards;
+      wildcards.erase (std::find (wildcards.begin (), wildcards.end (), endPoint));
+    }
+  if (--port->second.nEndPoints == 0)
+    {
+      m_ports.erase (port);
+    }
+}
 
+} /* namespace ns3 */
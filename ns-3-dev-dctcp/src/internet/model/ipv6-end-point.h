@@ -34,6 +34,7 @@ namespace ns3
 
 class Header;
 class Packet;
+class Ipv6EndPointDemux;
 
 /**
  * \ingroup ipv6
@@ -191,6 +192,16 @@ public:
    */
   bool IsRxEnabled (void);
 
+  /**
+   * \brief Set the demux which indexes this end point.
+   *
+   * The demux is notified when the addresses or the ports of the end point
+   * change, so that it can update its index.
+   *
+   * \param demux the demux, or 0
+   */
+  void SetDemux (Ipv6EndPointDemux *demux);
+
 private:
   /**
    * \brief The local address.
@@ -236,6 +247,11 @@ private:
    * \brief true if the endpoint can receive packets.
    */
   bool m_rxEnabled;
+
+  /**
+   * \brief The demux which indexes the endpoint, if any.
+   */
+  Ipv6EndPointDemux *m_demux;
 };
 
 } /* namespace ns3 */
@@ -25,7 +25,7 @@
 #include "ns3/simulator.h"
 #include "ns3/abort.h"
 #include "ns3/node.h"
-#include "math.h"
+#include <cmath>
 #include "ns3/tcp-socket-base.h"
 #include "ns3/sequence-number.h"
 #include "ns3/double.h"
@@ -37,6 +37,9 @@ NS_LOG_COMPONENT_DEFINE ("TcpDctcp");
 
 NS_OBJECT_ENSURE_REGISTERED (TcpDctcp);
 
+const uint32_t TcpDctcp::DCTCP_MAX_ALPHA;
+const uint32_t TcpDctcp::DCTCP_MAX_SHIFT_G;
+
 TypeId TcpDctcp::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::TcpDctcp")
@@ -44,15 +47,22 @@ TypeId TcpDctcp::GetTypeId (void)
     .AddConstructor<TcpDctcp> ()
     .SetGroupName ("Internet")
     .AddAttribute ("DctcpShiftG",
-                   "Parameter G for updating dctcp_alpha",
+                   "Parameter G for updating dctcp_alpha, a power of two "
+                   "between 1 and 1/1024",
                    DoubleValue (0.0625),
-                   MakeDoubleAccessor (&TcpDctcp::m_g),
-                   MakeDoubleChecker<double> (0))
+                   MakeDoubleAccessor (&TcpDctcp::SetDctcpShiftG,
+                                       &TcpDctcp::GetDctcpShiftG),
+                   MakeDoubleChecker<double> (0, 1))
     .AddAttribute ("DctcpAlphaOnInit",
                    "Parameter for initial alpha value",
                    DoubleValue (0.0),
-                   MakeDoubleAccessor (&TcpDctcp::SetDctcpAlpha),
-                   MakeDoubleChecker<double> (0))
+                   MakeDoubleAccessor (&TcpDctcp::SetDctcpAlpha,
+                                       &TcpDctcp::GetDctcpAlphaFraction),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddTraceSource ("DctcpAlpha",
+                     "Value of alpha, in units of 1/1024",
+                     MakeTraceSourceAccessor (&TcpDctcp::m_alpha),
+                     "ns3::TracedValueCallback::Uint32")
   ;
   return tid;
 }
@@ -63,7 +73,9 @@ std::string TcpDctcp::GetName () const
 }
 
 TcpDctcp::TcpDctcp ()
-  : TcpNewReno ()
+  : TcpNewReno (),
+    m_alpha (0),
+    m_shiftG (4)
 {
   NS_LOG_FUNCTION (this);
   m_delayedAckReserved = false;
@@ -75,7 +87,9 @@ TcpDctcp::TcpDctcp ()
 }
 
 TcpDctcp::TcpDctcp (const TcpDctcp& sock)
-  : TcpNewReno (sock)
+  : TcpNewReno (sock),
+    m_alpha (sock.m_alpha),
+    m_shiftG (sock.m_shiftG)
 {
   NS_LOG_FUNCTION (this);
   m_delayedAckReserved = (sock.m_delayedAckReserved);
@@ -101,7 +115,8 @@ void
 TcpDctcp::ReduceCwnd (Ptr<TcpSocketState> tcb)
 {
   NS_LOG_FUNCTION (this << tcb);
-  uint32_t val = (int)((1 - m_alpha / 2.0) * tcb->m_cWnd);
+  // cWnd * (1 - alpha / 2), with alpha scaled by DCTCP_MAX_ALPHA
+  uint32_t val = static_cast<uint32_t> ((static_cast<uint64_t> (tcb->m_cWnd) * (2 * DCTCP_MAX_ALPHA - m_alpha)) >> 11);
   tcb->m_cWnd = std::max (val, 2 * tcb->m_segmentSize);
 }
 
@@ -121,25 +136,54 @@ TcpDctcp::PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked, const Time
     }
   if (tcb->m_lastAckedSeq >= m_nextSeq)
     {
-      double bytesEcn;
-      if (m_ackedBytesTotal >  0)
-        {
-          bytesEcn = (double) m_ackedBytesEcn / m_ackedBytesTotal;
-        }
-      else
+      uint32_t alpha = m_alpha;
+      alpha -= alpha >> m_shiftG;
+      if (m_ackedBytesEcn > 0 && m_ackedBytesTotal > 0)
         {
-          bytesEcn = 0.0;
+          // m_ackedBytesEcn <= m_ackedBytesTotal, so the shift cannot
+          // overflow 64 bits and the result is at most DCTCP_MAX_ALPHA
+          alpha += static_cast<uint32_t> ((static_cast<uint64_t> (m_ackedBytesEcn) << (10 - m_shiftG)) / m_ackedBytesTotal);
         }
-      m_alpha = (1.0 - m_g) * m_alpha + m_g * bytesEcn;
+      m_alpha = std::min (alpha, DCTCP_MAX_ALPHA);
       Reset (tcb);
     }
 }
 
+uint32_t
+TcpDctcp::GetDctcpAlpha (void) const
+{
+  return m_alpha;
+}
+
 void
 TcpDctcp::SetDctcpAlpha (double alpha)
 {
   NS_LOG_FUNCTION (this << alpha);
-  m_alpha = alpha;
+  m_alpha = static_cast<uint32_t> (std::min (alpha, 1.0) * DCTCP_MAX_ALPHA + 0.5);
+}
+
+double
+TcpDctcp::GetDctcpAlphaFraction (void) const
+{
+  return static_cast<double> (m_alpha) / DCTCP_MAX_ALPHA;
+}
+
+void
+TcpDctcp::SetDctcpShiftG (double g)
+{
+  NS_LOG_FUNCTION (this << g);
+  int exp;
+  double mantissa = std::frexp (g, &exp);
+  // g = 2^-shift is represented as 0.5 * 2^(1 - shift)
+  NS_ABORT_MSG_UNLESS (mantissa == 0.5 && exp <= 1 && 1 - exp <= static_cast<int> (DCTCP_MAX_SHIFT_G),
+                       "DctcpShiftG must be a power of two between 1 and 1/1024, not " << g);
+  m_shiftG = 1 - exp;
+}
+
+double
+TcpDctcp::GetDctcpShiftG (void) const
+{
+  return std::ldexp (1.0, -static_cast<int> (m_shiftG));
 }
 
 void
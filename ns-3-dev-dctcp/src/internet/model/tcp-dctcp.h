@@ -23,6 +23,7 @@
 #define TCP_DCTCP_H
 
 #include "ns3/tcp-congestion-ops.h"
+#include "ns3/traced-value.h"
 
 namespace ns3 {
 
@@ -31,6 +32,16 @@ namespace ns3 {
  *
  * \brief An implementation of DCTCP. This model implements all the functionalities mentioned
  * in the DCTCP SIGCOMM paper except dynamic buffer allocation in switches
+ *
+ * As in Linux, alpha is kept in fixed point, scaled by DCTCP_MAX_ALPHA, and
+ * the estimation gain g is a power of two, so that the moving average is
+ * updated with shifts once per observation window:
+ *
+ *   alpha = alpha - (alpha >> shift_g) + (bytes_ecn << (10 - shift_g)) / bytes_acked
+ *
+ * Per-ACK processing only accumulates the acked and marked bytes; the single
+ * division happens at the end of a window, and is skipped altogether when no
+ * byte was marked.
  */
 
 class TcpDctcp : public TcpNewReno
@@ -92,6 +103,16 @@ public:
   virtual void CwndEvent (Ptr<TcpSocketState> tcb,
                           const TcpSocketState::TcpCAEvent_t event);
 
+  /**
+   * \brief Get the current value of alpha
+   *
+   * \return alpha, in units of 1 / DCTCP_MAX_ALPHA
+   */
+  uint32_t GetDctcpAlpha (void) const;
+
+  static const uint32_t DCTCP_MAX_ALPHA = 1024;   //!< Fixed-point scale of alpha
+  static const uint32_t DCTCP_MAX_SHIFT_G = 10;   //!< Largest supported shift for the estimation gain
+
 private:
   /**
    * \brief Changes state of m_ceState to true
@@ -130,16 +151,37 @@ private:
    */
   void SetDctcpAlpha (double alpha);
 
+  /**
+   * \brief Gets the value of m_alpha as a fraction
+   *
+   * \return DCTCP alpha parameter
+   */
+  double GetDctcpAlphaFraction (void) const;
+
+  /**
+   * \brief Sets the estimation gain, which must be a power of two
+   *
+   * \param g the estimation gain, 2^-m_shiftG
+   */
+  void SetDctcpShiftG (double g);
+
+  /**
+   * \brief Gets the estimation gain
+   *
+   * \return the estimation gain
+   */
+  double GetDctcpShiftG (void) const;
+
   uint32_t m_ackedBytesEcn;             //!< Number of acked bytes which are marked
   uint32_t m_ackedBytesTotal;           //!< Total number of acked bytes
   SequenceNumber32 m_priorRcvNxt;       //!< Sequence number of the first missing byte in data
   bool m_priorRcvNxtFlag;               //!< Variable used in setting the value of m_priorRcvNxt for first time
-  double m_alpha;                       //!< Parameter used to estimate fraction of sent bytes that encountered congestion
+  TracedValue<uint32_t> m_alpha;        //!< Fraction of sent bytes that encountered congestion, scaled by DCTCP_MAX_ALPHA
   SequenceNumber32 m_nextSeq;           //!< TCP sequence number threshold for beginning a new observation window
   bool m_nextSeqFlag;                   //!< Variable used in setting the value of m_nextSeq for first time
   bool m_ceState;                       //!< DCTCP Congestion Experienced state
   bool m_delayedAckReserved;            //!< Delayed Ack state
-  double m_g;                           //!< Estimation gain
+  uint32_t m_shiftG;                    //!< Estimation gain, as a right shift
 };
 
 } // namespace ns3
@@ -95,7 +95,8 @@ TcpL4Protocol::GetTypeId (void)
 }
 
 TcpL4Protocol::TcpL4Protocol ()
-  : m_endPoints (new Ipv4EndPointDemux ()), m_endPoints6 (new Ipv6EndPointDemux ())
+  : m_endPoints (new Ipv4EndPointDemux ()), m_endPoints6 (new Ipv6EndPointDemux ()),
+    m_timerWheel (Create<TcpTimerWheel> ())
 {
   NS_LOG_FUNCTION_NOARGS ();
   NS_LOG_LOGIC ("Made a TcpL4Protocol " << this);
@@ -741,6 +742,12 @@ TcpL4Protocol::RemoveSocket (Ptr<TcpSocketBase> socket)
   return false;
 }
 
+Ptr<TcpTimerWheel>
+TcpL4Protocol::GetTimerWheel (void) const
+{
+  return m_timerWheel;
+}
+
 void
 TcpL4Protocol::SetDownTarget (IpL4Protocol::DownTargetCallback callback)
 {
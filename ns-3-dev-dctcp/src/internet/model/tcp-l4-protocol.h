@@ -27,6 +27,7 @@
 #include "ns3/ipv6-address.h"
 #include "ns3/sequence-number.h"
 #include "ip-l4-protocol.h"
+#include "tcp-timer-wheel.h"
 
 
 namespace ns3 {
@@ -235,6 +236,13 @@ public:
    */
   bool RemoveSocket (Ptr<TcpSocketBase> socket);
 
+  /**
+   * \brief Get the wheel of the timers of the sockets
+   *
+   * \return the timer wheel
+   */
+  Ptr<TcpTimerWheel> GetTimerWheel (void) const;
+
   /**
    * \brief Remove an IPv4 Endpoint.
    * \param endPoint the end point to remove
@@ -321,6 +329,7 @@ private:
   TypeId m_congestionTypeId;       //!< The socket TypeId
   TypeId m_recoveryTypeId;         //!< The recovery TypeId
   std::vector<Ptr<TcpSocketBase> > m_sockets;      //!< list of sockets
+  Ptr<TcpTimerWheel> m_timerWheel;                 //!< wheel of the timers of the sockets
   IpL4Protocol::DownTargetCallback m_downTarget;   //!< Callback to send packets over IPv4
   IpL4Protocol::DownTargetCallback6 m_downTarget6; //!< Callback to send packets over IPv6
 
@@ -70,7 +70,9 @@ TcpOption::CreateOption (uint8_t kind)
     TypeId tid;
   };
 
-  static ObjectFactory objectFactory;
+  // One factory per thread, as options are created by the threads of a
+  // parallel simulation
+  static thread_local ObjectFactory objectFactory;
   static kindToTid toTid[] =
   {
     { TcpOption::END,           TcpOptionEnd::GetTypeId () },
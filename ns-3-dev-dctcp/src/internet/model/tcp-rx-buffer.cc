@@ -18,6 +18,8 @@
  * Author: Adrian Sai-wah Tam <adrian.sw.tam@gmail.com>
  */
 
+#include <algorithm>
+#include <iterator>
 #include "ns3/packet.h"
 #include "ns3/log.h"
 #include "tcp-rx-buffer.h"
@@ -155,16 +157,21 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
       if (maxSeq < tailSeq) tailSeq = maxSeq;
       if (tailSeq < headSeq) headSeq = tailSeq;
     }
-  // Remove overlapped bytes from packet
-  BufIterator i = m_data.begin ();
+  // Remove overlapped bytes from packet. Only the segment starting before
+  // headSeq, if any, and the ones starting in the packet can overlap it
+  BufIterator i = m_data.lower_bound (headSeq);
+  if (i != m_data.begin ())
+    {
+      --i;
+    }
   while (i != m_data.end () && i->first <= tailSeq)
     {
-      SequenceNumber32 lastByteSeq = i->first + SequenceNumber32 (i->second->GetSize ());
+      SequenceNumber32 lastByteSeq = i->first + SequenceNumber32 (i->second.m_length);
       if (lastByteSeq > headSeq)
         {
           if (i->first > headSeq && lastByteSeq < tailSeq)
             { // Rare case: Existing packet is embedded fully in the new packet
-              m_size -= i->second->GetSize ();
+              m_size -= i->second.m_length;
               m_data.erase (i++);
               continue;
             }
@@ -179,44 +186,38 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
         }
       ++i;
     }
-  // We now know how much we are going to store, trim the packet
+  // We now know how much we are going to store
   if (headSeq >= tailSeq)
     {
       NS_LOG_LOGIC ("Nothing to buffer");
       return false; // Nothing to buffer anyway
     }
-  else
-    {
-      uint32_t start = static_cast<uint32_t> (headSeq - tcph.GetSequenceNumber ());
-      uint32_t length = static_cast<uint32_t> (tailSeq - headSeq);
-      p = p->CreateFragment (start, length);
-      NS_ASSERT (length == p->GetSize ());
-    }
-  // Insert packet into buffer
+  // Insert a reference to the stored bytes of the packet into the buffer
+  Segment segment;
+  segment.m_packet = p;
+  segment.m_offset = static_cast<uint32_t> (headSeq - tcph.GetSequenceNumber ());
+  segment.m_length = static_cast<uint32_t> (tailSeq - headSeq);
+  NS_ASSERT (segment.m_offset + segment.m_length <= pktSize);
   NS_ASSERT (m_data.find (headSeq) == m_data.end ()); // Shouldn't be there yet
-  m_data [ headSeq ] = p;
+  m_data.insert (i, std::make_pair (headSeq, segment));
 
+  BlockList::iterator block = InsertBlock (headSeq, tailSeq);
   if (headSeq > m_nextRxSeq)
     {
       // Generate a new SACK block
-      UpdateSackList (headSeq, tailSeq);
+      UpdateSackList (block);
     }
 
-  NS_LOG_LOGIC ("Buffered packet of seqno=" << headSeq << " len=" << p->GetSize ());
+  NS_LOG_LOGIC ("Buffered packet of seqno=" << headSeq << " len=" << segment.m_length);
   // Update variables
-  m_size += p->GetSize ();      // Occupancy
-  for (i = m_data.begin (); i != m_data.end (); ++i)
-    {
-      if (i->first < m_nextRxSeq)
-        {
-          continue;
-        }
-      else if (i->first > m_nextRxSeq)
-        {
-          break;
-        };
-      m_nextRxSeq = i->first + SequenceNumber32 (i->second->GetSize ());
-      m_availBytes += i->second->GetSize ();
+  m_size += segment.m_length;   // Occupancy
+  block = m_blocks.begin ();
+  if (block->first <= m_nextRxSeq)
+    { // The block at the left edge is now in sequence
+      NS_ASSERT (block->first == m_nextRxSeq);
+      m_availBytes += block->second - m_nextRxSeq;
+      m_nextRxSeq = block->second;
+      m_blocks.erase (block);
       ClearSackList (m_nextRxSeq);
     }
   NS_LOG_LOGIC ("Updated buffer occupancy=" << m_size << " nextRxSeq=" << m_nextRxSeq);
@@ -235,18 +236,33 @@ TcpRxBuffer::GetSackListSize () const
   return static_cast<uint32_t> (m_sackList.size ());
 }
 
-void
-TcpRxBuffer::UpdateSackList (const SequenceNumber32 &head, const SequenceNumber32 &tail)
+TcpRxBuffer::BlockList::iterator
+TcpRxBuffer::InsertBlock (SequenceNumber32 head, SequenceNumber32 tail)
 {
   NS_LOG_FUNCTION (this << head << tail);
-  NS_ASSERT (head > m_nextRxSeq);
 
-  TcpOptionSack::SackBlock current;
-  current.first = head;
-  current.second = tail;
+  BlockList::iterator it = m_blocks.upper_bound (head);
+  if (it != m_blocks.begin () && std::prev (it)->second >= head)
+    { // The range overlaps or follows the previous block: start from it
+      --it;
+      head = it->first;
+    }
+  while (it != m_blocks.end () && it->first <= tail)
+    {
+      tail = std::max (tail, it->second);
+      it = m_blocks.erase (it);
+    }
+  return m_blocks.insert (it, std::make_pair (head, tail));
+}
+
+void
+TcpRxBuffer::UpdateSackList (BlockList::const_iterator block)
+{
+  NS_LOG_FUNCTION (this << block->first << block->second);
+  NS_ASSERT (block->first > m_nextRxSeq);
 
-  // The block "current" has been safely stored. Now we need to build the SACK
-  // list, to be advertised. From RFC 2018:
+  // The block holding the new data has been safely stored. Now we need to
+  // build the SACK list, to be advertised. From RFC 2018:
   // (a) The first SACK block (i.e., the one immediately following the
   //     kind and length fields in the option) MUST specify the contiguous
   //     block of data containing the segment which triggered this ACK,
@@ -271,65 +287,26 @@ TcpRxBuffer::UpdateSackList (const SequenceNumber32 &head, const SequenceNumber3
   //     following SACK blocks in the SACK option may be listed in
   //     arbitrary order.
 
-  m_sackList.push_front (current);
-
-  // We have inserted the block at the beginning of the list. Now, we should
-  // check if any existing blocks overlap with that.
-  bool updated = false;
-  TcpOptionSack::SackList::iterator it = m_sackList.begin ();
-  TcpOptionSack::SackBlock begin = *it;
-  TcpOptionSack::SackBlock merged;
-  ++it;
-
-  // Iterates until we examined all blocks in the list (maximum 4)
-  while (it != m_sackList.end ())
+  TcpOptionSack::SackList previous;
+  previous.swap (m_sackList);
+  m_sackList.push_back (*block);
+
+  // The blocks previously reported follow, replaced by the out-of-order block
+  // they are now part of; the blocks merged into one already in the list are
+  // not repeated. The blocks are never split, so the block holding the start
+  // of a previous one holds it as a whole. Since the maximum blocks that fits
+  // into a TCP header are 4, there's no point on maintaining the others.
+  for (TcpOptionSack::SackList::const_iterator it = previous.begin ();
+       it != previous.end () && m_sackList.size () < 4; ++it)
     {
-      current = *it;
-
-      // This is a left merge:
-      // [current_first; current_second] [beg_first; beg_second]
-      if (begin.first == current.second)
-        {
-          NS_ASSERT (current.first < begin.second);
-          merged = TcpOptionSack::SackBlock (current.first, begin.second);
-          updated = true;
-        }
-      // while this is a right merge
-      // [begin_first; begin_second] [current_first; current_second]
-      else if (begin.second == current.first)
-        {
-          NS_ASSERT (begin.first < current.second);
-          merged = TcpOptionSack::SackBlock (begin.first, current.second);
-          updated = true;
-        }
-
-      // If we have merged the blocks (and the result is in merged) we should
-      // delete the current block (it), the first block, and insert the merged
-      // one at the beginning.
-      if (updated)
+      BlockList::const_iterator current = std::prev (m_blocks.upper_bound (it->first));
+      NS_ASSERT (current->first <= it->first && it->second <= current->second);
+      TcpOptionSack::SackBlock merged (current->first, current->second);
+      if (std::find (m_sackList.begin (), m_sackList.end (), merged) == m_sackList.end ())
         {
-          m_sackList.erase (it);
-          m_sackList.pop_front ();
-          m_sackList.push_front (merged);
-          it = m_sackList.begin ();
-          begin = *it;
-          updated = false;
+          m_sackList.push_back (merged);
         }
-
-      ++it;
-    }
-
-  // Since the maximum blocks that fits into a TCP header are 4, there's no
-  // point on maintaining the others.
-  if (m_sackList.size () > 4)
-    {
-      m_sackList.pop_back ();
     }
-
-  // Please note that, if a block b is discarded and then a block contiguous
-  // to b is received, only that new block (without the b part) is reported.
-  // This is perfectly fine for the RFC point (a), given that we do not report any
-  // overlapping blocks shortly after.
 }
 
 void
@@ -376,20 +353,32 @@ TcpRxBuffer::Extract (uint32_t maxSize)
       i = m_data.begin ();
       NS_ASSERT (i->first <= m_nextRxSeq); // in-sequence data expected
       // Check if we send the whole pkt or just a partial
-      uint32_t pktSize = i->second->GetSize ();
+      Segment &segment = i->second;
+      uint32_t pktSize = segment.m_length;
       if (pktSize <= extractSize)
         { // Whole packet is extracted
-          outPkt->AddAtEnd (i->second);
+          if (segment.m_offset == 0 && pktSize == segment.m_packet->GetSize ())
+            {
+              outPkt->AddAtEnd (segment.m_packet);
+            }
+          else
+            {
+              outPkt->AddAtEnd (segment.m_packet->CreateFragment (segment.m_offset, pktSize));
+            }
           m_data.erase (i);
           m_size -= pktSize;
           m_availBytes -= pktSize;
           extractSize -= pktSize;
         }
       else
-        { // Partial is extracted and done
-          outPkt->AddAtEnd (i->second->CreateFragment (0, extractSize));
-          m_data[i->first + SequenceNumber32 (extractSize)] = i->second->CreateFragment (extractSize, pktSize - extractSize);
+        { // Partial is extracted and done: the rest stays in the same packet
+          outPkt->AddAtEnd (segment.m_packet->CreateFragment (segment.m_offset, extractSize));
+          Segment rest = segment;
+          rest.m_offset += extractSize;
+          rest.m_length -= extractSize;
+          SequenceNumber32 restSeq = i->first + SequenceNumber32 (extractSize);
           m_data.erase (i);
+          m_data.insert (m_data.begin (), std::make_pair (restSeq, rest));
           m_size -= extractSize;
           m_availBytes -= extractSize;
           extractSize = 0;
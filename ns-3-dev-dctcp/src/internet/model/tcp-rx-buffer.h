@@ -53,6 +53,23 @@ class Packet;
  * To store data, use Add; for retrieving a certain amount of ordered data, use
  * the method Extract.
  *
+ * Storage
+ * -------
+ *
+ * The received data is kept without copying: each stored segment is a
+ * reference to the packet it arrived in, together with the offset and the
+ * length of the bytes of that packet which are new to the buffer. Overlaps
+ * with data already stored are trimmed by adjusting the offset and the
+ * length, and a fragment is only created when the data is extracted.
+ * Segments are indexed by their starting sequence number, so that finding
+ * the segments overlapping an incoming one takes logarithmic time.
+ *
+ * Adjacent segments are not merged. The out-of-order data is instead also
+ * described by a set of disjoint blocks of contiguous sequence numbers,
+ * which are merged as soon as a segment fills the gap between them. When
+ * the block at the left edge starts at the next expected sequence number,
+ * it is made available to the application as a whole.
+ *
  * SACK list
  * ---------
  *
@@ -64,8 +81,10 @@ class Packet;
  * > If sent at all, SACK options SHOULD be included in all ACKs which do
  * > not ACK the highest sequence number in the data receiver's queue.
  *
- * For more information about the SACK list, please check the documentation of
- * the method GetSackList.
+ * The blocks of the SACK list are taken from the set of out-of-order blocks,
+ * hence they always describe the whole contiguous range around the data they
+ * report. For more information about the SACK list, please check the
+ * documentation of the method GetSackList.
  *
  * \see GetSackList
  * \see UpdateSackList
@@ -182,6 +201,20 @@ public:
   bool GotFin () const { return m_gotFin; }
 
 private:
+  /// Container of the blocks of contiguous out-of-order data (start -> end)
+  typedef std::map<SequenceNumber32, SequenceNumber32> BlockList;
+
+  /**
+   * \brief Add a range of sequence numbers to the out-of-order blocks
+   *
+   * The range is merged with the blocks it overlaps or is adjacent to.
+   *
+   * \param head first sequence number of the range
+   * \param tail sequence number following the range
+   * \return an iterator to the block containing the range
+   */
+  BlockList::iterator InsertBlock (SequenceNumber32 head, SequenceNumber32 tail);
+
   /**
    * \brief Update the sack list, with the block seq starting at the beginning
    *
@@ -197,10 +230,13 @@ private:
    * (or other) options, it is even less. For more detail about this function,
    * please see the source code and in-line comments.
    *
-   * \param head sequence number of the block at the beginning
-   * \param tail sequence number of the block at the end
+   * The first block of the list is the out-of-order block holding the
+   * received data; the blocks previously reported follow, replaced by the
+   * out-of-order block they are now part of.
+   *
+   * \param block the out-of-order block holding the received data
    */
-  void UpdateSackList (const SequenceNumber32 &head, const SequenceNumber32 &tail);
+  void UpdateSackList (BlockList::const_iterator block);
 
   /**
    * \brief Remove old blocks from the sack list
@@ -217,15 +253,31 @@ private:
 
   TcpOptionSack::SackList m_sackList; //!< Sack list (updated constantly)
 
+  /**
+   * \brief A segment of data stored in the buffer
+   *
+   * The data is the range [m_offset, m_offset + m_length) of the bytes of the
+   * packet it was received in.
+   */
+  struct Segment
+  {
+    Ptr<Packet> m_packet; //!< Packet holding the data
+    uint32_t m_offset;    //!< Offset of the data in the packet
+    uint32_t m_length;    //!< Length of the data
+  };
+
   /// container for data stored in the buffer
-  typedef std::map<SequenceNumber32, Ptr<Packet> >::iterator BufIterator;
+  typedef std::map<SequenceNumber32, Segment> SegmentList;
+  /// iterator over the data stored in the buffer
+  typedef SegmentList::iterator BufIterator;
   TracedValue<SequenceNumber32> m_nextRxSeq; //!< Seqnum of the first missing byte in data (RCV.NXT)
   SequenceNumber32 m_finSeq;                 //!< Seqnum of the FIN packet
   bool m_gotFin;                             //!< Did I received FIN packet?
   uint32_t m_size;                           //!< Number of total data bytes in the buffer, not necessarily contiguous
   uint32_t m_maxBuffer;                      //!< Upper bound of the number of data bytes in buffer (RCV.WND)
   uint32_t m_availBytes;                     //!< Number of bytes available to read, i.e. contiguous block at head
-  std::map<SequenceNumber32, Ptr<Packet> > m_data; //!< Corresponding data (may be null)
+  SegmentList m_data;                        //!< Corresponding data, indexed by starting seqnum
+  BlockList m_blocks;                        //!< Blocks of contiguous data beyond m_nextRxSeq
 };
 
 } //namespace ns3
@@ -52,6 +52,9 @@
 #include "tcp-rx-buffer.h"
 #include "rtt-estimator.h"
 #include "tcp-header.h"
+#include "flow-ports-tag.h"
+#include "ipv4-header.h"
+#include "ipv6-header.h"
 #include "tcp-option-winscale.h"
 #include "tcp-option-ts.h"
 #include "tcp-option-sack-permitted.h"
@@ -245,7 +248,7 @@ TcpSocketBase::TcpSocketBase (void)
   m_tcb->m_rxBuffer = CreateObject<TcpRxBuffer> ();
 
   m_tcb->m_currentPacingRate = m_tcb->m_maxPacingRate;
-  m_pacingTimer.SetFunction (&TcpSocketBase::NotifyPacingPerformed, this);
+  SetupTimers ();
 
   m_tcb->m_sendEmptyPacketCallback = MakeCallback (&TcpSocketBase::SendEmptyPacket, this);
 
@@ -334,7 +337,6 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     m_isFirstPartialAck (sock.m_isFirstPartialAck),
     m_txTrace (sock.m_txTrace),
     m_rxTrace (sock.m_rxTrace),
-    m_pacingTimer (Timer::REMOVE_ON_DESTROY),
     m_ecnMode (sock.m_ecnMode),
     m_ecnEchoSeq (sock.m_ecnEchoSeq),
     m_ecnCESeq (sock.m_ecnCESeq),
@@ -360,7 +362,7 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
   m_tcb->m_rxBuffer = CopyObject (sock.m_tcb->m_rxBuffer);
 
   m_tcb->m_currentPacingRate = m_tcb->m_maxPacingRate;
-  m_pacingTimer.SetFunction (&TcpSocketBase::NotifyPacingPerformed, this);
+  SetupTimers ();
 
   if (sock.m_congestionControl)
     {
@@ -457,6 +459,7 @@ void
 TcpSocketBase::SetTcp (Ptr<TcpL4Protocol> tcp)
 {
   m_tcp = tcp;
+  SetupTimers ();
 }
 
 /* Set an RTT estimator with this socket */
@@ -1240,6 +1243,8 @@ TcpSocketBase::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
   // in case the packet still has a priority tag attached, remove it
   SocketPriorityTag priorityTag;
   packet->RemovePacketTag (priorityTag);
+  SocketPacingRateTag pacingRateTag;
+  packet->RemovePacketTag (pacingRateTag);
 
   // Peel off TCP header
   TcpHeader tcpHeader;
@@ -1342,13 +1347,13 @@ TcpSocketBase::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
     { // Zero window: Enter persist state to send 1 byte to probe
       NS_LOG_LOGIC (this << " Enter zerowindow persist state");
       NS_LOG_LOGIC (this << " Cancelled ReTxTimeout event which was set to expire at " <<
-                    (Simulator::Now () + Simulator::GetDelayLeft (m_retxEvent)).GetSeconds ());
+                    (Simulator::Now () + m_retxEvent.GetDelayLeft ()).GetSeconds ());
       m_retxEvent.Cancel ();
       NS_LOG_LOGIC ("Schedule persist timeout at time " <<
                     Simulator::Now ().GetSeconds () << " to expire at time " <<
                     (Simulator::Now () + m_persistTimeout).GetSeconds ());
-      m_persistEvent = Simulator::Schedule (m_persistTimeout, &TcpSocketBase::PersistTimeout, this);
-      NS_ASSERT (m_persistTimeout == Simulator::GetDelayLeft (m_persistEvent));
+      m_persistEvent.Schedule (m_persistTimeout);
+      NS_ASSERT (m_persistTimeout == m_persistEvent.GetDelayLeft ());
     }
 
   // TCP state machine code in different process functions
@@ -2435,7 +2440,7 @@ TcpSocketBase::DoPeerClose (void)
     {
       NS_LOG_LOGIC ("TcpSocketBase " << this << " scheduling LATO1");
       Time lastRto = m_rtt->GetEstimate () + Max (m_clockGranularity, m_rtt->GetVariation () * 4);
-      m_lastAckEvent = Simulator::Schedule (lastRto, &TcpSocketBase::LastAckTimeout, this);
+      m_lastAckEvent.Schedule (lastRto);
     }
 }
 
@@ -2451,7 +2456,7 @@ TcpSocketBase::Destroy (void)
       m_tcp->RemoveSocket (this);
     }
   NS_LOG_LOGIC (this << " Cancelled ReTxTimeout event which was set to expire at " <<
-                (Simulator::Now () + Simulator::GetDelayLeft (m_retxEvent)).GetSeconds ());
+                (Simulator::Now () + m_retxEvent.GetDelayLeft ()).GetSeconds ());
   CancelAllTimers ();
 }
 
@@ -2467,7 +2472,7 @@ TcpSocketBase::Destroy6 (void)
       m_tcp->RemoveSocket (this);
     }
   NS_LOG_LOGIC (this << " Cancelled ReTxTimeout event which was set to expire at " <<
-                (Simulator::Now () + Simulator::GetDelayLeft (m_retxEvent)).GetSeconds ());
+                (Simulator::Now () + m_retxEvent.GetDelayLeft ()).GetSeconds ());
   CancelAllTimers ();
 }
 
@@ -2593,7 +2598,7 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
       NS_LOG_LOGIC ("Schedule retransmission timeout at time "
                     << Simulator::Now ().GetSeconds () << " to expire at time "
                     << (Simulator::Now () + m_rto.Get ()).GetSeconds ());
-      m_retxEvent = Simulator::Schedule (m_rto, &TcpSocketBase::SendEmptyPacket, this, flags);
+      m_retxEvent.Schedule (m_rto, MakeCallback (&TcpSocketBase::SendEmptyPacket, this).Bind (flags));
     }
 }
 
@@ -2644,10 +2649,13 @@ TcpSocketBase::SetupEndpoint ()
   // interface's address
   Ipv4Header header;
   header.SetDestination (m_endPoint->GetPeerAddress ());
+  // The routing protocol may pick the route from the ports of the connection
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddPacketTag (FlowPortsTag (m_endPoint->GetLocalPort (), m_endPoint->GetPeerPort ()));
   Socket::SocketErrno errno_;
   Ptr<Ipv4Route> route;
   Ptr<NetDevice> oif = m_boundnetdevice;
-  route = ipv4->GetRoutingProtocol ()->RouteOutput (Ptr<Packet> (), header, oif, errno_);
+  route = ipv4->GetRoutingProtocol ()->RouteOutput (p, header, oif, errno_);
   if (route == 0)
     {
       NS_LOG_LOGIC ("Route to " << m_endPoint->GetPeerAddress () << " does not exist");
@@ -2881,6 +2889,14 @@ TcpSocketBase::AddSocketTags (const Ptr<Packet> &p) const
       priorityTag.SetPriority (priority);
       p->ReplacePacketTag (priorityTag);
     }
+
+  if (m_tcb->m_pacing)
+    {
+      // Let a pacing queue disc release the packet at the rate of the socket
+      SocketPacingRateTag pacingRateTag;
+      pacingRateTag.SetPacingRate (m_tcb->m_currentPacingRate);
+      p->ReplacePacketTag (pacingRateTag);
+    }
 }
 /* Extract at most maxSize bytes from the TxBuffer at sequence seq, add the
     TCP header, and send to TcpL4Protocol */
@@ -2900,7 +2916,7 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
   uint8_t flags = withAck ? TcpHeader::ACK : 0;
   uint32_t remainingData = m_txBuffer->SizeFromSequence (seq + SequenceNumber32 (sz));
 
-  if (m_tcb->m_pacing)
+  if (m_tcb->m_pacing && !m_tcb->m_pacingByQueueDisc)
     {
       NS_LOG_INFO ("Pacing is enabled");
       if (m_pacingTimer.IsExpired ())
@@ -2968,6 +2984,15 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
   header.SetWindowSize (AdvertisedWindowSize ());
   AddOptions (header);
 
+  if (m_tcb->m_pacing && m_tcb->m_pacingByQueueDisc)
+    {
+      // The queue disc releases the IP packets of the socket at its pacing
+      // rate, headers included
+      uint32_t ipHeaderSize = m_endPoint ? Ipv4Header ().GetSerializedSize () : Ipv6Header ().GetSerializedSize ();
+      m_pacedUntil = Max (m_pacedUntil, Simulator::Now ())
+        + m_tcb->m_currentPacingRate.CalculateBytesTxTime (sz + header.GetSerializedSize () + ipHeaderSize);
+    }
+
   if (m_retxEvent.IsExpired ())
     {
       // Schedules retransmit timeout. m_rto should be already doubled.
@@ -2975,7 +3000,7 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
       NS_LOG_LOGIC (this << " SendDataPacket Schedule ReTxTimeout at time " <<
                     Simulator::Now ().GetSeconds () << " to expire at time " <<
                     (Simulator::Now () + m_rto.Get ()).GetSeconds () );
-      m_retxEvent = Simulator::Schedule (m_rto, &TcpSocketBase::ReTxTimeout, this);
+      m_retxEvent.Schedule (m_rto);
     }
 
   m_txTrace (p, header, this);
@@ -3066,7 +3091,7 @@ TcpSocketBase::SendPendingData (bool withAck)
   // else branch to control silly window syndrome and Nagle)
   while (availableWindow > 0)
     {
-      if (m_tcb->m_pacing)
+      if (m_tcb->m_pacing && !m_tcb->m_pacingByQueueDisc)
         {
           NS_LOG_INFO ("Pacing is enabled");
           if (m_pacingTimer.IsRunning ())
@@ -3076,6 +3101,20 @@ TcpSocketBase::SendPendingData (bool withAck)
             }
           NS_LOG_INFO ("Timer is not running");
         }
+      else if (m_tcb->m_pacing)
+        {
+          // As the TCP small queues of Linux, do not queue more than about
+          // 1 ms of packets in the queue disc which paces them, so that the
+          // flow is not dropped by the queue disc. The ACKs of the packets
+          // queued resume the transmission.
+          Time limit = Max (MilliSeconds (1),
+                            m_tcb->m_currentPacingRate.CalculateBytesTxTime (2 * m_tcb->m_segmentSize));
+          if (m_pacedUntil - Simulator::Now () > limit)
+            {
+              NS_LOG_INFO ("Skipping Packet due to the queue disc backlog " << m_pacedUntil - Simulator::Now ());
+              break;
+            }
+        }
 
       if (m_tcb->m_congState == TcpSocketState::CA_OPEN
           && m_state == TcpSocket::FIN_WAIT_1)
@@ -3157,7 +3196,7 @@ TcpSocketBase::SendPendingData (bool withAck)
                         " sent seq " << m_tcb->m_nextTxSequence <<
                         " size " << sz);
           ++nPacketsSent;
-          if (m_tcb->m_pacing)
+          if (m_tcb->m_pacing && !m_tcb->m_pacingByQueueDisc)
             {
               NS_LOG_INFO ("Pacing is enabled");
               if (m_pacingTimer.IsExpired ())
@@ -3356,10 +3395,9 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
       else if (m_delAckEvent.IsExpired ())
         {
           m_congestionControl->CwndEvent (m_tcb, TcpSocketState::CA_EVENT_DELAYED_ACK);
-          m_delAckEvent = Simulator::Schedule (m_delAckTimeout,
-                                               &TcpSocketBase::DelAckTimeout, this);
+          m_delAckEvent.Schedule (m_delAckTimeout);
           NS_LOG_LOGIC (this << " scheduled delayed ACK at " <<
-                        (Simulator::Now () + Simulator::GetDelayLeft (m_delAckEvent)).GetSeconds ());
+                        (Simulator::Now () + m_delAckEvent.GetDelayLeft ()).GetSeconds ());
         }
     }
 }
@@ -3433,9 +3471,8 @@ TcpSocketBase::NewAck (SequenceNumber32 const& ack, bool resetRTO)
 
   if (m_state != SYN_RCVD && resetRTO)
     { // Set RTO unless the ACK is received in SYN_RCVD state
-      NS_LOG_LOGIC (this << " Cancelled ReTxTimeout event which was set to expire at " <<
-                    (Simulator::Now () + Simulator::GetDelayLeft (m_retxEvent)).GetSeconds ());
-      m_retxEvent.Cancel ();
+      NS_LOG_LOGIC (this << " Rearm ReTxTimeout event which was set to expire at " <<
+                    (Simulator::Now () + m_retxEvent.GetDelayLeft ()).GetSeconds ());
       // On receiving a "New" ack we restart retransmission timer .. RFC 6298
       // RFC 6298, clause 2.4
       m_rto = Max (m_rtt->GetEstimate () + Max (m_clockGranularity, m_rtt->GetVariation () * 4), m_minRto);
@@ -3443,7 +3480,7 @@ TcpSocketBase::NewAck (SequenceNumber32 const& ack, bool resetRTO)
       NS_LOG_LOGIC (this << " Schedule ReTxTimeout at time " <<
                     Simulator::Now ().GetSeconds () << " to expire at time " <<
                     (Simulator::Now () + m_rto.Get ()).GetSeconds ());
-      m_retxEvent = Simulator::Schedule (m_rto, &TcpSocketBase::ReTxTimeout, this);
+      m_retxEvent.Schedule (m_rto);
     }
 
   // Note the highest ACK and tell app to send more
@@ -3461,7 +3498,7 @@ TcpSocketBase::NewAck (SequenceNumber32 const& ack, bool resetRTO)
   if (m_txBuffer->Size () == 0 && m_state != FIN_WAIT_1 && m_state != CLOSING)
     { // No retransmit timer if no data to retransmit
       NS_LOG_LOGIC (this << " Cancelled ReTxTimeout event which was set to expire at " <<
-                    (Simulator::Now () + Simulator::GetDelayLeft (m_retxEvent)).GetSeconds ());
+                    (Simulator::Now () + m_retxEvent.GetDelayLeft ()).GetSeconds ());
       m_retxEvent.Cancel ();
     }
 }
@@ -3702,7 +3739,7 @@ TcpSocketBase::PersistTimeout ()
   NS_LOG_LOGIC ("Schedule persist timeout at time "
                 << Simulator::Now ().GetSeconds () << " to expire at time "
                 << (Simulator::Now () + m_persistTimeout).GetSeconds ());
-  m_persistEvent = Simulator::Schedule (m_persistTimeout, &TcpSocketBase::PersistTimeout, this);
+  m_persistEvent.Schedule (m_persistTimeout);
 }
 
 void
@@ -3732,6 +3769,24 @@ TcpSocketBase::DoRetransmit ()
   NS_ASSERT (sz > 0);
 }
 
+void
+TcpSocketBase::SetupTimers (void)
+{
+  Ptr<TcpTimerWheel> wheel = m_tcp != 0 ? m_tcp->GetTimerWheel () : 0;
+  m_retxEvent.SetWheel (wheel);
+  m_retxEvent.SetFunction (MakeCallback (&TcpSocketBase::ReTxTimeout, this));
+  m_lastAckEvent.SetWheel (wheel);
+  m_lastAckEvent.SetFunction (MakeCallback (&TcpSocketBase::LastAckTimeout, this));
+  m_delAckEvent.SetWheel (wheel);
+  m_delAckEvent.SetFunction (MakeCallback (&TcpSocketBase::DelAckTimeout, this));
+  m_persistEvent.SetWheel (wheel);
+  m_persistEvent.SetFunction (MakeCallback (&TcpSocketBase::PersistTimeout, this));
+  m_timewaitEvent.SetWheel (wheel);
+  m_timewaitEvent.SetFunction (MakeCallback (&TcpSocketBase::CloseAndNotify, this));
+  m_pacingTimer.SetWheel (wheel);
+  m_pacingTimer.SetFunction (MakeCallback (&TcpSocketBase::NotifyPacingPerformed, this));
+}
+
 void
 TcpSocketBase::CancelAllTimers ()
 {
@@ -3761,8 +3816,7 @@ TcpSocketBase::TimeWait ()
     }
   // Move from TIME_WAIT to CLOSED after 2*MSL. Max segment lifetime is 2 min
   // according to RFC793, p.28
-  m_timewaitEvent = Simulator::Schedule (Seconds (2 * m_msl),
-                                         &TcpSocketBase::CloseAndNotify, this);
+  m_timewaitEvent.Schedule (Seconds (2 * m_msl));
 }
 
 /* Below are the attribute get/set functions */
@@ -32,6 +32,7 @@
 #include "ns3/data-rate.h"
 #include "ns3/node.h"
 #include "ns3/tcp-socket-state.h"
+#include "ns3/tcp-timer-wheel.h"
 
 namespace ns3 {
 
@@ -813,6 +814,12 @@ protected:
    */
   void DoPeerClose (void);
 
+  /**
+   * \brief Set the functions of the timers, and their wheel if the socket
+   * has a TcpL4Protocol
+   */
+  void SetupTimers (void);
+
   /**
    * \brief Cancel all timer when endpoint is deleted
    */
@@ -1169,12 +1176,12 @@ protected:
   void AddSocketTags (const Ptr<Packet> &p) const;
 
 protected:
-  // Counters and events
-  EventId           m_retxEvent     {}; //!< Retransmission event
-  EventId           m_lastAckEvent  {}; //!< Last ACK timeout event
-  EventId           m_delAckEvent   {}; //!< Delayed ACK timeout event
-  EventId           m_persistEvent  {}; //!< Persist event: Send 1 byte to probe for a non-zero Rx window
-  EventId           m_timewaitEvent {}; //!< TIME_WAIT expiration event: Move this socket to CLOSED state
+  // Counters and timers, kept in the TcpTimerWheel of the TcpL4Protocol
+  TcpTimer          m_retxEvent;     //!< Retransmission timer
+  TcpTimer          m_lastAckEvent;  //!< Last ACK timer
+  TcpTimer          m_delAckEvent;   //!< Delayed ACK timer
+  TcpTimer          m_persistEvent;  //!< Persist timer: Send 1 byte to probe for a non-zero Rx window
+  TcpTimer          m_timewaitEvent; //!< TIME_WAIT expiration timer: Move this socket to CLOSED state
 
   // ACK management
   uint32_t          m_dupAckCount {0};     //!< Dupack counter
@@ -1264,7 +1271,8 @@ protected:
                  Ptr<const TcpSocketBase> > m_rxTrace; //!< Trace of received packets
 
   // Pacing related variable
-  Timer m_pacingTimer {Timer::REMOVE_ON_DESTROY}; //!< Pacing Event
+  TcpTimer m_pacingTimer; //!< Pacing timer
+  Time m_pacedUntil {0};  //!< Time a pacing queue disc releases the last packet sent, if it paces them
 
   // Parameters related to Explicit Congestion Notification
   EcnMode_t                     m_ecnMode    {EcnMode_t::NoEcn};      //!< Socket ECN capability
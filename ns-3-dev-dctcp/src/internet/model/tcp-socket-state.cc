@@ -36,6 +36,13 @@ TcpSocketState::GetTypeId (void)
                    DataRateValue (DataRate ("4Gb/s")),
                    MakeDataRateAccessor (&TcpSocketState::m_maxPacingRate),
                    MakeDataRateChecker ())
+    .AddAttribute ("PacingByQueueDisc",
+                   "Leave the pacing of the packets to a queue disc of the outgoing "
+                   "device, such as FqPacingQueueDisc, rather than to the pacing timer "
+                   "of the socket. The packets carry the pacing rate in a SocketPacingRateTag",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpSocketState::m_pacingByQueueDisc),
+                   MakeBooleanChecker ())
     .AddTraceSource ("CongestionWindow",
                      "The TCP connection's congestion window",
                      MakeTraceSourceAccessor (&TcpSocketState::m_cWnd),
@@ -93,6 +100,7 @@ TcpSocketState::TcpSocketState (const TcpSocketState &other)
     m_pacing (other.m_pacing),
     m_maxPacingRate (other.m_maxPacingRate),
     m_currentPacingRate (other.m_currentPacingRate),
+    m_pacingByQueueDisc (other.m_pacingByQueueDisc),
     m_minRtt (other.m_minRtt),
     m_bytesInFlight (other.m_bytesInFlight),
     m_lastRtt (other.m_lastRtt)
@@ -149,6 +149,7 @@ public:
   bool                   m_pacing            {false}; //!< Pacing status
   DataRate               m_maxPacingRate     {0};    //!< Max Pacing rate
   DataRate               m_currentPacingRate {0};    //!< Current Pacing rate
+  bool                   m_pacingByQueueDisc {false}; //!< True if the queue disc paces the packets, not the pacing timer
 
   Time                   m_minRtt  {Time::Max ()};   //!< Minimum RTT observed throughout the connection
 
@@ -0,0 +1,382 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "tcp-timer-wheel.h"
+#include "ns3/simulator.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpTimerWheel");
+
+const uint32_t TcpTimerWheel::LEVEL_BITS;
+const uint32_t TcpTimerWheel::N_SLOTS;
+const uint32_t TcpTimerWheel::N_LEVELS;
+
+TcpTimerWheel::TcpTimerWheel ()
+  : m_now (0),
+    m_nTimers (0),
+    m_eventTime (0),
+    m_eventPending (false)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t level = 0; level < N_LEVELS; level++)
+    {
+      m_occupied[level] = 0;
+      for (uint32_t slot = 0; slot < N_SLOTS; slot++)
+        {
+          m_slots[level][slot].head = 0;
+          m_slots[level][slot].tail = 0;
+        }
+    }
+  m_expiring.head = 0;
+  m_expiring.tail = 0;
+}
+
+TcpTimerWheel::~TcpTimerWheel ()
+{
+  NS_LOG_FUNCTION (this);
+  // The armed timers keep a reference to the wheel
+  NS_ASSERT (m_nTimers == 0);
+  m_event.Cancel ();
+}
+
+uint32_t
+TcpTimerWheel::GetNTimers (void) const
+{
+  return m_nTimers;
+}
+
+void
+TcpTimerWheel::Insert (TcpTimer *timer)
+{
+  NS_LOG_FUNCTION (this << timer);
+  Advance (Simulator::Now ().GetTimeStep ());
+  Place (timer);
+  m_nTimers++;
+  if (!m_eventPending)
+    {
+      uint64_t deadline;
+      FindEarliest (deadline);
+      ScheduleEvent (deadline);
+    }
+  else if (timer->m_deadline < m_eventTime)
+    {
+      ScheduleEvent (timer->m_deadline);
+    }
+}
+
+void
+TcpTimerWheel::Remove (TcpTimer *timer)
+{
+  NS_LOG_FUNCTION (this << timer);
+  // The event of the wheel is left pending: it schedules the next deadline
+  // when it expires
+  Unlink (timer);
+  m_nTimers--;
+}
+
+void
+TcpTimerWheel::Place (TcpTimer *timer)
+{
+  uint64_t diff = timer->m_deadline ^ m_now;
+  uint32_t level = 0;
+  while (level + 1 < N_LEVELS && (diff >> ((level + 1) * LEVEL_BITS)) != 0)
+    {
+      level++;
+    }
+  uint32_t slot = (timer->m_deadline >> (level * LEVEL_BITS)) & (N_SLOTS - 1);
+  timer->m_level = level;
+  timer->m_slot = slot;
+  Append (m_slots[level][slot], timer);
+  m_occupied[level] |= static_cast<uint64_t> (1) << slot;
+}
+
+void
+TcpTimerWheel::Append (Slot &slot, TcpTimer *timer)
+{
+  timer->m_next = 0;
+  timer->m_prev = slot.tail;
+  if (slot.tail != 0)
+    {
+      slot.tail->m_next = timer;
+    }
+  else
+    {
+      slot.head = timer;
+    }
+  slot.tail = timer;
+}
+
+void
+TcpTimerWheel::Unlink (TcpTimer *timer)
+{
+  Slot &slot = timer->m_level < N_LEVELS ? m_slots[timer->m_level][timer->m_slot] : m_expiring;
+  if (timer->m_prev != 0)
+    {
+      timer->m_prev->m_next = timer->m_next;
+    }
+  else
+    {
+      slot.head = timer->m_next;
+    }
+  if (timer->m_next != 0)
+    {
+      timer->m_next->m_prev = timer->m_prev;
+    }
+  else
+    {
+      slot.tail = timer->m_prev;
+    }
+  if (slot.head == 0 && timer->m_level < N_LEVELS)
+    {
+      m_occupied[timer->m_level] &= ~(static_cast<uint64_t> (1) << timer->m_slot);
+    }
+  timer->m_prev = 0;
+  timer->m_next = 0;
+}
+
+void
+TcpTimerWheel::Advance (uint64_t now)
+{
+  if (now == m_now)
+    {
+      return;
+    }
+  Slot moved;
+  moved.head = 0;
+  moved.tail = 0;
+  if (now < m_now)
+    {
+      // The simulator was destroyed and time restarted: place all the timers
+      // again
+      NS_LOG_LOGIC ("Time went back from " << m_now << " to " << now);
+      for (uint32_t level = 0; level < N_LEVELS; level++)
+        {
+          for (uint32_t slot = 0; slot < N_SLOTS; slot++)
+            {
+              while (m_slots[level][slot].head != 0)
+                {
+                  TcpTimer *timer = m_slots[level][slot].head;
+                  Unlink (timer);
+                  Append (moved, timer);
+                }
+            }
+        }
+      m_eventPending = false;
+    }
+  else
+    {
+      // At each level, the timers of the slot reached share the higher bits
+      // of their deadline with the new time, and belong to lower levels
+      for (uint32_t level = 1; level < N_LEVELS; level++)
+        {
+          uint32_t shift = level * LEVEL_BITS;
+          if ((now >> shift) == (m_now >> shift))
+            {
+              break;
+            }
+          uint32_t slot = (now >> shift) & (N_SLOTS - 1);
+          while (m_slots[level][slot].head != 0)
+            {
+              TcpTimer *timer = m_slots[level][slot].head;
+              NS_ASSERT (timer->m_deadline >= now);
+              Unlink (timer);
+              Append (moved, timer);
+            }
+        }
+    }
+  m_now = now;
+  while (moved.head != 0)
+    {
+      TcpTimer *timer = moved.head;
+      moved.head = timer->m_next;
+      Place (timer);
+    }
+}
+
+bool
+TcpTimerWheel::FindEarliest (uint64_t &deadline) const
+{
+  for (uint32_t level = 0; level < N_LEVELS; level++)
+    {
+      uint64_t occupied = m_occupied[level];
+      if (occupied == 0)
+        {
+          continue;
+        }
+      // The timers of a level differ from the time of the wheel in the
+      // bits of the level only, so the first slot is the earliest one
+      uint32_t slot = 0;
+      while ((occupied & 1) == 0)
+        {
+          occupied >>= 1;
+          slot++;
+        }
+      if (level == 0)
+        {
+          deadline = (m_now & ~static_cast<uint64_t> (N_SLOTS - 1)) | slot;
+          return true;
+        }
+      const TcpTimer *timer = m_slots[level][slot].head;
+      deadline = timer->m_deadline;
+      for (timer = timer->m_next; timer != 0; timer = timer->m_next)
+        {
+          deadline = std::min (deadline, timer->m_deadline);
+        }
+      return true;
+    }
+  return false;
+}
+
+void
+TcpTimerWheel::ScheduleEvent (uint64_t deadline)
+{
+  NS_LOG_FUNCTION (this << deadline);
+  m_event.Cancel ();
+  m_eventTime = deadline;
+  m_eventPending = true;
+  m_event = Simulator::Schedule (TimeStep (deadline) - Simulator::Now (), &TcpTimerWheel::Expire, this);
+}
+
+void
+TcpTimerWheel::Expire (void)
+{
+  NS_LOG_FUNCTION (this);
+  // The timers, or the wheel, may be destroyed by the functions called
+  Ptr<TcpTimerWheel> self = this;
+  uint64_t now = Simulator::Now ().GetTimeStep ();
+  Advance (now);
+
+  // The timers which expire now are in the slot of the first level given by
+  // the current time.  They are moved to m_expiring, so that the functions
+  // called may cancel them.  The event stays pending meanwhile, so that the
+  // timers armed again are only scheduled once they are all expired.
+  Slot &slot = m_slots[0][now & (N_SLOTS - 1)];
+  while (slot.head != 0)
+    {
+      TcpTimer *timer = slot.head;
+      Unlink (timer);
+      timer->m_level = N_LEVELS;
+      Append (m_expiring, timer);
+    }
+  while (m_expiring.head != 0)
+    {
+      TcpTimer *timer = m_expiring.head;
+      NS_ASSERT (timer->m_deadline == now);
+      Unlink (timer);
+      m_nTimers--;
+      timer->m_running = false;
+      Callback<void> expire = timer->m_expire;
+      expire ();
+    }
+
+  m_eventPending = false;
+  uint64_t deadline;
+  if (FindEarliest (deadline))
+    {
+      ScheduleEvent (deadline);
+    }
+}
+
+TcpTimer::TcpTimer ()
+  : m_deadline (0),
+    m_running (false),
+    m_level (0),
+    m_slot (0),
+    m_prev (0),
+    m_next (0)
+{
+}
+
+TcpTimer::~TcpTimer ()
+{
+  Cancel ();
+}
+
+void
+TcpTimer::SetWheel (Ptr<TcpTimerWheel> wheel)
+{
+  NS_ASSERT (!m_running);
+  m_wheel = wheel;
+}
+
+void
+TcpTimer::SetFunction (Callback<void> function)
+{
+  m_function = function;
+}
+
+void
+TcpTimer::Schedule (Time delay)
+{
+  NS_ASSERT (!m_function.IsNull ());
+  Schedule (delay, m_function);
+}
+
+void
+TcpTimer::Schedule (Time delay, Callback<void> function)
+{
+  NS_ASSERT (delay.IsPositive ());
+  if (m_wheel == 0)
+    {
+      m_wheel = Create<TcpTimerWheel> ();
+    }
+  if (m_running)
+    {
+      m_wheel->Remove (this);
+    }
+  m_expire = function;
+  m_deadline = (Simulator::Now () + delay).GetTimeStep ();
+  m_running = true;
+  m_wheel->Insert (this);
+}
+
+void
+TcpTimer::Cancel (void)
+{
+  if (m_running)
+    {
+      m_wheel->Remove (this);
+      m_running = false;
+    }
+}
+
+bool
+TcpTimer::IsRunning (void) const
+{
+  return m_running;
+}
+
+bool
+TcpTimer::IsExpired (void) const
+{
+  return !m_running;
+}
+
+Time
+TcpTimer::GetDelayLeft (void) const
+{
+  if (!m_running)
+    {
+      return Seconds (0);
+    }
+  return TimeStep (m_deadline) - Simulator::Now ();
+}
+
+} // namespace ns3
@@ -0,0 +1,243 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_TIMER_WHEEL_H
+#define TCP_TIMER_WHEEL_H
+
+#include <stdint.h>
+#include "ns3/simple-ref-count.h"
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+class TcpTimer;
+
+/**
+ * \ingroup tcp
+ *
+ * \brief Hierarchical timing wheel holding the timers of the TCP sockets
+ * of a node
+ *
+ * The sockets re-arm their retransmission timer on almost every ACK, and
+ * most of these timers never expire.  Rather than scheduling and
+ * cancelling an event in the Simulator every time, the TcpTimer of the
+ * sockets are kept in this wheel, and only the earliest deadline of the
+ * wheel is scheduled in the Simulator.  Arming or cancelling a timer is a
+ * constant time operation on the wheel, and the event of the wheel is
+ * only rescheduled when a timer is armed before it: an event which finds
+ * no timer to expire, because the timers were re-armed later or
+ * cancelled, just schedules the next deadline.
+ *
+ * The deadlines are in time steps (see Time::GetTimeStep), so that the
+ * timers expire at the exact time they were armed for.  The wheel has
+ * N_LEVELS levels of N_SLOTS slots: a timer is kept at the level of the
+ * most significant group of LEVEL_BITS bits in which its deadline differs
+ * from the current time of the wheel, and in the slot given by these bits.
+ * The timers of a slot are moved to the lower levels when the time of the
+ * wheel reaches the slot.
+ */
+class TcpTimerWheel : public SimpleRefCount<TcpTimerWheel>
+{
+public:
+  TcpTimerWheel ();
+  ~TcpTimerWheel ();
+
+  /**
+   * \returns the number of armed timers
+   */
+  uint32_t GetNTimers (void) const;
+
+private:
+  friend class TcpTimer;
+
+  /**
+   * \brief Copy constructor, not implemented
+   * \param o the object to copy
+   */
+  TcpTimerWheel (const TcpTimerWheel &o);
+  /**
+   * \brief Assignment, not implemented
+   * \param o the object to copy
+   * \returns this object
+   */
+  TcpTimerWheel &operator = (const TcpTimerWheel &o);
+
+  static const uint32_t LEVEL_BITS = 6;                 //!< Bits of the deadlines per level
+  static const uint32_t N_SLOTS = 1 << LEVEL_BITS;      //!< Number of slots per level
+  static const uint32_t N_LEVELS = (64 + LEVEL_BITS - 1) / LEVEL_BITS; //!< Number of levels
+
+  /// A list of timers
+  struct Slot
+  {
+    TcpTimer *head; //!< first timer
+    TcpTimer *tail; //!< last timer
+  };
+
+  /**
+   * \brief Add an armed timer to the wheel, and schedule the event of the
+   * wheel if the timer expires before it
+   * \param timer the timer, whose deadline is set
+   */
+  void Insert (TcpTimer *timer);
+  /**
+   * \brief Remove an armed timer from the wheel
+   * \param timer the timer
+   */
+  void Remove (TcpTimer *timer);
+  /**
+   * \brief Add a timer at its place, relative to the time of the wheel
+   * \param timer the timer
+   */
+  void Place (TcpTimer *timer);
+  /**
+   * \brief Append a timer to a list
+   * \param slot the list
+   * \param timer the timer
+   */
+  static void Append (Slot &slot, TcpTimer *timer);
+  /**
+   * \brief Remove a timer from its list
+   * \param timer the timer
+   */
+  void Unlink (TcpTimer *timer);
+  /**
+   * \brief Move the time of the wheel, moving the timers of the slots
+   * reached to the lower levels
+   * \param now the new time, not later than any deadline
+   */
+  void Advance (uint64_t now);
+  /**
+   * \brief Find the earliest deadline
+   * \param deadline the earliest deadline, if any
+   * \returns false if no timer is armed
+   */
+  bool FindEarliest (uint64_t &deadline) const;
+  /**
+   * \brief Schedule the event of the wheel at a deadline
+   * \param deadline the deadline
+   */
+  void ScheduleEvent (uint64_t deadline);
+  /**
+   * \brief Expire the timers whose deadline is reached, and schedule the
+   * event of the wheel at the next deadline
+   */
+  void Expire (void);
+
+  Slot m_slots[N_LEVELS][N_SLOTS]; //!< the timers, by level and slot
+  uint64_t m_occupied[N_LEVELS];   //!< bitmap of the non-empty slots of each level
+  Slot m_expiring;                 //!< the timers being expired
+  uint64_t m_now;                  //!< the time of the wheel, in time steps
+  uint32_t m_nTimers;              //!< the number of armed timers
+  EventId m_event;                 //!< the event of the wheel
+  uint64_t m_eventTime;            //!< the time of the event, if pending
+  bool m_eventPending;             //!< true if the event is pending
+};
+
+/**
+ * \ingroup tcp
+ *
+ * \brief A TCP timer, kept in a TcpTimerWheel
+ *
+ * The interface follows the one of EventId and Timer: the timer calls its
+ * function when the delay it was scheduled for elapses, unless it was
+ * cancelled or scheduled again before.  The timer is removed from the
+ * wheel when it is destroyed, so that the function of an object is not
+ * called once the object is destroyed.
+ *
+ * A timer without wheel uses a wheel of its own.
+ */
+class TcpTimer
+{
+public:
+  TcpTimer ();
+  ~TcpTimer ();
+
+  /**
+   * \brief Set the wheel of the timer, which must not be running
+   * \param wheel the wheel
+   */
+  void SetWheel (Ptr<TcpTimerWheel> wheel);
+  /**
+   * \brief Set the function called by the timer when scheduled with
+   * Schedule (Time)
+   * \param function the function
+   */
+  void SetFunction (Callback<void> function);
+
+  /**
+   * \brief Arm the timer, replacing the previous deadline if it is
+   * running, to call the function of the timer
+   * \param delay the delay after which the function is called
+   */
+  void Schedule (Time delay);
+  /**
+   * \brief Arm the timer, replacing the previous deadline if it is
+   * running, to call a function
+   * \param delay the delay after which the function is called
+   * \param function the function called once, instead of the function
+   * of the timer
+   */
+  void Schedule (Time delay, Callback<void> function);
+  /**
+   * \brief Disarm the timer, if running
+   */
+  void Cancel (void);
+
+  /**
+   * \returns true if the timer is armed
+   */
+  bool IsRunning (void) const;
+  /**
+   * \returns true if the timer is not armed
+   */
+  bool IsExpired (void) const;
+  /**
+   * \returns the delay until the timer expires, or zero if it is not armed
+   */
+  Time GetDelayLeft (void) const;
+
+private:
+  friend class TcpTimerWheel;
+
+  /**
+   * \brief Copy constructor, not implemented
+   * \param o the object to copy
+   */
+  TcpTimer (const TcpTimer &o);
+  /**
+   * \brief Assignment, not implemented
+   * \param o the object to copy
+   * \returns this object
+   */
+  TcpTimer &operator = (const TcpTimer &o);
+
+  Ptr<TcpTimerWheel> m_wheel;   //!< the wheel
+  Callback<void> m_function;    //!< the function of the timer
+  Callback<void> m_expire;      //!< the function called when the timer expires
+  uint64_t m_deadline;          //!< the deadline, in time steps
+  bool m_running;               //!< true if the timer is armed
+  uint8_t m_level;              //!< the level of the timer in the wheel
+  uint8_t m_slot;               //!< the slot of the timer in its level
+  TcpTimer *m_prev;             //!< the previous timer of the slot
+  TcpTimer *m_next;             //!< the next timer of the slot
+};
+
+} // namespace ns3
+
+#endif /* TCP_TIMER_WHEEL_H */
@@ -96,22 +96,21 @@ TcpTxBuffer::GetTypeId (void)
  * initialized below is insignificant.
  */
 TcpTxBuffer::TcpTxBuffer (uint32_t n)
-  : m_maxBuffer (32768), m_size (0), m_sentSize (0), m_firstByteSeq (n)
+  : m_maxBuffer (32768), m_size (0), m_sentSize (0), m_firstByteSeq (n),
+    m_lostHint (n), m_lostEnd (n), m_retxHint (n), m_rule3Hint (n)
 {
 }
 
 TcpTxBuffer::~TcpTxBuffer (void)
 {
-  PacketList::iterator it;
-
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  for (SentList::iterator it = m_sentList.begin (); it != m_sentList.end (); ++it)
     {
-      TcpTxItem *item = *it;
+      TcpTxItem *item = it->second;
       m_sentSize -= item->m_packet->GetSize ();
       delete item;
     }
 
-  for (it = m_appList.begin (); it != m_appList.end (); ++it)
+  for (PacketList::iterator it = m_appList.begin (); it != m_appList.end (); ++it)
     {
       TcpTxItem *item = *it;
       m_size -= item->m_packet->GetSize ();
@@ -161,14 +160,13 @@ TcpTxBuffer::SetHeadSequence (const SequenceNumber32& seq)
   NS_LOG_FUNCTION (this << seq);
   m_firstByteSeq = seq;
 
-  if (m_sentList.size () > 0)
-    {
-      m_sentList.front ()->m_startSeq = seq;
-    }
-
   // if you change the head with data already sent, something bad will happen
   NS_ASSERT (m_sentList.size () == 0);
   m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_lostHint = seq;
+  m_lostEnd = seq;
+  m_retxHint = seq;
+  m_rule3Hint = seq;
 }
 
 bool
@@ -294,7 +292,7 @@ TcpTxBuffer::GetNewSegment (uint32_t numBytes)
   NS_ASSERT (it != m_appList.end ());
 
   m_appList.erase (it);
-  m_sentList.insert (m_sentList.end (), item);
+  m_sentList.insert (m_sentList.end (), std::make_pair (item->m_startSeq, item));
   m_sentSize += item->m_packet->GetSize ();
 
   return item;
@@ -308,40 +306,34 @@ TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &s
   NS_ASSERT (numBytes <= m_sentSize);
   NS_ASSERT (m_sentList.size () >= 1);
 
-  auto it = m_sentList.begin ();
-  bool listEdited = false;
   uint32_t s = numBytes;
 
   // Avoid to merge different packet for this retransmission if flags are
   // different.
-  for (; it != m_sentList.end(); ++it)
+  SentList::iterator it = m_sentList.find (seq);
+  if (it != m_sentList.end ())
     {
-      if ((*it)->m_startSeq == seq)
+      SentList::iterator next = std::next (it);
+      if (next != m_sentList.end ())
         {
-          auto next = it;
-          next++;
-          if (next != m_sentList.end ())
+          // Next is not sacked... there is the possibility to merge
+          if (! next->second->m_sacked)
             {
-              // Next is not sacked... there is the possibility to merge
-              if (! (*next)->m_sacked)
-                {
-                  s = std::min(s, (*it)->m_packet->GetSize () + (*next)->m_packet->GetSize ());
-                }
-              else
-                {
-                  // Next is sacked... better to retransmit only the first segment
-                  s = std::min(s, (*it)->m_packet->GetSize ());
-                }
+              s = std::min(s, it->second->m_packet->GetSize () + next->second->m_packet->GetSize ());
             }
           else
             {
-              s = std::min(s, (*it)->m_packet->GetSize ());
+              // Next is sacked... better to retransmit only the first segment
+              s = std::min(s, it->second->m_packet->GetSize ());
             }
-          break;
+        }
+      else
+        {
+          s = std::min(s, it->second->m_packet->GetSize ());
         }
     }
 
-  TcpTxItem *item = GetPacketFromList (m_sentList, m_firstByteSeq, s, seq, &listEdited);
+  TcpTxItem *item = GetPacketFromSentList (s, seq);
 
   if (! item->m_retrans)
     {
@@ -352,26 +344,20 @@ TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &s
   return item;
 }
 
-std::pair <TcpTxBuffer::PacketList::const_iterator, SequenceNumber32>
+std::pair <TcpTxBuffer::SentList::const_iterator, SequenceNumber32>
 TcpTxBuffer::FindHighestSacked () const
 {
   NS_LOG_FUNCTION (this);
 
-  SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-
-  auto ret = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
-
-  for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  for (auto it = m_sentList.rbegin (); it != m_sentList.rend (); ++it)
     {
-      const TcpTxItem *item = *it;
-      if (item->m_sacked)
+      if (it->second->m_sacked)
         {
-          ret = std::make_pair (it, beginOfCurrentPacket);
+          return std::make_pair (std::prev (it.base ()), it->first);
         }
-      beginOfCurrentPacket += item->m_packet->GetSize ();
     }
 
-  return ret;
+  return std::make_pair (m_sentList.end (), SequenceNumber32 (0));
 }
 
 
@@ -439,9 +425,6 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
     {
       currentItem = *it;
       currentPacket = currentItem->m_packet;
-      NS_ASSERT_MSG (list != m_sentList || currentItem->m_startSeq >= m_firstByteSeq,
-                     "start: " << m_firstByteSeq << " currentItem start: " <<
-                     currentItem->m_startSeq);
 
       // The objective of this snippet is to find (or to create) the packet
       // that begin with the sequence seq
@@ -580,6 +563,121 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
   NS_FATAL_ERROR ("This point is not reachable");
 }
 
+TcpTxItem*
+TcpTxBuffer::GetPacketFromSentList (uint32_t numBytes, const SequenceNumber32 &seq)
+{
+  NS_LOG_FUNCTION (this << numBytes << seq);
+
+  // Find the item which contains seq
+  SentList::iterator it = m_sentList.upper_bound (seq);
+  NS_ASSERT (it != m_sentList.begin ());
+  --it;
+  NS_ASSERT_MSG (it->second->m_startSeq >= m_firstByteSeq,
+                 "start: " << m_firstByteSeq << " item start: " <<
+                 it->second->m_startSeq);
+
+  if (it->first < seq)
+    {
+      // seq is in the middle of the item: fragment its beginning
+      NS_LOG_INFO ("Item " << *(it->second) << " contains " << seq << ", fragmenting");
+      it = SplitSentItem (it, seq - it->first);
+    }
+
+  TcpTxItem *outItem = it->second;
+  NS_ASSERT (outItem->m_startSeq == seq);
+
+  // Merge the following items until the requested block is covered
+  while (outItem->m_packet->GetSize () < numBytes)
+    {
+      if (std::next (it) == m_sentList.end ())
+        {
+          // The current item is the last one we sent. We have not more data;
+          // Go for this one.
+          NS_LOG_WARN ("Cannot reach the end, but this case is covered "
+                       "with conditional statements inside CopyFromSequence."
+                       "Something has gone wrong, report a bug");
+          return outItem;
+        }
+      MergeSentItems (it);
+    }
+
+  if (outItem->m_packet->GetSize () > numBytes)
+    {
+      // the end is inside the item: fragment it
+      SplitSentItem (it, numBytes);
+      outItem = it->second;
+    }
+
+  return outItem;
+}
+
+TcpTxBuffer::SentList::iterator
+TcpTxBuffer::SplitSentItem (SentList::iterator it, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << *(it->second) << size);
+
+  TcpTxItem *firstPart = new TcpTxItem ();
+  TcpTxItem *secondPart = it->second;
+  SplitItems (firstPart, secondPart, size);
+
+  // The first part keeps the position (and the key) of the original item
+  it->second = firstPart;
+  return m_sentList.insert (std::next (it), std::make_pair (secondPart->m_startSeq, secondPart));
+}
+
+void
+TcpTxBuffer::MergeSentItems (SentList::iterator it)
+{
+  NS_LOG_FUNCTION (this << *(it->second));
+
+  SentList::iterator next = std::next (it);
+  NS_ASSERT (next != m_sentList.end ());
+
+  bool retrans = it->second->m_retrans || next->second->m_retrans;
+  MergeItems (it->second, next->second);
+  if (retrans && !it->second->m_retrans)
+    {
+      LowerRetxHint (it->first);
+    }
+
+  if (m_highestSack.first == next)
+    {
+      m_highestSack = std::make_pair (it, it->first);
+    }
+
+  delete next->second;
+  m_sentList.erase (next);
+}
+
+void
+TcpTxBuffer::LowerRetxHint (const SequenceNumber32 &seq) const
+{
+  if (seq < m_retxHint)
+    {
+      m_retxHint = seq;
+    }
+  if (seq < m_rule3Hint)
+    {
+      m_rule3Hint = seq;
+    }
+}
+
+void
+TcpTxBuffer::MarkLost (SentList::const_iterator it)
+{
+  TcpTxItem *item = it->second;
+  NS_ASSERT (!item->m_lost);
+  item->m_lost = true;
+  m_lostOut += item->m_packet->GetSize ();
+
+  SequenceNumber32 end = it->first + item->m_packet->GetSize ();
+  if (m_lostEnd < end)
+    {
+      m_lostEnd = end;
+    }
+  LowerRetxHint (it->first);
+}
+
 static bool AreEquals (const bool &first, const bool &second)
 {
   return first ? second : !second;
@@ -665,7 +763,7 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
   // Scan the buffer and discard packets
   uint32_t offset = seq - m_firstByteSeq.Get ();  // Number of bytes to remove
   uint32_t pktSize;
-  PacketList::iterator i = m_sentList.begin ();
+  SentList::iterator i = m_sentList.begin ();
   while (m_size > 0 && offset > 0)
     {
       if (i == m_sentList.end ())
@@ -677,7 +775,7 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
           i = m_sentList.begin ();
           NS_ASSERT (i != m_sentList.end ());
         }
-      TcpTxItem *item = *i;
+      TcpTxItem *item = i->second;
       Ptr<Packet> p = item->m_packet;
       pktSize = p->GetSize ();
       NS_ASSERT_MSG (item->m_startSeq == m_firstByteSeq,
@@ -706,6 +804,9 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
           // PacketTags are preserved when fragmenting
           item->m_packet = item->m_packet->CreateFragment (offset, pktSize);
           item->m_startSeq += offset;
+          // index the item with its new starting sequence
+          m_sentList.erase (i);
+          m_sentList.insert (m_sentList.begin (), std::make_pair (item->m_startSeq, item));
           m_size -= offset;
           m_sentSize -= offset;
           m_firstByteSeq += offset;
@@ -726,7 +827,7 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
 
   if (!m_sentList.empty ())
     {
-      TcpTxItem *head = m_sentList.front ();
+      TcpTxItem *head = m_sentList.begin ()->second;
       if (head->m_sacked)
         {
           NS_ASSERT (!head->m_lost);
@@ -736,8 +837,8 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
           head->m_sacked = false;
           m_sackedOut -= head->m_packet->GetSize ();
           NS_LOG_INFO ("Moving the SACK flag from the HEAD to another segment");
-          AddRenoSack ();
           MarkHeadAsLost ();
+          AddRenoSack ();
         }
 
       NS_ASSERT_MSG (head->m_startSeq == seq,
@@ -749,6 +850,22 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
     {
       m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
     }
+  if (m_lostHint < m_firstByteSeq)
+    {
+      m_lostHint = m_firstByteSeq;
+    }
+  if (m_lostEnd < m_firstByteSeq)
+    {
+      m_lostEnd = m_firstByteSeq;
+    }
+  if (m_retxHint < m_firstByteSeq)
+    {
+      m_retxHint = m_firstByteSeq;
+    }
+  if (m_rule3Hint < m_firstByteSeq)
+    {
+      m_rule3Hint = m_firstByteSeq;
+    }
 
   NS_LOG_DEBUG ("Discarded up to " << seq << " lost: " << m_lostOut <<
                 " retrans: " << m_retrans << " sacked: " << m_sackedOut);
@@ -768,44 +885,45 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list)
 
   for (auto option_it = list.begin (); option_it != list.end (); ++option_it)
     {
-      PacketList::iterator item_it = m_sentList.begin ();
-      SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-
       if (m_firstByteSeq + m_sentSize < (*option_it).first && !modified)
         {
           NS_LOG_INFO ("Not updating scoreboard, the option block is outside the sent list");
           return false;
         }
 
+      // Start from the first item which begins inside the block
+      SentList::iterator item_it = m_sentList.lower_bound ((*option_it).first);
+
       while (item_it != m_sentList.end ())
         {
-          uint32_t pktSize = (*item_it)->m_packet->GetSize ();
+          TcpTxItem *item = item_it->second;
+          SequenceNumber32 beginOfCurrentPacket = item_it->first;
+          uint32_t pktSize = item->m_packet->GetSize ();
 
           // Check the boundary of this packet ... only mark as sacked if
           // it is precisely mapped over the option. It means that if the receiver
           // is reporting as sacked single range bytes that are not mapped 1:1
           // in what we have, the option is discarded. There's room for improvement
           // here.
-          if (beginOfCurrentPacket >= (*option_it).first
-              && beginOfCurrentPacket + pktSize <= (*option_it).second)
+          if (beginOfCurrentPacket + pktSize <= (*option_it).second)
             {
-              if ((*item_it)->m_sacked)
+              if (item->m_sacked)
                 {
-                  NS_ASSERT (!(*item_it)->m_lost);
+                  NS_ASSERT (!item->m_lost);
                   NS_LOG_INFO ("Received block " << *option_it <<
-                               ", checking sentList for block " << *(*item_it) <<
+                               ", checking sentList for block " << *item <<
                                ", found in the sackboard already sacked");
                 }
               else
                 {
-                  if ((*item_it)->m_lost)
+                  if (item->m_lost)
                     {
-                      (*item_it)->m_lost = false;
-                      m_lostOut -= (*item_it)->m_packet->GetSize ();
+                      item->m_lost = false;
+                      m_lostOut -= item->m_packet->GetSize ();
                     }
 
-                  (*item_it)->m_sacked = true;
-                  m_sackedOut += (*item_it)->m_packet->GetSize ();
+                  item->m_sacked = true;
+                  m_sackedOut += item->m_packet->GetSize ();
 
                   if (m_highestSack.first == m_sentList.end()
                       || m_highestSack.second <= beginOfCurrentPacket + pktSize)
@@ -814,22 +932,21 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list)
                     }
 
                   NS_LOG_INFO ("Received block " << *option_it <<
-                               ", checking sentList for block " << *(*item_it) <<
+                               ", checking sentList for block " << *item <<
                                ", found in the sackboard, sacking, current highSack: " <<
                                m_highestSack.second);
                 }
               modified = true;
             }
-          else if (beginOfCurrentPacket + pktSize > (*option_it).second)
+          else
             {
               // We already passed the received block end. Exit from the loop
               NS_LOG_INFO ("Received block [" << *option_it <<
-                           ", checking sentList for block " << *(*item_it) <<
+                           ", checking sentList for block " << *item <<
                            "], not found, breaking loop");
               break;
             }
 
-          beginOfCurrentPacket += pktSize;
           ++item_it;
         }
     }
@@ -840,7 +957,7 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list)
       UpdateLostCount ();
     }
 
-  NS_ASSERT ((*(m_sentList.begin ()))->m_sacked == false);
+  NS_ASSERT (m_sentList.begin ()->second->m_sacked == false);
   NS_ASSERT_MSG (m_sentSize >= m_sackedOut + m_lostOut, *this);
   //NS_ASSERT (list.size () == 0 || modified);   // Assert for duplicated SACK or
                                                  // impossiblity to map the option into the sent blocks
@@ -853,7 +970,7 @@ TcpTxBuffer::UpdateLostCount ()
 {
   NS_LOG_FUNCTION (this);
   uint32_t sacked = 0;
-  SequenceNumber32 beginOfCurrentPacket = m_highestSack.second;
+  SequenceNumber32 lostUpTo;
   if (m_highestSack.first == m_sentList.end ())
     {
       NS_LOG_INFO ("Status before the update: " << *this <<
@@ -862,35 +979,45 @@ TcpTxBuffer::UpdateLostCount ()
   else
     {
       NS_LOG_INFO ("Status before the update: " << *this <<
-                   ", will start from item " << *(*m_highestSack.first));
+                   ", will start from item " << *(m_highestSack.first->second));
     }
 
   for (auto it = m_highestSack.first; it != m_sentList.begin(); --it)
     {
-      TcpTxItem *item = *it;
+      TcpTxItem *item = it->second;
+      if (sacked >= m_dupAckThresh && it->first < m_lostHint)
+        {
+          // The items before the hint are already lost or sacked
+          break;
+        }
+
       if (item->m_sacked)
         {
           sacked++;
+          if (sacked == m_dupAckThresh)
+            {
+              lostUpTo = it->first;
+            }
         }
 
       if (sacked >= m_dupAckThresh)
         {
           if (!item->m_sacked && !item->m_lost)
             {
-              item->m_lost = true;
-              m_lostOut += item->m_packet->GetSize ();
+              MarkLost (it);
             }
         }
-      beginOfCurrentPacket -= item->m_packet->GetSize ();
     }
 
   if (sacked >= m_dupAckThresh)
     {
-      TcpTxItem *item = *m_sentList.begin ();
-      if (!item->m_lost)
+      if (!m_sentList.begin ()->second->m_lost)
         {
-          item->m_lost = true;
-          m_lostOut += item->m_packet->GetSize ();
+          MarkLost (m_sentList.begin ());
+        }
+      if (m_lostHint < lostUpTo)
+        {
+          m_lostHint = lostUpTo;
         }
     }
   NS_LOG_INFO ("Status after the update: " << *this);
@@ -902,35 +1029,24 @@ TcpTxBuffer::IsLost (const SequenceNumber32 &seq) const
 {
   NS_LOG_FUNCTION (this << seq);
 
-  SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-  PacketList::const_iterator it;
-
   if (seq >= m_highestSack.second)
     {
       return false;
     }
 
-  // In theory, using a map and hints when inserting elements can improve
-  // performance
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  for (SentList::const_iterator it = m_sentList.lower_bound (seq); it != m_sentList.end (); ++it)
     {
-      // Search for the right iterator before calling IsLost()
-      if (beginOfCurrentPacket >= seq)
+      if (it->second->m_lost == true)
         {
-          if ((*it)->m_lost == true)
-            {
-              NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
-              return true;
-            }
-
-          if ((*it)->m_sacked == true)
-            {
-              NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
-              return false;
-            }
+          NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
+          return true;
         }
 
-      beginOfCurrentPacket += (*it)->m_packet->GetSize ();
+      if (it->second->m_sacked == true)
+        {
+          NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
+          return false;
+        }
     }
 
   return false;
@@ -954,36 +1070,34 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, bool isRecovery) const
    *
    *     (1.c) IsLost (S2) returns true.
    */
-  PacketList::const_iterator it;
+  SentList::const_iterator it;
   TcpTxItem *item;
   SequenceNumber32 seqPerRule3;
   bool isSeqPerRule3Valid = false;
-  SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq;
 
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  // Start from the item containing the retransmission hint, as the previous
+  // ones do not meet the criteria
+  it = m_sentList.upper_bound (m_retxHint);
+  if (it != m_sentList.begin ())
     {
-      item = *it;
+      --it;
+    }
+
+  // Lost items do not go beyond m_lostEnd
+  for (; it != m_sentList.end () && it->first < m_lostEnd; ++it)
+    {
+      item = it->second;
 
       // Condition 1.a , 1.b , and 1.c
-      if (item->m_retrans == false && item->m_sacked == false)
+      if (item->m_retrans == false && item->m_sacked == false && item->m_lost)
         {
-          if (item->m_lost)
-            {
-              NS_LOG_INFO("IsLost, returning" << beginOfCurrentPkt);
-              *seq = beginOfCurrentPkt;
-              return true;
-            }
-          else if (seqPerRule3.GetValue () == 0 && isRecovery)
-            {
-              NS_LOG_INFO ("Saving for rule 3 the seq " << beginOfCurrentPkt);
-              isSeqPerRule3Valid = true;
-              seqPerRule3 = beginOfCurrentPkt;
-            }
+          NS_LOG_INFO("IsLost, returning" << it->first);
+          m_retxHint = it->first;
+          *seq = it->first;
+          return true;
         }
-
-      // Nothing found, iterate
-      beginOfCurrentPkt += item->m_packet->GetSize ();
     }
+  m_retxHint = m_firstByteSeq + m_sentSize;
 
   /* (2) If no sequence number 'S2' per rule (1) exists but there
    *     exists available unsent data and the receiver's advertised
@@ -1007,7 +1121,43 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, bool isRecovery) const
    *     detecting loss given in steps (1.a) and (1.b) above
    *     (specifically excluding step (1.c)), then one segment of up to
    *     SMSS octets starting with S3 SHOULD be returned.
+   *
+   * Since rule (1) failed, none of the unsacked, not retransmitted items is
+   * lost.
    */
+  if (isRecovery)
+    {
+      it = m_sentList.upper_bound (m_rule3Hint);
+      if (it != m_sentList.begin ())
+        {
+          --it;
+        }
+
+      for (; it != m_sentList.end (); ++it)
+        {
+          item = it->second;
+
+          if (item->m_retrans == false && item->m_sacked == false)
+            {
+              NS_LOG_INFO ("Saving for rule 3 the seq " << it->first);
+              if (!isSeqPerRule3Valid)
+                {
+                  m_rule3Hint = it->first;
+                }
+              isSeqPerRule3Valid = true;
+              seqPerRule3 = it->first;
+              if (seqPerRule3.GetValue () != 0)
+                {
+                  break;
+                }
+            }
+        }
+      if (!isSeqPerRule3Valid)
+        {
+          m_rule3Hint = m_firstByteSeq + m_sentSize;
+        }
+    }
+
   if (isSeqPerRule3Valid)
     {
       NS_LOG_INFO ("Rule3 valid. " << seqPerRule3);
@@ -1056,7 +1206,7 @@ TcpTxBuffer::BytesInFlight () const
 uint32_t
 TcpTxBuffer::BytesInFlightRFC () const
 {
-  PacketList::const_iterator it;
+  SentList::const_iterator it;
   TcpTxItem *item;
   uint32_t size = 0; // "pipe" in RFC
   SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq;
@@ -1070,7 +1220,7 @@ TcpTxBuffer::BytesInFlightRFC () const
   // been SACKed:
   for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
     {
-      item = *it;
+      item = it->second;
       totalSize += item->m_packet->GetSize();
       if (!item->m_sacked)
         {
@@ -1118,17 +1268,17 @@ TcpTxBuffer::BytesInFlightRFC () const
 }
 
 bool
-TcpTxBuffer::IsLostRFC (const SequenceNumber32 &seq, const PacketList::const_iterator &segment) const
+TcpTxBuffer::IsLostRFC (const SequenceNumber32 &seq, const SentList::const_iterator &segment) const
 {
   NS_LOG_FUNCTION (this << seq);
   uint32_t count = 0;
   uint32_t bytes = 0;
-  PacketList::const_iterator it;
+  SentList::const_iterator it;
   TcpTxItem *item;
   Ptr<const Packet> current;
   SequenceNumber32 beginOfCurrentPacket = seq;
 
-  if ((*segment)->m_sacked == true)
+  if (segment->second->m_sacked == true)
     {
       return false;
     }
@@ -1140,7 +1290,7 @@ TcpTxBuffer::IsLostRFC (const SequenceNumber32 &seq, const PacketList::const_ite
   // > routine returns false.
   for (it = segment; it != m_sentList.end (); ++it)
     {
-      item = *it;
+      item = it->second;
       current = item->m_packet;
 
       if (item->m_sacked)
@@ -1182,10 +1332,13 @@ TcpTxBuffer::ResetRenoSack ()
   m_sackedOut = 0;
   for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
     {
-      (*it)->m_sacked = false;
+      it->second->m_sacked = false;
     }
 
   m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_lostHint = m_firstByteSeq;
+  m_retxHint = m_firstByteSeq;
+  m_rule3Hint = m_firstByteSeq;
 }
 
 void
@@ -1197,10 +1350,11 @@ TcpTxBuffer::ResetSentList ()
   // Keep the head items; they will then marked as lost
   while (m_sentList.size () > 0)
     {
-      item = m_sentList.back ();
+      SentList::iterator last = std::prev (m_sentList.end ());
+      item = last->second;
       item->m_retrans = item->m_sacked = item->m_lost = false;
       m_appList.push_front (item);
-      m_sentList.pop_back ();
+      m_sentList.erase (last);
     }
 
   m_sentSize = 0;
@@ -1208,6 +1362,10 @@ TcpTxBuffer::ResetSentList ()
   m_retrans = 0;
   m_sackedOut = 0;
   m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_lostHint = m_firstByteSeq;
+  m_lostEnd = m_firstByteSeq;
+  m_retxHint = m_firstByteSeq;
+  m_rule3Hint = m_firstByteSeq;
 }
 
 void
@@ -1216,15 +1374,40 @@ TcpTxBuffer::ResetLastSegmentSent ()
   NS_LOG_FUNCTION (this);
   if (!m_sentList.empty ())
     {
-      TcpTxItem *item = m_sentList.back ();
+      SentList::iterator last = std::prev (m_sentList.end ());
+      TcpTxItem *item = last->second;
 
-      m_sentList.pop_back ();
+      if (m_highestSack.first == last)
+        {
+          m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+        }
+      m_sentList.erase (last);
       m_sentSize -= item->m_packet->GetSize ();
       if (item->m_retrans)
         {
           m_retrans -= item->m_packet->GetSize ();
         }
       m_appList.insert (m_appList.begin (), item);
+
+      // The item will be sent again as new data, hence the hints must not
+      // be beyond the end of the sent data
+      SequenceNumber32 sentEnd = m_firstByteSeq + m_sentSize;
+      if (sentEnd < m_lostHint)
+        {
+          m_lostHint = sentEnd;
+        }
+      if (sentEnd < m_lostEnd)
+        {
+          m_lostEnd = sentEnd;
+        }
+      if (sentEnd < m_retxHint)
+        {
+          m_retxHint = sentEnd;
+        }
+      if (sentEnd < m_rule3Hint)
+        {
+          m_rule3Hint = sentEnd;
+        }
     }
   ConsistencyCheck ();
 }
@@ -1248,29 +1431,36 @@ TcpTxBuffer::SetSentListLost (bool resetSack)
 
   for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
     {
+      TcpTxItem *item = it->second;
       if (resetSack)
         {
-          (*it)->m_sacked = false;
-          (*it)->m_lost = true;
+          item->m_sacked = false;
+          item->m_lost = true;
         }
       else
         {
-          if ((*it)->m_lost)
+          if (item->m_lost)
             {
               // Have to increment it because we set it to 0 at line 1133
-              m_lostOut += (*it)->m_packet->GetSize ();
+              m_lostOut += item->m_packet->GetSize ();
             }
-          else if (!(*it)->m_sacked)
+          else if (!item->m_sacked)
             {
               // Packet is not marked lost, nor is sacked. Then it becomes lost.
-              (*it)->m_lost = true;
-              m_lostOut += (*it)->m_packet->GetSize ();
+              item->m_lost = true;
+              m_lostOut += item->m_packet->GetSize ();
             }
         }
 
-      (*it)->m_retrans = false;
+      item->m_retrans = false;
     }
 
+  // All the items are now either lost or sacked, and have to be retransmitted
+  m_lostHint = m_firstByteSeq + m_sentSize;
+  m_lostEnd = m_firstByteSeq + m_sentSize;
+  m_retxHint = m_firstByteSeq;
+  m_rule3Hint = m_firstByteSeq;
+
   NS_LOG_INFO ("Set sent list lost, status: " << *this);
   NS_ASSERT_MSG (m_sentSize >= m_sackedOut + m_lostOut, *this);
   ConsistencyCheck ();
@@ -1286,7 +1476,7 @@ TcpTxBuffer::IsHeadRetransmitted () const
       return false;
     }
 
-  return m_sentList.front ()->m_retrans;
+  return m_sentList.begin ()->second->m_retrans;
 }
 
 void
@@ -1299,10 +1489,12 @@ TcpTxBuffer::DeleteRetransmittedFlagFromHead ()
       return;
     }
 
-  if (m_sentList.front ()->m_retrans)
+  TcpTxItem *head = m_sentList.begin ()->second;
+  if (head->m_retrans)
     {
-      m_sentList.front ()->m_retrans = false;
-      m_retrans -= m_sentList.front ()->m_packet->GetSize ();
+      head->m_retrans = false;
+      m_retrans -= head->m_packet->GetSize ();
+      LowerRetxHint (head->m_startSeq);
     }
   ConsistencyCheck ();
 }
@@ -1312,26 +1504,29 @@ TcpTxBuffer::MarkHeadAsLost ()
 {
   if (m_sentList.size () > 0)
     {
+      TcpTxItem *head = m_sentList.begin ()->second;
+
       // If the head is sacked (reneging by the receiver the previously sent
       // information) we revert the sacked flag.
       // A sacked head means that we should advance SND.UNA.. so it's an error.
-      if (m_sentList.front ()->m_sacked)
+      if (head->m_sacked)
         {
-          m_sentList.front ()->m_sacked = false;
-          m_sackedOut -= m_sentList.front ()->m_packet->GetSize ();
+          head->m_sacked = false;
+          m_sackedOut -= head->m_packet->GetSize ();
         }
 
-      if (m_sentList.front ()->m_retrans)
+      if (head->m_retrans)
         {
-          m_sentList.front ()->m_retrans = false;
-          m_retrans -= m_sentList.front ()->m_packet->GetSize ();
+          head->m_retrans = false;
+          m_retrans -= head->m_packet->GetSize ();
         }
 
-      if (! m_sentList.front()->m_lost)
+      if (! head->m_lost)
         {
-          m_sentList.front()->m_lost = true;
-          m_lostOut += m_sentList.front ()->m_packet->GetSize ();
+          MarkLost (m_sentList.begin ());
         }
+
+      LowerRetxHint (head->m_startSeq);
     }
   ConsistencyCheck ();
 }
@@ -1345,10 +1540,10 @@ TcpTxBuffer::AddRenoSack (void)
   m_renoSack = true;
 
   // We can _never_ SACK the head, so start from the second segment sent
-  auto it = ++m_sentList.begin ();
+  auto it = std::next (m_sentList.begin ());
 
   // Find the "highest sacked" point, that is SND.UNA + m_sackedOut
-  while (it != m_sentList.end () && (*it)->m_sacked)
+  while (it != m_sentList.end () && it->second->m_sacked)
     {
       ++it;
     }
@@ -1356,9 +1551,9 @@ TcpTxBuffer::AddRenoSack (void)
   // Add to the sacked size the size of the first "not sacked" segment
   if (it != m_sentList.end ())
     {
-      (*it)->m_sacked = true;
-      m_sackedOut += (*it)->m_packet->GetSize ();
-      m_highestSack = std::make_pair (it, (*it)->m_startSeq);
+      it->second->m_sacked = true;
+      m_sackedOut += it->second->m_packet->GetSize ();
+      m_highestSack = std::make_pair (it, it->first);
       NS_LOG_INFO ("Added a Reno SACK, status: " << *this);
     }
   else
@@ -1386,17 +1581,29 @@ TcpTxBuffer::ConsistencyCheck () const
 
   for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
     {
-      if ((*it)->m_sacked)
+      const TcpTxItem *item = it->second;
+      NS_ASSERT_MSG (it->first == item->m_startSeq, "Item " << *item <<
+                     " indexed as " << it->first);
+      NS_ASSERT_MSG (it->first >= m_lostHint || item->m_lost || item->m_sacked,
+                     "Item " << *item << " before the lost hint " << m_lostHint);
+      NS_ASSERT_MSG (it->first >= m_retxHint || !item->m_lost || item->m_sacked
+                     || item->m_retrans,
+                     "Item " << *item << " before the retransmission hint " << m_retxHint);
+      NS_ASSERT_MSG (!item->m_lost || it->first + item->m_packet->GetSize () <= m_lostEnd,
+                     "Lost item " << *item << " after the lost end " << m_lostEnd);
+      NS_ASSERT_MSG (it->first >= m_rule3Hint || item->m_sacked || item->m_retrans,
+                     "Item " << *item << " before the rule 3 hint " << m_rule3Hint);
+      if (item->m_sacked)
         {
-          sacked += (*it)->m_packet->GetSize ();
+          sacked += item->m_packet->GetSize ();
         }
-      if ((*it)->m_lost)
+      if (item->m_lost)
         {
-          lost += (*it)->m_packet->GetSize ();
+          lost += item->m_packet->GetSize ();
         }
-      if ((*it)->m_retrans)
+      if (item->m_retrans)
         {
-          retrans += (*it)->m_packet->GetSize ();
+          retrans += item->m_packet->GetSize ();
         }
     }
 
@@ -1418,23 +1625,22 @@ operator<< (std::ostream & os, TcpTxItem const & item)
 std::ostream &
 operator<< (std::ostream & os, TcpTxBuffer const & tcpTxBuf)
 {
-  TcpTxBuffer::PacketList::const_iterator it;
   std::stringstream ss;
   SequenceNumber32 beginOfCurrentPacket = tcpTxBuf.m_firstByteSeq;
   uint32_t sentSize = 0, appSize = 0;
 
   Ptr<Packet> p;
-  for (it = tcpTxBuf.m_sentList.begin (); it != tcpTxBuf.m_sentList.end (); ++it)
+  for (auto it = tcpTxBuf.m_sentList.begin (); it != tcpTxBuf.m_sentList.end (); ++it)
     {
-      p = (*it)->m_packet;
+      p = it->second->m_packet;
       ss << "{";
-      (*it)->Print (ss);
+      it->second->Print (ss);
       ss << "}";
       sentSize += p->GetSize ();
       beginOfCurrentPacket += p->GetSize ();
     }
 
-  for (it = tcpTxBuf.m_appList.begin (); it != tcpTxBuf.m_appList.end (); ++it)
+  for (auto it = tcpTxBuf.m_appList.begin (); it != tcpTxBuf.m_appList.end (); ++it)
     {
       appSize += (*it)->m_packet->GetSize ();
     }
@@ -28,6 +28,8 @@
 #include "ns3/nstime.h"
 #include "ns3/tcp-option-sack.h"
 #include "ns3/packet.h"
+#include <list>
+#include <map>
 
 namespace ns3 {
 class Packet;
@@ -87,6 +89,11 @@ public:
  * are not transmitted yet as segments. To discover how the chunks are managed
  * and retrieved from these lists, check CopyFromSequence documentation.
  *
+ * The SentList is a map indexed by the sequence number of the first byte of
+ * each item, so that the item holding a given sequence number (e.g., the
+ * start of a SACK block or of a retransmission) is found in logarithmic time
+ * instead of walking the list from its head.
+ *
  * The head of the data is represented by m_firstByteSeq, and it is returned by
  * HeadSequence(). The last byte is returned by TailSequence(). In this class,
  * we also store the size (in bytes) of the packets inside the SentList in the
@@ -122,6 +129,15 @@ public:
  * segments that can be lost (\see UpdateLostCount), and we set the flags
  * accordingly.
  *
+ * To avoid walking the whole SentList on every ACK, hints are kept, in the
+ * spirit of the lost_skb_hint and retransmit_skb_hint of Linux: all the
+ * items starting before the lost hint are either lost or sacked, hence
+ * UpdateLostCount stops there, and none of the items starting before the
+ * retransmission hints is a candidate for rule (1) (lost, not sacked and not
+ * retransmitted) or rule (3) (not sacked and not retransmitted) of NextSeg,
+ * hence NextSeg starts from there. Moreover, no lost item ends after the
+ * lost end, so that the search for rule (1) stops there.
+ *
  * Management of bytes in flight
  * -----------------------------
  *
@@ -410,6 +426,7 @@ private:
   friend std::ostream & operator<< (std::ostream & os, TcpTxBuffer const & tcpTxBuf);
 
   typedef std::list<TcpTxItem*> PacketList; //!< container for data stored in the buffer
+  typedef std::map<SequenceNumber32, TcpTxItem*> SentList; //!< container for sent data, indexed by sequence number
 
   /**
    * \brief Update the lost count
@@ -426,8 +443,8 @@ private:
    * The {New}Reno cases, for now, are managed in TcpSocketBase through the
    * call to MarkHeadAsLost.
    * This function is, therefore, called after a SACK option has been received,
-   * and updates the lost count. It can be probably optimized by not walking
-   * the entire list, but a subset.
+   * and updates the lost count. The walk stops at the lost hint, since the
+   * items before it are already lost or sacked.
    *
    */
   void UpdateLostCount ();
@@ -448,7 +465,7 @@ private:
    * \param segment Iterator to the sequence
    * \return true if seq is lost per RFC 6675, false otherwise
    */
-  bool IsLostRFC (const SequenceNumber32 &seq, const PacketList::const_iterator &segment) const;
+  bool IsLostRFC (const SequenceNumber32 &seq, const SentList::const_iterator &segment) const;
 
   /**
    * \brief Calculate the number of bytes in flight per RFC 6675
@@ -478,9 +495,9 @@ private:
    * This is clearly a retransmission, and if everything is going well,
    * the block requested is matching perfectly with another one requested
    * in the past. If not, fragmentation or merge are required. We manage
-   * both inside GetPacketFromList.
+   * both inside GetPacketFromSentList.
    *
-   * \see GetPacketFromList
+   * \see GetPacketFromSentList
    *
    * \param numBytes number of bytes to copy
    * \param seq sequence requested
@@ -489,7 +506,7 @@ private:
   TcpTxItem* GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &seq);
 
   /**
-   * \brief Get a block (which is returned as Packet) from a list
+   * \brief Get a block (which is returned as Packet) from the AppList
    *
    * This function extract a block [requestedSeq,numBytes) from the list, which
    * starts at startingSeq.
@@ -562,6 +579,52 @@ private:
                                 uint32_t numBytes, const SequenceNumber32 &requestedSeq,
                                 bool *listEdited = nullptr) const;
 
+  /**
+   * \brief Get a block (which is returned as Packet) from the SentList
+   *
+   * The item holding requestedSeq is looked up by sequence number; it is
+   * then fragmented, or merged with the items following it, so that the
+   * returned item covers exactly [requestedSeq, requestedSeq + numBytes),
+   * as done by GetPacketFromList.
+   *
+   * \param numBytes Bytes to extract, starting from requestedSeq
+   * \param requestedSeq Requested sequence
+   * \return the item that contains the right packet
+   */
+  TcpTxItem* GetPacketFromSentList (uint32_t numBytes, const SequenceNumber32 &requestedSeq);
+
+  /**
+   * \brief Split an item of the SentList in two
+   *
+   * \param it Iterator to the item to split; on return, it refers to the
+   * first part
+   * \param size Size of the first part
+   * \return an iterator to the second part
+   */
+  SentList::iterator SplitSentItem (SentList::iterator it, uint32_t size);
+
+  /**
+   * \brief Merge an item of the SentList with the one following it
+   *
+   * \param it Iterator to the first item, which receives the second one
+   */
+  void MergeSentItems (SentList::iterator it);
+
+  /**
+   * \brief Move the retransmission hints back to an item which may have
+   * become a candidate for retransmission
+   *
+   * \param seq Sequence number of the first byte of the item
+   */
+  void LowerRetxHint (const SequenceNumber32 &seq) const;
+
+  /**
+   * \brief Mark an item of the SentList as lost
+   *
+   * \param it Iterator to the item, which must not be lost
+   */
+  void MarkLost (SentList::const_iterator it);
+
   /**
    * \brief Merge two TcpTxItem
    *
@@ -596,17 +659,21 @@ private:
    * \brief Find the highest SACK byte
    * \return a pair with the highest byte and an iterator inside m_sentList
    */
-  std::pair <TcpTxBuffer::PacketList::const_iterator, SequenceNumber32>
+  std::pair <TcpTxBuffer::SentList::const_iterator, SequenceNumber32>
   FindHighestSacked () const;
 
   PacketList m_appList;  //!< Buffer for application data
-  PacketList m_sentList; //!< Buffer for sent (but not acked) data
+  SentList m_sentList;   //!< Buffer for sent (but not acked) data
   uint32_t m_maxBuffer;  //!< Max number of data bytes in buffer (SND.WND)
   uint32_t m_size;       //!< Size of all data in this buffer
   uint32_t m_sentSize;   //!< Size of sent (and not discarded) segments
 
   TracedValue<SequenceNumber32> m_firstByteSeq; //!< Sequence number of the first byte in data (SND.UNA)
-  std::pair <PacketList::const_iterator, SequenceNumber32> m_highestSack; //!< Highest SACK byte
+  std::pair <SentList::const_iterator, SequenceNumber32> m_highestSack; //!< Highest SACK byte
+  SequenceNumber32 m_lostHint;         //!< Items starting before this sequence are lost or sacked
+  SequenceNumber32 m_lostEnd;          //!< Lost items end before this sequence
+  mutable SequenceNumber32 m_retxHint; //!< No item starting before this sequence is to be retransmitted per NextSeg rule (1)
+  mutable SequenceNumber32 m_rule3Hint; //!< No item starting before this sequence is to be retransmitted per NextSeg rule (3)
 
   uint32_t m_lostOut   {0}; //!< Number of lost bytes
   uint32_t m_sackedOut {0}; //!< Number of sacked bytes
@@ -34,6 +34,7 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/ipv4-packet-info-tag.h"
 #include "ns3/ipv6-packet-info-tag.h"
+#include "flow-ports-tag.h"
 #include "udp-socket-impl.h"
 #include "udp-l4-protocol.h"
 #include "ipv4-end-point.h"
@@ -624,7 +625,11 @@ UdpSocketImpl::DoSendTo (Ptr<Packet> p, Ipv4Address dest, uint16_t port, uint8_t
       Ptr<Ipv4Route> route;
       Ptr<NetDevice> oif = m_boundnetdevice; //specify non-zero if bound to a specific device
       // TBD-- we could cache the route and just check its validity
+      // The UDP header is not added yet, hence the ports are given in a tag
+      FlowPortsTag portsTag (m_endPoint->GetLocalPort (), port);
+      p->AddPacketTag (portsTag);
       route = ipv4->GetRoutingProtocol ()->RouteOutput (p, header, oif, errno_); 
+      p->RemovePacketTag (portsTag);
       if (route != 0)
         {
           NS_LOG_LOGIC ("Route exists");
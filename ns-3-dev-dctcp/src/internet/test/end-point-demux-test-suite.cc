@@ -0,0 +1,207 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/ipv4-end-point-demux.h"
+#include "ns3/ipv4-end-point.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv6-end-point-demux.h"
+#include "ns3/ipv6-end-point.h"
+#include "ns3/ipv6-interface.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the lookups of the IPv4 end point demux, with many
+ * connections sharing the local port of a listening end point.
+ */
+class Ipv4EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv4EndPointDemuxTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+Ipv4EndPointDemuxTestCase::Ipv4EndPointDemuxTestCase ()
+  : TestCase ("Check the 4-tuple and local port lookups of Ipv4EndPointDemux")
+{
+}
+
+void
+Ipv4EndPointDemuxTestCase::DoRun (void)
+{
+  Ipv4EndPointDemux demux;
+  Ptr<Ipv4Interface> interface = CreateObject<Ipv4Interface> ();
+  Ipv4Address local ("10.0.0.1");
+  const uint32_t n = 1000;
+
+  Ipv4EndPoint *listener = demux.Allocate (0, 80);
+  NS_TEST_ASSERT_MSG_NE (listener, 0, "Listening end point not allocated");
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (80), true, "Port 80 not in use");
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (81), false, "Port 81 in use");
+
+  std::vector<Ipv4EndPoint *> connections;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ipv4Address peer (0x0b000000 + i);
+      connections.push_back (demux.Allocate (0, local, 80, peer, 1000 + i));
+      NS_TEST_ASSERT_MSG_NE (connections.back (), 0, "Connection " << i << " not allocated");
+    }
+  NS_TEST_ASSERT_MSG_EQ (demux.Allocate (0, local, 80, Ipv4Address (0x0b000000), 1000), 0,
+                         "Duplicated connection allocated");
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ipv4EndPointDemux::EndPoints endPoints = demux.Lookup (local, 80, Ipv4Address (0x0b000000 + i),
+                                                             1000 + i, interface);
+      NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Connection " << i << " not found");
+      NS_TEST_ASSERT_MSG_EQ (endPoints.front (), connections[i], "Wrong end point for connection " << i);
+    }
+
+  // A packet of another peer goes to the listening end point
+  Ipv4EndPointDemux::EndPoints endPoints = demux.Lookup (local, 80, Ipv4Address ("12.0.0.1"), 5000, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Listening end point not found");
+  NS_TEST_ASSERT_MSG_EQ (endPoints.front (), listener, "Wrong end point for a new peer");
+  endPoints = demux.Lookup (local, 81, Ipv4Address ("12.0.0.1"), 5000, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 0, "End point found on an unused port");
+
+  // The index follows the changes of the peer of an end point
+  connections[0]->SetPeer (Ipv4Address ("12.0.0.2"), 6000);
+  endPoints = demux.Lookup (local, 80, Ipv4Address ("12.0.0.2"), 6000, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.front (), connections[0], "Connection not found with its new peer");
+  endPoints = demux.Lookup (local, 80, Ipv4Address (0x0b000000), 1000, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.front (), listener, "Connection found with its old peer");
+
+  // A connected end point, bound to any local address, is found as well
+  Ipv4EndPoint *unbound = demux.Allocate (0, Ipv4Address::GetAny (), 80, Ipv4Address ("12.0.0.3"), 7000);
+  endPoints = demux.Lookup (local, 80, Ipv4Address ("12.0.0.3"), 7000, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.front (), unbound, "Connection bound to any address not found");
+
+  // An end point which does not receive is skipped
+  connections[1]->SetRxEnabled (false);
+  endPoints = demux.Lookup (local, 80, Ipv4Address (0x0b000001), 1001, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.front (), listener, "Connection not receiving found");
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      demux.DeAllocate (connections[i]);
+    }
+  demux.DeAllocate (unbound);
+  endPoints = demux.Lookup (local, 80, Ipv4Address (0x0b000002), 1002, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.front (), listener, "Deallocated connection found");
+  demux.DeAllocate (listener);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (80), false, "Port 80 still in use");
+  endPoints = demux.Lookup (local, 80, Ipv4Address (0x0b000002), 1002, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 0, "Deallocated end point found");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the lookups of the IPv6 end point demux, with many
+ * connections sharing the local port of a listening end point.
+ */
+class Ipv6EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv6EndPointDemuxTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+Ipv6EndPointDemuxTestCase::Ipv6EndPointDemuxTestCase ()
+  : TestCase ("Check the 4-tuple and local port lookups of Ipv6EndPointDemux")
+{
+}
+
+void
+Ipv6EndPointDemuxTestCase::DoRun (void)
+{
+  Ipv6EndPointDemux demux;
+  Ptr<Ipv6Interface> interface = CreateObject<Ipv6Interface> ();
+  Ipv6Address local ("2001:1::1");
+  const uint32_t n = 1000;
+
+  Ipv6EndPoint *listener = demux.Allocate (0, 80);
+  NS_TEST_ASSERT_MSG_NE (listener, 0, "Listening end point not allocated");
+
+  std::vector<Ipv6EndPoint *> connections;
+  std::vector<Ipv6Address> peers;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      uint8_t address[16] = { 0x20, 0x01, 0x00, 0x02 };
+      address[14] = i >> 8;
+      address[15] = i & 0xff;
+      peers.push_back (Ipv6Address (address));
+      connections.push_back (demux.Allocate (0, local, 80, peers[i], 1000 + i));
+      NS_TEST_ASSERT_MSG_NE (connections.back (), 0, "Connection " << i << " not allocated");
+    }
+  NS_TEST_ASSERT_MSG_EQ (demux.Allocate (0, local, 80, peers[0], 1000), 0,
+                         "Duplicated connection allocated");
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ipv6EndPointDemux::EndPoints endPoints = demux.Lookup (local, 80, peers[i], 1000 + i, interface);
+      NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Connection " << i << " not found");
+      NS_TEST_ASSERT_MSG_EQ (endPoints.front (), connections[i], "Wrong end point for connection " << i);
+    }
+
+  Ipv6EndPointDemux::EndPoints endPoints = demux.Lookup (local, 80, Ipv6Address ("2001:3::1"), 5000, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.front (), listener, "Wrong end point for a new peer");
+
+  connections[0]->SetPeer (Ipv6Address ("2001:3::2"), 6000);
+  endPoints = demux.Lookup (local, 80, Ipv6Address ("2001:3::2"), 6000, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.front (), connections[0], "Connection not found with its new peer");
+  endPoints = demux.Lookup (local, 80, peers[0], 1000, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.front (), listener, "Connection found with its old peer");
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      demux.DeAllocate (connections[i]);
+    }
+  endPoints = demux.Lookup (local, 80, peers[1], 1001, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.front (), listener, "Deallocated connection found");
+  demux.DeAllocate (listener);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (80), false, "Port 80 still in use");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief End point demux TestSuite
+ */
+class EndPointDemuxTestSuite : public TestSuite
+{
+public:
+  EndPointDemuxTestSuite ();
+};
+
+EndPointDemuxTestSuite::EndPointDemuxTestSuite ()
+  : TestSuite ("end-point-demux", UNIT)
+{
+  AddTestCase (new Ipv4EndPointDemuxTestCase, TestCase::QUICK);
+  AddTestCase (new Ipv6EndPointDemuxTestCase, TestCase::QUICK);
+}
+
+static EndPointDemuxTestSuite g_endPointDemuxTestSuite; //!< Static variable for test initialization
@@ -42,6 +42,9 @@
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/ipv4-global-routing.h"
 #include "ns3/bridge-helper.h"
+#include "ns3/udp-header.h"
+#include "ns3/udp-l4-protocol.h"
+#include <set>
 
 using namespace ns3;
 
@@ -1244,6 +1247,257 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting longest prefix match and ECMP test
+ *
+ * Routes are added by hand to a node linked to four neighbors:
+ * a default route through the first one, a 172.16.0.0/12 route through the
+ * second one, a 172.16.5.0/24 route through the third one, a 172.16.5.9
+ * host route through the fourth one, and a 192.168.0.0/16 route through
+ * each of them.
+ */
+class Ipv4GlobalRoutingLpmEcmpTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingLpmEcmpTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Look a route up
+   * \param dest the destination
+   * \param sourcePort the UDP source port of the packet
+   * \param oif the output interface, or 0
+   * \return the gateway of the route, or 0.0.0.0 if none is found
+   */
+  Ipv4Address GetGateway (std::string dest, uint16_t sourcePort = 1234, Ptr<NetDevice> oif = 0);
+
+  Ptr<Ipv4GlobalRouting> m_routing; //!< the routing protocol of the node
+};
+
+Ipv4GlobalRoutingLpmEcmpTestCase::Ipv4GlobalRoutingLpmEcmpTestCase ()
+  : TestCase ("Global routing longest prefix match and ECMP")
+{
+}
+
+Ipv4Address
+Ipv4GlobalRoutingLpmEcmpTestCase::GetGateway (std::string dest, uint16_t sourcePort, Ptr<NetDevice> oif)
+{
+  Ipv4Header header;
+  header.SetSource (Ipv4Address ("10.0.1.1"));
+  header.SetDestination (Ipv4Address (dest.c_str ()));
+  header.SetProtocol (UdpL4Protocol::PROT_NUMBER);
+  Ptr<Packet> packet = Create<Packet> (100);
+  UdpHeader udpHeader;
+  udpHeader.SetSourcePort (sourcePort);
+  udpHeader.SetDestinationPort (80);
+  packet->AddHeader (udpHeader);
+  Socket::SocketErrno sockerr;
+  Ptr<Ipv4Route> route = m_routing->RouteOutput (packet, header, oif, sockerr);
+  return (route != 0 ? route->GetGateway () : Ipv4Address::GetAny ());
+}
+
+void
+Ipv4GlobalRoutingLpmEcmpTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (5);
+  InternetStackHelper internet;
+  Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+  internet.SetRoutingHelper (ipv4RoutingHelper);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  NetDeviceContainer devices;
+  for (uint32_t i = 1; i <= 4; i++)
+    {
+      NetDeviceContainer link = simpleHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (i)));
+      std::ostringstream base;
+      base << "10.0." << i << ".0";
+      ipv4.SetBase (base.str ().c_str (), "255.255.255.0");
+      ipv4.Assign (link);
+      devices.Add (link.Get (0));
+    }
+
+  m_routing = nodes.Get (0)->GetObject<Ipv4L3Protocol> ()->GetRoutingProtocol ()->GetObject<Ipv4GlobalRouting> ();
+  NS_TEST_ASSERT_MSG_NE (m_routing, 0, "Error-- no Ipv4GlobalRouting object");
+  // Interface 0 is the loopback
+  m_routing->AddNetworkRouteTo (Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), Ipv4Address ("10.0.1.2"), 1);
+  m_routing->AddNetworkRouteTo (Ipv4Address ("172.16.0.0"), Ipv4Mask ("255.240.0.0"), Ipv4Address ("10.0.2.2"), 2);
+  m_routing->AddNetworkRouteTo (Ipv4Address ("172.16.5.0"), Ipv4Mask ("255.255.255.0"), Ipv4Address ("10.0.3.2"), 3);
+  m_routing->AddHostRouteTo (Ipv4Address ("172.16.5.9"), Ipv4Address ("10.0.4.2"), 4);
+  for (uint32_t i = 1; i <= 4; i++)
+    {
+      std::ostringstream gateway;
+      gateway << "10.0." << i << ".2";
+      m_routing->AddNetworkRouteTo (Ipv4Address ("192.168.0.0"), Ipv4Mask ("255.255.0.0"),
+                                    Ipv4Address (gateway.str ().c_str ()), i);
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_routing->GetNRoutes (), 8, "Error-- wrong number of routes");
+
+  // Longest prefix match
+  NS_TEST_ASSERT_MSG_EQ (GetGateway ("8.8.8.8"), Ipv4Address ("10.0.1.2"), "Error-- default route not used");
+  NS_TEST_ASSERT_MSG_EQ (GetGateway ("172.17.0.1"), Ipv4Address ("10.0.2.2"), "Error-- /12 route not used");
+  NS_TEST_ASSERT_MSG_EQ (GetGateway ("172.16.5.1"), Ipv4Address ("10.0.3.2"), "Error-- /24 route not used");
+  NS_TEST_ASSERT_MSG_EQ (GetGateway ("172.16.5.9"), Ipv4Address ("10.0.4.2"), "Error-- host route not used");
+  // The longest prefix through the requested interface
+  NS_TEST_ASSERT_MSG_EQ (GetGateway ("172.16.5.9", 1234, devices.Get (1)), Ipv4Address ("10.0.2.2"),
+                         "Error-- /12 route not used through its interface");
+  NS_TEST_ASSERT_MSG_EQ (GetGateway ("172.16.5.9", 1234, devices.Get (2)), Ipv4Address ("10.0.3.2"),
+                         "Error-- /24 route not used through its interface");
+
+  // Removing the host route, then the /24 route
+  NS_TEST_ASSERT_MSG_EQ (m_routing->GetRoute (0)->IsHost (), true, "Error-- host routes not first");
+  m_routing->RemoveRoute (0);
+  NS_TEST_ASSERT_MSG_EQ (GetGateway ("172.16.5.9"), Ipv4Address ("10.0.3.2"), "Error-- host route not removed");
+  m_routing->RemoveRoute (2);
+  NS_TEST_ASSERT_MSG_EQ (GetGateway ("172.16.5.9"), Ipv4Address ("10.0.2.2"), "Error-- /24 route not removed");
+  NS_TEST_ASSERT_MSG_EQ (m_routing->GetNRoutes (), 6, "Error-- wrong number of routes");
+
+  // Without ECMP, the first route is always used
+  for (uint16_t port = 1000; port < 1064; port++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (GetGateway ("192.168.3.4", port), Ipv4Address ("10.0.1.2"),
+                             "Error-- first ECMP route not used");
+    }
+
+  // With flow ECMP, the packets of a flow follow the same route, and the
+  // flows are spread over the routes
+  m_routing->SetAttribute ("FlowEcmpRouting", BooleanValue (true));
+  std::set<Ipv4Address> gateways;
+  for (uint16_t port = 1000; port < 1064; port++)
+    {
+      Ipv4Address gateway = GetGateway ("192.168.3.4", port);
+      NS_TEST_ASSERT_MSG_EQ (GetGateway ("192.168.3.4", port), gateway, "Error-- flow not routed consistently");
+      gateways.insert (gateway);
+    }
+  NS_TEST_ASSERT_MSG_EQ (gateways.size (), 4, "Error-- flows not spread over the ECMP routes");
+  // Only the routes through the requested interface are candidates
+  NS_TEST_ASSERT_MSG_EQ (GetGateway ("192.168.3.4", 1000, devices.Get (3)), Ipv4Address ("10.0.4.2"),
+                         "Error-- ECMP route not through its interface");
+
+  m_routing = 0;
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting flow ECMP test for the packets sent by UDP sockets
+ *
+ * A node linked to four neighbors has a route to 192.168.0.0/16 through
+ * each of them. UDP sockets not bound to a local address send packets of
+ * different sizes and contents: the packets of a socket must leave through
+ * the same interface, and the sockets must be spread over the interfaces.
+ */
+class Ipv4GlobalRoutingUdpFlowEcmpTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingUdpFlowEcmpTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Record the interface a packet is sent through
+   * \param p the packet
+   * \param ipv4 the IPv4 protocol
+   * \param interface the interface
+   */
+  void SendTrace (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface);
+  /**
+   * \brief Send packets from several UDP sockets and check their interfaces
+   * \param node the node of the sockets
+   */
+  void SendPackets (Ptr<Node> node);
+
+  std::set<uint32_t> m_interfaces; //!< the interfaces used by the current socket
+};
+
+Ipv4GlobalRoutingUdpFlowEcmpTestCase::Ipv4GlobalRoutingUdpFlowEcmpTestCase ()
+  : TestCase ("Global routing flow ECMP of the packets sent by UDP sockets")
+{
+}
+
+void
+Ipv4GlobalRoutingUdpFlowEcmpTestCase::SendTrace (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  m_interfaces.insert (interface);
+}
+
+void
+Ipv4GlobalRoutingUdpFlowEcmpTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (5);
+  InternetStackHelper internet;
+  Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+  internet.SetRoutingHelper (ipv4RoutingHelper);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  for (uint32_t i = 1; i <= 4; i++)
+    {
+      NetDeviceContainer link = simpleHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (i)));
+      std::ostringstream base;
+      base << "10.0." << i << ".0";
+      ipv4.SetBase (base.str ().c_str (), "255.255.255.0");
+      ipv4.Assign (link);
+    }
+
+  Ptr<Ipv4L3Protocol> ipv4L3 = nodes.Get (0)->GetObject<Ipv4L3Protocol> ();
+  Ptr<Ipv4GlobalRouting> routing = ipv4L3->GetRoutingProtocol ()->GetObject<Ipv4GlobalRouting> ();
+  NS_TEST_ASSERT_MSG_NE (routing, 0, "Error-- no Ipv4GlobalRouting object");
+  for (uint32_t i = 1; i <= 4; i++)
+    {
+      std::ostringstream gateway;
+      gateway << "10.0." << i << ".2";
+      routing->AddNetworkRouteTo (Ipv4Address ("192.168.0.0"), Ipv4Mask ("255.255.0.0"),
+                                  Ipv4Address (gateway.str ().c_str ()), i);
+    }
+  routing->SetAttribute ("FlowEcmpRouting", BooleanValue (true));
+  ipv4L3->TraceConnectWithoutContext ("Tx", MakeCallback (&Ipv4GlobalRoutingUdpFlowEcmpTestCase::SendTrace, this));
+
+  Simulator::Schedule (Seconds (1), &Ipv4GlobalRoutingUdpFlowEcmpTestCase::SendPackets, this, nodes.Get (0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+Ipv4GlobalRoutingUdpFlowEcmpTestCase::SendPackets (Ptr<Node> node)
+{
+  Ptr<SocketFactory> factory = node->GetObject<SocketFactory> (UdpSocketFactory::GetTypeId ());
+  std::set<uint32_t> interfaces;
+  for (uint32_t i = 0; i < 16; i++)
+    {
+      Ptr<Socket> socket = factory->CreateSocket ();
+      socket->Bind ();
+      socket->Connect (InetSocketAddress (Ipv4Address ("192.168.3.4"), 1234));
+      m_interfaces.clear ();
+      for (uint32_t j = 0; j < 32; j++)
+        {
+          // The route must not depend on the payload
+          uint8_t payload[64];
+          for (uint32_t k = 0; k < sizeof (payload); k++)
+            {
+              payload[k] = static_cast<uint8_t> (j * 37 + k);
+            }
+          socket->Send (Create<Packet> (payload, 4 + j));
+        }
+      NS_TEST_EXPECT_MSG_EQ (m_interfaces.size (), 1, "Error-- packets of socket " << i << " not routed consistently");
+      interfaces.insert (m_interfaces.begin (), m_interfaces.end ());
+      socket->Close ();
+    }
+  NS_TEST_EXPECT_MSG_GT (interfaces.size (), 1, "Error-- sockets not spread over the ECMP routes");
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -1267,6 +1521,8 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
     AddTestCase (new TwoBridgeTest, TestCase::QUICK);
     AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
     AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingLpmEcmpTestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingUdpFlowEcmpTestCase, TestCase::QUICK);
   }
 
 static Ipv4GlobalRoutingTestSuite g_globalRoutingTestSuite; //!< Static variable for test initialization
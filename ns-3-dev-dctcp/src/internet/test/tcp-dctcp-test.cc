@@ -30,6 +30,7 @@
 #include "ns3/tcp-l4-protocol.h"
 #include "ns3/tcp-dctcp.h"
 #include "ns3/string.h"
+#include "ns3/double.h"
 #include "ns3/tcp-tx-buffer.h"
 
 using namespace ns3;
@@ -449,7 +450,7 @@ TcpDctcpCongestedRouter::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize,
       NS_LOG_LOGIC (this << " SendDataPacket Schedule ReTxTimeout at time " <<
                     Simulator::Now ().GetSeconds () << " to expire at time " <<
                     (Simulator::Now () + m_rto.Get ()).GetSeconds () );
-      m_retxEvent = Simulator::Schedule (m_rto, &TcpDctcpCongestedRouter::ReTxTimeout, this);
+      m_retxEvent.Schedule (m_rto);
     }
 
   m_txTrace (p, header, this);
@@ -704,6 +705,78 @@ TcpDctcpDecrementTest::ExecuteTest (void)
 
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Test the fixed-point update of the DCTCP alpha
+ */
+class TcpDctcpAlphaTest : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   *
+   * \param name Name of the test
+   */
+  TcpDctcpAlphaTest (const std::string &name);
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpDctcpAlphaTest::TcpDctcpAlphaTest (const std::string &name)
+  : TestCase (name)
+{
+}
+
+void
+TcpDctcpAlphaTest::DoRun ()
+{
+  Ptr<TcpSocketState> state = CreateObject <TcpSocketState> ();
+  state->m_cWnd = 10 * 1446;
+  state->m_segmentSize = 1446;
+  // every ACK closes an observation window
+  state->m_nextTxSequence = SequenceNumber32 (3216);
+  state->m_lastAckedSeq = SequenceNumber32 (4753);
+
+  Ptr<TcpDctcp> cong = CreateObject <TcpDctcp> ();
+  NS_TEST_ASSERT_MSG_EQ (cong->GetDctcpAlpha (), 0, "alpha starts from DctcpAlphaOnInit");
+
+  // all bytes marked: alpha = alpha - alpha / 16 + 1024 / 16
+  state->m_ecnState = TcpSocketState::ECN_ECE_RCVD;
+  cong->PktsAcked (state, 2, MilliSeconds (100));
+  NS_TEST_ASSERT_MSG_EQ (cong->GetDctcpAlpha (), 64, "alpha after a fully marked window");
+  cong->PktsAcked (state, 2, MilliSeconds (100));
+  NS_TEST_ASSERT_MSG_EQ (cong->GetDctcpAlpha (), 124, "alpha after two fully marked windows");
+
+  // no byte marked: alpha = alpha - alpha / 16
+  state->m_ecnState = TcpSocketState::ECN_IDLE;
+  cong->PktsAcked (state, 2, MilliSeconds (100));
+  NS_TEST_ASSERT_MSG_EQ (cong->GetDctcpAlpha (), 117, "alpha after an unmarked window");
+
+  // g = 1/2: alpha = alpha - alpha / 2 + 1024 / 2
+  cong->SetAttribute ("DctcpShiftG", DoubleValue (0.5));
+  DoubleValue g;
+  cong->GetAttribute ("DctcpShiftG", g);
+  NS_TEST_ASSERT_MSG_EQ (g.Get (), 0.5, "estimation gain correctly set");
+  state->m_ecnState = TcpSocketState::ECN_ECE_RCVD;
+  cong->PktsAcked (state, 2, MilliSeconds (100));
+  NS_TEST_ASSERT_MSG_EQ (cong->GetDctcpAlpha (), 571, "alpha after a fully marked window with g = 1/2");
+
+  // alpha = 1 halves the congestion window
+  cong->SetAttribute ("DctcpAlphaOnInit", DoubleValue (1.0));
+  NS_TEST_ASSERT_MSG_EQ (cong->GetDctcpAlpha (), TcpDctcp::DCTCP_MAX_ALPHA, "alpha correctly set");
+  cong->ReduceCwnd (state);
+  NS_TEST_ASSERT_MSG_EQ (state->m_cWnd.Get (), 5 * 1446, "cWnd halved when alpha is 1");
+
+  // alpha is kept by sockets forked from this one
+  Ptr<TcpDctcp> forked = DynamicCast<TcpDctcp> (cong->Fork ());
+  NS_TEST_ASSERT_MSG_EQ (forked->GetDctcpAlpha (), TcpDctcp::DCTCP_MAX_ALPHA, "alpha copied on fork");
+  forked->GetAttribute ("DctcpShiftG", g);
+  NS_TEST_ASSERT_MSG_EQ (g.Get (), 0.5, "estimation gain copied on fork");
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -717,6 +790,7 @@ public:
   {
     AddTestCase (new TcpDctcpToNewReno (2 * 1446, 1446, 4 * 1446, 2, SequenceNumber32 (4753), SequenceNumber32 (3216), MilliSeconds (100), "DCTCP falls to New Reno for slowstart"), TestCase::QUICK);
     AddTestCase (new TcpDctcpDecrementTest (4 * 1446, 1446, 2, SequenceNumber32 (3216), SequenceNumber32 (4753), MilliSeconds (100), "DCTCP decrement test"), TestCase::QUICK);
+    AddTestCase (new TcpDctcpAlphaTest ("DCTCP fixed-point alpha test"), TestCase::QUICK);
     AddTestCase (new TcpDctcpCodePointsTest (1, "ECT Test : Check if ECT is set on Syn, Syn+Ack, Ack and Data packets for DCTCP packets"),
                  TestCase::QUICK);
     AddTestCase (new TcpDctcpCodePointsTest (2, "ECT Test : Check if ECT is not set on Syn, Syn+Ack and Ack but set on Data packets for non-DCTCP but ECN enabled traffic"),TestCase::QUICK);
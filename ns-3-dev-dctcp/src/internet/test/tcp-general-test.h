@@ -551,12 +551,12 @@ protected:
   uint32_t GetRWnd (SocketWho who);
 
   /**
-   * \brief Get the persistent event of the selected socket
+   * \brief Get the persistent timer of the selected socket
    *
    * \param who socket where check the parameter
-   * \return the persistent event in the selected socket
+   * \return the persistent timer in the selected socket
    */
-  EventId GetPersistentEvent (SocketWho who);
+  const TcpTimer &GetPersistentEvent (SocketWho who);
 
   /**
    * \brief Get the persistent timeout of the selected socket
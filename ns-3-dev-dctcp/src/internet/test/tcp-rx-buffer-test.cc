@@ -20,6 +20,7 @@
 #include "ns3/log.h"
 
 #include "ns3/tcp-rx-buffer.h"
+#include <vector>
 
 using namespace ns3;
 
@@ -44,6 +45,24 @@ private:
    * \brief Test the SACK list update.
    */
   void TestUpdateSACKList ();
+  /**
+   * \brief Test the trimming of overlapping segments and the extracted data.
+   */
+  void TestOverlap ();
+  /**
+   * \brief Create a segment of the test byte stream.
+   * \param seq the sequence number of the first byte
+   * \param size the number of bytes
+   * \return the segment
+   */
+  Ptr<Packet> CreateSegment (uint32_t seq, uint32_t size) const;
+  /**
+   * \brief Check that a packet holds the expected bytes of the test byte stream.
+   * \param p the packet
+   * \param seq the sequence number of the first byte
+   * \return true if the bytes are the expected ones
+   */
+  bool CheckSegment (Ptr<const Packet> p, uint32_t seq) const;
 };
 
 TcpRxBufferTestCase::TcpRxBufferTestCase ()
@@ -55,6 +74,101 @@ void
 TcpRxBufferTestCase::DoRun ()
 {
   TestUpdateSACKList ();
+  TestOverlap ();
+}
+
+Ptr<Packet>
+TcpRxBufferTestCase::CreateSegment (uint32_t seq, uint32_t size) const
+{
+  std::vector<uint8_t> buffer (size);
+  for (uint32_t i = 0; i < size; ++i)
+    {
+      buffer[i] = static_cast<uint8_t> ((seq + i) % 251);
+    }
+  return Create<Packet> (buffer.data (), size);
+}
+
+bool
+TcpRxBufferTestCase::CheckSegment (Ptr<const Packet> p, uint32_t seq) const
+{
+  std::vector<uint8_t> buffer (p->GetSize ());
+  p->CopyData (buffer.data (), buffer.size ());
+  for (uint32_t i = 0; i < buffer.size (); ++i)
+    {
+      if (buffer[i] != static_cast<uint8_t> ((seq + i) % 251))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+TcpRxBufferTestCase::TestOverlap ()
+{
+  TcpRxBuffer rxBuf;
+  TcpOptionSack::SackList sackList;
+  TcpHeader h;
+  rxBuf.SetNextRxSequence (SequenceNumber32 (1));
+
+  // Two out-of-order segments
+  h.SetSequenceNumber (SequenceNumber32 (201));
+  rxBuf.Add (CreateSegment (201, 100), h);
+  h.SetSequenceNumber (SequenceNumber32 (401));
+  rxBuf.Add (CreateSegment (401, 100), h);
+  sackList = rxBuf.GetSackList ();
+  NS_TEST_ASSERT_MSG_EQ (sackList.size (), 2,
+                         "SACK list should contain two elements");
+
+  // A segment overlapping both: only the gap between them is stored, and the
+  // blocks are merged
+  h.SetSequenceNumber (SequenceNumber32 (251));
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Add (CreateSegment (251, 200), h), true,
+                         "The segment filling the gap was not stored");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), 300,
+                         "Overlapping bytes were stored twice");
+  sackList = rxBuf.GetSackList ();
+  NS_TEST_ASSERT_MSG_EQ (sackList.size (), 1,
+                         "SACK list should contain one element");
+  NS_TEST_ASSERT_MSG_EQ (sackList.begin ()->first, SequenceNumber32 (201),
+                         "SACK block different than expected");
+  NS_TEST_ASSERT_MSG_EQ (sackList.begin ()->second, SequenceNumber32 (501),
+                         "SACK block different than expected");
+
+  // A segment already stored as a whole
+  h.SetSequenceNumber (SequenceNumber32 (301));
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Add (CreateSegment (301, 100), h), false,
+                         "A duplicate segment was stored");
+
+  // In order data, then a segment overlapping it and filling the hole
+  h.SetSequenceNumber (SequenceNumber32 (1));
+  rxBuf.Add (CreateSegment (1, 100), h);
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Available (), 100,
+                         "In order data not available");
+  h.SetSequenceNumber (SequenceNumber32 (51));
+  rxBuf.Add (CreateSegment (51, 200), h);
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.NextRxSequence (), SequenceNumber32 (501),
+                         "Sequence number differs from expected");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Available (), 500,
+                         "Not all the data is available");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), 500,
+                         "Overlapping bytes were stored twice");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.GetSackListSize (), 0,
+                         "SACK list should contain no element");
+
+  // The data is extracted in order, splitting a stored segment
+  Ptr<Packet> p = rxBuf.Extract (150);
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 150,
+                         "Extracted size differs from expected");
+  NS_TEST_ASSERT_MSG_EQ (CheckSegment (p, 1), true,
+                         "Extracted data differs from expected");
+  p = rxBuf.Extract (1000);
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 350,
+                         "Extracted size differs from expected");
+  NS_TEST_ASSERT_MSG_EQ (CheckSegment (p, 151), true,
+                         "Extracted data differs from expected");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), 0,
+                         "Data left in the buffer");
 }
 
 void
@@ -0,0 +1,260 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/tcp-timer-wheel.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that the timers of a TcpTimerWheel expire once, at the
+ * time they were last armed for, unless cancelled
+ */
+class TcpTimerWheelExpiryTestCase : public TestCase
+{
+public:
+  TcpTimerWheelExpiryTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Record the expiry of a timer
+   * \param i the index of the timer
+   */
+  void Expire (uint32_t i);
+  /**
+   * \brief Arm, re-arm or cancel some of the timers
+   * \param round the round of changes
+   */
+  void Change (uint32_t round);
+
+  static const uint32_t N_TIMERS = 2000;   //!< Number of timers
+  static const uint32_t N_ROUNDS = 50;     //!< Number of rounds of changes
+
+  Ptr<TcpTimerWheel> m_wheel;              //!< the wheel
+  TcpTimer m_timers[N_TIMERS];             //!< the timers
+  Time m_expected[N_TIMERS];               //!< the expected expiry times, negative if none
+  uint32_t m_nExpired[N_TIMERS];           //!< the number of expiries of each timer
+  bool m_wrongTime;                        //!< true if a timer expired at another time
+  uint64_t m_random;                       //!< state of the pseudo-random sequence
+
+  /**
+   * \returns a pseudo-random number
+   */
+  uint32_t Random (void);
+};
+
+TcpTimerWheelExpiryTestCase::TcpTimerWheelExpiryTestCase ()
+  : TestCase ("Check the expiry times of TcpTimerWheel timers"),
+    m_wrongTime (false),
+    m_random (1)
+{
+}
+
+uint32_t
+TcpTimerWheelExpiryTestCase::Random (void)
+{
+  m_random = m_random * 6364136223846793005ULL + 1442695040888963407ULL;
+  return m_random >> 33;
+}
+
+void
+TcpTimerWheelExpiryTestCase::Expire (uint32_t i)
+{
+  m_nExpired[i]++;
+  if (Simulator::Now () != m_expected[i])
+    {
+      m_wrongTime = true;
+    }
+  m_expected[i] = Seconds (-1);
+}
+
+void
+TcpTimerWheelExpiryTestCase::Change (uint32_t round)
+{
+  for (uint32_t j = 0; j < N_TIMERS / 10; j++)
+    {
+      uint32_t i = Random () % N_TIMERS;
+      switch (Random () % 4)
+        {
+        case 0:
+          m_timers[i].Cancel ();
+          m_expected[i] = Seconds (-1);
+          break;
+        case 1:
+          // Short delays, at the finest level of the wheel
+          m_timers[i].Schedule (NanoSeconds (Random () % 100));
+          m_expected[i] = m_timers[i].GetDelayLeft () + Simulator::Now ();
+          break;
+        default:
+          // Delays of up to a second, like the timers of TCP
+          m_timers[i].Schedule (MicroSeconds (Random () % 1000000));
+          m_expected[i] = m_timers[i].GetDelayLeft () + Simulator::Now ();
+          break;
+        }
+    }
+  if (round + 1 < N_ROUNDS)
+    {
+      Simulator::Schedule (MicroSeconds (Random () % 50000), &TcpTimerWheelExpiryTestCase::Change,
+                           this, round + 1);
+    }
+}
+
+void
+TcpTimerWheelExpiryTestCase::DoRun (void)
+{
+  m_wheel = Create<TcpTimerWheel> ();
+  for (uint32_t i = 0; i < N_TIMERS; i++)
+    {
+      m_timers[i].SetWheel (m_wheel);
+      m_timers[i].SetFunction (MakeCallback (&TcpTimerWheelExpiryTestCase::Expire, this).Bind (i));
+      m_expected[i] = Seconds (-1);
+      m_nExpired[i] = 0;
+    }
+  Simulator::Schedule (Seconds (1), &TcpTimerWheelExpiryTestCase::Change, this, 0);
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_wrongTime, false, "A timer expired at the wrong time");
+  NS_TEST_ASSERT_MSG_EQ (m_wheel->GetNTimers (), 0, "Timers still armed");
+  uint32_t nExpired = 0;
+  for (uint32_t i = 0; i < N_TIMERS; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_expected[i].IsNegative (), true, "Timer " << i << " did not expire");
+      NS_TEST_ASSERT_MSG_EQ (m_timers[i].IsExpired (), true, "Timer " << i << " still running");
+      nExpired += m_nExpired[i];
+    }
+  NS_TEST_ASSERT_MSG_GT (nExpired, N_TIMERS / 2, "Too few timers expired");
+
+  // A timer destroyed while armed is removed from the wheel
+  {
+    TcpTimer timer;
+    timer.SetWheel (m_wheel);
+    timer.Schedule (Seconds (1), MakeCallback (&TcpTimerWheelExpiryTestCase::Expire, this).Bind (0u));
+    NS_TEST_ASSERT_MSG_EQ (m_wheel->GetNTimers (), 1, "Timer not armed");
+  }
+  NS_TEST_ASSERT_MSG_EQ (m_wheel->GetNTimers (), 0, "Destroyed timer still armed");
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_EQ (m_wrongTime, false, "Destroyed timer expired");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that re-arming timers later does not schedule events in
+ * the Simulator
+ */
+class TcpTimerWheelRearmTestCase : public TestCase
+{
+public:
+  TcpTimerWheelRearmTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Re-arm all the timers, as the retransmission timers are on
+   * every ACK
+   * \param round the round
+   */
+  void Rearm (uint32_t round);
+  /**
+   * \brief Count the expiry of a timer
+   */
+  void Expire (void);
+
+  static const uint32_t N_TIMERS = 1000;   //!< Number of timers
+  static const uint32_t N_ROUNDS = 1000;   //!< Number of rounds of re-arming
+
+  TcpTimer m_timers[N_TIMERS];             //!< the timers
+  uint32_t m_nExpired;                     //!< the number of expiries
+  Time m_lastExpiry;                       //!< the time of the last expiry
+};
+
+TcpTimerWheelRearmTestCase::TcpTimerWheelRearmTestCase ()
+  : TestCase ("Check the number of events scheduled by re-armed TcpTimerWheel timers"),
+    m_nExpired (0)
+{
+}
+
+void
+TcpTimerWheelRearmTestCase::Rearm (uint32_t round)
+{
+  for (uint32_t i = 0; i < N_TIMERS; i++)
+    {
+      m_timers[i].Schedule (MilliSeconds (200) + MicroSeconds (i));
+    }
+  if (round + 1 < N_ROUNDS)
+    {
+      Simulator::Schedule (MilliSeconds (1), &TcpTimerWheelRearmTestCase::Rearm, this, round + 1);
+    }
+}
+
+void
+TcpTimerWheelRearmTestCase::Expire (void)
+{
+  m_nExpired++;
+  m_lastExpiry = Simulator::Now ();
+}
+
+void
+TcpTimerWheelRearmTestCase::DoRun (void)
+{
+  Ptr<TcpTimerWheel> wheel = Create<TcpTimerWheel> ();
+  for (uint32_t i = 0; i < N_TIMERS; i++)
+    {
+      m_timers[i].SetWheel (wheel);
+      m_timers[i].SetFunction (MakeCallback (&TcpTimerWheelRearmTestCase::Expire, this));
+    }
+  Simulator::ScheduleNow (&TcpTimerWheelRearmTestCase::Rearm, this, 0);
+  Simulator::Run ();
+  uint64_t nEvents = Simulator::GetEventCount ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_nExpired, N_TIMERS, "Wrong number of expiries");
+  NS_TEST_ASSERT_MSG_EQ (m_lastExpiry, MilliSeconds (N_ROUNDS - 1 + 200) + MicroSeconds (N_TIMERS - 1),
+                         "Wrong time of the last expiry");
+  // One event per round, one per expiry, and the few events of the wheel
+  // which found the timers re-armed
+  NS_TEST_ASSERT_MSG_LT (nEvents, N_ROUNDS + N_TIMERS + 20, "Too many events scheduled");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TcpTimerWheel TestSuite
+ */
+class TcpTimerWheelTestSuite : public TestSuite
+{
+public:
+  TcpTimerWheelTestSuite ();
+};
+
+TcpTimerWheelTestSuite::TcpTimerWheelTestSuite ()
+  : TestSuite ("tcp-timer-wheel", UNIT)
+{
+  AddTestCase (new TcpTimerWheelExpiryTestCase, TestCase::QUICK);
+  AddTestCase (new TcpTimerWheelRearmTestCase, TestCase::QUICK);
+}
+
+static TcpTimerWheelTestSuite g_tcpTimerWheelTestSuite; //!< Static variable for test initialization
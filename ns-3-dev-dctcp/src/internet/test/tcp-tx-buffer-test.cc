@@ -49,6 +49,8 @@ private:
   void TestTransmittedBlock ();
   /** \brief Test the generation of the "next" block */
   void TestNextSeg ();
+  /** \brief Test the scoreboard of a window of many segments with holes */
+  void TestLargeWindow ();
 };
 
 TcpTxBufferTestCase::TcpTxBufferTestCase ()
@@ -81,6 +83,8 @@ TcpTxBufferTestCase::DoRun ()
                        &TcpTxBufferTestCase::TestTransmittedBlock, this);
   Simulator::Schedule (Seconds (0.0),
                        &TcpTxBufferTestCase::TestNextSeg, this);
+  Simulator::Schedule (Seconds (0.0),
+                       &TcpTxBufferTestCase::TestLargeWindow, this);
 
   Simulator::Run ();
   Simulator::Destroy ();
@@ -267,6 +271,83 @@ TcpTxBufferTestCase::TestNextSeg ()
                          "Data inside the buffer");
 }
 
+void
+TcpTxBufferTestCase::TestLargeWindow ()
+{
+  TcpTxBuffer txBuf;
+  SequenceNumber32 head (1);
+  SequenceNumber32 ret;
+  uint32_t segmentSize = 100;
+  uint32_t nSegments = 1000;
+  txBuf.SetHeadSequence (head);
+  txBuf.SetMaxBufferSize (nSegments * segmentSize);
+  txBuf.SetSegmentSize (segmentSize);
+  txBuf.SetDupAckThresh (3);
+
+  txBuf.Add (Create<Packet> (nSegments * segmentSize));
+  for (uint32_t i = 0; i < nSegments; ++i)
+    {
+      txBuf.CopyFromSequence (segmentSize, head + (segmentSize * i));
+    }
+
+  // Every tenth segment is lost; the others are sacked one after the other,
+  // each SACK block covering the run of segments received so far
+  SequenceNumber32 blockStart;
+  for (uint32_t i = 1; i < nSegments; ++i)
+    {
+      if (i % 10 == 0)
+        {
+          continue;
+        }
+      if (i % 10 == 1)
+        {
+          blockStart = head + (segmentSize * i);
+        }
+      Ptr<TcpOptionSack> sack = CreateObject<TcpOptionSack> ();
+      sack->AddSackBlock (TcpOptionSack::SackBlock (blockStart, head + (segmentSize * (i + 1))));
+      NS_TEST_ASSERT_MSG_EQ (txBuf.Update (sack->GetSackList ()), true,
+                             "The SACK block was not applied");
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetSacked (), 900 * segmentSize,
+                         "Unexpected number of sacked bytes");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), 100 * segmentSize,
+                         "Unexpected number of lost bytes");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (), 0,
+                         "Unexpected number of bytes in flight");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (head + (segmentSize * 990)), true,
+                         "The last hole should be lost");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (head + (segmentSize * 991)), false,
+                         "A sacked segment should not be lost");
+
+  // The holes are retransmitted in order
+  for (uint32_t i = 0; i < nSegments; i += 10)
+    {
+      NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&ret, false), true,
+                             "No NextSeq with holes to retransmit");
+      NS_TEST_ASSERT_MSG_EQ (ret, head + (segmentSize * i),
+                             "Different NextSeq than expected while retransmitting");
+      NS_TEST_ASSERT_MSG_EQ (txBuf.CopyFromSequence (segmentSize, ret)->GetSize (), segmentSize,
+                             "Unexpected size of the retransmitted segment");
+    }
+  NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&ret, false), false,
+                         "NextSeq returned with all the holes retransmitted");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (), 100 * segmentSize,
+                         "Unexpected number of bytes in flight");
+
+  // Cumulative ACKs up to a hole in the middle of the window, then to its end
+  txBuf.DiscardUpTo (head + (segmentSize * 510));
+  NS_TEST_ASSERT_MSG_EQ (txBuf.Size (), 490 * segmentSize,
+                         "Unexpected size after the cumulative ACK");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), 49 * segmentSize,
+                         "Unexpected number of lost bytes after the cumulative ACK");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetSacked (), 441 * segmentSize,
+                         "Unexpected number of sacked bytes after the cumulative ACK");
+  txBuf.DiscardUpTo (head + (segmentSize * nSegments));
+  NS_TEST_ASSERT_MSG_EQ (txBuf.Size (), 0,
+                         "Data inside the buffer");
+}
+
 void
 TcpTxBufferTestCase::TestNewBlock ()
 {
@@ -0,0 +1,718 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "multithreaded-simulator-impl.h"
+
+#include "ns3/simulator.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/system-thread.h"
+#include "ns3/channel.h"
+#include "ns3/net-device.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/nstime.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+namespace ns3 {
+
+// Note:  Logging in this file is largely avoided due to the
+// number of calls that are made to these functions and the possibility
+// of causing recursions leading to stack overflow
+NS_LOG_COMPONENT_DEFINE ("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED (MultithreadedSimulatorImpl);
+
+/// Timestamp standing for no event
+static const uint64_t NO_EVENT = std::numeric_limits<uint64_t>::max ();
+/// Number of times a thread polls the barrier before giving the processor up
+static const uint32_t BARRIER_SPINS = 4096;
+
+thread_local MultithreadedSimulatorImpl::Partition *MultithreadedSimulatorImpl::g_current = 0;
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultithreadedSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .SetGroupName ("Mpi")
+    .AddConstructor<MultithreadedSimulatorImpl> ()
+  ;
+  return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl ()
+  : m_stop (false),
+    m_stopTs (NO_EVENT),
+    m_currentTs (0),
+    m_lookAhead (NO_EVENT),
+    m_arrived (0),
+    m_generation (0),
+    m_windowEnd (0),
+    m_done (false)
+{
+  NS_LOG_FUNCTION (this);
+  // Until Run, all the events are inserted into partition 0, whose event
+  // list is created by SetScheduler
+  Partition *partition = new Partition;
+  partition->simulator = this;
+  partition->id = 0;
+  // uids are allocated from 4.
+  // uid 0 is "invalid" events
+  // uid 1 is "now" events
+  // uid 2 is "destroy" events
+  partition->uid = 4;
+  // before ::Run is entered, the m_currentUid will be zero
+  partition->currentUid = 0;
+  partition->currentTs = 0;
+  partition->currentContext = Simulator::NO_CONTEXT;
+  partition->eventCount = 0;
+  partition->unscheduledEvents = 0;
+  partition->stop = false;
+  partition->nextTs = NO_EVENT;
+  partition->sentTs = NO_EVENT;
+  partition->phase = 0;
+  m_partitions.push_back (partition);
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<Partition *>::iterator it = m_partitions.begin (); it != m_partitions.end (); ++it)
+    {
+      delete *it;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<Partition *>::iterator it = m_partitions.begin (); it != m_partitions.end (); ++it)
+    {
+      Partition *partition = *it;
+      ReceiveEvents (partition, 0);
+      ReceiveEvents (partition, 1);
+      while (!partition->events->IsEmpty ())
+        {
+          Scheduler::Event next = partition->events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      partition->events = 0;
+    }
+  SimulatorImpl::DoDispose ();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  while (!m_destroyEvents.empty ())
+    {
+      Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
+      m_destroyEvents.pop_front ();
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+  m_schedulerFactory = schedulerFactory;
+  for (std::vector<Partition *>::iterator it = m_partitions.begin (); it != m_partitions.end (); ++it)
+    {
+      Partition *partition = *it;
+      Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler> ();
+      if (partition->events != 0)
+        {
+          while (!partition->events->IsEmpty ())
+            {
+              scheduler->Insert (partition->events->RemoveNext ());
+            }
+        }
+      partition->events = scheduler;
+    }
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::GetPartition (uint32_t context) const
+{
+  // Contexts which are not node ids (e.g., NO_CONTEXT) belong to partition 0
+  if (context < m_partitionOf.size ())
+    {
+      return m_partitions[m_partitionOf[context]];
+    }
+  return m_partitions[0];
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::GetCurrentPartition (void) const
+{
+  return g_current != 0 ? g_current : m_partitions[0];
+}
+
+void
+MultithreadedSimulatorImpl::CreatePartitions (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (m_schedulerFactory.IsTypeIdSet (), "No scheduler set");
+
+  uint32_t nPartitions = m_partitions.size ();
+  m_partitionOf.resize (NodeList::GetNNodes ());
+  for (uint32_t i = 0; i < m_partitionOf.size (); ++i)
+    {
+      m_partitionOf[i] = NodeList::GetNode (i)->GetSystemId ();
+      nPartitions = std::max (nPartitions, m_partitionOf[i] + 1);
+    }
+
+  // The uids of the events are only unique within a partition: start the
+  // new ones after all the uids allocated so far
+  uint32_t uid = 0;
+  for (std::vector<Partition *>::iterator it = m_partitions.begin (); it != m_partitions.end (); ++it)
+    {
+      uid = std::max (uid, (*it)->uid);
+    }
+  while (m_partitions.size () < nPartitions)
+    {
+      Partition *partition = new Partition;
+      partition->simulator = this;
+      partition->id = m_partitions.size ();
+      partition->events = m_schedulerFactory.Create<Scheduler> ();
+      partition->currentUid = 0;
+      partition->currentTs = m_currentTs;
+      partition->currentContext = Simulator::NO_CONTEXT;
+      partition->eventCount = 0;
+      partition->unscheduledEvents = 0;
+      partition->stop = false;
+      partition->nextTs = NO_EVENT;
+      partition->sentTs = NO_EVENT;
+      partition->phase = 0;
+      m_partitions.push_back (partition);
+    }
+  for (std::vector<Partition *>::iterator it = m_partitions.begin (); it != m_partitions.end (); ++it)
+    {
+      Partition *partition = *it;
+      partition->uid = uid;
+      partition->inbox[0].resize (m_partitions.size ());
+      partition->inbox[1].resize (m_partitions.size ());
+    }
+
+  // Move the events scheduled before the partitions were known, keeping
+  // their uids so that their EventIds remain valid
+  for (std::vector<Partition *>::iterator it = m_partitions.begin (); it != m_partitions.end (); ++it)
+    {
+      Partition *partition = *it;
+      std::vector<Scheduler::Event> events;
+      while (!partition->events->IsEmpty ())
+        {
+          events.push_back (partition->events->RemoveNext ());
+        }
+      partition->unscheduledEvents -= events.size ();
+      for (std::vector<Scheduler::Event>::const_iterator ev = events.begin (); ev != events.end (); ++ev)
+        {
+          Partition *destination = GetPartition (ev->key.m_context);
+          destination->events->Insert (*ev);
+          destination->unscheduledEvents++;
+        }
+    }
+
+  CalculateLookAhead ();
+  NS_LOG_INFO (m_partitions.size () << " partitions, lookahead " << GetLookAhead ());
+}
+
+void
+MultithreadedSimulatorImpl::CalculateLookAhead (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_lookAhead = NO_EVENT;
+  for (NodeList::Iterator iter = NodeList::Begin (); iter != NodeList::End (); ++iter)
+    {
+      Ptr<Node> node = *iter;
+      for (uint32_t i = 0; i < node->GetNDevices (); ++i)
+        {
+          Ptr<NetDevice> localNetDevice = node->GetDevice (i);
+          Ptr<Channel> channel = localNetDevice->GetChannel ();
+          if (channel == 0)
+            {
+              continue;
+            }
+          for (std::size_t j = 0; j < channel->GetNDevices (); ++j)
+            {
+              Ptr<Node> remoteNode = channel->GetDevice (j)->GetNode ();
+              if (remoteNode == 0 || remoteNode->GetSystemId () == node->GetSystemId ())
+                {
+                  continue;
+                }
+              TimeValue delay;
+              if (!localNetDevice->IsPointToPoint ()
+                  || !channel->GetAttributeFailSafe ("Delay", delay))
+                {
+                  NS_FATAL_ERROR ("Nodes " << node->GetId () << " and " << remoteNode->GetId ()
+                                  << " are in different partitions but not connected by a point-to-point link");
+                }
+              if (!delay.Get ().IsStrictlyPositive ())
+                {
+                  NS_FATAL_ERROR ("The link between nodes " << node->GetId () << " and " << remoteNode->GetId ()
+                                  << ", in different partitions, has no delay");
+                }
+              m_lookAhead = std::min (m_lookAhead, static_cast<uint64_t> (delay.Get ().GetTimeStep ()));
+            }
+        }
+    }
+}
+
+Time
+MultithreadedSimulatorImpl::GetLookAhead (void) const
+{
+  return m_lookAhead == NO_EVENT ? GetMaximumSimulationTime () : TimeStep (m_lookAhead);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetNPartitions (void) const
+{
+  return m_partitions.size ();
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId (void) const
+{
+  return g_current != 0 ? g_current->id : 0;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::Insert (Partition *partition, uint64_t ts, uint32_t context, EventImpl *event)
+{
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = ts;
+  ev.key.m_context = context;
+  ev.key.m_uid = partition->uid;
+  partition->uid++;
+  partition->unscheduledEvents++;
+  partition->events->Insert (ev);
+  return ev.key.m_uid;
+}
+
+void
+MultithreadedSimulatorImpl::ReceiveEvents (Partition *partition, uint32_t phase)
+{
+  // Insert the events in the order of the partitions which sent them, so
+  // that their uids do not depend on the scheduling of the threads
+  std::vector<EventsWithContext> &inbox = partition->inbox[phase];
+  for (std::vector<EventsWithContext>::iterator it = inbox.begin (); it != inbox.end (); ++it)
+    {
+      for (EventsWithContext::const_iterator ev = it->begin (); ev != it->end (); ++ev)
+        {
+          Insert (partition, ev->timestamp, ev->context, ev->event);
+        }
+      it->clear ();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::ProcessOneEvent (Partition *partition)
+{
+  Scheduler::Event next = partition->events->RemoveNext ();
+
+  NS_ASSERT (next.key.m_ts >= partition->currentTs);
+  partition->unscheduledEvents--;
+  partition->eventCount++;
+
+  NS_LOG_LOGIC ("handle " << next.key.m_ts);
+  partition->currentTs = next.key.m_ts;
+  partition->currentContext = next.key.m_context;
+  partition->currentUid = next.key.m_uid;
+  next.impl->Invoke ();
+  next.impl->Unref ();
+}
+
+void
+MultithreadedSimulatorImpl::Synchronize (void)
+{
+  uint32_t generation = m_generation.load (std::memory_order_acquire);
+  if (m_arrived.fetch_add (1, std::memory_order_acq_rel) + 1 == m_partitions.size ())
+    {
+      ComputeWindow ();
+      m_arrived.store (0, std::memory_order_relaxed);
+      m_generation.store (generation + 1, std::memory_order_release);
+      return;
+    }
+  uint32_t spins = 0;
+  while (m_generation.load (std::memory_order_acquire) == generation)
+    {
+      // The window of the other partitions is usually about to end:
+      // only give the processor up if it takes long
+      if (++spins > BARRIER_SPINS)
+        {
+          std::this_thread::yield ();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::ComputeWindow (void)
+{
+  uint64_t next = NO_EVENT;
+  bool stop = false;
+  for (std::vector<Partition *>::const_iterator it = m_partitions.begin (); it != m_partitions.end (); ++it)
+    {
+      next = std::min (next, (*it)->nextTs);
+      stop = stop || (*it)->stop;
+    }
+  if (stop || next == NO_EVENT || next > m_stopTs)
+    {
+      m_done = true;
+      return;
+    }
+  // No event sent during the window can be earlier than its end
+  m_windowEnd = (next > NO_EVENT - m_lookAhead) ? NO_EVENT : next + m_lookAhead;
+  if (m_stopTs != NO_EVENT)
+    {
+      m_windowEnd = std::min (m_windowEnd, m_stopTs + 1);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::RunPartition (Partition *partition)
+{
+  MultithreadedSimulatorImpl *simulator = partition->simulator;
+  g_current = partition;
+  while (true)
+    {
+      // Publish the earliest event this partition may have to execute in
+      // the next window
+      partition->nextTs = partition->events->IsEmpty () ? NO_EVENT : partition->events->PeekNext ().key.m_ts;
+      partition->nextTs = std::min (partition->nextTs, partition->sentTs);
+      partition->sentTs = NO_EVENT;
+
+      simulator->Synchronize ();
+      if (simulator->m_done)
+        {
+          break;
+        }
+
+      // The senders have moved on to the other list
+      uint32_t previous = partition->phase;
+      partition->phase = 1 - previous;
+      ReceiveEvents (partition, previous);
+
+      uint64_t windowEnd = simulator->m_windowEnd;
+      while (!partition->stop
+             && !partition->events->IsEmpty ()
+             && partition->events->PeekNext ().key.m_ts < windowEnd)
+        {
+          ProcessOneEvent (partition);
+        }
+    }
+  g_current = 0;
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished (void) const
+{
+  if (m_stop)
+    {
+      return true;
+    }
+  for (std::vector<Partition *>::const_iterator it = m_partitions.begin (); it != m_partitions.end (); ++it)
+    {
+      if (!(*it)->events->IsEmpty ())
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+MultithreadedSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  CreatePartitions ();
+  m_stop = false;
+  m_done = false;
+  for (std::vector<Partition *>::iterator it = m_partitions.begin (); it != m_partitions.end (); ++it)
+    {
+      (*it)->stop = false;
+    }
+
+  // Partition 0 is run by the calling thread
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 1; i < m_partitions.size (); ++i)
+    {
+      Ptr<SystemThread> thread = Create<SystemThread> (MakeBoundCallback (&MultithreadedSimulatorImpl::RunPartition,
+                                                                          m_partitions[i]));
+      thread->Start ();
+      threads.push_back (thread);
+    }
+  RunPartition (m_partitions[0]);
+  for (std::vector<Ptr<SystemThread> >::iterator it = threads.begin (); it != threads.end (); ++it)
+    {
+      (*it)->Join ();
+    }
+
+  // Deliver the events sent during the last window, for a later Run
+  for (std::vector<Partition *>::iterator it = m_partitions.begin (); it != m_partitions.end (); ++it)
+    {
+      Partition *partition = *it;
+      ReceiveEvents (partition, 0);
+      ReceiveEvents (partition, 1);
+      partition->phase = 0;
+      m_currentTs = std::max (m_currentTs, partition->currentTs);
+      m_stop = m_stop || partition->stop;
+    }
+  if (m_partitions[0]->currentTs >= m_stopTs)
+    {
+      m_stopTs = NO_EVENT;
+    }
+
+  // If the simulator stopped naturally by lack of events, make a
+  // consistency test to check that we didn't lose any events along the way.
+  for (std::vector<Partition *>::const_iterator it = m_partitions.begin (); it != m_partitions.end (); ++it)
+    {
+      NS_ASSERT (!(*it)->events->IsEmpty () || (*it)->unscheduledEvents == 0);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (g_current != 0)
+    {
+      g_current->stop = true;
+    }
+  else
+    {
+      m_stop = true;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Stop (Time const &delay)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep ());
+  if (g_current == 0)
+    {
+      // Known to all the partitions, which then stop at the same time
+      m_stopTs = std::min (m_stopTs, m_currentTs + delay.GetTimeStep ());
+    }
+  Simulator::Schedule (delay, &Simulator::Stop);
+}
+
+//
+// Schedule an event for a _relative_ time in the future.
+//
+EventId
+MultithreadedSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep () << event);
+  NS_ASSERT_MSG (delay.IsPositive (), "MultithreadedSimulatorImpl::Schedule(): Negative delay");
+
+  Partition *partition = GetCurrentPartition ();
+  uint64_t now = g_current != 0 ? partition->currentTs : m_currentTs;
+  uint64_t ts = now + delay.GetTimeStep ();
+  uint32_t uid = Insert (partition, ts, partition->currentContext, event);
+  return EventId (event, ts, partition->currentContext, uid);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << context << delay.GetTimeStep () << event);
+  NS_ASSERT_MSG (delay.IsPositive (), "MultithreadedSimulatorImpl::ScheduleWithContext(): Negative delay");
+
+  Partition *partition = GetPartition (context);
+  if (g_current == 0 || g_current == partition)
+    {
+      uint64_t now = g_current != 0 ? partition->currentTs : m_currentTs;
+      Insert (partition, now + delay.GetTimeStep (), context, event);
+      return;
+    }
+
+  // The event belongs to another partition, which receives it at the
+  // start of the next window: the delay must cover the current one
+  if (static_cast<uint64_t> (delay.GetTimeStep ()) < m_lookAhead)
+    {
+      NS_FATAL_ERROR ("Event scheduled from partition " << g_current->id << " to partition "
+                      << partition->id << " with a delay of " << delay
+                      << ", shorter than the lookahead " << GetLookAhead ());
+    }
+  EventWithContext ev;
+  ev.context = context;
+  ev.timestamp = g_current->currentTs + delay.GetTimeStep ();
+  ev.event = event;
+  partition->inbox[g_current->phase][g_current->id].push_back (ev);
+  g_current->sentTs = std::min (g_current->sentTs, ev.timestamp);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  Partition *partition = GetCurrentPartition ();
+  uint64_t now = g_current != 0 ? partition->currentTs : m_currentTs;
+  uint32_t uid = Insert (partition, now, partition->currentContext, event);
+  return EventId (event, now, partition->currentContext, uid);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  EventId id (Ptr<EventImpl> (event, false), Now ().GetTimeStep (), 0xffffffff, 2);
+  CriticalSection cs (m_destroyEventsMutex);
+  m_destroyEvents.push_back (id);
+  return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now (void) const
+{
+  // Do not add function logging here, to avoid stack overflow
+  return TimeStep (g_current != 0 ? g_current->currentTs : m_currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  else
+    {
+      return TimeStep (id.GetTs () - Now ().GetTimeStep ());
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+      CriticalSection cs (m_destroyEventsMutex);
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  if (IsExpired (id))
+    {
+      return;
+    }
+  Partition *partition = GetPartition (id.GetContext ());
+  NS_ASSERT_MSG (g_current == 0 || g_current == partition, "Event removed from another partition");
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  partition->events->Remove (event);
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+
+  partition->unscheduledEvents--;
+}
+
+void
+MultithreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired (const EventId &id) const
+{
+  if (id.GetUid () == 2)
+    {
+      if (id.PeekEventImpl () == 0 ||
+          id.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      CriticalSection cs (const_cast<SystemMutex &> (m_destroyEventsMutex));
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  const Partition *partition = GetPartition (id.GetContext ());
+  if (id.PeekEventImpl () == 0 ||
+      id.GetTs () < partition->currentTs ||
+      (id.GetTs () == partition->currentTs &&
+       id.GetUid () <= partition->currentUid) ||
+      id.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  else
+    {
+      return false;
+    }
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return TimeStep (0x7fffffffffffffffLL);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext (void) const
+{
+  return GetCurrentPartition ()->currentContext;
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetEventCount (void) const
+{
+  if (g_current != 0)
+    {
+      return g_current->eventCount;
+    }
+  uint64_t count = 0;
+  for (std::vector<Partition *>::const_iterator it = m_partitions.begin (); it != m_partitions.end (); ++it)
+    {
+      count += (*it)->eventCount;
+    }
+  return count;
+}
+
+} // namespace ns3
@@ -0,0 +1,234 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_MULTITHREADED_SIMULATOR_IMPL_H
+#define NS3_MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "ns3/simulator-impl.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/object-factory.h"
+#include "ns3/system-mutex.h"
+#include "ns3/ptr.h"
+
+#include <atomic>
+#include <list>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ * \ingroup mpi
+ *
+ * \brief Parallel simulator implementation running the partitions of the
+ * nodes in threads of the same process
+ *
+ * The nodes are partitioned by their system id, as with the
+ * DistributedSimulatorImpl, but every partition is run by a thread of the
+ * calling process instead of an MPI rank: partition 0 by the thread
+ * calling Simulator::Run, the others by threads started by Run. Nodes of
+ * different partitions may only be connected by point-to-point links,
+ * whose packets are handed over to the destination partition as pointers
+ * to deep copies (see Packet::DeepCopy), without serialization.
+ *
+ * The partitions are synchronized conservatively, by time windows whose
+ * length is the lookahead, the smallest delay of the point-to-point links
+ * connecting different partitions: at the start of every window, all
+ * threads wait for each other and agree on the earliest pending event of
+ * all partitions, T; then, every partition executes its events earlier
+ * than T + lookahead, which no event of another partition in the window
+ * can precede. The events sent to other partitions are delivered at the
+ * start of the next window, in the order of the partitions which sent
+ * them, so that a simulation gives the same results whatever the
+ * scheduling of the threads.
+ *
+ * Within a partition, the events are executed in the same order as with
+ * the DefaultSimulatorImpl, and a simulation whose nodes are all in the
+ * same partition gives the same results. With more partitions, the events
+ * scheduled at the same time in different partitions may be executed in a
+ * different order.
+ *
+ * The models run by a partition may only touch the objects of the nodes
+ * of this partition: objects shared by nodes of different partitions
+ * (e.g., a FlowMonitor, or a trace sink counting the packets of all the
+ * nodes) need to be made thread safe by the user, and the
+ * TxRxPointToPoint trace of a point-to-point channel connecting different
+ * partitions must not be connected. Simulator::Stop (delay) called before
+ * Run stops all partitions exactly at the given time, while when called
+ * during the simulation, the other partitions only stop at the end of the
+ * window.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  MultithreadedSimulatorImpl ();
+  ~MultithreadedSimulatorImpl ();
+
+  // virtual from SimulatorImpl
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (Time const &delay);
+  virtual EventId Schedule (Time const &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &id);
+  virtual void Cancel (const EventId &id);
+  virtual bool IsExpired (const EventId &id) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+  virtual uint64_t GetEventCount (void) const;
+
+  /**
+   * \return the lookahead computed by the last call to Run
+   */
+  Time GetLookAhead (void) const;
+  /**
+   * \return the number of partitions (and threads) of the last call to Run
+   */
+  uint32_t GetNPartitions (void) const;
+
+private:
+  virtual void DoDispose (void);
+
+  /** An event sent to another partition. */
+  struct EventWithContext
+  {
+    uint32_t context;   //!< The event context
+    uint64_t timestamp; //!< The absolute event timestamp
+    EventImpl *event;   //!< The event implementation
+  };
+  /** The events sent by a partition to another during a window. */
+  typedef std::vector<struct EventWithContext> EventsWithContext;
+
+  /** The state of a partition, only used by the thread running it. */
+  struct Partition
+  {
+    MultithreadedSimulatorImpl *simulator; //!< The simulator
+    uint32_t id;                 //!< The partition (and system) id
+    Ptr<Scheduler> events;       //!< The event list
+    uint32_t uid;                //!< Next event unique id
+    uint32_t currentUid;         //!< Unique id of the current event
+    uint64_t currentTs;          //!< Timestamp of the current event
+    uint32_t currentContext;     //!< Execution context of the current event
+    uint64_t eventCount;         //!< Number of events executed
+    int unscheduledEvents;       //!< Number of events inserted but not executed
+    bool stop;                   //!< Whether Stop was called by the partition
+    uint64_t nextTs;             //!< Earliest event published at the end of a window
+    uint64_t sentTs;             //!< Earliest event sent during the window
+    uint32_t phase;              //!< Parity of the current window
+    /**
+     * The events received from every other partition, for the even and
+     * odd windows: the events sent during a window are written by the
+     * sender to the list of the parity of the window, and read by the
+     * destination at the start of the next window.
+     */
+    std::vector<EventsWithContext> inbox[2];
+  };
+
+  /**
+   * \param context an event context
+   * \return the partition running the events of the context
+   */
+  Partition *GetPartition (uint32_t context) const;
+  /**
+   * \return the partition of the calling thread, or the partition of
+   * the events without context outside Run
+   */
+  Partition *GetCurrentPartition (void) const;
+  /**
+   * \brief Map the nodes to their partition, create the partitions and
+   * move every pending event to the partition of its context
+   */
+  void CreatePartitions (void);
+  /**
+   * \brief Compute the lookahead from the delays of the point-to-point
+   * links connecting different partitions
+   */
+  void CalculateLookAhead (void);
+  /**
+   * \brief Insert an event into the event list of a partition
+   * \param partition the partition
+   * \param ts the absolute timestamp of the event
+   * \param context the event context
+   * \param event the event implementation
+   * \return the unique id of the event
+   */
+  static uint32_t Insert (Partition *partition, uint64_t ts, uint32_t context, EventImpl *event);
+  /**
+   * \brief Insert the events received by a partition during a window
+   * \param partition the partition
+   * \param phase the parity of the window
+   */
+  static void ReceiveEvents (Partition *partition, uint32_t phase);
+  /**
+   * \brief Execute the next event of a partition
+   * \param partition the partition
+   */
+  static void ProcessOneEvent (Partition *partition);
+  /**
+   * \brief Run the windows of a partition until the simulation ends
+   * \param partition the partition
+   */
+  static void RunPartition (Partition *partition);
+  /**
+   * \brief Wait for all the partitions to end the current window; the
+   * last one to arrive computes the next window
+   */
+  void Synchronize (void);
+  /**
+   * \brief Compute the end of the next window from the earliest events
+   * published by the partitions
+   */
+  void ComputeWindow (void);
+
+  typedef std::list<EventId> DestroyEvents; //!< Container type for the events to run at Simulator::Destroy()
+  DestroyEvents m_destroyEvents;  //!< The container of events to run at Destroy
+  SystemMutex m_destroyEventsMutex; //!< Protects m_destroyEvents
+  bool m_stop;                    //!< Whether Stop was called outside Run, or by the last Run
+  uint64_t m_stopTs;              //!< Time given to Stop before Run
+  uint64_t m_currentTs;           //!< Time reached by the last Run
+  ObjectFactory m_schedulerFactory; //!< Factory of the event lists
+
+  std::vector<Partition *> m_partitions; //!< The partitions
+  std::vector<uint32_t> m_partitionOf;   //!< The partition of every node id
+  uint64_t m_lookAhead;                  //!< The lookahead, in time steps
+
+  std::atomic<uint32_t> m_arrived;    //!< Number of partitions at the barrier
+  std::atomic<uint32_t> m_generation; //!< Number of windows computed
+  uint64_t m_windowEnd;               //!< End (excluded) of the current window
+  bool m_done;                        //!< Whether the simulation has ended
+
+  /** The partition run by the calling thread during Run. */
+  static thread_local Partition *g_current;
+};
+
+} // namespace ns3
+
+#endif /* NS3_MULTITHREADED_SIMULATOR_IMPL_H */
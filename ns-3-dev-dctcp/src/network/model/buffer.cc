@@ -18,6 +18,7 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "buffer.h"
+#include "packet-pool.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
 
@@ -50,96 +51,30 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("Buffer");
 
 
-uint32_t Buffer::g_recommendedStart = 0;
+thread_local uint32_t Buffer::g_recommendedStart = 0;
 #ifdef BUFFER_FREE_LIST
-/* The following macros are pretty evil but they are needed to allow us to
- * keep track of 3 possible states for the g_freeList variable:
- *  - uninitialized means that no one has created a buffer yet
- *    so no one has created the associated free list (it is created
- *    on-demand when the first buffer is created)
- *  - initialized means that the free list exists and is valid
- *  - destroyed means that the static destructors of this compilation unit
- *    have run so, the free list has been cleared from its content
- * The key is that in destroyed state, we are careful not re-create it
- * which is a typical weakness of lazy evaluation schemes which use 
- * '0' as a special value to indicate both un-initialized and destroyed.
- * Note that it is important to use '0' as the marker for un-initialized state
- * because the variable holding this state information is initialized to zero
- * which the compiler assigns to zero-memory which is initialized to _zero_
- * before the constructors run so this ensures perfect handling of crazy 
- * constructor orderings.
- */
-#define MAGIC_DESTROYED (~(long) 0)
-#define IS_UNINITIALIZED(x) (x == (Buffer::FreeList*)0)
-#define IS_DESTROYED(x) (x == (Buffer::FreeList*)MAGIC_DESTROYED)
-#define IS_INITIALIZED(x) (!IS_UNINITIALIZED (x) && !IS_DESTROYED (x))
-#define DESTROYED ((Buffer::FreeList*)MAGIC_DESTROYED)
-#define UNINITIALIZED ((Buffer::FreeList*)0)
-uint32_t Buffer::g_maxSize = 0;
-Buffer::FreeList *Buffer::g_freeList = 0;
-struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
-
-Buffer::LocalStaticDestructor::~LocalStaticDestructor(void)
-{
-  NS_LOG_FUNCTION (this);
-  if (IS_INITIALIZED (g_freeList))
-    {
-      for (Buffer::FreeList::iterator i = g_freeList->begin ();
-           i != g_freeList->end (); i++)
-        {
-          Buffer::Deallocate (*i);
-        }
-      delete g_freeList;
-      g_freeList = DESTROYED;
-    }
-}
-
 void
 Buffer::Recycle (struct Buffer::Data *data)
 {
   NS_LOG_FUNCTION (data);
   NS_ASSERT (data->m_count == 0);
-  NS_ASSERT (!IS_UNINITIALIZED (g_freeList));
-  g_maxSize = std::max (g_maxSize, data->m_size);
-  /* feed into free list */
-  if (data->m_size < g_maxSize ||
-      IS_DESTROYED (g_freeList) ||
-      g_freeList->size () > 1000)
-    {
-      Buffer::Deallocate (data);
-    }
-  else
-    {
-      NS_ASSERT (IS_INITIALIZED (g_freeList));
-      g_freeList->push_back (data);
-    }
+  PacketPool::Deallocate (data, data->m_size - 1 + sizeof (struct Buffer::Data));
 }
 
 Buffer::Data *
 Buffer::Create (uint32_t dataSize)
 {
   NS_LOG_FUNCTION (dataSize);
-  /* try to find a buffer correctly sized. */
-  if (IS_UNINITIALIZED (g_freeList))
-    {
-      g_freeList = new Buffer::FreeList ();
-    }
-  else if (IS_INITIALIZED (g_freeList))
+  if (dataSize == 0)
     {
-      while (!g_freeList->empty ()) 
-        {
-          struct Buffer::Data *data = g_freeList->back ();
-          g_freeList->pop_back ();
-          if (data->m_size >= dataSize) 
-            {
-              data->m_count = 1;
-              return data;
-            }
-          Buffer::Deallocate (data);
-        }
+      dataSize = 1;
     }
-  struct Buffer::Data *data = Buffer::Allocate (dataSize);
-  NS_ASSERT (data->m_count == 1);
+  /* use the whole block of the pool: the room left lets the buffer grow
+   * without being reallocated. */
+  std::size_t size = PacketPool::GetBlockSize (dataSize - 1 + sizeof (struct Buffer::Data));
+  struct Buffer::Data *data = static_cast<struct Buffer::Data *> (PacketPool::Allocate (size));
+  data->m_size = size + 1 - sizeof (struct Buffer::Data);
+  data->m_count = 1;
   return data;
 }
 #else /* BUFFER_FREE_LIST */
@@ -244,7 +179,7 @@ void
 Buffer::Initialize (uint32_t zeroSize)
 {
   NS_LOG_FUNCTION (this << zeroSize);
-  m_data = Buffer::Create (0);
+  m_data = Buffer::Create (g_recommendedStart);
   m_start = std::min (m_data->m_size, g_recommendedStart);
   m_maxZeroAreaStart = m_start;
   m_zeroAreaStart = m_start;
@@ -527,6 +462,26 @@ Buffer::CreateFragment (uint32_t start, uint32_t length) const
   return tmp;
 }
 
+void
+Buffer::Unshare (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (CheckInternalState ());
+  if (m_data->m_count == 1)
+    {
+      return;
+    }
+  // Keep the same offsets, so that only the data needs to be copied
+  struct Buffer::Data *data = Buffer::Create (m_data->m_size);
+  uint32_t end = m_end - (m_zeroAreaEnd - m_zeroAreaStart);
+  memcpy (data->m_data + m_start, m_data->m_data + m_start, end - m_start);
+  data->m_dirtyStart = m_data->m_dirtyStart;
+  data->m_dirtyEnd = m_data->m_dirtyEnd;
+  m_data->m_count--;
+  m_data = data;
+  NS_ASSERT (CheckInternalState ());
+}
+
 Buffer 
 Buffer::CreateFullCopy (void) const
 {
@@ -555,6 +555,17 @@ private:
    */
   Buffer CreateFragment (uint32_t start, uint32_t length) const;
 
+  /**
+   * \brief Give this Buffer its own copy of the data it shares with
+   * other Buffer instances, if any.
+   *
+   * Copies of a Buffer share their data until one of them is written
+   * to. Once unshared, the Buffer can be handed over to another thread.
+   * Any call to this method invalidates any Iterator
+   * pointing to this Buffer.
+   */
+  void Unshare (void);
+
   /**
    * \return an Iterator which points to the
    * start of this Buffer.
@@ -767,7 +778,7 @@ private:
    * writing data. i.e., m_start should be initialized to this 
    * value.
    */
-  static uint32_t g_recommendedStart;
+  static thread_local uint32_t g_recommendedStart;
 
   /**
    * offset to the start of the virtual zero area from the start
@@ -790,18 +801,6 @@ private:
    */
   uint32_t m_end;
 
-#ifdef BUFFER_FREE_LIST
-  /// Container for buffer data
-  typedef std::vector<struct Buffer::Data*> FreeList;
-  /// Local static destructor structure
-  struct LocalStaticDestructor 
-  {
-    ~LocalStaticDestructor ();
-  };
-  static uint32_t g_maxSize; //!< Max observed data size
-  static FreeList *g_freeList; //!< Buffer data container
-  static struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
-#endif
 };
 
 } // namespace ns3
@@ -51,14 +51,17 @@ struct ByteTagListData {
  *
  * \brief Container class for struct ByteTagListData
  *
- * Internal use only.
+ * Internal use only. Every thread has its own free list, released when
+ * the thread exits.
  */
-static class ByteTagListDataFreeList : public std::vector<struct ByteTagListData *>
+static thread_local class ByteTagListDataFreeList : public std::vector<struct ByteTagListData *>
 {
 public:
   ~ByteTagListDataFreeList ();
 } g_freeList; //!< Container for struct ByteTagListData
-static uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
+static thread_local uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
+/// Whether g_freeList has been destroyed (at the exit of the thread)
+static thread_local bool g_freeListDestroyed = false;
 
 ByteTagListDataFreeList::~ByteTagListDataFreeList ()
 {
@@ -69,6 +72,7 @@ ByteTagListDataFreeList::~ByteTagListDataFreeList ()
       uint8_t *buffer = (uint8_t *)(*i);
       delete [] buffer;
     }
+  g_freeListDestroyed = true;
 }
 #endif /* USE_FREE_LIST */
 
@@ -251,6 +255,21 @@ ByteTagList::RemoveAll (void)
   m_used = 0;
 }
 
+void
+ByteTagList::Unshare (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_data == 0 || m_data->count == 1)
+    {
+      return;
+    }
+  struct ByteTagListData *newData = Allocate (m_data->size);
+  std::memcpy (&newData->data, &m_data->data, m_used);
+  newData->dirty = m_used;
+  Deallocate (m_data);
+  m_data = newData;
+}
+
 ByteTagList::Iterator 
 ByteTagList::BeginAll (void) const
 {
@@ -345,7 +364,7 @@ struct ByteTagListData *
 ByteTagList::Allocate (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
-  while (!g_freeList.empty ())
+  while (!g_freeListDestroyed && !g_freeList.empty ())
     {
       struct ByteTagListData *data = g_freeList.back ();
       g_freeList.pop_back ();
@@ -379,7 +398,8 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
   data->count--;
   if (data->count == 0)
     {
-      if (g_freeList.size () > FREE_LIST_SIZE ||
+      if (g_freeListDestroyed ||
+          g_freeList.size () > FREE_LIST_SIZE ||
           data->size < g_maxSize)
         {
           uint8_t *buffer = (uint8_t *)data;
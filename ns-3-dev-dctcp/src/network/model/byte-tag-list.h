@@ -194,6 +194,13 @@ private:
    */ 
   void RemoveAll (void);
 
+  /**
+   * Give this ByteTagList its own copy of the tags it shares with other
+   * ByteTagList instances, if any, so that it can be handed over to
+   * another thread.
+   */
+  void Unshare (void);
+
   /**
    * \param offsetStart the offset which uniquely identifies the first data byte 
    *        present in the byte buffer associated to this ByteTagList.
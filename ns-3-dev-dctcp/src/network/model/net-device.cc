@@ -20,6 +20,7 @@
 
 #include "ns3/log.h"
 #include "net-device.h"
+#include "ns3/queue-item.h"
 
 namespace ns3 {
 
@@ -41,4 +42,19 @@ NetDevice::~NetDevice ()
   NS_LOG_FUNCTION (this);
 }
 
+uint32_t
+NetDevice::SendBurst (const std::vector<Ptr<QueueDiscItem> > &items)
+{
+  NS_LOG_FUNCTION (this << items.size ());
+  uint32_t nSent = 0;
+  for (std::vector<Ptr<QueueDiscItem> >::const_iterator it = items.begin (); it != items.end (); ++it)
+    {
+      if (Send ((*it)->GetPacket (), (*it)->GetAddress (), (*it)->GetProtocol ()))
+        {
+          nSent++;
+        }
+    }
+  return nSent;
+}
+
 } // namespace ns3
@@ -22,6 +22,7 @@
 #define NET_DEVICE_H
 
 #include <stdint.h>
+#include <vector>
 #include "ns3/callback.h"
 #include "ns3/object.h"
 #include "ns3/ptr.h"
@@ -34,6 +35,7 @@ namespace ns3 {
 
 class Node;
 class Channel;
+class QueueDiscItem;
 
 /**
  * \ingroup network
@@ -260,6 +262,19 @@ public:
    * \return whether the Send operation succeeded 
    */
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber) = 0;
+  /**
+   * \param items the packets sent from above down to Network Device, along
+   *        with their destination address and protocol number
+   *
+   *  Called from the queue discs to send a burst of packets into the Network
+   *  Device in a single call, as the Linux bulk dequeue does by setting the
+   *  xmit_more flag.  The queue disc makes sure that the device queue has
+   *  room for the whole burst.  The default implementation calls Send for
+   *  each packet; devices may override it to process the burst at once.
+   *
+   * \return the number of packets whose Send operation succeeded
+   */
+  virtual uint32_t SendBurst (const std::vector<Ptr<QueueDiscItem> > &items);
   /**
    * \returns the node base class which contains this network
    *          interface.
@@ -33,10 +33,12 @@ NS_LOG_COMPONENT_DEFINE ("PacketMetadata");
 
 bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
+bool PacketMetadata::m_enableCompact = false;
 bool PacketMetadata::m_metadataSkipped = false;
-uint32_t PacketMetadata::m_maxSize = 0;
-uint16_t PacketMetadata::m_chunkUid = 0;
-PacketMetadata::DataFreeList PacketMetadata::m_freeList;
+thread_local uint32_t PacketMetadata::m_maxSize = 0;
+thread_local uint16_t PacketMetadata::m_chunkUid = 0;
+thread_local PacketMetadata::DataFreeList PacketMetadata::m_freeList;
+thread_local bool PacketMetadata::m_freeListDestroyed = false;
 
 PacketMetadata::DataFreeList::~DataFreeList ()
 {
@@ -45,7 +47,7 @@ PacketMetadata::DataFreeList::~DataFreeList ()
     {
       PacketMetadata::Deallocate (*i);
     }
-  PacketMetadata::m_enable = false;
+  PacketMetadata::m_freeListDestroyed = true;
 }
 
 void 
@@ -70,6 +72,204 @@ PacketMetadata::EnableChecking (void)
   m_enableChecking = true;
 }
 
+void
+PacketMetadata::EnableCompact (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Enable ();
+  m_enableCompact = true;
+}
+
+/**
+ * \param value a signed value
+ * \returns the value mapped to an unsigned one, the small negative values
+ * to small numbers so that their uleb128 encoding is short
+ */
+static uint64_t
+ZigZagEncode (int64_t value)
+{
+  return (static_cast<uint64_t> (value) << 1) ^ static_cast<uint64_t> (value >> 63);
+}
+
+/**
+ * \param value a value returned by ZigZagEncode
+ * \returns the signed value
+ */
+static int64_t
+ZigZagDecode (uint64_t value)
+{
+  return static_cast<int64_t> (value >> 1) ^ -static_cast<int64_t> (value & 0x1);
+}
+
+uint32_t
+PacketMetadata::AppendCompactValue (uint64_t value, uint8_t *buffer)
+{
+  uint32_t n = 0;
+  while (value >= 0x80)
+    {
+      buffer[n] = 0x80 | (value & 0x7f);
+      value >>= 7;
+      n++;
+    }
+  buffer[n] = value;
+  return n + 1;
+}
+
+uint64_t
+PacketMetadata::ReadCompactValue (const uint8_t **pBuffer)
+{
+  const uint8_t *buffer = *pBuffer;
+  uint64_t result = 0;
+  uint32_t shift = 0;
+  uint8_t byte;
+  do
+    {
+      byte = *buffer;
+      result |= static_cast<uint64_t> (byte & 0x7f) << shift;
+      shift += 7;
+      buffer++;
+    }
+  while (byte & 0x80);
+  *pBuffer = buffer;
+  return result;
+}
+
+uint16_t
+PacketMetadata::ReadCompactItem (uint16_t current,
+                                 struct PacketMetadata::SmallItem *item,
+                                 struct PacketMetadata::ExtraItem *extraItem) const
+{
+  NS_LOG_FUNCTION (this << current);
+  NS_ASSERT (IsCompact () && current < m_compactUsed);
+  const uint8_t *buffer = &m_compact[current];
+  uint64_t type = ReadCompactValue (&buffer);
+  uint32_t typeUid = (item->typeUid >> 1) + ZigZagDecode (type >> 1);
+  item->next = 0xffff;
+  item->prev = 0xffff;
+  item->typeUid = typeUid << 1;
+  item->size = ReadCompactValue (&buffer);
+  item->chunkUid += ZigZagDecode (ReadCompactValue (&buffer));
+  if ((type & 0x1) == 0x1)
+    {
+      extraItem->fragmentStart = ReadCompactValue (&buffer);
+      extraItem->fragmentEnd = item->size - ReadCompactValue (&buffer);
+      extraItem->packetUid = m_packetUid + ZigZagDecode (ReadCompactValue (&buffer));
+    }
+  else
+    {
+      extraItem->fragmentStart = 0;
+      extraItem->fragmentEnd = item->size;
+      extraItem->packetUid = m_packetUid;
+    }
+  NS_ASSERT (buffer <= &m_compact[m_compactUsed]);
+  return buffer - &m_compact[0];
+}
+
+uint32_t
+PacketMetadata::ReadCompact (struct PacketMetadata::CompactItem *items) const
+{
+  NS_LOG_FUNCTION (this << items);
+  uint32_t n = 0;
+  uint16_t current = 0;
+  while (current < m_compactUsed)
+    {
+      NS_ASSERT (n < PACKET_METADATA_COMPACT_MAX_ITEMS);
+      struct PacketMetadata::SmallItem *item = &items[n].item;
+      item->typeUid = (n == 0) ? 0 : items[n - 1].item.typeUid;
+      item->chunkUid = (n == 0) ? 0 : items[n - 1].item.chunkUid;
+      current = ReadCompactItem (current, item, &items[n].extraItem);
+      n++;
+    }
+  return n;
+}
+
+void
+PacketMetadata::WriteCompact (const struct PacketMetadata::CompactItem *items, uint32_t n)
+{
+  NS_LOG_FUNCTION (this << items << n);
+  NS_ASSERT (IsCompact ());
+  // room for the largest item written past the end of the inline area
+  uint8_t buffer[PACKET_METADATA_COMPACT_SIZE + 40];
+  uint32_t used = 0;
+  uint32_t previousTypeUid = 0;
+  uint16_t previousChunkUid = 0;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      const struct PacketMetadata::SmallItem *item = &items[i].item;
+      const struct PacketMetadata::ExtraItem *extraItem = &items[i].extraItem;
+      uint32_t typeUid = item->typeUid >> 1;
+      bool isExtra = extraItem->fragmentStart != 0
+        || extraItem->fragmentEnd != item->size
+        || extraItem->packetUid != m_packetUid;
+      int64_t typeDelta = static_cast<int64_t> (typeUid) - previousTypeUid;
+      used += AppendCompactValue ((ZigZagEncode (typeDelta) << 1) | (isExtra ? 1 : 0),
+                                  &buffer[used]);
+      used += AppendCompactValue (item->size, &buffer[used]);
+      int16_t chunkDelta = static_cast<int16_t> (item->chunkUid - previousChunkUid);
+      used += AppendCompactValue (ZigZagEncode (chunkDelta), &buffer[used]);
+      if (isExtra)
+        {
+          used += AppendCompactValue (extraItem->fragmentStart, &buffer[used]);
+          used += AppendCompactValue (item->size - extraItem->fragmentEnd, &buffer[used]);
+          int64_t packetDelta = static_cast<int64_t> (extraItem->packetUid - m_packetUid);
+          used += AppendCompactValue (ZigZagEncode (packetDelta), &buffer[used]);
+        }
+      if (used > PACKET_METADATA_COMPACT_SIZE)
+        {
+          Inflate (items, n);
+          return;
+        }
+      previousTypeUid = typeUid;
+      previousChunkUid = item->chunkUid;
+    }
+  memcpy (m_compact, buffer, used);
+  m_compactUsed = used;
+}
+
+void
+PacketMetadata::Inflate (const struct PacketMetadata::CompactItem *items, uint32_t n)
+{
+  NS_ASSERT (IsCompact ());
+  m_data = PacketMetadata::Create (10);
+  memset (m_data->m_data, 0xff, 4);
+  m_head = 0xffff;
+  m_tail = 0xffff;
+  m_used = 0;
+  m_compactUsed = 0;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      struct PacketMetadata::SmallItem item = items[i].item;
+      const struct PacketMetadata::ExtraItem *extraItem = &items[i].extraItem;
+      item.next = 0xffff;
+      item.prev = m_tail;
+      uint16_t written;
+      if (extraItem->fragmentStart != 0
+          || extraItem->fragmentEnd != item.size
+          || extraItem->packetUid != m_packetUid)
+        {
+          written = AddBig (0xffff, m_tail, &item, extraItem);
+        }
+      else
+        {
+          written = AddSmall (&item);
+        }
+      UpdateTail (written);
+    }
+}
+
+void
+PacketMetadata::Inflate (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!IsCompact ())
+    {
+      return;
+    }
+  struct PacketMetadata::CompactItem items[PACKET_METADATA_COMPACT_MAX_ITEMS];
+  uint32_t n = ReadCompact (items);
+  Inflate (items, n);
+}
+
 void
 PacketMetadata::ReserveCopy (uint32_t size)
 {
@@ -133,6 +333,10 @@ bool
 PacketMetadata::IsStateOk (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (IsCompact ())
+    {
+      return m_compactUsed <= PACKET_METADATA_COMPACT_SIZE;
+    }
   bool ok = m_used <= m_data->m_size;
   ok &= IsPointerOk (m_head);
   ok &= IsPointerOk (m_tail);
@@ -505,6 +709,7 @@ PacketMetadata::ReplaceTail (PacketMetadata::SmallItem *item,
 
   // create a copy of the packet without its tail.
   PacketMetadata h (m_packetUid, 0);
+  h.Inflate ();
   uint16_t current = m_head;
   while (current != 0xffff && current != m_tail)
     {
@@ -575,7 +780,7 @@ PacketMetadata::Create (uint32_t size)
     {
       m_maxSize = size;
     }
-  while (!m_freeList.empty ()) 
+  while (!m_freeListDestroyed && !m_freeList.empty ()) 
     {
       struct PacketMetadata::Data *data = m_freeList.back ();
       m_freeList.pop_back ();
@@ -596,7 +801,7 @@ void
 PacketMetadata::Recycle (struct PacketMetadata::Data *data)
 {
   NS_LOG_FUNCTION (data);
-  if (!m_enable)
+  if (!m_enable || m_freeListDestroyed)
     {
       PacketMetadata::Deallocate (data);
       return;
@@ -668,6 +873,20 @@ PacketMetadata::DoAddHeader (uint32_t uid, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (IsCompact ())
+    {
+      struct PacketMetadata::CompactItem items[PACKET_METADATA_COMPACT_MAX_ITEMS + 1];
+      uint32_t n = ReadCompact (&items[1]);
+      items[0].item.typeUid = uid;
+      items[0].item.size = size;
+      items[0].item.chunkUid = m_chunkUid;
+      m_chunkUid++;
+      items[0].extraItem.fragmentStart = 0;
+      items[0].extraItem.fragmentEnd = size;
+      items[0].extraItem.packetUid = m_packetUid;
+      WriteCompact (items, n + 1);
+      return;
+    }
 
   struct PacketMetadata::SmallItem item;
   item.next = m_head;
@@ -690,6 +909,32 @@ PacketMetadata::RemoveHeader (const Header &header, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (IsCompact ())
+    {
+      struct PacketMetadata::CompactItem items[PACKET_METADATA_COMPACT_MAX_ITEMS];
+      uint32_t n = ReadCompact (items);
+      if (n == 0 ||
+          items[0].item.typeUid != uid ||
+          items[0].item.size != size)
+        {
+          if (m_enableChecking)
+            {
+              NS_FATAL_ERROR ("Removing unexpected header.");
+            }
+          return;
+        }
+      else if (items[0].extraItem.fragmentStart != 0 ||
+               items[0].extraItem.fragmentEnd != size)
+        {
+          if (m_enableChecking)
+            {
+              NS_FATAL_ERROR ("Removing incomplete header.");
+            }
+          return;
+        }
+      WriteCompact (&items[1], n - 1);
+      return;
+    }
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
   uint32_t read = ReadItems (m_head, &item, &extraItem);
@@ -738,6 +983,20 @@ PacketMetadata::AddTrailer (const Trailer &trailer, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (IsCompact ())
+    {
+      struct PacketMetadata::CompactItem items[PACKET_METADATA_COMPACT_MAX_ITEMS + 1];
+      uint32_t n = ReadCompact (items);
+      items[n].item.typeUid = uid;
+      items[n].item.size = size;
+      items[n].item.chunkUid = m_chunkUid;
+      m_chunkUid++;
+      items[n].extraItem.fragmentStart = 0;
+      items[n].extraItem.fragmentEnd = size;
+      items[n].extraItem.packetUid = m_packetUid;
+      WriteCompact (items, n + 1);
+      return;
+    }
   struct PacketMetadata::SmallItem item;
   item.next = 0xffff;
   item.prev = m_tail;
@@ -760,6 +1019,32 @@ PacketMetadata::RemoveTrailer (const Trailer &trailer, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (IsCompact ())
+    {
+      struct PacketMetadata::CompactItem items[PACKET_METADATA_COMPACT_MAX_ITEMS];
+      uint32_t n = ReadCompact (items);
+      if (n == 0 ||
+          items[n - 1].item.typeUid != uid ||
+          items[n - 1].item.size != size)
+        {
+          if (m_enableChecking)
+            {
+              NS_FATAL_ERROR ("Removing unexpected trailer.");
+            }
+          return;
+        }
+      else if (items[n - 1].extraItem.fragmentStart != 0 ||
+               items[n - 1].extraItem.fragmentEnd != size)
+        {
+          if (m_enableChecking)
+            {
+              NS_FATAL_ERROR ("Removing incomplete trailer.");
+            }
+          return;
+        }
+      WriteCompact (items, n - 1);
+      return;
+    }
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
   uint32_t read = ReadItems (m_tail, &item, &extraItem);
@@ -807,7 +1092,7 @@ PacketMetadata::AddAtEnd (PacketMetadata const&o)
       m_metadataSkipped = true;
       return;
     }
-  if (m_tail == 0xffff)
+  if (IsCompact () ? m_compactUsed == 0 : m_tail == 0xffff)
     {
       // We have no items so 'AddAtEnd' is 
       // equivalent to self-assignment.
@@ -815,12 +1100,44 @@ PacketMetadata::AddAtEnd (PacketMetadata const&o)
       NS_ASSERT (IsStateOk ());
       return;
     }
-  if (o.m_head == 0xffff)
+  if (o.IsCompact () ? o.m_compactUsed == 0 : o.m_head == 0xffff)
     {
-      NS_ASSERT (o.m_tail == 0xffff);
+      NS_ASSERT (o.IsCompact () || o.m_tail == 0xffff);
       // we have nothing to append.
       return;
     }
+  if (IsCompact () && o.IsCompact ())
+    {
+      struct PacketMetadata::CompactItem items[2 * PACKET_METADATA_COMPACT_MAX_ITEMS];
+      uint32_t n = ReadCompact (items);
+      uint32_t m = o.ReadCompact (&items[n]);
+      struct PacketMetadata::CompactItem *tail = &items[n - 1];
+      const struct PacketMetadata::CompactItem *head = &items[n];
+      if (head->extraItem.packetUid == tail->extraItem.packetUid &&
+          head->item.typeUid == tail->item.typeUid &&
+          head->item.chunkUid == tail->item.chunkUid &&
+          head->item.size == tail->item.size &&
+          head->extraItem.fragmentStart == tail->extraItem.fragmentEnd)
+        {
+          // merge the fragments of the same header, as below
+          tail->extraItem.fragmentEnd = head->extraItem.fragmentEnd;
+          for (uint32_t i = n; i + 1 < n + m; i++)
+            {
+              items[i] = items[i + 1];
+            }
+          m--;
+        }
+      WriteCompact (items, n + m);
+      return;
+    }
+  if (o.IsCompact ())
+    {
+      PacketMetadata other = o;
+      other.Inflate ();
+      AddAtEnd (other);
+      return;
+    }
+  Inflate ();
   NS_ASSERT (m_head != 0xffff && m_tail != 0xffff);
 
   // We read the current tail because we are going to append
@@ -895,6 +1212,31 @@ PacketMetadata::RemoveAtStart (uint32_t start)
       m_metadataSkipped = true;
       return;
     }
+  if (IsCompact ())
+    {
+      struct PacketMetadata::CompactItem items[PACKET_METADATA_COMPACT_MAX_ITEMS];
+      uint32_t n = ReadCompact (items);
+      uint32_t leftToRemove = start;
+      uint32_t first = 0;
+      while (first < n && leftToRemove > 0)
+        {
+          struct PacketMetadata::ExtraItem *extraItem = &items[first].extraItem;
+          uint32_t itemRealSize = extraItem->fragmentEnd - extraItem->fragmentStart;
+          if (itemRealSize <= leftToRemove)
+            {
+              leftToRemove -= itemRealSize;
+              first++;
+            }
+          else
+            {
+              extraItem->fragmentStart += leftToRemove;
+              leftToRemove = 0;
+            }
+        }
+      NS_ASSERT (leftToRemove == 0);
+      WriteCompact (&items[first], n - first);
+      return;
+    }
   NS_ASSERT (m_data != 0);
   uint32_t leftToRemove = start;
   uint16_t current = m_head;
@@ -922,6 +1264,7 @@ PacketMetadata::RemoveAtStart (uint32_t start)
         {
           // fragment the list item.
           PacketMetadata fragment (m_packetUid, 0);
+          fragment.Inflate ();
           extraItem.fragmentStart += leftToRemove;
           leftToRemove = 0;
           uint16_t written = fragment.AddBig (0xffff, fragment.m_tail,
@@ -958,6 +1301,30 @@ PacketMetadata::RemoveAtEnd (uint32_t end)
       m_metadataSkipped = true;
       return;
     }
+  if (IsCompact ())
+    {
+      struct PacketMetadata::CompactItem items[PACKET_METADATA_COMPACT_MAX_ITEMS];
+      uint32_t n = ReadCompact (items);
+      uint32_t leftToRemove = end;
+      while (n > 0 && leftToRemove > 0)
+        {
+          struct PacketMetadata::ExtraItem *extraItem = &items[n - 1].extraItem;
+          uint32_t itemRealSize = extraItem->fragmentEnd - extraItem->fragmentStart;
+          if (itemRealSize <= leftToRemove)
+            {
+              leftToRemove -= itemRealSize;
+              n--;
+            }
+          else
+            {
+              extraItem->fragmentEnd -= leftToRemove;
+              leftToRemove = 0;
+            }
+        }
+      NS_ASSERT (leftToRemove == 0);
+      WriteCompact (items, n);
+      return;
+    }
   NS_ASSERT (m_data != 0);
 
   uint32_t leftToRemove = end;
@@ -986,6 +1353,7 @@ PacketMetadata::RemoveAtEnd (uint32_t end)
         {
           // fragment the list item.
           PacketMetadata fragment (m_packetUid, 0);
+          fragment.Inflate ();
           NS_ASSERT (extraItem.fragmentEnd > leftToRemove);
           extraItem.fragmentEnd -= leftToRemove;
           leftToRemove = 0;
@@ -1018,6 +1386,16 @@ PacketMetadata::GetTotalSize (void) const
 {
   NS_LOG_FUNCTION (this);
   uint32_t totalSize = 0;
+  if (IsCompact ())
+    {
+      struct PacketMetadata::CompactItem items[PACKET_METADATA_COMPACT_MAX_ITEMS];
+      uint32_t n = ReadCompact (items);
+      for (uint32_t i = 0; i < n; i++)
+        {
+          totalSize += items[i].extraItem.fragmentEnd - items[i].extraItem.fragmentStart;
+        }
+      return totalSize;
+    }
   uint16_t current = m_head;
   uint16_t tail = m_tail;
   while (current != 0xffff)
@@ -1036,6 +1414,21 @@ PacketMetadata::GetTotalSize (void) const
   return totalSize;
 }
 
+void
+PacketMetadata::Unshare (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (IsCompact ())
+    {
+      // nothing is shared by the inline area
+      return;
+    }
+  if (m_data->m_count > 1)
+    {
+      ReserveCopy (0);
+    }
+}
+
 uint64_t 
 PacketMetadata::GetUid (void) const
 {
@@ -1051,9 +1444,11 @@ PacketMetadata::BeginItem (Buffer buffer) const
 PacketMetadata::ItemIterator::ItemIterator (const PacketMetadata *metadata, Buffer buffer)
   : m_metadata (metadata),
     m_buffer (buffer),
-    m_current (metadata->m_head),
+    m_current (metadata->IsCompact () ? 0 : metadata->m_head),
     m_offset (0),
-    m_hasReadTail (false)
+    m_hasReadTail (false),
+    m_previousTypeUid (0),
+    m_previousChunkUid (0)
 {
   NS_LOG_FUNCTION (this << metadata << &buffer);
 }
@@ -1061,6 +1456,10 @@ bool
 PacketMetadata::ItemIterator::HasNext (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_metadata->IsCompact ())
+    {
+      return m_current < m_metadata->m_compactUsed;
+    }
   if (m_current == 0xffff)
     {
       return false;
@@ -1078,12 +1477,24 @@ PacketMetadata::ItemIterator::Next (void)
   struct PacketMetadata::Item item;
   struct PacketMetadata::SmallItem smallItem;
   struct PacketMetadata::ExtraItem extraItem;
-  m_metadata->ReadItems (m_current, &smallItem, &extraItem);
-  if (m_current == m_metadata->m_tail)
+  if (m_metadata->IsCompact ())
     {
-      m_hasReadTail = true;
+      // the items of the compact mode are only decoded here, on demand
+      smallItem.typeUid = m_previousTypeUid;
+      smallItem.chunkUid = m_previousChunkUid;
+      m_current = m_metadata->ReadCompactItem (m_current, &smallItem, &extraItem);
+      m_previousTypeUid = smallItem.typeUid;
+      m_previousChunkUid = smallItem.chunkUid;
+    }
+  else
+    {
+      m_metadata->ReadItems (m_current, &smallItem, &extraItem);
+      if (m_current == m_metadata->m_tail)
+        {
+          m_hasReadTail = true;
+        }
+      m_current = smallItem.next;
     }
-  m_current = smallItem.next;
   uint32_t uid = (smallItem.typeUid & 0xfffffffe) >> 1;
   item.tid.SetUid (uid);
   item.currentTrimedFromStart = extraItem.fragmentStart;
@@ -1145,6 +1556,12 @@ PacketMetadata::GetSerializedSize (void) const
     {
       return totalSize;
     }
+  if (IsCompact ())
+    {
+      PacketMetadata metadata = *this;
+      metadata.Inflate ();
+      return metadata.GetSerializedSize ();
+    }
 
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
@@ -1178,6 +1595,12 @@ uint32_t
 PacketMetadata::Serialize (uint8_t* buffer, uint32_t maxSize) const
 {
   NS_LOG_FUNCTION (this << &buffer << maxSize);
+  if (IsCompact ())
+    {
+      PacketMetadata metadata = *this;
+      metadata.Inflate ();
+      return metadata.Serialize (buffer, maxSize);
+    }
   uint8_t* start = buffer;
 
   buffer = AddToRawU64 (m_packetUid, start, buffer, maxSize);
@@ -1279,6 +1702,7 @@ uint32_t
 PacketMetadata::Deserialize (const uint8_t* buffer, uint32_t size)
 {
   NS_LOG_FUNCTION (this << &buffer << size);
+  Inflate ();
   const uint8_t* start = buffer;
   uint32_t desSize = size - 4;
 
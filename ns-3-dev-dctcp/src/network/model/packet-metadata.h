@@ -23,6 +23,7 @@
 #include <stdint.h>
 #include <vector>
 #include <limits>
+#include <cstring>
 #include "ns3/callback.h"
 #include "ns3/assert.h"
 #include "ns3/type-id.h"
@@ -74,6 +75,17 @@ class Trailer;
  * integers, and some others as variable-size 32-bit integers.
  * The variable-size 32 bit integers are stored using the uleb128
  * encoding.
+ *
+ * When the compact mode is enabled (see EnableCompact), the items of a
+ * new packet are instead stored in a small byte area inline in the
+ * PacketMetadata object, as a stream of uleb128 values: each item
+ * records the delta of its type uid and of its chunk uid from the
+ * previous item, its size and, for fragments and items added from
+ * another packet only, its fragment bounds and the delta of its packet
+ * uid. The items are decoded only when an operation needs them, and
+ * the printable Item structures only when they are iterated over, by
+ * Packet::Print or the ascii tracing. A packet whose items no longer
+ * fit in the inline area falls back to the linked list described above.
  */
 class PacketMetadata 
 {
@@ -150,6 +162,8 @@ private:
     uint16_t m_current; //!< current position
     uint32_t m_offset; //!< offset
     bool m_hasReadTail; //!< true if the metadata tail has been read
+    uint32_t m_previousTypeUid; //!< type uid of the previous compact item
+    uint16_t m_previousChunkUid; //!< chunk uid of the previous compact item
   };
 
   /**
@@ -160,6 +174,17 @@ private:
    * \brief Enable the packet metadata checking
    */
   static void EnableChecking (void);
+  /**
+   * \brief Enable the packet metadata, stored in the compact mode
+   *
+   * The metadata of the packets created afterwards is stored inline,
+   * without any allocation, as long as it fits in
+   * PACKET_METADATA_COMPACT_SIZE bytes, which is enough for the headers
+   * of a typical TCP/IP packet. This keeps the memory of the metadata
+   * low in long simulations which need it for the header checks or
+   * tracing.
+   */
+  static void EnableCompact (void);
 
   /**
    * \brief Constructor
@@ -239,6 +264,13 @@ private:
    */
   void RemoveAtEnd (uint32_t end);
 
+  /**
+   * \brief Give this metadata its own copy of the records it shares
+   * with other PacketMetadata instances, if any, so that it can be
+   * handed over to another thread
+   */
+  void Unshare (void);
+
   /**
    * \brief Get the packet Uid
    * \return the packet Uid
@@ -407,6 +439,15 @@ private:
    * of PacketMetadata::Data is 16 bytes
    */ 
 #define PACKET_METADATA_DATA_M_DATA_SIZE 8
+  /**
+   * the size of the inline area of the compact mode
+   */
+#define PACKET_METADATA_COMPACT_SIZE 24
+  /**
+   * the max number of items in the inline area, each taking at least
+   * three bytes
+   */
+#define PACKET_METADATA_COMPACT_MAX_ITEMS (PACKET_METADATA_COMPACT_SIZE / 3)
   
   /**
    * Data structure
@@ -496,6 +537,8 @@ private:
 
   /**
    * \brief Class to hold all the metadata
+   *
+   * Every thread has its own free list, released when the thread exits.
    */
   class DataFreeList : public std::vector<struct Data *>
   {
@@ -503,6 +546,17 @@ public:
     ~DataFreeList ();
   };
 
+  /**
+   * \brief An item of the compact mode, decoded
+   *
+   * The next and prev fields of the SmallItem are unused, and the low
+   * bit of its typeUid is always zero.
+   */
+  struct CompactItem {
+    struct SmallItem item; //!< the item
+    struct ExtraItem extraItem; //!< its fragment and packet uid
+  };
+
   friend DataFreeList::~DataFreeList ();
   /// Friend class
   friend class ItemIterator;
@@ -620,6 +674,58 @@ public:
    * \param size header serialized size
    */
   void DoAddHeader (uint32_t uid, uint32_t size);
+  /**
+   * \brief Check if the metadata is stored in the compact mode
+   * \returns true if the items are stored inline
+   */
+  inline bool IsCompact (void) const;
+  /**
+   * \brief Read an item of the compact mode
+   * \param current the offset of the item in the inline area
+   * \param item on input, the type uid and the chunk uid of the previous
+   *        item, or zero for the first one; on output, the item read
+   * \param extraItem pointer to where we should store the data to return to the caller
+   * \returns the offset of the next item
+   */
+  uint16_t ReadCompactItem (uint16_t current,
+                            struct PacketMetadata::SmallItem *item,
+                            struct PacketMetadata::ExtraItem *extraItem) const;
+  /**
+   * \brief Read all the items of the compact mode
+   * \param items array of PACKET_METADATA_COMPACT_MAX_ITEMS items to fill
+   * \returns the number of items read
+   */
+  uint32_t ReadCompact (struct PacketMetadata::CompactItem *items) const;
+  /**
+   * \brief Store items in the compact mode, or in the linked list if
+   * they do not fit in the inline area
+   * \param items the items to store
+   * \param n the number of items
+   */
+  void WriteCompact (const struct PacketMetadata::CompactItem *items, uint32_t n);
+  /**
+   * \brief Store items in the linked list, leaving the compact mode
+   * \param items the items to store
+   * \param n the number of items
+   */
+  void Inflate (const struct PacketMetadata::CompactItem *items, uint32_t n);
+  /**
+   * \brief Leave the compact mode, keeping the current items
+   */
+  void Inflate (void);
+  /**
+   * \brief Append a value to the inline area, with the uleb128 encoding
+   * \param value the value to add
+   * \param buffer the buffer to write to
+   * \returns the number of bytes written
+   */
+  static uint32_t AppendCompactValue (uint64_t value, uint8_t *buffer);
+  /**
+   * \brief Read a uleb128 coded value of the inline area
+   * \param pBuffer the buffer to read from, moved past the value
+   * \returns the value
+   */
+  static uint64_t ReadCompactValue (const uint8_t **pBuffer);
   /**
    * \brief Check if the metadata state is ok
    * \returns true if the internal state is ok
@@ -661,9 +767,11 @@ public:
    */
   static void Deallocate (struct PacketMetadata::Data *data);
 
-  static DataFreeList m_freeList; //!< the metadata data storage
+  static thread_local DataFreeList m_freeList; //!< the metadata data storage
+  static thread_local bool m_freeListDestroyed; //!< true once m_freeList has been released
   static bool m_enable; //!< Enable the packet metadata
   static bool m_enableChecking; //!< Enable the packet metadata checking
+  static bool m_enableCompact; //!< Store the metadata of new packets inline
 
   /**
    * Set to true when adding metadata to a packet is skipped because
@@ -672,8 +780,8 @@ public:
    */
   static bool m_metadataSkipped;
 
-  static uint32_t m_maxSize; //!< maximum metadata size
-  static uint16_t m_chunkUid; //!< Chunk Uid
+  static thread_local uint32_t m_maxSize; //!< maximum metadata size
+  static thread_local uint16_t m_chunkUid; //!< Chunk Uid
 
   struct Data *m_data; //!< Metadata storage
   /*
@@ -684,7 +792,13 @@ public:
   uint16_t m_head; //!< list head
   uint16_t m_tail; //!< list tail
   uint16_t m_used; //!< used portion
+  uint8_t m_compactUsed; //!< used portion of m_compact, in the compact mode
   uint64_t m_packetUid; //!< packet Uid
+  /**
+   * the items in the compact mode, when m_data is null. Its size keeps
+   * a Packet in the same PacketPool class as without it.
+   */
+  uint8_t m_compact[PACKET_METADATA_COMPACT_SIZE];
 };
 
 } // namespace ns3
@@ -692,13 +806,17 @@ public:
 namespace ns3 {
 
 PacketMetadata::PacketMetadata (uint64_t uid, uint32_t size)
-  : m_data (PacketMetadata::Create (10)),
+  : m_data (m_enableCompact ? 0 : PacketMetadata::Create (10)),
     m_head (0xffff),
     m_tail (0xffff),
     m_used (0),
+    m_compactUsed (0),
     m_packetUid (uid)
 {
-  memset (m_data->m_data, 0xff, 4);
+  if (m_data != 0)
+    {
+      memset (m_data->m_data, 0xff, 4);
+    }
   if (size > 0)
     {
       DoAddHeader (0, size);
@@ -709,9 +827,14 @@ PacketMetadata::PacketMetadata (PacketMetadata const &o)
     m_head (o.m_head),
     m_tail (o.m_tail),
     m_used (o.m_used),
+    m_compactUsed (o.m_compactUsed),
     m_packetUid (o.m_packetUid)
 {
-  NS_ASSERT (m_data != 0);
+  if (m_data == 0)
+    {
+      memcpy (m_compact, o.m_compact, m_compactUsed);
+      return;
+    }
   NS_ASSERT (m_data->m_count < std::numeric_limits<uint32_t>::max());
   m_data->m_count++;
 }
@@ -721,31 +844,48 @@ PacketMetadata::operator = (PacketMetadata const& o)
   if (m_data != o.m_data) 
     {
       // not self assignment
-      NS_ASSERT (m_data != 0);
-      m_data->m_count--;
-      if (m_data->m_count == 0) 
+      if (m_data != 0)
         {
-          PacketMetadata::Recycle (m_data);
+          m_data->m_count--;
+          if (m_data->m_count == 0) 
+            {
+              PacketMetadata::Recycle (m_data);
+            }
         }
       m_data = o.m_data;
-      NS_ASSERT (m_data != 0);
-      m_data->m_count++;
+      if (m_data != 0)
+        {
+          m_data->m_count++;
+        }
+    }
+  if (m_data == 0 && this != &o)
+    {
+      memcpy (m_compact, o.m_compact, o.m_compactUsed);
     }
   m_head = o.m_head;
   m_tail = o.m_tail;
   m_used = o.m_used;
+  m_compactUsed = o.m_compactUsed;
   m_packetUid = o.m_packetUid;
   return *this;
 }
 PacketMetadata::~PacketMetadata ()
 {
-  NS_ASSERT (m_data != 0);
+  if (m_data == 0)
+    {
+      return;
+    }
   m_data->m_count--;
   if (m_data->m_count == 0) 
     {
       PacketMetadata::Recycle (m_data);
     }
 }
+bool
+PacketMetadata::IsCompact (void) const
+{
+  return m_data == 0;
+}
 
 } // namespace ns3
 
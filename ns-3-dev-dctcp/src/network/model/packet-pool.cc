@@ -0,0 +1,125 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "packet-pool.h"
+#include "ns3/assert.h"
+
+#include <new>
+
+namespace ns3 {
+
+// The free lists are trivially constructed, and zero-initialized, so that
+// using them costs no initialization check
+thread_local PacketPool::FreeLists PacketPool::g_freeLists;
+thread_local struct PacketPool::LocalStaticDestructor PacketPool::g_localStaticDestructor;
+
+PacketPool::LocalStaticDestructor::~LocalStaticDestructor (void)
+{
+  for (uint32_t c = 0; c < N_CLASSES; ++c)
+    {
+      while (g_freeLists.head[c] != 0)
+        {
+          Block *block = g_freeLists.head[c];
+          g_freeLists.head[c] = block->next;
+          ::operator delete (block);
+        }
+      g_freeLists.count[c] = 0;
+    }
+  // The blocks released later by the thread go back to the heap
+  g_freeLists.destroyed = true;
+}
+
+uint32_t
+PacketPool::GetClass (std::size_t size)
+{
+  uint32_t c = 0;
+  while (c < N_CLASSES && (static_cast<std::size_t> (1) << (MIN_BLOCK_SHIFT + c)) < size)
+    {
+      c++;
+    }
+  return c;
+}
+
+std::size_t
+PacketPool::GetBlockSize (std::size_t size)
+{
+  uint32_t c = GetClass (size);
+  if (c == N_CLASSES)
+    {
+      return size;
+    }
+  return static_cast<std::size_t> (1) << (MIN_BLOCK_SHIFT + c);
+}
+
+void *
+PacketPool::Allocate (std::size_t size)
+{
+  uint32_t c = GetClass (size);
+  if (c < N_CLASSES && g_freeLists.head[c] != 0)
+    {
+      Block *block = g_freeLists.head[c];
+      g_freeLists.head[c] = block->next;
+      g_freeLists.count[c]--;
+      g_freeLists.stats.hits++;
+      return block;
+    }
+  if (!g_freeLists.initialized)
+    {
+      // thread_local objects are only constructed, and so destroyed
+      // with their thread, once used
+      (void) &g_localStaticDestructor;
+      g_freeLists.initialized = true;
+    }
+  g_freeLists.stats.misses++;
+  return ::operator new (GetBlockSize (size));
+}
+
+void
+PacketPool::Deallocate (void *block, std::size_t size)
+{
+  NS_ASSERT (block != 0);
+  uint32_t c = GetClass (size);
+  if (c == N_CLASSES
+      || g_freeLists.destroyed
+      || g_freeLists.count[c] >= MAX_FREE_BLOCKS)
+    {
+      ::operator delete (block);
+      return;
+    }
+  if (!g_freeLists.initialized)
+    {
+      (void) &g_localStaticDestructor;
+      g_freeLists.initialized = true;
+    }
+  Block *b = static_cast<Block *> (block);
+  b->next = g_freeLists.head[c];
+  g_freeLists.head[c] = b;
+  g_freeLists.count[c]++;
+}
+
+PacketPool::Stats
+PacketPool::GetStats (void)
+{
+  return g_freeLists.stats;
+}
+
+void
+PacketPool::ResetStats (void)
+{
+  g_freeLists.stats.hits = 0;
+  g_freeLists.stats.misses = 0;
+}
+
+} // namespace ns3
@@ -0,0 +1,117 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef PACKET_POOL_H
+#define PACKET_POOL_H
+
+#include <stdint.h>
+#include <cstddef>
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ *
+ * \brief Per-thread pool of the memory blocks of packets
+ *
+ * The Packet objects, the data of their Buffer and the nodes of their
+ * PacketTagList are allocated from this pool. The blocks are grouped in
+ * size classes, every power of two from 32 bytes to 16 KiB; a released
+ * block is kept in the free list of its class, up to 1024 blocks per
+ * class, and handed out again to the next allocation of the same class.
+ * Larger blocks are allocated from the heap.
+ *
+ * Every thread has its own free lists, released when the thread exits, so
+ * that no lock is needed: a block may be released by another thread than
+ * the one which allocated it, and is then kept by the releasing thread.
+ */
+class PacketPool
+{
+public:
+  /// Allocation statistics of a thread
+  struct Stats
+  {
+    uint64_t hits;   //!< Number of allocations served by a free list
+    uint64_t misses; //!< Number of allocations served by the heap
+  };
+
+  /**
+   * \brief Allocate a block
+   * \param size the requested size in bytes
+   * \return a block of GetBlockSize (size) bytes
+   */
+  static void *Allocate (std::size_t size);
+  /**
+   * \brief Release a block
+   * \param block the block returned by Allocate
+   * \param size the size given to Allocate, or the size of the block
+   */
+  static void Deallocate (void *block, std::size_t size);
+  /**
+   * \param size a requested size in bytes
+   * \return the size of the blocks returned by Allocate for this size,
+   * which can all be used by the caller
+   */
+  static std::size_t GetBlockSize (std::size_t size);
+  /**
+   * \return the allocation statistics of the calling thread
+   */
+  static Stats GetStats (void);
+  /**
+   * \brief Reset the allocation statistics of the calling thread
+   */
+  static void ResetStats (void);
+
+private:
+  /// log2 of the size of the smallest blocks
+  static const uint32_t MIN_BLOCK_SHIFT = 5;
+  /// Number of size classes
+  static const uint32_t N_CLASSES = 10;
+  /// Max number of blocks kept by the free list of a class
+  static const uint32_t MAX_FREE_BLOCKS = 1024;
+
+  /**
+   * \param size a requested size in bytes
+   * \return the size class of the size, or N_CLASSES for the sizes
+   * allocated from the heap
+   */
+  static uint32_t GetClass (std::size_t size);
+
+  /// A block in a free list
+  struct Block
+  {
+    Block *next; //!< Next block of the free list
+  };
+  /// The free lists of a thread
+  struct FreeLists
+  {
+    Block *head[N_CLASSES];     //!< First free block of every class
+    uint32_t count[N_CLASSES];  //!< Number of free blocks of every class
+    Stats stats;                //!< Allocation statistics
+    bool initialized;           //!< Whether the LocalStaticDestructor was set up
+    bool destroyed;             //!< Whether the thread is exiting
+  };
+  /// Local static destructor structure
+  struct LocalStaticDestructor
+  {
+    ~LocalStaticDestructor ();
+  };
+  static thread_local FreeLists g_freeLists; //!< Free lists of the thread
+  static thread_local struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
+};
+
+} // namespace ns3
+
+#endif /* PACKET_POOL_H */
@@ -43,8 +43,8 @@ PacketTagList::CreateTagData (size_t dataSize)
                  << " exceeds maximum "
                  << std::numeric_limits<decltype(TagData::size)>::max () );
 
-  void * p = std::malloc (sizeof (TagData) + dataSize - 1);
-  // The matching frees are in RemoveAll and RemoveWriter
+  void * p = PacketPool::Allocate (sizeof (TagData) + dataSize - 1);
+  // The matching frees are in RemoveAll and RemoveWriter, through FreeTagData
 
   TagData * tag = new (p) TagData;
   tag->size = dataSize;
@@ -194,8 +194,7 @@ PacketTagList::RemoveWriter (Tag & tag, bool preMerge,
   if (preMerge)
     {
       // found tid before first merge, so delete cur
-      cur->~TagData ();
-      std::free (cur);
+      FreeTagData (cur);
     }
   else
     {
@@ -294,6 +293,40 @@ PacketTagList::Peek (Tag &tag) const
   return false;
 }
 
+void
+PacketTagList::Unshare (void)
+{
+  NS_LOG_FUNCTION (this);
+  bool shared = false;
+  for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
+    {
+      if (cur->count > 1)
+        {
+          shared = true;
+          break;
+        }
+    }
+  if (!shared)
+    {
+      return;
+    }
+  struct TagData *head = 0;
+  struct TagData **prevNext = &head;
+  for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
+    {
+      struct TagData * copy = CreateTagData (cur->size);
+      copy->tid = cur->tid;
+      copy->count = 1;
+      copy->size = cur->size;
+      memcpy (copy->data, cur->data, copy->size);
+      copy->next = 0;
+      *prevNext = copy;
+      prevNext = &copy->next;
+    }
+  RemoveAll ();
+  m_next = head;
+}
+
 const struct PacketTagList::TagData *
 PacketTagList::Head (void) const
 {
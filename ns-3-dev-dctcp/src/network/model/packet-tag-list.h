@@ -28,6 +28,7 @@
 #include <stdint.h>
 #include <ostream>
 #include "ns3/type-id.h"
+#include "packet-pool.h"
 
 namespace ns3 {
 
@@ -213,6 +214,11 @@ public:
    * Remove all tags from this list (up to the first merge).
    */
   inline void RemoveAll (void);
+  /**
+   * Copy the tags this list shares with other lists, if any, so that
+   * the list can be handed over to another thread.
+   */
+  void Unshare (void);
   /**
    * \returns pointer to head of tag list
    */
@@ -228,6 +234,14 @@ private:
    */
   static
   TagData * CreateTagData (size_t dataSize);
+  /**
+   * Destroy a TagData struct created by CreateTagData and release its
+   * memory to the PacketPool.
+   *
+   * \param [in] tag The TagData object.
+   */
+  static inline
+  void FreeTagData (TagData * tag);
   
   /**
    * Typedef of method function pointer for copy-on-write operations
@@ -323,6 +337,14 @@ PacketTagList::operator = (PacketTagList const &o)
   return *this;
 }
 
+void
+PacketTagList::FreeTagData (TagData * tag)
+{
+  size_t size = sizeof (TagData) + tag->size - 1;
+  tag->~TagData ();
+  PacketPool::Deallocate (tag, size);
+}
+
 PacketTagList::~PacketTagList ()
 {
   RemoveAll ();
@@ -341,15 +363,13 @@ PacketTagList::RemoveAll (void)
         }
       if (prev != 0) 
         {
-          prev->~TagData ();
-          std::free (prev);
+          FreeTagData (prev);
         }
       prev = cur;
     }
   if (prev != 0) 
     {
-      prev->~TagData ();
-      std::free (prev);
+      FreeTagData (prev);
     }
   m_next = 0;
 }
@@ -18,6 +18,7 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "packet.h"
+#include "packet-pool.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
@@ -28,7 +29,7 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Packet");
 
-uint32_t Packet::m_globalUid = 0;
+std::atomic<uint32_t> Packet::m_globalUid (0);
 
 TypeId 
 ByteTagIterator::Item::GetTypeId (void) const
@@ -126,6 +127,17 @@ Packet::Copy (void) const
   return Ptr<Packet> (new Packet (*this), false);
 }
 
+Ptr<Packet>
+Packet::DeepCopy (void) const
+{
+  Ptr<Packet> copy = Copy ();
+  copy->m_buffer.Unshare ();
+  copy->m_byteTagList.Unshare ();
+  copy->m_packetTagList.Unshare ();
+  copy->m_metadata.Unshare ();
+  return copy;
+}
+
 Packet::Packet ()
   : m_buffer (),
     m_byteTagList (),
@@ -136,10 +148,9 @@ Packet::Packet ()
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, 0),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid++, 0),
     m_nixVector (0)
 {
-  m_globalUid++;
 }
 
 Packet::Packet (const Packet &o)
@@ -152,6 +163,18 @@ Packet::Packet (const Packet &o)
     : m_nixVector = 0;
 }
 
+void *
+Packet::operator new (std::size_t size)
+{
+  return PacketPool::Allocate (size);
+}
+
+void
+Packet::operator delete (void *p, std::size_t size)
+{
+  PacketPool::Deallocate (p, size);
+}
+
 Packet &
 Packet::operator = (const Packet &o)
 {
@@ -178,10 +201,9 @@ Packet::Packet (uint32_t size)
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid++, size),
     m_nixVector (0)
 {
-  m_globalUid++;
 }
 Packet::Packet (uint8_t const *buffer, uint32_t size, bool magic)
   : m_buffer (0, false),
@@ -204,10 +226,9 @@ Packet::Packet (uint8_t const*buffer, uint32_t size)
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid++, size),
     m_nixVector (0)
 {
-  m_globalUid++;
   m_buffer.AddAtStart (size);
   Buffer::Iterator i = m_buffer.Begin ();
   i.Write (buffer, size);
@@ -582,6 +603,13 @@ Packet::EnableChecking (void)
   PacketMetadata::EnableChecking ();
 }
 
+void
+Packet::EnableCompactMetadata (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  PacketMetadata::EnableCompact ();
+}
+
 uint32_t Packet::GetSerializedSize (void) const
 {
   uint32_t size = 0;
@@ -21,6 +21,7 @@
 #define PACKET_H
 
 #include <stdint.h>
+#include <atomic>
 #include "buffer.h"
 #include "header.h"
 #include "trailer.h"
@@ -248,6 +249,18 @@ public:
    * \return the copied object
    */
   Packet &operator = (const Packet &o);
+  /**
+   * \brief Allocate the memory of a packet from the PacketPool
+   * \param size the size of the object
+   * \return the memory of the packet
+   */
+  static void *operator new (std::size_t size);
+  /**
+   * \brief Release the memory of a packet to the PacketPool
+   * \param p the memory of the packet
+   * \param size the size of the object
+   */
+  static void operator delete (void *p, std::size_t size);
   /**
    * \brief Create a packet with a zero-filled payload.
    *
@@ -453,6 +466,18 @@ public:
    */
   Ptr<Packet> Copy (void) const;
 
+  /**
+   * \brief performs a deep copy of the packet.
+   *
+   * \returns a copy of the packet sharing no data with this packet.
+   *
+   * Unlike the copies made by Copy, which share their data with
+   * the original packet until either of them is modified, the returned
+   * packet owns all its data, so that it can be handed over to a thread
+   * other than the one using this packet (see MultithreadedSimulatorImpl).
+   */
+  Ptr<Packet> DeepCopy (void) const;
+
   /**
    * \brief Returns the packet's Uid.
    *
@@ -530,6 +555,16 @@ public:
    * errors will be detected and will abort the program.
    */
   static void EnableChecking (void);
+  /**
+   * \brief Enable packets metadata, stored in its compact mode.
+   *
+   * The metadata of the packets is then stored inline in the Packet
+   * objects, without any other allocation, as long as it is small, and
+   * decoded only when the packet is printed. It can be combined with
+   * EnableChecking, to keep the checks of the headers removed from the
+   * packets in long simulations.
+   */
+  static void EnableCompactMetadata (void);
 
   /**
    * \brief Returns number of bytes required for packet
@@ -787,7 +822,7 @@ private:
   /* Please see comments above about nix-vector */
   Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
 
-  static uint32_t m_globalUid; //!< Global counter of packets Uid
+  static std::atomic<uint32_t> m_globalUid; //!< Global counter of packets Uid
 };
 
 /**
@@ -948,4 +948,62 @@ SocketIpv6TclassTag::Print (std::ostream &os) const
   os << "IPV6_TCLASS = " << m_ipv6Tclass;
 }
 
+SocketPacingRateTag::SocketPacingRateTag ()
+  : m_pacingRate (0)
+{
+}
+
+void
+SocketPacingRateTag::SetPacingRate (DataRate rate)
+{
+  m_pacingRate = rate.GetBitRate ();
+}
+
+DataRate
+SocketPacingRateTag::GetPacingRate (void) const
+{
+  return DataRate (m_pacingRate);
+}
+
+TypeId
+SocketPacingRateTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::SocketPacingRateTag")
+    .SetParent<Tag> ()
+    .SetGroupName("Network")
+    .AddConstructor<SocketPacingRateTag> ()
+    ;
+  return tid;
+}
+
+TypeId
+SocketPacingRateTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+SocketPacingRateTag::GetSerializedSize (void) const
+{
+  return sizeof (uint64_t);
+}
+
+void
+SocketPacingRateTag::Serialize (TagBuffer i) const
+{
+  i.WriteU64 (m_pacingRate);
+}
+
+void
+SocketPacingRateTag::Deserialize (TagBuffer i)
+{
+  m_pacingRate = i.ReadU64 ();
+}
+
+void
+SocketPacingRateTag::Print (std::ostream &os) const
+{
+  os << "pacing rate = " << m_pacingRate << "bps";
+}
+
 } // namespace ns3
@@ -32,6 +32,7 @@
 #include <stdint.h>
 #include "ns3/inet-socket-address.h"
 #include "ns3/inet6-socket-address.h"
+#include "ns3/data-rate.h"
 
 namespace ns3 {
 
@@ -1394,6 +1395,55 @@ private:
   uint8_t m_ipv6Tclass; //!< the Tclass carried by the tag
 };
 
+/**
+ * \brief indicates the pacing rate of the socket which sent the packet.
+ *
+ * The tag lets a queue disc, such as the FqPacingQueueDisc, release the
+ * packets of every socket at the pacing rate of the socket.
+ */
+class SocketPacingRateTag : public Tag
+{
+public:
+  SocketPacingRateTag ();
+
+  /**
+   * \brief Set the tag's pacing rate
+   *
+   * \param rate the pacing rate
+   */
+  void SetPacingRate (DataRate rate);
+
+  /**
+   * \brief Get the tag's pacing rate
+   *
+   * \returns the pacing rate
+   */
+  DataRate GetPacingRate (void) const;
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  // inherited function, no need to doc.
+  virtual TypeId GetInstanceTypeId (void) const;
+
+  // inherited function, no need to doc.
+  virtual uint32_t GetSerializedSize (void) const;
+
+  // inherited function, no need to doc.
+  virtual void Serialize (TagBuffer i) const;
+
+  // inherited function, no need to doc.
+  virtual void Deserialize (TagBuffer i);
+
+  // inherited function, no need to doc.
+  virtual void Print (std::ostream &os) const;
+private:
+  uint64_t m_pacingRate; //!< the pacing rate carried by the tag, in bit/s
+};
+
 } // namespace ns3
 
 #endif /* NS3_SOCKET_H */
@@ -0,0 +1,132 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdio>
+
+#include "ns3/columnar-trace-file.h"
+#include "ns3/traced-value.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Check that the records written by the sinks of a ColumnarTraceFile
+ * are read back by a ColumnarTraceReader
+ */
+class ColumnarTraceFileTestCase : public TestCase
+{
+public:
+  ColumnarTraceFileTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  TracedValue<uint32_t> m_bytes; //!< traced unsigned value
+  TracedValue<Time> m_rtt;       //!< traced time
+  TracedValue<double> m_rate;    //!< traced floating point value
+};
+
+ColumnarTraceFileTestCase::ColumnarTraceFileTestCase ()
+  : TestCase ("Check the records written and read back from columnar trace files")
+{
+}
+
+void
+ColumnarTraceFileTestCase::DoRun (void)
+{
+  std::string bytesFilename = CreateTempDirFilename ("bytes.col");
+  std::string rttFilename = CreateTempDirFilename ("rtt.col");
+  std::string rateFilename = CreateTempDirFilename ("rate.col");
+  const uint32_t n = 1000;
+
+  {
+    // A small buffer, so that the records are written in several blocks
+    Ptr<ColumnarTraceFile> bytes = Create<ColumnarTraceFile> (bytesFilename, "BytesInQueue",
+                                                              ColumnarTraceFile::UINT64, 160);
+    Ptr<ColumnarTraceFile> rtt = Create<ColumnarTraceFile> (rttFilename, "RTT",
+                                                            ColumnarTraceFile::GetValueTypeOf<Time> ());
+    Ptr<ColumnarTraceFile> rate = Create<ColumnarTraceFile> (rateFilename, "Rate",
+                                                             ColumnarTraceFile::DOUBLE);
+    m_bytes.ConnectWithoutContext (bytes->MakeSink<uint32_t> ());
+    m_rtt.ConnectWithoutContext (rtt->MakeSink<Time> ());
+    m_rate.ConnectWithoutContext (rate->MakeSink<double> ());
+    for (uint32_t i = 1; i <= n; i++)
+      {
+        Simulator::Schedule (MicroSeconds (i), &TracedValue<uint32_t>::Set, &m_bytes, i * 1500);
+        Simulator::Schedule (MicroSeconds (i), &TracedValue<Time>::Set, &m_rtt, MicroSeconds (100 + i));
+        Simulator::Schedule (MicroSeconds (i), &TracedValue<double>::Set, &m_rate, i / 4.0);
+      }
+    Simulator::Run ();
+    Simulator::Destroy ();
+    NS_TEST_ASSERT_MSG_EQ (bytes->GetNRecords (), n, "Records not counted");
+    m_bytes.DisconnectWithoutContext (bytes->MakeSink<uint32_t> ());
+    m_rtt.DisconnectWithoutContext (rtt->MakeSink<Time> ());
+    m_rate.DisconnectWithoutContext (rate->MakeSink<double> ());
+  }
+
+  ColumnarTraceReader reader;
+  NS_TEST_ASSERT_MSG_EQ (reader.Open (bytesFilename), true, "Cannot map " << bytesFilename);
+  NS_TEST_ASSERT_MSG_EQ (reader.GetName (), "BytesInQueue", "Wrong trace name");
+  NS_TEST_ASSERT_MSG_EQ (reader.GetValueType (), ColumnarTraceFile::UINT64, "Wrong value type");
+  NS_TEST_ASSERT_MSG_EQ (reader.GetNRecords (), n, "Wrong number of records");
+  for (uint32_t i = 0; i < n; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (reader.GetTime (i), MicroSeconds (i + 1), "Wrong time of record " << i);
+      NS_TEST_ASSERT_MSG_EQ (reader.GetUint (i), (i + 1) * 1500, "Wrong value of record " << i);
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (reader.Open (rttFilename), true, "Cannot map " << rttFilename);
+  NS_TEST_ASSERT_MSG_EQ (reader.GetValueType (), ColumnarTraceFile::INT64, "Wrong value type");
+  NS_TEST_ASSERT_MSG_EQ (reader.GetNRecords (), n, "Wrong number of records");
+  NS_TEST_ASSERT_MSG_EQ (reader.GetInt (n - 1), MicroSeconds (100 + n).GetNanoSeconds (), "Wrong time value");
+
+  NS_TEST_ASSERT_MSG_EQ (reader.Open (rateFilename), true, "Cannot map " << rateFilename);
+  NS_TEST_ASSERT_MSG_EQ (reader.GetValueType (), ColumnarTraceFile::DOUBLE, "Wrong value type");
+  NS_TEST_ASSERT_MSG_EQ (reader.GetDouble (2), 0.75, "Wrong floating point value");
+  NS_TEST_ASSERT_MSG_EQ (reader.GetValue (n - 1), n / 4.0, "Wrong floating point value");
+  reader.Close ();
+
+  NS_TEST_ASSERT_MSG_EQ (reader.Open (CreateTempDirFilename ("missing.col")), false,
+                         "Missing file should not be mapped");
+
+  std::remove (bytesFilename.c_str ());
+  std::remove (rttFilename.c_str ());
+  std::remove (rateFilename.c_str ());
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief ColumnarTraceFile TestSuite
+ */
+class ColumnarTraceFileTestSuite : public TestSuite
+{
+public:
+  ColumnarTraceFileTestSuite ();
+};
+
+ColumnarTraceFileTestSuite::ColumnarTraceFileTestSuite ()
+  : TestSuite ("columnar-trace-file", UNIT)
+{
+  AddTestCase (new ColumnarTraceFileTestCase, TestCase::QUICK);
+}
+
+static ColumnarTraceFileTestSuite g_columnarTraceFileTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,152 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/data-rate.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Check the transmission times and the numbers of bytes computed
+ * by DataRate
+ */
+class DataRateTxTimeTestCase : public TestCase
+{
+public:
+  DataRateTxTimeTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+DataRateTxTimeTestCase::DataRateTxTimeTestCase ()
+  : TestCase ("Check the transmission times computed by DataRate")
+{
+}
+
+void
+DataRateTxTimeTestCase::DoRun (void)
+{
+  NS_TEST_ASSERT_MSG_EQ (DataRate ("10Mbps").CalculateBytesTxTime (1500), MicroSeconds (1200),
+                         "Wrong transmission time");
+  NS_TEST_ASSERT_MSG_EQ (DataRate ("5Mbps").CalculateBytesTxTime (1), NanoSeconds (1600),
+                         "Wrong transmission time");
+  NS_TEST_ASSERT_MSG_EQ (DataRate ("40Gbps").CalculateBytesTxTime (100), NanoSeconds (20),
+                         "Wrong transmission time");
+  // Rounded down to the nanosecond
+  NS_TEST_ASSERT_MSG_EQ (DataRate ("3Gbps").CalculateBytesTxTime (1), NanoSeconds (2),
+                         "Wrong transmission time");
+  NS_TEST_ASSERT_MSG_EQ (DataRate ("9600bps").CalculateBytesTxTime (65535), NanoSeconds (54612500000LL),
+                         "Wrong transmission time");
+  NS_TEST_ASSERT_MSG_EQ (DataRate ("1Gbps").CalculateBitsTxTime (1), NanoSeconds (1),
+                         "Wrong transmission time");
+  NS_TEST_ASSERT_MSG_EQ (DataRate ("1bps").CalculateBytesTxTime (1000000), Seconds (8000000),
+                         "Wrong transmission time");
+
+  NS_TEST_ASSERT_MSG_EQ (DataRate ("1Mbps").CalculateBytesInTime (Seconds (1)), 125000,
+                         "Wrong number of bytes");
+  NS_TEST_ASSERT_MSG_EQ (DataRate ("10Gbps").CalculateBytesInTime (NanoSeconds (1199)), 1498,
+                         "Wrong number of bytes");
+  NS_TEST_ASSERT_MSG_EQ (DataRate ("10Gbps").CalculateBytesInTime (NanoSeconds (-1)), 0,
+                         "Wrong number of bytes");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Check that a TxTimeCalculator computes the same transmission times
+ * and numbers of bytes as its DataRate
+ */
+class TxTimeCalculatorTestCase : public TestCase
+{
+public:
+  TxTimeCalculatorTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TxTimeCalculatorTestCase::TxTimeCalculatorTestCase ()
+  : TestCase ("Check that TxTimeCalculator matches DataRate")
+{
+}
+
+void
+TxTimeCalculatorTestCase::DoRun (void)
+{
+  const uint64_t rates[] = { 1, 3, 7, 9600, 32768, 1544000, 5000000, 10000000,
+                             123456789, 1000000000, 3000000000ULL, 10000000000ULL,
+                             40000000000ULL, 100000000000ULL, 8000000001ULL };
+  const uint32_t sizes[] = { 0, 1, 40, 52, 64, 100, 576, 1000, 1460, 1500, 1502,
+                             9000, 65535, 1000000, 1000000000 };
+  const int64_t times[] = { 0, 1, 3, 999, 1199, 1200, 123456, 1000000, 999999999,
+                            1000000000, 2305843009LL, 2305843010LL, 86400000000000LL };
+
+  for (uint32_t i = 0; i < sizeof (rates) / sizeof (rates[0]); i++)
+    {
+      DataRate rate (rates[i]);
+      TxTimeCalculator calculator (rate);
+      NS_TEST_ASSERT_MSG_EQ (calculator.GetDataRate (), rate, "Wrong data rate");
+      for (uint32_t j = 0; j < sizeof (sizes) / sizeof (sizes[0]); j++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (calculator.CalculateBytesTxTime (sizes[j]),
+                                 rate.CalculateBytesTxTime (sizes[j]),
+                                 "Wrong transmission time of " << sizes[j] << " bytes at " << rate);
+        }
+      for (uint32_t j = 0; j < sizeof (times) / sizeof (times[0]); j++)
+        {
+          Time time = NanoSeconds (times[j]);
+          NS_TEST_ASSERT_MSG_EQ (calculator.CalculateBytesInTime (time),
+                                 rate.CalculateBytesInTime (time),
+                                 "Wrong number of bytes in " << time << " at " << rate);
+        }
+      // Back and forth
+      for (uint32_t bytes = 1; bytes < 2000; bytes += 7)
+        {
+          Time txTime = calculator.CalculateBytesTxTime (bytes);
+          NS_TEST_ASSERT_MSG_EQ (calculator.CalculateBytesInTime (txTime),
+                                 rate.CalculateBytesInTime (txTime),
+                                 "Wrong number of bytes in " << txTime << " at " << rate);
+          NS_TEST_ASSERT_MSG_EQ ((calculator.CalculateBytesInTime (txTime) <= bytes), true,
+                                 "More bytes than transmitted in " << txTime << " at " << rate);
+        }
+    }
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief DataRate TestSuite
+ */
+class DataRateTestSuite : public TestSuite
+{
+public:
+  DataRateTestSuite ();
+};
+
+DataRateTestSuite::DataRateTestSuite ()
+  : TestSuite ("data-rate", UNIT)
+{
+  AddTestCase (new DataRateTxTimeTestCase, TestCase::QUICK);
+  AddTestCase (new TxTimeCalculatorTestCase, TestCase::QUICK);
+}
+
+static DataRateTestSuite g_dataRateTestSuite; //!< Static variable for test initialization
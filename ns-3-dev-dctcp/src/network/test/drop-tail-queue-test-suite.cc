@@ -18,7 +18,9 @@
 
 #include "ns3/test.h"
 #include "ns3/drop-tail-queue.h"
+#include "ns3/ring-buffer.h"
 #include "ns3/string.h"
+#include <list>
 
 using namespace ns3;
 
@@ -83,6 +85,103 @@ DropTailQueueTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ ((packet == 0), true, "There are really no packets in there");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check the ring buffer storing the packets of a queue: FIFO order across
+ * wraparounds and growths, insertion and removal in the middle, and release
+ * of the removed packets.
+ */
+class DropTailQueueRingBufferTestCase : public TestCase
+{
+public:
+  DropTailQueueRingBufferTestCase ();
+  virtual void DoRun (void);
+};
+
+DropTailQueueRingBufferTestCase::DropTailQueueRingBufferTestCase ()
+  : TestCase ("Check the ring buffer storing the packets of a drop tail queue")
+{
+}
+void
+DropTailQueueRingBufferTestCase::DoRun (void)
+{
+  // a deep queue which repeatedly wraps around and grows
+  Ptr<DropTailQueue<Packet> > queue = CreateObject<DropTailQueue<Packet> > ();
+  queue->SetMaxSize (QueueSize ("1000p"));
+  std::list<Ptr<Packet> > expected;
+  for (uint32_t round = 1; round <= 10; round++)
+    {
+      for (uint32_t i = 0; i < 100 * round; i++)
+        {
+          Ptr<Packet> p = Create<Packet> (i % 7);
+          bool accepted = (expected.size () < 1000);
+          NS_TEST_EXPECT_MSG_EQ (queue->Enqueue (p), accepted, "Unexpected enqueue result");
+          if (accepted)
+            {
+              expected.push_back (p);
+            }
+        }
+      for (uint32_t i = 0; i < 70 * round && !expected.empty (); i++)
+        {
+          Ptr<Packet> p = queue->Dequeue ();
+          NS_TEST_ASSERT_MSG_EQ (p, expected.front (), "Packets are not dequeued in FIFO order");
+          expected.pop_front ();
+        }
+      NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), expected.size (), "Unexpected number of packets");
+    }
+  while (!expected.empty ())
+    {
+      NS_TEST_ASSERT_MSG_EQ (queue->Dequeue (), expected.front (), "Packets are not dequeued in FIFO order");
+      expected.pop_front ();
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->IsEmpty (), true, "The queue should be empty");
+
+  // insertion and removal at any position
+  RingBuffer<Ptr<Packet> > buffer;
+  std::list<Ptr<Packet> > reference;
+  for (uint32_t i = 0; i < 200; i++)
+    {
+      uint32_t pos = (i * 37) % (reference.size () + 1);
+      Ptr<Packet> p = Create<Packet> ();
+      RingBuffer<Ptr<Packet> >::iterator it = buffer.begin ();
+      std::list<Ptr<Packet> >::iterator ref = reference.begin ();
+      for (uint32_t j = 0; j < pos; j++, ++it, ++ref)
+        {
+        }
+      NS_TEST_EXPECT_MSG_EQ (*buffer.insert (it, p), p, "The inserted packet is not returned");
+      reference.insert (ref, p);
+      if (i % 3 == 2)
+        {
+          pos = (i * 11) % reference.size ();
+          it = buffer.begin ();
+          ref = reference.begin ();
+          for (uint32_t j = 0; j < pos; j++, ++it, ++ref)
+            {
+            }
+          buffer.erase (it);
+          reference.erase (ref);
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (buffer.size (), reference.size (), "Unexpected number of packets");
+  std::list<Ptr<Packet> >::const_iterator ref = reference.begin ();
+  for (RingBuffer<Ptr<Packet> >::const_iterator it = buffer.cbegin (); it != buffer.cend (); ++it, ++ref)
+    {
+      NS_TEST_EXPECT_MSG_EQ (*it, *ref, "Unexpected packet order");
+    }
+
+  // removed packets are not referenced by the buffer any more
+  Ptr<Packet> p = Create<Packet> ();
+  buffer.insert (buffer.cend (), p);
+  NS_TEST_EXPECT_MSG_EQ (p->GetReferenceCount (), 2, "The buffer should hold a reference");
+  buffer.erase (--buffer.cend ());
+  NS_TEST_EXPECT_MSG_EQ (p->GetReferenceCount (), 1, "The buffer should have released its reference");
+  buffer.insert (buffer.cbegin (), p);
+  buffer.erase (buffer.cbegin ());
+  NS_TEST_EXPECT_MSG_EQ (p->GetReferenceCount (), 1, "The buffer should have released its reference");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -96,6 +195,7 @@ public:
     : TestSuite ("drop-tail-queue", UNIT)
   {
     AddTestCase (new DropTailQueueTestCase (), TestCase::QUICK);
+    AddTestCase (new DropTailQueueRingBufferTestCase (), TestCase::QUICK);
   }
 };
 
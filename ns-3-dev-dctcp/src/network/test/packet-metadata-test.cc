@@ -20,6 +20,7 @@
 #include <cstdarg>
 #include <iostream>
 #include <sstream>
+#include <vector>
 #include "ns3/test.h"
 #include "ns3/header.h"
 #include "ns3/trailer.h"
@@ -318,7 +319,11 @@ HistoryTrailer<N>::Deserialize (Buffer::Iterator start)
  */
 class PacketMetadataTest : public TestCase {
 public:
-  PacketMetadataTest ();
+  /**
+   * Constructor
+   * \param compact whether to store the metadata in the compact mode
+   */
+  PacketMetadataTest (bool compact);
   virtual ~PacketMetadataTest ();
   /**
    * Checks the packet header and trailer history
@@ -337,10 +342,12 @@ private:
    * \return The packet with the header added.
    */
   Ptr<Packet> DoAddHeader (Ptr<Packet> p);
+  bool m_compact; //!< Whether to store the metadata in the compact mode
 };
 
-PacketMetadataTest::PacketMetadataTest ()
-  : TestCase ("Packet metadata")
+PacketMetadataTest::PacketMetadataTest (bool compact)
+  : TestCase (compact ? "Packet metadata, compact mode" : "Packet metadata"),
+    m_compact (compact)
 {
 }
 
@@ -477,7 +484,14 @@ PacketMetadataTest::DoAddHeader (Ptr<Packet> p)
 void
 PacketMetadataTest::DoRun (void)
 {
-  PacketMetadata::Enable ();
+  if (m_compact)
+    {
+      PacketMetadata::EnableCompact ();
+    }
+  else
+    {
+      PacketMetadata::Enable ();
+    }
 
   Ptr<Packet> p = Create<Packet> (0);
   Ptr<Packet> p1 = Create<Packet> (0);
@@ -902,6 +916,132 @@ PacketMetadataTest::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (msg, std::string ("hello world"), "Could not find original data in received packet");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that the compact mode of the packet metadata records the same
+ * items as the linked list, also once they no longer fit inline and
+ * when both are mixed.
+ */
+class PacketMetadataCompactTest : public TestCase {
+public:
+  PacketMetadataCompactTest ();
+  virtual void DoRun (void);
+private:
+  /**
+   * Create packets through fragmentation, aggregation and headers
+   * \return the packets
+   */
+  std::vector<Ptr<Packet> > CreatePackets (void);
+  /**
+   * \param p The packet
+   * \return the description of the metadata items of the packet
+   */
+  std::string GetItems (Ptr<const Packet> p);
+};
+
+PacketMetadataCompactTest::PacketMetadataCompactTest ()
+  : TestCase ("Packet metadata, compact and linked list modes")
+{
+}
+
+std::vector<Ptr<Packet> >
+PacketMetadataCompactTest::CreatePackets (void)
+{
+  std::vector<Ptr<Packet> > packets;
+
+  // a segment made of the fragments of two application packets
+  Ptr<Packet> p = Create<Packet> (500);
+  p->AddAtEnd (Create<Packet> (500));
+  Ptr<Packet> p1 = p->CreateFragment (100, 536);
+  ADD_HEADER (p1, 20);
+  ADD_HEADER (p1, 24);
+  ADD_HEADER (p1, 2);
+  packets.push_back (p1->Copy ());
+  REM_HEADER (p1, 2);
+  REM_HEADER (p1, 24);
+  packets.push_back (p1);
+
+  // a packet put back together from its fragments, and a fragment of a
+  // header
+  p = Create<Packet> (200);
+  ADD_HEADER (p, 10);
+  ADD_TRAILER (p, 4);
+  p1 = p->CreateFragment (0, 100);
+  p1->AddAtEnd (p->CreateFragment (100, 114));
+  packets.push_back (p1);
+  packets.push_back (p->CreateFragment (5, 20));
+
+  // more headers than the inline area can hold
+  p = Create<Packet> (1000);
+  ADD_HEADER (p, 1);
+  ADD_HEADER (p, 2);
+  ADD_HEADER (p, 3);
+  ADD_HEADER (p, 4);
+  ADD_HEADER (p, 5);
+  ADD_HEADER (p, 6);
+  ADD_HEADER (p, 7);
+  ADD_HEADER (p, 8);
+  ADD_HEADER (p, 9);
+  packets.push_back (p->Copy ());
+  REM_HEADER (p, 9);
+  REM_HEADER (p, 8);
+  p->RemoveAtEnd (10);
+  packets.push_back (p);
+  return packets;
+}
+
+std::string
+PacketMetadataCompactTest::GetItems (Ptr<const Packet> p)
+{
+  std::ostringstream oss;
+  PacketMetadata::ItemIterator i = p->BeginItem ();
+  while (i.HasNext ())
+    {
+      struct PacketMetadata::Item item = i.Next ();
+      oss << item.type << " " << item.tid.GetUid () << " " << item.isFragment
+          << " " << item.currentSize << " " << item.currentTrimedFromStart
+          << " " << item.currentTrimedFromEnd << "; ";
+    }
+  return oss.str ();
+}
+
+void
+PacketMetadataCompactTest::DoRun (void)
+{
+  // the packets created before EnableCompact keep the linked list
+  PacketMetadata::Enable ();
+  std::vector<Ptr<Packet> > expected = CreatePackets ();
+  Ptr<Packet> headerPacket = Create<Packet> (100);
+  ADD_HEADER (headerPacket, 8);
+  Ptr<Packet> payload = Create<Packet> (300);
+
+  PacketMetadata::EnableCompact ();
+  std::vector<Ptr<Packet> > packets = CreatePackets ();
+  NS_TEST_ASSERT_MSG_EQ (packets.size (), expected.size (), "Wrong number of packets");
+  for (uint32_t i = 0; i < packets.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (GetItems (packets[i]), GetItems (expected[i]),
+                             "Different items in the compact mode for packet " << i);
+    }
+
+  Ptr<Packet> p = Create<Packet> (100);
+  ADD_HEADER (p, 8);
+  Ptr<Packet> mixed = p->Copy ();
+  mixed->AddAtEnd (payload);
+  Ptr<Packet> reference = headerPacket->Copy ();
+  reference->AddAtEnd (payload);
+  NS_TEST_EXPECT_MSG_EQ (GetItems (mixed), GetItems (reference),
+                         "Wrong items after adding a packet of the linked list mode");
+  mixed = payload->Copy ();
+  mixed->AddAtEnd (p);
+  reference = payload->Copy ();
+  reference->AddAtEnd (headerPacket);
+  NS_TEST_EXPECT_MSG_EQ (GetItems (mixed), GetItems (reference),
+                         "Wrong items after adding a packet of the compact mode");
+}
+
 
 /**
  * \ingroup network-test
@@ -918,7 +1058,10 @@ public:
 PacketMetadataTestSuite::PacketMetadataTestSuite ()
   : TestSuite ("packet-metadata", UNIT)
 {
-  AddTestCase (new PacketMetadataTest, TestCase::QUICK);
+  AddTestCase (new PacketMetadataTest (false), TestCase::QUICK);
+  // the compact mode, once enabled, stays enabled for the next test cases
+  AddTestCase (new PacketMetadataCompactTest, TestCase::QUICK);
+  AddTestCase (new PacketMetadataTest (true), TestCase::QUICK);
 }
 
 static PacketMetadataTestSuite g_packetMetadataTest; //!< Static variable for test initialization
@@ -0,0 +1,139 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/packet-pool.h"
+#include "ns3/packet.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Check the size classes of the PacketPool and the reuse of the
+ * released blocks
+ */
+class PacketPoolTest : public TestCase
+{
+public:
+  PacketPoolTest ();
+  virtual void DoRun (void);
+};
+
+PacketPoolTest::PacketPoolTest ()
+  : TestCase ("Check the size classes and the reuse of the blocks")
+{
+}
+
+void
+PacketPoolTest::DoRun (void)
+{
+  NS_TEST_ASSERT_MSG_EQ (PacketPool::GetBlockSize (1), 32, "Wrong size of the smallest class");
+  NS_TEST_ASSERT_MSG_EQ (PacketPool::GetBlockSize (32), 32, "Wrong class of a block size");
+  NS_TEST_ASSERT_MSG_EQ (PacketPool::GetBlockSize (33), 64, "Wrong class of a size");
+  NS_TEST_ASSERT_MSG_EQ (PacketPool::GetBlockSize (16384), 16384, "Wrong size of the largest class");
+  NS_TEST_ASSERT_MSG_EQ (PacketPool::GetBlockSize (16385), 16385, "Heap blocks should not be rounded");
+
+  PacketPool::ResetStats ();
+  void *block = PacketPool::Allocate (100);
+  PacketPool::Deallocate (block, 100);
+  void *reused = PacketPool::Allocate (128);
+  NS_TEST_ASSERT_MSG_EQ (reused, block, "Released block of the same class not reused");
+  PacketPool::Deallocate (reused, 128);
+  PacketPool::Stats stats = PacketPool::GetStats ();
+  NS_TEST_ASSERT_MSG_EQ (stats.hits + stats.misses, 2, "Allocations not counted");
+  NS_TEST_ASSERT_MSG_GT (stats.hits, 0, "Reuse not counted as a hit");
+
+  PacketPool::ResetStats ();
+  block = PacketPool::Allocate (20000);
+  PacketPool::Deallocate (block, 20000);
+  block = PacketPool::Allocate (20000);
+  PacketPool::Deallocate (block, 20000);
+  stats = PacketPool::GetStats ();
+  NS_TEST_ASSERT_MSG_EQ (stats.misses, 2, "Heap blocks should not be pooled");
+  NS_TEST_ASSERT_MSG_EQ (stats.hits, 0, "Heap blocks should not be pooled");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Check that packets reuse the memory released by the previous
+ * packets
+ */
+class PacketPoolPacketTest : public TestCase
+{
+public:
+  PacketPoolPacketTest ();
+  virtual void DoRun (void);
+private:
+  /**
+   * Create, copy and release packets
+   * \param n the number of packets
+   */
+  void CreatePackets (uint32_t n);
+};
+
+PacketPoolPacketTest::PacketPoolPacketTest ()
+  : TestCase ("Check that packets are allocated from the pool")
+{
+}
+
+void
+PacketPoolPacketTest::CreatePackets (uint32_t n)
+{
+  uint8_t data[200] = {0};
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (data, sizeof (data));
+      p->AddPaddingAtEnd (1000);
+      Ptr<Packet> copy = p->DeepCopy ();
+      NS_TEST_ASSERT_MSG_EQ (copy->GetSize (), 1200, "Wrong packet size");
+    }
+}
+
+void
+PacketPoolPacketTest::DoRun (void)
+{
+  CreatePackets (10);
+  PacketPool::ResetStats ();
+  CreatePackets (100);
+  PacketPool::Stats stats = PacketPool::GetStats ();
+  NS_TEST_ASSERT_MSG_EQ (stats.misses, 0, "Packets allocated from the heap");
+  NS_TEST_ASSERT_MSG_GT (stats.hits, 200, "Packets not allocated from the pool");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief PacketPool TestSuite
+ */
+class PacketPoolTestSuite : public TestSuite
+{
+public:
+  PacketPoolTestSuite ();
+};
+
+PacketPoolTestSuite::PacketPoolTestSuite ()
+  : TestSuite ("packet-pool", UNIT)
+{
+  AddTestCase (new PacketPoolTest, TestCase::QUICK);
+  AddTestCase (new PacketPoolPacketTest, TestCase::QUICK);
+}
+
+static PacketPoolTestSuite g_packetPoolTestSuite; //!< Static variable for test initialization
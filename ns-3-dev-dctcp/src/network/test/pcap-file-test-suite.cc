@@ -20,11 +20,13 @@
 #include <cstdio>
 #include <cstdlib>
 #include <sstream>
+#include <fstream>
 #include <cstring>
 
 #include "ns3/log.h"
 #include "ns3/test.h"
 #include "ns3/pcap-file.h"
+#include "ns3/packet.h"
 
 using namespace ns3;
 
@@ -1144,6 +1146,110 @@ DiffTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (usec, 3696, "Files are different from 2.3696 seconds");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test case to make sure that the asynchronous mode writes the
+ * same file as the synchronous one.
+ */
+class AsyncWriteTestCase : public TestCase
+{
+public:
+  AsyncWriteTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Write packets of a counting pattern and various sizes to a file
+   * \param filename the file name
+   * \param snapLen the snap length of the file
+   * \param blockSize the block size of the asynchronous mode, or 0 to
+   * write synchronously
+   */
+  void WriteFile (std::string const &filename, uint32_t snapLen, uint32_t blockSize);
+  /**
+   * \param filename a file name
+   * \returns the content of the file
+   */
+  std::string ReadFile (std::string const &filename);
+};
+
+AsyncWriteTestCase::AsyncWriteTestCase ()
+  : TestCase ("Check that the asynchronous mode writes the same file")
+{
+}
+
+void
+AsyncWriteTestCase::WriteFile (std::string const &filename, uint32_t snapLen, uint32_t blockSize)
+{
+  uint8_t data[1500];
+  for (uint32_t i = 0; i < sizeof (data); ++i)
+    {
+      data[i] = i;
+    }
+
+  PcapFile f;
+  f.Open (filename, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << filename << ", \"std::ios::out\") returns error");
+  f.Init (1, snapLen);
+  if (blockSize > 0)
+    {
+      f.EnableAsync (blockSize);
+    }
+  for (uint32_t i = 0; i < 1000; ++i)
+    {
+      uint32_t size = (i * 37) % sizeof (data);
+      if (i % 2 == 0)
+        {
+          f.Write (i / 100, i % 100, data, size);
+        }
+      else
+        {
+          f.Write (i / 100, i % 100, Create<Packet> (data, size));
+        }
+      NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Write must not fail");
+    }
+  f.Close ();
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Close must not fail");
+}
+
+std::string
+AsyncWriteTestCase::ReadFile (std::string const &filename)
+{
+  std::ifstream file (filename.c_str (), std::ios::binary);
+  std::stringstream content;
+  content << file.rdbuf ();
+  return content.str ();
+}
+
+void
+AsyncWriteTestCase::DoRun (void)
+{
+  std::string syncFilename = CreateTempDirFilename ("sync.pcap");
+  std::string asyncFilename = CreateTempDirFilename ("async.pcap");
+  uint32_t snapLens[] = { PcapFile::SNAPLEN_DEFAULT, PcapFile::SNAPLEN_HEADERS };
+  uint32_t blockSizes[] = { PcapFile::ASYNC_BLOCK_SIZE_DEFAULT, 4096, 1 };
+
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      WriteFile (syncFilename, snapLens[i], 0);
+      std::string expected = ReadFile (syncFilename);
+      for (uint32_t j = 0; j < 3; ++j)
+        {
+          WriteFile (asyncFilename, snapLens[i], blockSizes[j]);
+          std::string content = ReadFile (asyncFilename);
+          NS_TEST_EXPECT_MSG_EQ (content.size (), expected.size (), "Wrong file size with snap length "
+                                 << snapLens[i] << " and block size " << blockSizes[j]);
+          NS_TEST_EXPECT_MSG_EQ ((content == expected), true, "Different files with snap length "
+                                 << snapLens[i] << " and block size " << blockSizes[j]);
+        }
+    }
+  remove (syncFilename.c_str ());
+  remove (asyncFilename.c_str ());
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1165,6 +1271,7 @@ PcapFileTestSuite::PcapFileTestSuite ()
   //AddTestCase (new AppendModeCreateTestCase, TestCase::QUICK);
   AddTestCase (new FileHeaderTestCase, TestCase::QUICK);
   AddTestCase (new RecordHeaderTestCase, TestCase::QUICK);
+  AddTestCase (new AsyncWriteTestCase, TestCase::QUICK);
   AddTestCase (new ReadFileTestCase, TestCase::QUICK);
   AddTestCase (new DiffTestCase, TestCase::QUICK);
 }
@@ -0,0 +1,273 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "columnar-trace-file.h"
+#include "ns3/fatal-error.h"
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ColumnarTraceFile");
+
+const char ColumnarTraceFile::MAGIC[8] = { 'n', 's', '3', 'c', 'o', 'l', 't', 'r' };
+
+ColumnarTraceFile::ColumnarTraceFile (std::string const &filename, std::string const &name,
+                                      ValueType type, uint32_t bufferSize)
+  : m_type (type),
+    m_used (0),
+    m_nRecords (0)
+{
+  NS_LOG_FUNCTION (this << filename << name << type << bufferSize);
+  NS_ABORT_MSG_UNLESS (sizeof (FileHeader) == 64 && sizeof (Record) == 16,
+                       "Unexpected layout of the columnar trace structures");
+  m_capacity = std::max<uint32_t> (bufferSize / sizeof (Record), 1);
+  m_buffer = new Record[m_capacity];
+
+  FileHeader header;
+  std::memset (&header, 0, sizeof (header));
+  std::memcpy (header.magic, MAGIC, sizeof (header.magic));
+  header.version = VERSION;
+  header.recordSize = sizeof (Record);
+  header.valueType = type;
+  name.copy (header.name, sizeof (header.name) - 1);
+
+  m_file.open (filename.c_str (), std::ios::out | std::ios::trunc | std::ios::binary);
+  if (m_file.fail ())
+    {
+      NS_FATAL_ERROR ("ColumnarTraceFile::ColumnarTraceFile(): Unable to open " << filename);
+    }
+  m_file.write ((const char *)&header, sizeof (header));
+}
+
+ColumnarTraceFile::~ColumnarTraceFile ()
+{
+  NS_LOG_FUNCTION (this);
+  Flush ();
+  m_file.close ();
+  delete [] m_buffer;
+}
+
+ColumnarTraceFile::ValueType
+ColumnarTraceFile::GetValueType (void) const
+{
+  return m_type;
+}
+
+uint64_t
+ColumnarTraceFile::GetNRecords (void) const
+{
+  return m_nRecords;
+}
+
+void
+ColumnarTraceFile::Write (Time time, uint64_t value)
+{
+  Record &record = m_buffer[m_used];
+  record.time = time.GetNanoSeconds ();
+  record.value = value;
+  m_nRecords++;
+  if (++m_used == m_capacity)
+    {
+      Flush ();
+    }
+}
+
+void
+ColumnarTraceFile::WriteUint (Time time, uint64_t value)
+{
+  NS_ASSERT (m_type == UINT64);
+  Write (time, value);
+}
+
+void
+ColumnarTraceFile::WriteInt (Time time, int64_t value)
+{
+  NS_ASSERT (m_type == INT64);
+  Write (time, static_cast<uint64_t> (value));
+}
+
+void
+ColumnarTraceFile::WriteDouble (Time time, double value)
+{
+  NS_ASSERT (m_type == DOUBLE);
+  Write (time, Traits<double>::Encode (value));
+}
+
+void
+ColumnarTraceFile::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_file.write ((const char *)m_buffer, m_used * sizeof (Record));
+  m_file.flush ();
+  m_used = 0;
+}
+
+bool
+ColumnarTraceFile::Fail (void) const
+{
+  return m_file.fail ();
+}
+
+ColumnarTraceReader::ColumnarTraceReader ()
+  : m_map (0),
+    m_size (0),
+    m_header (0),
+    m_records (0),
+    m_nRecords (0)
+{
+}
+
+ColumnarTraceReader::~ColumnarTraceReader ()
+{
+  Close ();
+}
+
+bool
+ColumnarTraceReader::Open (std::string const &filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  Close ();
+  int fd = open (filename.c_str (), O_RDONLY);
+  if (fd < 0)
+    {
+      return false;
+    }
+  struct stat st;
+  if (fstat (fd, &st) != 0 || st.st_size < static_cast<off_t> (sizeof (ColumnarTraceFile::FileHeader)))
+    {
+      close (fd);
+      return false;
+    }
+  void *map = mmap (0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  // The mapping stays valid once the file is closed
+  close (fd);
+  if (map == MAP_FAILED)
+    {
+      return false;
+    }
+  m_map = map;
+  m_size = st.st_size;
+
+  m_header = static_cast<const ColumnarTraceFile::FileHeader *> (m_map);
+  if (std::memcmp (m_header->magic, ColumnarTraceFile::MAGIC, sizeof (m_header->magic)) != 0
+      || m_header->version != ColumnarTraceFile::VERSION
+      || m_header->recordSize != sizeof (ColumnarTraceFile::Record)
+      || m_header->valueType > ColumnarTraceFile::DOUBLE)
+    {
+      Close ();
+      return false;
+    }
+  // Sequential scans are the common case
+  madvise (m_map, m_size, MADV_SEQUENTIAL);
+  m_records = reinterpret_cast<const ColumnarTraceFile::Record *> (m_header + 1);
+  // A trailing partial record, if the writer was interrupted, is ignored
+  m_nRecords = (m_size - sizeof (ColumnarTraceFile::FileHeader)) / sizeof (ColumnarTraceFile::Record);
+  return true;
+}
+
+void
+ColumnarTraceReader::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_map != 0)
+    {
+      munmap (m_map, m_size);
+    }
+  m_map = 0;
+  m_size = 0;
+  m_header = 0;
+  m_records = 0;
+  m_nRecords = 0;
+}
+
+std::string
+ColumnarTraceReader::GetName (void) const
+{
+  NS_ASSERT (m_header != 0);
+  return std::string (m_header->name, strnlen (m_header->name, sizeof (m_header->name)));
+}
+
+ColumnarTraceFile::ValueType
+ColumnarTraceReader::GetValueType (void) const
+{
+  NS_ASSERT (m_header != 0);
+  return static_cast<ColumnarTraceFile::ValueType> (m_header->valueType);
+}
+
+uint64_t
+ColumnarTraceReader::GetNRecords (void) const
+{
+  return m_nRecords;
+}
+
+const ColumnarTraceFile::Record *
+ColumnarTraceReader::GetRecords (void) const
+{
+  return m_records;
+}
+
+Time
+ColumnarTraceReader::GetTime (uint64_t i) const
+{
+  NS_ASSERT (i < m_nRecords);
+  return NanoSeconds (m_records[i].time);
+}
+
+double
+ColumnarTraceReader::GetValue (uint64_t i) const
+{
+  switch (GetValueType ())
+    {
+    case ColumnarTraceFile::UINT64:
+      return static_cast<double> (GetUint (i));
+    case ColumnarTraceFile::INT64:
+      return static_cast<double> (GetInt (i));
+    default:
+      return GetDouble (i);
+    }
+}
+
+uint64_t
+ColumnarTraceReader::GetUint (uint64_t i) const
+{
+  NS_ASSERT (i < m_nRecords && GetValueType () == ColumnarTraceFile::UINT64);
+  return m_records[i].value;
+}
+
+int64_t
+ColumnarTraceReader::GetInt (uint64_t i) const
+{
+  NS_ASSERT (i < m_nRecords && GetValueType () == ColumnarTraceFile::INT64);
+  return static_cast<int64_t> (m_records[i].value);
+}
+
+double
+ColumnarTraceReader::GetDouble (uint64_t i) const
+{
+  NS_ASSERT (i < m_nRecords && GetValueType () == ColumnarTraceFile::DOUBLE);
+  double value;
+  std::memcpy (&value, &m_records[i].value, sizeof (value));
+  return value;
+}
+
+} // namespace ns3
@@ -0,0 +1,383 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef COLUMNAR_TRACE_FILE_H
+#define COLUMNAR_TRACE_FILE_H
+
+#include <stdint.h>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include "ns3/simple-ref-count.h"
+#include "ns3/assert.h"
+#include "ns3/callback.h"
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
+#include "sequence-number.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ *
+ * \brief Binary trace file of the values of one trace source
+ *
+ * A columnar trace file holds the values taken by a single trace source,
+ * typically a TracedValue such as the CongestionWindow or the RTT of a
+ * TCP socket, the BytesInQueue of a queue disc or the VirtualQueue of a
+ * PhantomQueue.  It is meant to replace the text files written through
+ * an AsciiTraceHelper stream when the traces are large: the file can be
+ * mapped in memory and scanned without any parsing.
+ *
+ * The file starts with a 64-byte header (see FileHeader) followed by
+ * fixed-width 16-byte records, each made of the simulation time in
+ * nanoseconds and of the new value, both 64-bit and in the byte order of
+ * the machine which wrote the file.  The number of records is deduced
+ * from the size of the file.  The value is stored, depending on the type
+ * of the trace source, as an unsigned integer, a signed integer or a
+ * double (see ValueType); Time values are stored in nanoseconds.  The
+ * records can for instance be read with numpy as
+ * \verbatim
+   numpy.memmap (filename, dtype=[('time', '<i8'), ('value', '<u8')], offset=64)
+   \endverbatim
+ * replacing u8 by i8 or f8 according to the value type.
+ *
+ * The records are gathered in a buffer which is written to the file when
+ * full, so that large traces are written at the bandwidth of the disk.
+ * The sinks returned by MakeSink can be connected to trace sources:
+ * \code
+ *   Ptr<ColumnarTraceFile> file = Create<ColumnarTraceFile> ("cwnd.col", "cwnd");
+ *   socket->TraceConnectWithoutContext ("CongestionWindow", file->MakeSink<uint32_t> ());
+ * \endcode
+ *
+ * ColumnarTraceReader maps the files for the analysis.
+ */
+class ColumnarTraceFile : public SimpleRefCount<ColumnarTraceFile>
+{
+public:
+  /// Type of the values of a file
+  enum ValueType
+  {
+    UINT64 = 0,  //!< unsigned integers
+    INT64 = 1,   //!< signed integers, and times in nanoseconds
+    DOUBLE = 2   //!< floating point values
+  };
+
+  /// Header at the start of a file
+  struct FileHeader
+  {
+    char magic[8];          //!< MAGIC, not null terminated
+    uint32_t version;       //!< VERSION
+    uint32_t recordSize;    //!< size of the records, in bytes
+    uint32_t valueType;     //!< type of the values, a ValueType
+    uint32_t reserved;      //!< zero
+    uint64_t reserved2;     //!< zero
+    char name[32];          //!< name of the trace, null terminated
+  };
+
+  /// A record of a file
+  struct Record
+  {
+    int64_t time;           //!< simulation time in nanoseconds
+    uint64_t value;         //!< bits of the value
+  };
+
+  static const char MAGIC[8];                   //!< Magic number of the files
+  static const uint32_t VERSION = 1;            //!< Version of the format
+  static const uint32_t BUFFER_SIZE_DEFAULT = 1 << 20; //!< Default size of the write buffer, in bytes
+
+  /**
+   * Create the file, replacing any existing file
+   *
+   * \param filename the file name
+   * \param name the name of the trace, truncated to 31 characters
+   * \param type the type of the values, see MakeSink
+   * \param bufferSize the size of the write buffer, in bytes
+   */
+  ColumnarTraceFile (std::string const &filename, std::string const &name,
+                     ValueType type = UINT64, uint32_t bufferSize = BUFFER_SIZE_DEFAULT);
+  /**
+   * Write the buffered records and close the file
+   */
+  ~ColumnarTraceFile ();
+
+  /**
+   * \returns the type of the values
+   */
+  ValueType GetValueType (void) const;
+  /**
+   * \returns the number of records written so far
+   */
+  uint64_t GetNRecords (void) const;
+
+  /**
+   * \brief Write an unsigned value
+   * \param time the time of the value
+   * \param value the value
+   */
+  void WriteUint (Time time, uint64_t value);
+  /**
+   * \brief Write a signed value
+   * \param time the time of the value
+   * \param value the value
+   */
+  void WriteInt (Time time, int64_t value);
+  /**
+   * \brief Write a floating point value
+   * \param time the time of the value
+   * \param value the value
+   */
+  void WriteDouble (Time time, double value);
+
+  /**
+   * \brief Write the buffered records to the file
+   */
+  void Flush (void);
+  /**
+   * \returns true if a write to the file failed
+   */
+  bool Fail (void) const;
+
+  /**
+   * \brief A sink for a TracedValue, writing the new value at the current
+   * simulation time
+   * \tparam T the type of the TracedValue
+   * \param oldValue the previous value, ignored
+   * \param newValue the new value
+   */
+  template <typename T>
+  void TracedValueSink (T oldValue, T newValue);
+  /**
+   * \tparam T the type of the TracedValue: an arithmetic or enum type,
+   * Time or SequenceNumber32, whose value type must match the type of
+   * the file
+   * \returns a callback to TracedValueSink on this file, which keeps
+   * the file open as long as it is connected
+   */
+  template <typename T>
+  Callback<void, T, T> MakeSink (void);
+
+  /**
+   * \tparam T the type of a TracedValue
+   * \returns the value type of the file for this type
+   */
+  template <typename T>
+  static ValueType GetValueTypeOf (void);
+
+private:
+  /**
+   * \brief Write a record
+   * \param time the time of the value
+   * \param value the bits of the value
+   */
+  void Write (Time time, uint64_t value);
+
+  /// Value types of the arithmetic and enum types
+  template <typename T, bool = std::is_floating_point<T>::value>
+  struct Traits
+  {
+    static const ValueType type = std::is_signed<T>::value || std::is_enum<T>::value ? INT64 : UINT64; //!< value type
+    /**
+     * \param value a value
+     * \returns the bits of the value
+     */
+    static uint64_t Encode (T value)
+    {
+      return type == INT64 ? static_cast<uint64_t> (static_cast<int64_t> (value)) : static_cast<uint64_t> (value);
+    }
+  };
+  /// Value type of the floating point types
+  template <typename T>
+  struct Traits<T, true>
+  {
+    static const ValueType type = DOUBLE; //!< value type
+    /**
+     * \param value a value
+     * \returns the bits of the value
+     */
+    static uint64_t Encode (T value)
+    {
+      double d = value;
+      uint64_t bits;
+      std::memcpy (&bits, &d, sizeof (bits));
+      return bits;
+    }
+  };
+
+  std::ofstream m_file;   //!< the file
+  ValueType m_type;       //!< the type of the values
+  Record *m_buffer;       //!< the buffered records
+  uint32_t m_capacity;    //!< the number of records of the buffer
+  uint32_t m_used;        //!< the number of buffered records
+  uint64_t m_nRecords;    //!< the number of records written
+};
+
+/**
+ * \ingroup network
+ *
+ * \brief Memory mapped reader of a ColumnarTraceFile
+ *
+ * The whole file is mapped read-only and the records are accessed in
+ * place, so that scanning a trace costs no more than reading it from
+ * the disk.
+ */
+class ColumnarTraceReader
+{
+public:
+  ColumnarTraceReader ();
+  /**
+   * Unmap the file
+   */
+  ~ColumnarTraceReader ();
+
+  /**
+   * \brief Map a file
+   * \param filename the file name
+   * \returns false if the file cannot be mapped or is not a columnar
+   * trace file
+   */
+  bool Open (std::string const &filename);
+  /**
+   * \brief Unmap the file, if any
+   */
+  void Close (void);
+
+  /**
+   * \returns the name of the trace
+   */
+  std::string GetName (void) const;
+  /**
+   * \returns the type of the values
+   */
+  ColumnarTraceFile::ValueType GetValueType (void) const;
+  /**
+   * \returns the number of records
+   */
+  uint64_t GetNRecords (void) const;
+  /**
+   * \returns the records, in the mapped file
+   */
+  const ColumnarTraceFile::Record *GetRecords (void) const;
+
+  /**
+   * \param i the index of a record
+   * \returns the time of the record
+   */
+  Time GetTime (uint64_t i) const;
+  /**
+   * \param i the index of a record
+   * \returns the value of the record, converted to a double whatever the
+   * value type
+   */
+  double GetValue (uint64_t i) const;
+  /**
+   * \param i the index of a record of an UINT64 file
+   * \returns the value of the record
+   */
+  uint64_t GetUint (uint64_t i) const;
+  /**
+   * \param i the index of a record of an INT64 file
+   * \returns the value of the record
+   */
+  int64_t GetInt (uint64_t i) const;
+  /**
+   * \param i the index of a record of a DOUBLE file
+   * \returns the value of the record
+   */
+  double GetDouble (uint64_t i) const;
+
+private:
+  /**
+   * \brief Copy constructor, not implemented
+   * \param o the object to copy
+   */
+  ColumnarTraceReader (ColumnarTraceReader const &o);
+  /**
+   * \brief Assignment, not implemented
+   * \param o the object to copy
+   * \returns this object
+   */
+  ColumnarTraceReader &operator = (ColumnarTraceReader const &o);
+
+  void *m_map;                                //!< the mapped file
+  uint64_t m_size;                            //!< the size of the mapping
+  const ColumnarTraceFile::FileHeader *m_header; //!< the header of the file
+  const ColumnarTraceFile::Record *m_records; //!< the records of the file
+  uint64_t m_nRecords;                        //!< the number of records
+};
+
+} // namespace ns3
+
+/****************************************************
+ *      Template implementation
+ ***************************************************/
+
+namespace ns3 {
+
+template <typename T>
+ColumnarTraceFile::ValueType
+ColumnarTraceFile::GetValueTypeOf (void)
+{
+  return Traits<T>::type;
+}
+
+template <>
+inline ColumnarTraceFile::ValueType
+ColumnarTraceFile::GetValueTypeOf<Time> (void)
+{
+  return INT64;
+}
+
+template <>
+inline ColumnarTraceFile::ValueType
+ColumnarTraceFile::GetValueTypeOf<SequenceNumber32> (void)
+{
+  return UINT64;
+}
+
+template <typename T>
+void
+ColumnarTraceFile::TracedValueSink (T oldValue, T newValue)
+{
+  Write (Simulator::Now (), Traits<T>::Encode (newValue));
+}
+
+template <>
+inline void
+ColumnarTraceFile::TracedValueSink<Time> (Time oldValue, Time newValue)
+{
+  Write (Simulator::Now (), static_cast<uint64_t> (newValue.GetNanoSeconds ()));
+}
+
+template <>
+inline void
+ColumnarTraceFile::TracedValueSink<SequenceNumber32> (SequenceNumber32 oldValue, SequenceNumber32 newValue)
+{
+  Write (Simulator::Now (), newValue.GetValue ());
+}
+
+template <typename T>
+Callback<void, T, T>
+ColumnarTraceFile::MakeSink (void)
+{
+  NS_ASSERT_MSG (GetValueTypeOf<T> () == m_type, "Trace sink of another value type than the file");
+  return MakeCallback (&ColumnarTraceFile::TracedValueSink<T>, Ptr<ColumnarTraceFile> (this));
+}
+
+} // namespace ns3
+
+#endif /* COLUMNAR_TRACE_FILE_H */
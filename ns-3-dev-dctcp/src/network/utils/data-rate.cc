@@ -22,6 +22,8 @@
 #include "ns3/nstime.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
+#include <algorithm>
+#include <limits>
 
 namespace ns3 {
   
@@ -235,15 +237,52 @@ double DataRate::CalculateTxTime (uint32_t bytes) const
 Time DataRate::CalculateBytesTxTime (uint32_t bytes) const
 {
   NS_LOG_FUNCTION (this << bytes);
-  // \todo avoid to use double (if possible).
-  return Seconds (static_cast<double>(bytes)*8/m_bps);
+  return BitsTxTime (static_cast<uint64_t> (bytes) * 8, m_bps);
 }
 
 Time DataRate::CalculateBitsTxTime (uint32_t bits) const
 {
   NS_LOG_FUNCTION (this << bits);
-  // \todo avoid to use double (if possible).
-  return Seconds (static_cast<double>(bits)/m_bps);
+  return BitsTxTime (bits, m_bps);
+}
+
+uint64_t DataRate::CalculateBytesInTime (const Time &time) const
+{
+  NS_LOG_FUNCTION (this << time);
+  if (time.IsNegative ())
+    {
+      return 0;
+    }
+#ifdef HAVE___UINT128_T
+  if (Time::GetResolution () == Time::NS)
+    {
+      unsigned __int128 bytes = static_cast<unsigned __int128> (time.GetTimeStep ()) * m_bps / BIT_NS_PER_BYTE;
+      if (bytes <= std::numeric_limits<uint64_t>::max ())
+        {
+          return static_cast<uint64_t> (bytes);
+        }
+    }
+#endif
+  return static_cast<uint64_t> (time.GetSeconds () * m_bps / 8);
+}
+
+const uint64_t DataRate::BIT_NS_PER_BYTE;
+
+Time DataRate::BitsTxTime (uint64_t bits, uint64_t bps)
+{
+#ifdef HAVE___UINT128_T
+  // The exact number of nanoseconds, rounded down like the conversions
+  // of the other time resolutions
+  if (Time::GetResolution () == Time::NS && bps > 0)
+    {
+      unsigned __int128 ns = static_cast<unsigned __int128> (bits) * 1000000000 / bps;
+      if (ns <= static_cast<uint64_t> (std::numeric_limits<int64_t>::max ()))
+        {
+          return Time (static_cast<int64_t> (ns));
+        }
+    }
+#endif
+  return Seconds (static_cast<double> (bits) / bps);
 }
 
 uint64_t DataRate::GetBitRate () const
@@ -293,4 +332,67 @@ double operator* (const Time& lhs, const DataRate& rhs)
   return lhs.GetSeconds ()*rhs.GetBitRate ();
 }
 
+TxTimeCalculator::TxTimeCalculator ()
+  : m_nsPerByte (0),
+    m_nsPerByteFraction (0),
+    m_maxBytes (0),
+    m_bytesPerNs (0),
+    m_bytesPerNsFraction (0),
+    m_maxNs (0)
+{
+}
+
+TxTimeCalculator::TxTimeCalculator (const DataRate &rate)
+  : m_rate (rate),
+    m_nsPerByte (0),
+    m_nsPerByteFraction (0),
+    m_maxBytes (0),
+    m_bytesPerNs (0),
+    m_bytesPerNsFraction (0),
+    m_maxNs (0)
+{
+  NS_LOG_FUNCTION (this << rate);
+#ifdef HAVE___UINT128_T
+  uint64_t bps = rate.GetBitRate ();
+  if (bps == 0 || Time::GetResolution () != Time::NS)
+    {
+      // Every conversion falls back to the DataRate
+      return;
+    }
+  const uint64_t maxValue = std::numeric_limits<uint64_t>::max ();
+
+  // The nanoseconds per byte are 8e9 / bps, and bytes * 8e9 / bps is at
+  // least 1 / bps away from the next integer when it is not one.  Rounding
+  // the fraction up makes an error below bytes / 2^64, which hence does not
+  // change the integer part as long as bytes < 2^64 / bps
+  m_nsPerByte = DataRate::BIT_NS_PER_BYTE / bps;
+  m_nsPerByteFraction = CeilFraction (DataRate::BIT_NS_PER_BYTE % bps, bps);
+  m_maxBytes = std::min (maxValue / bps,
+                         static_cast<uint64_t> (std::numeric_limits<int64_t>::max ()) / (m_nsPerByte + 1));
+
+  // Likewise, the bytes per nanosecond are bps / 8e9
+  m_bytesPerNs = bps / DataRate::BIT_NS_PER_BYTE;
+  m_bytesPerNsFraction = CeilFraction (bps % DataRate::BIT_NS_PER_BYTE, DataRate::BIT_NS_PER_BYTE);
+  m_maxNs = std::min (maxValue / DataRate::BIT_NS_PER_BYTE, maxValue / (m_bytesPerNs + 1));
+#endif
+}
+
+DataRate
+TxTimeCalculator::GetDataRate (void) const
+{
+  return m_rate;
+}
+
+uint64_t
+TxTimeCalculator::CeilFraction (uint64_t numerator, uint64_t denominator)
+{
+#ifdef HAVE___UINT128_T
+  NS_ASSERT (numerator < denominator);
+  return ((static_cast<unsigned __int128> (numerator) << 64) + denominator - 1) / denominator;
+#else
+  NS_FATAL_ERROR ("TxTimeCalculator::CeilFraction(): 128-bit integers are not supported");
+  return 0;
+#endif
+}
+
 } // namespace ns3
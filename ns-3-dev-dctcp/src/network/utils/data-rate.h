@@ -24,6 +24,7 @@
 #include <string>
 #include <iostream>
 #include <stdint.h>
+#include "ns3/core-config.h"
 #include "ns3/nstime.h"
 #include "ns3/attribute.h"
 #include "ns3/attribute-helper.h"
@@ -178,6 +179,15 @@ public:
    */
   Time CalculateBitsTxTime (uint32_t bits) const;
 
+  /**
+   * \brief Calculate the number of bytes transmitted in a given time
+   *
+   * Calculates the number of whole bytes transmitted at this data rate
+   * \param time The duration of the transmission
+   * \return The number of bytes transmitted in \p time, 0 if \p time is negative
+   */
+  uint64_t CalculateBytesInTime (const Time &time) const;
+
   /**
    * \brief Calculate transmission time
    *
@@ -197,7 +207,17 @@ public:
    */
   uint64_t GetBitRate () const;
 
+  /// Number of bit-nanoseconds in a byte: a byte takes 8e9 / bps nanoseconds
+  static const uint64_t BIT_NS_PER_BYTE = 8000000000ULL;
+
 private:
+  /**
+   * \brief Calculate transmission time
+   * \param bits The number of bits
+   * \param bps The data rate, in bits per second
+   * \return The transmission time of \p bits at \p bps
+   */
+  static Time BitsTxTime (uint64_t bits, uint64_t bps);
 
   /**
    * \brief Parse a string representing a DataRate into an uint64_t
@@ -241,6 +261,104 @@ std::istream &operator >> (std::istream &is, DataRate &rate);
 
 ATTRIBUTE_HELPER_HEADER (DataRate);
 
+/**
+ * \ingroup datarate
+ * \brief Conversions between bytes and transmission times at a fixed
+ * DataRate, without divisions
+ *
+ * DataRate::CalculateBytesTxTime divides by the bit rate every time it is
+ * called.  A device transmitting at a given rate can instead keep a
+ * TxTimeCalculator, built when the rate is set, which holds the number of
+ * nanoseconds needed to transmit a byte (and the number of bytes
+ * transmitted in a nanosecond) as fixed-point numbers with 64 fractional
+ * bits, rounded up.  A conversion then costs a multiplication, and gives
+ * exactly the result of the DataRate methods.  The few conversions for
+ * which the fixed-point numbers are not accurate enough, such as those of
+ * very large sizes, fall back to the DataRate methods.
+ *
+ * The fixed-point numbers are only used with the default nanosecond time
+ * resolution, which must hence be set before the calculator is built.
+ */
+class TxTimeCalculator
+{
+public:
+  TxTimeCalculator ();
+  /**
+   * \brief Build the calculator of a data rate
+   * \param rate the data rate
+   */
+  TxTimeCalculator (const DataRate &rate);
+
+  /**
+   * \return the data rate of the calculator
+   */
+  DataRate GetDataRate (void) const;
+
+  /**
+   * \brief Calculate transmission time, see DataRate::CalculateBytesTxTime
+   * \param bytes The number of bytes (not bits) for which to calculate
+   * \return The transmission time for the number of bytes specified
+   */
+  Time CalculateBytesTxTime (uint32_t bytes) const
+  {
+    if (bytes <= m_maxBytes)
+      {
+        return Time (static_cast<int64_t> (bytes * m_nsPerByte + MulHigh (bytes, m_nsPerByteFraction)));
+      }
+    return m_rate.CalculateBytesTxTime (bytes);
+  }
+  /**
+   * \brief Calculate the number of bytes transmitted in a given time, see
+   * DataRate::CalculateBytesInTime
+   * \param time The duration of the transmission
+   * \return The number of bytes transmitted in \p time, 0 if \p time is negative
+   */
+  uint64_t CalculateBytesInTime (const Time &time) const
+  {
+    int64_t ns = time.GetTimeStep ();
+    if (ns >= 0 && static_cast<uint64_t> (ns) <= m_maxNs)
+      {
+        return ns * m_bytesPerNs + MulHigh (ns, m_bytesPerNsFraction);
+      }
+    return m_rate.CalculateBytesInTime (time);
+  }
+
+private:
+  /**
+   * \param numerator the numerator, smaller than \p denominator
+   * \param denominator the denominator
+   * \return the 64 fractional bits of \p numerator / \p denominator, rounded up
+   */
+  static uint64_t CeilFraction (uint64_t numerator, uint64_t denominator);
+  /**
+   * \param a a factor
+   * \param b a factor
+   * \return the 64 most significant bits of the 128-bit product of \p a by \p b
+   */
+  static uint64_t MulHigh (uint64_t a, uint64_t b)
+  {
+#ifdef HAVE___UINT128_T
+    return (static_cast<unsigned __int128> (a) * b) >> 64;
+#else
+    uint64_t aLow = a & 0xffffffff;
+    uint64_t aHigh = a >> 32;
+    uint64_t bLow = b & 0xffffffff;
+    uint64_t bHigh = b >> 32;
+    uint64_t middle = aHigh * bLow + ((aLow * bLow) >> 32);
+    uint64_t middle2 = aLow * bHigh + (middle & 0xffffffff);
+    return aHigh * bHigh + (middle >> 32) + (middle2 >> 32);
+#endif
+  }
+
+  DataRate m_rate;               //!< the data rate
+  uint64_t m_nsPerByte;          //!< integer part of the nanoseconds per byte
+  uint64_t m_nsPerByteFraction;  //!< fractional part of the nanoseconds per byte
+  uint64_t m_maxBytes;           //!< largest number of bytes converted exactly
+  uint64_t m_bytesPerNs;         //!< integer part of the bytes per nanosecond
+  uint64_t m_bytesPerNsFraction; //!< fractional part of the bytes per nanosecond
+  uint64_t m_maxNs;              //!< largest number of nanoseconds converted exactly
+};
+
 
 /**
  * \brief Multiply datarate by a time value
@@ -88,6 +88,7 @@ DynamicQueueLimits::Reset ()
   NS_LOG_FUNCTION (this);
   // Reset all dynamic values
   m_limit = 0;
+  m_adjLimit = 0;
   m_numQueued = 0;
   m_numCompleted = 0;
   m_lastObjCnt = 0;
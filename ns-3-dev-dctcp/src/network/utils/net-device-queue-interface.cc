@@ -24,6 +24,7 @@
 #include "ns3/simulator.h"
 #include "ns3/uinteger.h"
 #include "ns3/queue-item.h"
+#include <limits>
 
 namespace ns3 {
 
@@ -32,6 +33,7 @@ NS_LOG_COMPONENT_DEFINE ("NetDeviceQueueInterface");
 NetDeviceQueue::NetDeviceQueue ()
   : m_stoppedByDevice (false),
     m_stoppedByQueueLimits (false),
+    m_inBurst (false),
     NS_LOG_TEMPLATE_DEFINE ("NetDeviceQueueInterface")
 {
   NS_LOG_FUNCTION (this);
@@ -43,6 +45,7 @@ NetDeviceQueue::~NetDeviceQueue ()
 
   m_queueLimits = 0;
   m_wakeCallback.Nullify ();
+  m_room = nullptr;
   m_device = 0;
 }
 
@@ -106,7 +109,8 @@ NetDeviceQueue::NotifyQueuedBytes (uint32_t bytes)
       return;
     }
   m_queueLimits->Queued (bytes);
-  if (m_queueLimits->Available () >= 0)
+  // Within a burst, the queue limits are checked by EndBurst
+  if (m_inBurst || m_queueLimits->Available () >= 0)
     {
       return;
     }
@@ -135,6 +139,51 @@ NetDeviceQueue::NotifyTransmittedBytes (uint32_t bytes)
     }
 }
 
+void
+NetDeviceQueue::BeginBurst (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_inBurst = true;
+}
+
+void
+NetDeviceQueue::EndBurst (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_inBurst = false;
+  if (m_queueLimits && m_queueLimits->Available () < 0)
+    {
+      m_stoppedByQueueLimits = true;
+    }
+  if (m_room && m_room () == 0)
+    {
+      NS_LOG_DEBUG ("The device queue is being stopped after a burst");
+      Stop ();
+    }
+}
+
+uint32_t
+NetDeviceQueue::GetAvailablePackets (void) const
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_room)
+    {
+      return 1;
+    }
+  return m_room ();
+}
+
+int32_t
+NetDeviceQueue::GetAvailableBytes (void) const
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_queueLimits)
+    {
+      return std::numeric_limits<int32_t>::max ();
+    }
+  return m_queueLimits->Available ();
+}
+
 void
 NetDeviceQueue::ResetQueueLimits ()
 {
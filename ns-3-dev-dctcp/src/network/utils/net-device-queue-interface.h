@@ -27,6 +27,7 @@
 #include "ns3/ptr.h"
 #include "ns3/log.h"
 #include "ns3/net-device.h"
+#include "ns3/queue-size.h"
 
 namespace ns3 {
 
@@ -60,20 +61,20 @@ public:
 
   /**
    * Called by the device to start this device transmission queue.
-   * This is the analogous to the netif_tx_start_queue function of the Linux kernel.
+   * This is analogous to the netif_tx_start_queue function of the Linux kernel.
    */
   virtual void Start (void);
 
   /**
    * Called by the device to stop this device transmission queue.
-   * This is the analogous to the netif_tx_stop_queue function of the Linux kernel.
+   * This is analogous to the netif_tx_stop_queue function of the Linux kernel.
    */
   virtual void Stop (void);
 
   /**
    * Called by the device to wake the queue disc associated with this
    * device transmission queue. This is done by invoking the wake callback.
-   * This is the analogous to the netif_tx_wake_queue function of the Linux kernel.
+   * This is analogous to the netif_tx_wake_queue function of the Linux kernel.
    */
   virtual void Wake (void);
 
@@ -82,7 +83,7 @@ public:
    * \return true if the device transmission queue is stopped.
    *
    * Called by queue discs to enquire about the status of a given transmission queue.
-   * This is the analogous to the netif_xmit_stopped function of the Linux kernel.
+   * This is analogous to the netif_xmit_stopped function of the Linux kernel.
    */
   bool IsStopped (void) const;
 
@@ -124,6 +125,43 @@ public:
    */
   void NotifyTransmittedBytes (uint32_t bytes);
 
+  /**
+   * \brief Called by the netdevice before enqueuing a burst of packets in the
+   *        device queue
+   *
+   * Until EndBurst is called, the packets enqueued are accounted to the queue
+   * limits, but the device transmission queue is not stopped.  The queue disc
+   * sized the burst so that it fits the device queue and the queue limits.
+   * This is analogous to the xmit_more flag of the Linux kernel.
+   */
+  void BeginBurst (void);
+
+  /**
+   * \brief Called by the netdevice after enqueuing a burst of packets in the
+   *        device queue, to stop the device transmission queue if the queue
+   *        limits are exceeded or the device queue cannot store another packet
+   */
+  void EndBurst (void);
+
+  /**
+   * \brief Get the number of packets which can be sent in a burst to the device
+   * \return the number of packets of MTU size the device queue can still store,
+   *         or one if the device queue is unknown
+   *
+   * Called by queue discs to size their bulk dequeues.
+   */
+  uint32_t GetAvailablePackets (void) const;
+
+  /**
+   * \brief Get the number of bytes which can be sent in a burst to the device
+   * \return the number of bytes the queue limits allow to queue, or the
+   *         largest value if this queue has no queue limits
+   *
+   * Called by queue discs to size their bulk dequeues.  This is analogous
+   * to the qdisc_avail_bulklimit function of the Linux kernel.
+   */
+  int32_t GetAvailableBytes (void) const;
+
   /**
    * \brief Reset queue limits state
    */
@@ -197,8 +235,18 @@ public:
   void ConnectQueueTraces (Ptr<QueueType> queue);
 
 private:
+  /**
+   * \brief Get the room left in the queue of a netdevice
+   * \param queue the device queue
+   * \return the number of packets of MTU size the device queue can still store
+   */
+  template <typename QueueType>
+  uint32_t GetRoom (QueueType* queue) const;
+
   bool m_stoppedByDevice;         //!< True if the queue has been stopped by the device
   bool m_stoppedByQueueLimits;    //!< True if the queue has been stopped by a queue limits object
+  bool m_inBurst;                 //!< True while the device enqueues a burst of packets
+  std::function<uint32_t (void)> m_room;  //!< Returns the room left in the device queue
   Ptr<QueueLimits> m_queueLimits; //!< Queue limits object
   WakeCallback m_wakeCallback;    //!< Wake callback
   Ptr<NetDevice> m_device;        //!< the netdevice aggregated to the NetDeviceQueueInterface
@@ -317,6 +365,23 @@ NetDeviceQueue::ConnectQueueTraces (Ptr<QueueType> queue)
   queue->TraceConnectWithoutContext ("DropBeforeEnqueue",
                                      MakeCallback (&NetDeviceQueue::PacketDiscarded<QueueType>, this)
                                      .Bind (PeekPointer (queue)));
+  QueueType* q = PeekPointer (queue);
+  m_room = [this, q] () { return GetRoom (q); };
+}
+
+template <typename QueueType>
+uint32_t
+NetDeviceQueue::GetRoom (QueueType* queue) const
+{
+  NS_ASSERT_MSG (m_device, "Aggregated NetDevice not set");
+  QueueSize maxSize = queue->GetMaxSize ();
+  uint32_t current = queue->GetCurrentSize ().GetValue ();
+  if (current >= maxSize.GetValue ())
+    {
+      return 0;
+    }
+  uint32_t room = maxSize.GetValue () - current;
+  return (maxSize.GetUnit () == QueueSizeUnit::PACKETS ? room : room / m_device->GetMtu ());
 }
 
 template <typename QueueType>
@@ -328,13 +393,16 @@ NetDeviceQueue::PacketEnqueued (QueueType* queue, Ptr<const typename QueueType::
   // Inform BQL
   NotifyQueuedBytes (item->GetSize ());
 
-  NS_ASSERT_MSG (m_device, "Aggregated NetDevice not set");
-  Ptr<Packet> p = Create<Packet> (m_device->GetMtu ());
+  // Within a burst, the queue is checked by EndBurst
+  if (m_inBurst)
+    {
+      return;
+    }
 
   // After enqueuing a packet, we need to check whether the queue is able to
   // store another packet. If not, we stop the queue
 
-  if (queue->GetCurrentSize () + p > queue->GetMaxSize ())
+  if (GetRoom (queue) == 0)
     {
       NS_LOG_DEBUG ("The device queue is being stopped (" << queue->GetCurrentSize ()
                     << " inside)");
@@ -351,14 +419,11 @@ NetDeviceQueue::PacketDequeued (QueueType* queue, Ptr<const typename QueueType::
   // Inform BQL
   NotifyTransmittedBytes (item->GetSize ());
 
-  NS_ASSERT_MSG (m_device, "Aggregated NetDevice not set");
-  Ptr<Packet> p = Create<Packet> (m_device->GetMtu ());
-
   // After dequeuing a packet, if there is room for another packet we
   // call Wake () that ensures that the queue is not stopped and restarts
   // the queue disc if the queue was stopped
 
-  if (queue->GetCurrentSize () + p <= queue->GetMaxSize ())
+  if (GetRoom (queue) > 0)
     {
       Wake ();
     }
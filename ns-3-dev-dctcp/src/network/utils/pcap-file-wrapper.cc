@@ -37,7 +37,8 @@ PcapFileWrapper::GetTypeId (void)
     .SetGroupName("Network")
     .AddConstructor<PcapFileWrapper> ()
     .AddAttribute ("CaptureSize",
-                   "Maximum length of captured packets (cf. pcap snaplen)",
+                   "Maximum length of captured packets (cf. pcap snaplen). "
+                   "PcapFile::SNAPLEN_HEADERS keeps the headers of the packets only.",
                    UintegerValue (PcapFile::SNAPLEN_DEFAULT),
                    MakeUintegerAccessor (&PcapFileWrapper::m_snapLen),
                    MakeUintegerChecker<uint32_t> (0, PcapFile::SNAPLEN_DEFAULT))
@@ -46,6 +47,16 @@ PcapFileWrapper::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&PcapFileWrapper::m_nanosecMode),
                    MakeBooleanChecker())
+    .AddAttribute ("Asynchronous",
+                   "Whether the packets are written to the file by a background thread.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PcapFileWrapper::m_async),
+                   MakeBooleanChecker())
+    .AddAttribute ("BufferSize",
+                   "Size of the blocks of packets handed over to the background thread.",
+                   UintegerValue (PcapFile::ASYNC_BLOCK_SIZE_DEFAULT),
+                   MakeUintegerAccessor (&PcapFileWrapper::m_bufferSize),
+                   MakeUintegerChecker<uint32_t> (1))
   ;
   return tid;
 }
@@ -113,6 +124,10 @@ PcapFileWrapper::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t tzCorrec
     {
       m_file.Init (dataLinkType, m_snapLen, tzCorrection, false, m_nanosecMode);
     } 
+  if (m_async)
+    {
+      m_file.EnableAsync (m_bufferSize);
+    }
 }
 
 void
@@ -102,6 +102,9 @@ public:
    * time zone from UTC/GMT.  For example, Pacific Standard Time in the US is
    * GMT-8, so one would enter -8 for that correction.  Defaults to 0 (UTC).
    *
+   * If the "Asynchronous" attribute is set, the packets are then written
+   * to the file by a background thread (see PcapFile::EnableAsync).
+   *
    * \warning Calling this method on an existing file will result in the loss
    * any existing data.
    */
@@ -224,6 +227,8 @@ private:
   PcapFile m_file; //!< Pcap file
   uint32_t m_snapLen; //!< max length of saved packets
   bool     m_nanosecMode; //!< Timestamps in nanosecond mode
+  bool     m_async; //!< Write from a background thread
+  uint32_t m_bufferSize; //!< size of the blocks of the background thread
 };
 
 } // namespace ns3
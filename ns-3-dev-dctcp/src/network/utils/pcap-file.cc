@@ -20,6 +20,14 @@
 
 #include <iostream>
 #include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <deque>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "ns3/assert.h"
 #include "ns3/packet.h"
 #include "ns3/fatal-error.h"
@@ -47,10 +55,242 @@ const uint32_t NS_SWAPPED_MAGIC = 0x4d3cb2a1; /**< Looks this way if byte swappi
 const uint16_t VERSION_MAJOR = 2;             /**< Major version of supported pcap file format */
 const uint16_t VERSION_MINOR = 4;             /**< Minor version of supported pcap file format */
 
+const uint32_t RECORD_HEADER_SIZE = 16;       /**< Size of a record header in the file */
+
+/**
+ * \brief Writer thread of the asynchronous mode of PcapFile
+ *
+ * The records are appended to the current block; once full, the block is
+ * queued for the thread, which writes it to the stream and puts it back
+ * into the free blocks.  At most MAX_BLOCKS blocks are allocated: when none
+ * is free, Reserve waits for the thread.
+ */
+class PcapFile::AsyncWriter
+{
+public:
+  /**
+   * Start the thread
+   * \param stream the stream to write to, only used by the thread from now
+   * on, except within Flush
+   * \param blockSize the size of the blocks
+   */
+  AsyncWriter (std::ostream *stream, uint32_t blockSize);
+  /**
+   * Write the pending records and stop the thread
+   */
+  ~AsyncWriter ();
+  /**
+   * \param size the size of the next records, up to the block size
+   * \returns where to copy the next size bytes of records, which are
+   * only written once appended
+   */
+  uint8_t *Reserve (uint32_t size);
+  /**
+   * \param size the number of bytes copied where Reserve pointed
+   */
+  void Append (uint32_t size);
+  /**
+   * Write all the appended records and flush the stream
+   */
+  void Flush (void);
+  /**
+   * \returns true if a write to the stream failed
+   */
+  bool Failed (void) const;
+
+private:
+  /// Loop of the thread
+  void Run (void);
+  /// Queue the current block for the thread
+  void Submit (void);
+  /**
+   * \returns a free block, allocated or released by the thread
+   */
+  uint8_t *GetFreeBlock (void);
+
+  /// A block queued for the thread
+  struct Block
+  {
+    uint8_t *data;  //!< the records
+    uint32_t used;  //!< the number of bytes of records
+  };
+
+  static const uint32_t MAX_BLOCKS = 4;  //!< Max number of blocks
+  static const std::size_t ALIGNMENT = 4096; //!< Alignment of the blocks
+
+  std::ostream *m_stream;        //!< the stream to write to
+  uint32_t m_blockSize;          //!< the size of the blocks
+  uint8_t *m_current;            //!< the block being filled, if any
+  uint32_t m_used;               //!< the bytes appended to the current block
+  uint32_t m_nBlocks;            //!< the number of blocks allocated
+  std::vector<uint8_t *> m_free; //!< the free blocks
+  std::deque<Block> m_pending;   //!< the blocks queued for the thread
+  bool m_writing;                //!< whether the thread is writing a block
+  bool m_stop;                   //!< whether the thread should exit
+  std::atomic<bool> m_failed;    //!< whether a write failed
+  std::mutex m_mutex;            //!< protects the free and queued blocks
+  std::condition_variable m_queued;   //!< a block was queued, or m_stop set
+  std::condition_variable m_written;  //!< a block was written
+  std::thread m_thread;          //!< the writer thread
+};
+
+PcapFile::AsyncWriter::AsyncWriter (std::ostream *stream, uint32_t blockSize)
+  : m_stream (stream),
+    m_blockSize (blockSize),
+    m_current (0),
+    m_used (0),
+    m_nBlocks (0),
+    m_writing (false),
+    m_stop (false),
+    m_failed (false)
+{
+  m_thread = std::thread (&AsyncWriter::Run, this);
+}
+
+PcapFile::AsyncWriter::~AsyncWriter ()
+{
+  Flush ();
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    m_stop = true;
+  }
+  m_queued.notify_one ();
+  m_thread.join ();
+  if (m_current != 0)
+    {
+      m_free.push_back (m_current);
+    }
+  for (std::vector<uint8_t *>::iterator i = m_free.begin (); i != m_free.end (); ++i)
+    {
+      std::free (*i);
+    }
+}
+
+uint8_t *
+PcapFile::AsyncWriter::Reserve (uint32_t size)
+{
+  NS_ASSERT (size <= m_blockSize);
+  if (m_current != 0 && m_used + size <= m_blockSize)
+    {
+      return m_current + m_used;
+    }
+  if (m_current != 0)
+    {
+      Submit ();
+    }
+  m_current = GetFreeBlock ();
+  m_used = 0;
+  return m_current;
+}
+
+void
+PcapFile::AsyncWriter::Append (uint32_t size)
+{
+  NS_ASSERT (m_current != 0 && m_used + size <= m_blockSize);
+  m_used += size;
+}
+
+void
+PcapFile::AsyncWriter::Flush (void)
+{
+  if (m_current != 0 && m_used > 0)
+    {
+      Submit ();
+    }
+  std::unique_lock<std::mutex> lock (m_mutex);
+  while (!m_pending.empty () || m_writing)
+    {
+      m_written.wait (lock);
+    }
+  // The thread is idle until the next block is queued
+  m_stream->flush ();
+  if (m_stream->fail ())
+    {
+      m_failed = true;
+    }
+}
+
+bool
+PcapFile::AsyncWriter::Failed (void) const
+{
+  return m_failed;
+}
+
+void
+PcapFile::AsyncWriter::Submit (void)
+{
+  Block block;
+  block.data = m_current;
+  block.used = m_used;
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    m_pending.push_back (block);
+  }
+  m_queued.notify_one ();
+  m_current = 0;
+  m_used = 0;
+}
+
+uint8_t *
+PcapFile::AsyncWriter::GetFreeBlock (void)
+{
+  std::unique_lock<std::mutex> lock (m_mutex);
+  if (m_free.empty () && m_nBlocks < MAX_BLOCKS)
+    {
+      void *data = 0;
+      if (posix_memalign (&data, ALIGNMENT, m_blockSize) != 0)
+        {
+          NS_FATAL_ERROR ("PcapFile::AsyncWriter::GetFreeBlock(): Cannot allocate a block of " << m_blockSize << " bytes");
+        }
+      m_nBlocks++;
+      return static_cast<uint8_t *> (data);
+    }
+  while (m_free.empty ())
+    {
+      m_written.wait (lock);
+    }
+  uint8_t *data = m_free.back ();
+  m_free.pop_back ();
+  return data;
+}
+
+void
+PcapFile::AsyncWriter::Run (void)
+{
+  std::unique_lock<std::mutex> lock (m_mutex);
+  while (true)
+    {
+      while (m_pending.empty () && !m_stop)
+        {
+          m_queued.wait (lock);
+        }
+      if (m_pending.empty ())
+        {
+          break;
+        }
+      Block block = m_pending.front ();
+      m_pending.pop_front ();
+      m_writing = true;
+      lock.unlock ();
+
+      m_stream->write ((const char *)block.data, block.used);
+      if (m_stream->fail ())
+        {
+          m_failed = true;
+        }
+
+      lock.lock ();
+      m_writing = false;
+      m_free.push_back (block.data);
+      m_written.notify_all ();
+    }
+}
+
 PcapFile::PcapFile ()
   : m_file (),
     m_swapMode (false),
-    m_nanosecMode (false)
+    m_nanosecMode (false),
+    m_asyncWriter (0)
 {
   NS_LOG_FUNCTION (this);
   FatalImpl::RegisterStream (&m_file); 
@@ -68,6 +308,10 @@ bool
 PcapFile::Fail (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_asyncWriter != 0)
+    {
+      return m_asyncWriter->Failed ();
+    }
   return m_file.fail ();
 }
 bool 
@@ -88,6 +332,16 @@ void
 PcapFile::Close (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_asyncWriter != 0)
+    {
+      bool failed = m_asyncWriter->Failed ();
+      delete m_asyncWriter;
+      m_asyncWriter = 0;
+      if (failed)
+        {
+          m_file.setstate (std::ios::failbit);
+        }
+    }
   m_file.close ();
 }
 
@@ -399,11 +653,20 @@ PcapFile::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t timeZoneCorrect
   WriteFileHeader ();
 }
 
+void
+PcapFile::EnableAsync (uint32_t blockSize)
+{
+  NS_LOG_FUNCTION (this << blockSize);
+  NS_ASSERT (m_file.good ());
+  NS_ASSERT (m_asyncWriter == 0);
+  blockSize = std::max (blockSize, RECORD_HEADER_SIZE + m_fileHeader.m_snapLen);
+  m_asyncWriter = new AsyncWriter (&m_file, blockSize);
+}
+
 uint32_t
 PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << totalLen);
-  NS_ASSERT (m_file.good ());
 
   uint32_t inclLen = totalLen > m_fileHeader.m_snapLen ? m_fileHeader.m_snapLen : totalLen;
 
@@ -418,6 +681,23 @@ PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
       Swap (&header, &header);
     }
 
+  if (m_asyncWriter != 0)
+    {
+      //
+      // Reserve the room of the data as well, so that the record is not
+      // split over two blocks
+      //
+      uint8_t *buffer = m_asyncWriter->Reserve (RECORD_HEADER_SIZE + inclLen);
+      std::memcpy (buffer, &header.m_tsSec, sizeof(header.m_tsSec));
+      std::memcpy (buffer + 4, &header.m_tsUsec, sizeof(header.m_tsUsec));
+      std::memcpy (buffer + 8, &header.m_inclLen, sizeof(header.m_inclLen));
+      std::memcpy (buffer + 12, &header.m_origLen, sizeof(header.m_origLen));
+      m_asyncWriter->Append (RECORD_HEADER_SIZE);
+      return inclLen;
+    }
+
+  NS_ASSERT (m_file.good ());
+
   //
   // Watch out for memory alignment differences between machines, so write
   // them all individually.
@@ -435,6 +715,12 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, uint8_t const * const data, ui
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << &data << totalLen);
   uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, totalLen);
+  if (m_asyncWriter != 0)
+    {
+      std::memcpy (m_asyncWriter->Reserve (inclLen), data, inclLen);
+      m_asyncWriter->Append (inclLen);
+      return;
+    }
   m_file.write ((const char *)data, inclLen);
   NS_BUILD_DEBUG(m_file.flush());
 }
@@ -444,6 +730,11 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << p);
   uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, p->GetSize ());
+  if (m_asyncWriter != 0)
+    {
+      m_asyncWriter->Append (p->CopyData (m_asyncWriter->Reserve (inclLen), inclLen));
+      return;
+    }
   p->CopyData (&m_file, inclLen);
   NS_BUILD_DEBUG(m_file.flush());
 }
@@ -460,6 +751,14 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, const Header &header, Ptr<cons
   headerBuffer.AddAtStart (headerSize);
   header.Serialize (headerBuffer.Begin ());
   uint32_t toCopy = std::min (headerSize, inclLen);
+  if (m_asyncWriter != 0)
+    {
+      uint8_t *buffer = m_asyncWriter->Reserve (inclLen);
+      headerBuffer.CopyData (buffer, toCopy);
+      p->CopyData (buffer + toCopy, inclLen - toCopy);
+      m_asyncWriter->Append (inclLen);
+      return;
+    }
   headerBuffer.CopyData (&m_file, toCopy);
   inclLen -= toCopy;
   p->CopyData (&m_file, inclLen);
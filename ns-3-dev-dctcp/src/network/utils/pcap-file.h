@@ -44,6 +44,8 @@ class PcapFile
 public:
   static const int32_t  ZONE_DEFAULT    = 0;           /**< Time zone offset for current location */
   static const uint32_t SNAPLEN_DEFAULT = 65535;       /**< Default value for maximum octets to save per packet */
+  static const uint32_t SNAPLEN_HEADERS = 96;          /**< Maximum octets to save per packet to keep only the link, network and transport headers of most packets */
+  static const uint32_t ASYNC_BLOCK_SIZE_DEFAULT = 1 << 20; /**< Default size of the blocks of the asynchronous mode */
 
 public:
   PcapFile ();
@@ -122,6 +124,22 @@ public:
              bool swapMode = false,
              bool nanosecMode = false);
 
+  /**
+   * Write the next packets to the file from a background thread.  The
+   * records are copied into blocks of memory, aligned on pages, and each
+   * full block is handed over to a thread which writes it to the file,
+   * so that the caller does not wait for the file system.  When all the
+   * blocks are waiting to be written, the caller waits for the first one.
+   * Close () writes the pending records and stops the thread.
+   *
+   * The file must have been opened with write permissions and
+   * initialized.  Only Write, Fail and Close can then be called.
+   *
+   * \param blockSize The size of the blocks, raised if needed to hold a
+   * record of the snap length.
+   */
+  void EnableAsync (uint32_t blockSize = ASYNC_BLOCK_SIZE_DEFAULT);
+
   /**
    * \brief Write next packet to file
    * 
@@ -290,6 +308,8 @@ public:
                     uint32_t snapLen = SNAPLEN_DEFAULT);
 
 private:
+  class AsyncWriter;
+
   /**
    * \brief Pcap file header
    */
@@ -371,6 +391,7 @@ private:
   PcapFileHeader m_fileHeader;  //!< file header
   bool m_swapMode;              //!< swap mode
   bool m_nanosecMode;           //!< nanosecond timestamp mode
+  AsyncWriter *m_asyncWriter;   //!< writer thread of the asynchronous mode, if enabled
 };
 
 } // namespace ns3
@@ -31,6 +31,7 @@
 #include "ns3/log.h"
 #include "ns3/queue-size.h"
 #include "ns3/queue-item.h"
+#include "ns3/ring-buffer.h"
 #include <string>
 #include <sstream>
 #include <list>
@@ -223,6 +224,47 @@ private:
 };
 
 
+/**
+ * \ingroup queue
+ * \brief Container used by a Queue to store its items
+ *
+ * Items are stored in a std::list by default, which allows subclasses to
+ * keep iterators to the items across insertions and removals. Queues of
+ * packets and of queue disc items, which only operate at the ends of the
+ * queue, use a RingBuffer instead, which does not allocate memory for every
+ * enqueued item.
+ *
+ * \tparam Item \explicit Type of the items in the queue
+ */
+template <typename Item>
+struct QueueStorage
+{
+  /// The container type
+  typedef std::list<Ptr<Item> > Container;
+};
+
+/**
+ * \ingroup queue
+ * \brief Queues of packets are stored in a RingBuffer
+ */
+template <>
+struct QueueStorage<Packet>
+{
+  /// The container type
+  typedef RingBuffer<Ptr<Packet> > Container;
+};
+
+/**
+ * \ingroup queue
+ * \brief Queues of queue disc items are stored in a RingBuffer
+ */
+template <>
+struct QueueStorage<QueueDiscItem>
+{
+  /// The container type
+  typedef RingBuffer<Ptr<QueueDiscItem> > Container;
+};
+
 /**
  * \ingroup queue
  * \brief Template class for packet Queues
@@ -300,10 +342,12 @@ public:
 
 protected:
 
+  /// Container of the items.
+  typedef typename QueueStorage<Item>::Container Container;
   /// Const iterator.
-  typedef typename std::list<Ptr<Item> >::const_iterator ConstIterator;
+  typedef typename Container::const_iterator ConstIterator;
   /// Iterator.
-  typedef typename std::list<Ptr<Item> >::iterator Iterator;
+  typedef typename Container::iterator Iterator;
 
   /**
    * \brief Get a const iterator which refers to the first item in the queue.
@@ -419,7 +463,7 @@ protected:
   void DropAfterDequeue (Ptr<Item> item);
 
 private:
-  std::list<Ptr<Item> > m_packets;          //!< the items in the queue
+  Container m_packets;                      //!< the items in the queue
   NS_LOG_TEMPLATE_DECLARE;                  //!< the log component
 
   /// Traced callback: fired when a packet is enqueued
@@ -0,0 +1,352 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include "ns3/assert.h"
+#include <vector>
+#include <iterator>
+#include <cstddef>
+
+namespace ns3 {
+
+/**
+ * \ingroup queue
+ *
+ * \brief A growable ring buffer, used as the storage of packet queues
+ *
+ * The elements are stored in a contiguous array whose capacity is a power of
+ * two and which is doubled when full; the capacity is never reduced, hence
+ * a queue which has reached its steady state occupancy does not allocate
+ * memory any more. Inserting or erasing at either end takes constant time;
+ * inserting or erasing elsewhere shifts the elements on the shorter side.
+ *
+ * This class provides the subset of the std::list interface used by the
+ * Queue class. Unlike std::list, and like std::deque, inserting or erasing
+ * an element invalidates the iterators to the other elements.
+ */
+template <typename T>
+class RingBuffer
+{
+public:
+  /**
+   * \brief Iterator over the elements of a ring buffer
+   *
+   * \tparam Ref reference type
+   * \tparam Pointer pointer type
+   * \tparam Buffer (possibly const) ring buffer type
+   */
+  template <typename Ref, typename Pointer, typename Buffer>
+  class IteratorBase
+  {
+  public:
+    /// Iterator category
+    typedef std::random_access_iterator_tag iterator_category;
+    /// Type of the elements
+    typedef T value_type;
+    /// Type of the difference between two iterators
+    typedef std::ptrdiff_t difference_type;
+    /// Pointer type
+    typedef Pointer pointer;
+    /// Reference type
+    typedef Ref reference;
+
+    IteratorBase ()
+      : m_buffer (0),
+        m_index (0)
+    {
+    }
+    /**
+     * Constructor
+     * \param buffer the ring buffer
+     * \param index the position in the ring buffer
+     */
+    IteratorBase (Buffer *buffer, std::size_t index)
+      : m_buffer (buffer),
+        m_index (index)
+    {
+    }
+    /**
+     * Conversion from an iterator to a const iterator
+     * \param o the iterator to convert
+     */
+    template <typename R, typename P, typename B>
+    IteratorBase (const IteratorBase<R, P, B> &o)
+      : m_buffer (o.m_buffer),
+        m_index (o.m_index)
+    {
+    }
+    /** \returns the element */
+    Ref operator* () const
+    {
+      return m_buffer->At (m_index);
+    }
+    /** \returns a pointer to the element */
+    Pointer operator-> () const
+    {
+      return &m_buffer->At (m_index);
+    }
+    /** \returns the iterator to the next element */
+    IteratorBase & operator++ ()
+    {
+      m_index++;
+      return *this;
+    }
+    /** \returns the iterator before increment */
+    IteratorBase operator++ (int)
+    {
+      IteratorBase tmp = *this;
+      m_index++;
+      return tmp;
+    }
+    /** \returns the iterator to the previous element */
+    IteratorBase & operator-- ()
+    {
+      m_index--;
+      return *this;
+    }
+    /** \returns the iterator before decrement */
+    IteratorBase operator-- (int)
+    {
+      IteratorBase tmp = *this;
+      m_index--;
+      return tmp;
+    }
+    /**
+     * \param n the offset
+     * \returns the iterator n elements after this one
+     */
+    IteratorBase operator+ (difference_type n) const
+    {
+      return IteratorBase (m_buffer, m_index + n);
+    }
+    /**
+     * \param o the other iterator
+     * \returns the distance between the two iterators
+     */
+    template <typename R, typename P, typename B>
+    difference_type operator- (const IteratorBase<R, P, B> &o) const
+    {
+      return static_cast<difference_type> (m_index) - static_cast<difference_type> (o.m_index);
+    }
+    /**
+     * \param o the other iterator
+     * \returns true if both iterators refer to the same element
+     */
+    template <typename R, typename P, typename B>
+    bool operator== (const IteratorBase<R, P, B> &o) const
+    {
+      return m_buffer == o.m_buffer && m_index == o.m_index;
+    }
+    /**
+     * \param o the other iterator
+     * \returns true if the iterators refer to different elements
+     */
+    template <typename R, typename P, typename B>
+    bool operator!= (const IteratorBase<R, P, B> &o) const
+    {
+      return !(*this == o);
+    }
+
+  private:
+    template <typename R, typename P, typename B> friend class IteratorBase;
+    friend class RingBuffer;
+
+    Buffer *m_buffer;     //!< the ring buffer
+    std::size_t m_index;  //!< position from the front of the ring buffer
+  };
+
+  /// Iterator
+  typedef IteratorBase<T &, T *, RingBuffer> iterator;
+  /// Const iterator
+  typedef IteratorBase<const T &, const T *, const RingBuffer> const_iterator;
+
+  RingBuffer ()
+    : m_head (0),
+      m_size (0)
+  {
+  }
+
+  /** \returns an iterator to the first element */
+  iterator begin (void)
+  {
+    return iterator (this, 0);
+  }
+  /** \returns an iterator past the last element */
+  iterator end (void)
+  {
+    return iterator (this, m_size);
+  }
+  /** \returns a const iterator to the first element */
+  const_iterator begin (void) const
+  {
+    return const_iterator (this, 0);
+  }
+  /** \returns a const iterator past the last element */
+  const_iterator end (void) const
+  {
+    return const_iterator (this, m_size);
+  }
+  /** \returns a const iterator to the first element */
+  const_iterator cbegin (void) const
+  {
+    return begin ();
+  }
+  /** \returns a const iterator past the last element */
+  const_iterator cend (void) const
+  {
+    return end ();
+  }
+  /** \returns the number of elements */
+  std::size_t size (void) const
+  {
+    return m_size;
+  }
+  /** \returns true if there are no elements */
+  bool empty (void) const
+  {
+    return m_size == 0;
+  }
+  /** \returns the number of elements which can be stored without allocating memory */
+  std::size_t capacity (void) const
+  {
+    return m_buffer.size ();
+  }
+
+  /**
+   * Insert an element
+   * \param pos the position before which the element is inserted
+   * \param value the element
+   * \returns an iterator to the inserted element
+   */
+  iterator insert (const_iterator pos, const T &value)
+  {
+    NS_ASSERT (pos.m_buffer == this && pos.m_index <= m_size);
+    if (m_size == m_buffer.size ())
+      {
+        Grow ();
+      }
+    std::size_t index = pos.m_index;
+    if (index < m_size - index)
+      {
+        // shift the first elements backward
+        m_head = (m_head + m_buffer.size () - 1) & Mask ();
+        for (std::size_t i = 0; i < index; i++)
+          {
+            At (i) = At (i + 1);
+          }
+      }
+    else
+      {
+        // shift the last elements forward
+        for (std::size_t i = m_size; i > index; i--)
+          {
+            At (i) = At (i - 1);
+          }
+      }
+    m_size++;
+    At (index) = value;
+    return iterator (this, index);
+  }
+
+  /**
+   * Erase an element
+   * \param pos the position of the element
+   * \returns an iterator to the element following the erased one
+   */
+  iterator erase (const_iterator pos)
+  {
+    NS_ASSERT (pos.m_buffer == this && pos.m_index < m_size);
+    std::size_t index = pos.m_index;
+    if (index < m_size - 1 - index)
+      {
+        // shift the first elements forward
+        for (std::size_t i = index; i > 0; i--)
+          {
+            At (i) = At (i - 1);
+          }
+        At (0) = T ();
+        m_head = (m_head + 1) & Mask ();
+      }
+    else
+      {
+        // shift the last elements backward
+        for (std::size_t i = index; i + 1 < m_size; i++)
+          {
+            At (i) = At (i + 1);
+          }
+        At (m_size - 1) = T ();
+      }
+    m_size--;
+    return iterator (this, index);
+  }
+
+  /**
+   * Erase all the elements, keeping the capacity
+   */
+  void clear (void)
+  {
+    for (std::size_t i = 0; i < m_size; i++)
+      {
+        At (i) = T ();
+      }
+    m_head = 0;
+    m_size = 0;
+  }
+
+private:
+  /**
+   * \param index the position from the front
+   * \returns the element at the given position
+   */
+  T & At (std::size_t index)
+  {
+    return m_buffer[(m_head + index) & Mask ()];
+  }
+  /**
+   * \param index the position from the front
+   * \returns the element at the given position
+   */
+  const T & At (std::size_t index) const
+  {
+    return m_buffer[(m_head + index) & Mask ()];
+  }
+  /** \returns the mask to apply to indices, the capacity being a power of two */
+  std::size_t Mask (void) const
+  {
+    return m_buffer.size () - 1;
+  }
+  /** Double the capacity, moving the elements to the front of the new array */
+  void Grow (void)
+  {
+    std::vector<T> buffer (m_buffer.empty () ? 16 : 2 * m_buffer.size ());
+    for (std::size_t i = 0; i < m_size; i++)
+      {
+        buffer[i] = At (i);
+      }
+    m_buffer.swap (buffer);
+    m_head = 0;
+  }
+
+  std::vector<T> m_buffer;   //!< the storage, whose size is a power of two
+  std::size_t m_head;        //!< index in the storage of the first element
+  std::size_t m_size;        //!< number of elements
+};
+
+} // namespace ns3
+
+#endif /* RING_BUFFER_H */
@@ -21,6 +21,7 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
+#include "ns3/node.h"
 #include "ns3/log.h"
 
 namespace ns3 {
@@ -80,6 +81,21 @@ PointToPointChannel::Attach (Ptr<PointToPointNetDevice> device)
       m_link[1].m_dst = m_link[0].m_src;
       m_link[0].m_state = IDLE;
       m_link[1].m_state = IDLE;
+      CacheNodes (m_link[0]);
+      CacheNodes (m_link[1]);
+    }
+}
+
+void
+PointToPointChannel::CacheNodes (Link &link)
+{
+  Ptr<Node> src = link.m_src->GetNode ();
+  Ptr<Node> dst = link.m_dst->GetNode ();
+  if (src != 0 && dst != 0)
+    {
+      link.m_dstNodeId = dst->GetId ();
+      link.m_remote = src->GetSystemId () != dst->GetSystemId ();
+      link.m_nodesKnown = true;
     }
 }
 
@@ -96,13 +112,34 @@ PointToPointChannel::TransmitStart (
   NS_ASSERT (m_link[1].m_state != INITIALIZING);
 
   uint32_t wire = src == m_link[0].m_src ? 0 : 1;
+  Link &link = m_link[wire];
+  if (!link.m_nodesKnown)
+    {
+      CacheNodes (link);
+      NS_ASSERT_MSG (link.m_nodesKnown, "The devices have not been added to nodes");
+    }
 
-  Simulator::ScheduleWithContext (m_link[wire].m_dst->GetNode ()->GetId (),
-                                  txTime + m_delay, &PointToPointNetDevice::Receive,
-                                  m_link[wire].m_dst, p->Copy ());
+  if (link.m_remote)
+    {
+      // The destination may be run by another thread: hand it over a
+      // packet sharing no data with ours, and do not touch the reference
+      // count of the destination device
+      Simulator::ScheduleWithContext (link.m_dstNodeId,
+                                      txTime + m_delay, &PointToPointNetDevice::Receive,
+                                      PeekPointer (link.m_dst), p->DeepCopy ());
+    }
+  else
+    {
+      Simulator::ScheduleWithContext (link.m_dstNodeId,
+                                      txTime + m_delay, &PointToPointNetDevice::Receive,
+                                      link.m_dst, p->Copy ());
+    }
 
   // Call the tx anim callback on the net device
-  m_txrxPointToPoint (p, src, m_link[wire].m_dst, txTime, txTime + m_delay);
+  if (!m_txrxPointToPoint.IsEmpty ())
+    {
+      m_txrxPointToPoint (p, src, link.m_dst, txTime, txTime + m_delay);
+    }
   return true;
 }
 
@@ -194,13 +194,27 @@ public:
     /** \brief Create the link, it will be in INITIALIZING state
      *
      */
-    Link() : m_state (INITIALIZING), m_src (0), m_dst (0) {}
+    Link() : m_state (INITIALIZING), m_src (0), m_dst (0), m_nodesKnown (false), m_dstNodeId (0), m_remote (false) {}
 
     WireState                  m_state; //!< State of the link
     Ptr<PointToPointNetDevice> m_src;   //!< First NetDevice
     Ptr<PointToPointNetDevice> m_dst;   //!< Second NetDevice
+    bool                       m_nodesKnown; //!< Whether m_dstNodeId and m_remote are set
+    uint32_t                   m_dstNodeId;  //!< Id of the node of the second NetDevice
+    bool                       m_remote;     //!< Whether the nodes have different system ids
   };
 
+  /**
+   * \brief Record the id and the system id of the nodes of a link, if the
+   * devices have been added to their nodes
+   *
+   * This lets TransmitStart reach the node at the other end of the link
+   * without touching it, as it may be run by another thread.
+   *
+   * \param link the link
+   */
+  static void CacheNodes (Link &link);
+
   Link    m_link[N_DEVICES]; //!< Link model
 };
 
@@ -25,6 +25,8 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
+#include "ns3/queue-item.h"
+#include "ns3/net-device-queue-interface.h"
 #include "point-to-point-net-device.h"
 #include "point-to-point-channel.h"
 #include "ppp-header.h"
@@ -55,7 +57,8 @@ PointToPointNetDevice::GetTypeId (void)
     .AddAttribute ("DataRate", 
                    "The default data rate for point to point links",
                    DataRateValue (DataRate ("32768b/s")),
-                   MakeDataRateAccessor (&PointToPointNetDevice::m_bps),
+                   MakeDataRateAccessor (&PointToPointNetDevice::SetDataRate,
+                                         &PointToPointNetDevice::GetDataRate),
                    MakeDataRateChecker ())
     .AddAttribute ("ReceiveErrorModel", 
                    "The receiver error model used to simulate packet loss",
@@ -215,6 +218,7 @@ PointToPointNetDevice::DoDispose ()
   m_receiveErrorModel = 0;
   m_currentPkt = 0;
   m_queue = 0;
+  m_queueInterface = 0;
   NetDevice::DoDispose ();
 }
 
@@ -223,6 +227,13 @@ PointToPointNetDevice::SetDataRate (DataRate bps)
 {
   NS_LOG_FUNCTION (this);
   m_bps = bps;
+  m_txTimeCalculator = TxTimeCalculator (bps);
+}
+
+DataRate
+PointToPointNetDevice::GetDataRate (void) const
+{
+  return m_bps;
 }
 
 void
@@ -248,7 +259,7 @@ PointToPointNetDevice::TransmitStart (Ptr<Packet> p)
   m_currentPkt = p;
   m_phyTxBeginTrace (m_currentPkt);
 
-  Time txTime = m_bps.CalculateBytesTxTime (p->GetSize ());
+  Time txTime = m_txTimeCalculator.CalculateBytesTxTime (p->GetSize ());
   Time txCompleteTime = txTime + m_tInterframeGap;
 
   NS_LOG_LOGIC ("Schedule TransmitCompleteEvent in " << txCompleteTime.GetSeconds () << "sec");
@@ -556,6 +567,65 @@ PointToPointNetDevice::Send (
   return false;
 }
 
+uint32_t
+PointToPointNetDevice::SendBurst (const std::vector<Ptr<QueueDiscItem> > &items)
+{
+  NS_LOG_FUNCTION (this << items.size ());
+
+  if (IsLinkUp () == false)
+    {
+      for (std::vector<Ptr<QueueDiscItem> >::const_iterator it = items.begin (); it != items.end (); ++it)
+        {
+          m_macTxDropTrace ((*it)->GetPacket ());
+        }
+      return 0;
+    }
+
+  //
+  // The whole burst is enqueued before the device queue is checked and the
+  // transmission is started, as a Linux driver does when xmit_more is set.
+  //
+  if (m_queueInterface == 0)
+    {
+      m_queueInterface = GetObject<NetDeviceQueueInterface> ();
+    }
+  Ptr<NetDeviceQueue> txq = (m_queueInterface != 0 ? m_queueInterface->GetTxQueue (0) : 0);
+  if (txq != 0)
+    {
+      txq->BeginBurst ();
+    }
+
+  uint32_t nSent = 0;
+  for (std::vector<Ptr<QueueDiscItem> >::const_iterator it = items.begin (); it != items.end (); ++it)
+    {
+      Ptr<Packet> packet = (*it)->GetPacket ();
+      AddHeader (packet, (*it)->GetProtocol ());
+      m_macTxTrace (packet);
+      if (m_queue->Enqueue (packet))
+        {
+          nSent++;
+        }
+      else
+        {
+          m_macTxDropTrace (packet);
+        }
+    }
+
+  if (txq != 0)
+    {
+      txq->EndBurst ();
+    }
+
+  if (m_txMachineState == READY && !m_queue->IsEmpty ())
+    {
+      Ptr<Packet> packet = m_queue->Dequeue ();
+      m_snifferTrace (packet);
+      m_promiscSnifferTrace (packet);
+      TransmitStart (packet);
+    }
+  return nSent;
+}
+
 bool
 PointToPointNetDevice::SendFrom (Ptr<Packet> packet, 
                                  const Address &source, 
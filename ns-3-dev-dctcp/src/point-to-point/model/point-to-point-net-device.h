@@ -36,6 +36,7 @@ namespace ns3 {
 template <typename Item> class Queue;
 class PointToPointChannel;
 class ErrorModel;
+class NetDeviceQueueInterface;
 
 /**
  * \defgroup point-to-point Point-To-Point Network Device
@@ -94,6 +95,13 @@ public:
    */
   void SetDataRate (DataRate bps);
 
+  /**
+   * Get the Data Rate used for transmission of packets.
+   *
+   * \returns the data rate at which this object operates
+   */
+  DataRate GetDataRate (void) const;
+
   /**
    * Set the interframe gap used to separate packets.  The interframe gap
    * defines the minimum space required between packets sent by this device.
@@ -177,6 +185,7 @@ public:
 
   virtual bool Send (Ptr<Packet> packet, const Address &dest, uint16_t protocolNumber);
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber);
+  virtual uint32_t SendBurst (const std::vector<Ptr<QueueDiscItem> > &items);
 
   virtual Ptr<Node> GetNode (void) const;
   virtual void SetNode (Ptr<Node> node);
@@ -301,6 +310,11 @@ private:
    */
   DataRate       m_bps;
 
+  /**
+   * The transmission times at m_bps, computed without divisions.
+   */
+  TxTimeCalculator m_txTimeCalculator;
+
   /**
    * The interframe gap that the Net Device uses to throttle packet
    * transmission
@@ -321,6 +335,12 @@ private:
    */
   Ptr<Queue<Packet> > m_queue;
 
+  /**
+   * The interface to the transmission queue of this device, used to enqueue
+   * bursts of packets
+   */
+  Ptr<NetDeviceQueueInterface> m_queueInterface;
+
   /**
    * Error model for receive packet events
    */
@@ -24,6 +24,15 @@
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/node.h"
+#include "ns3/global-value.h"
+#include "ns3/string.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/queue-item.h"
+#include "ns3/dynamic-queue-limits.h"
+#include "ns3/uinteger.h"
+
+#include <vector>
 
 using namespace ns3;
 
@@ -94,6 +103,308 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \brief Queue disc item of the PointToPointBurstTest
+ */
+class PointToPointTestItem : public QueueDiscItem
+{
+public:
+  /**
+   * \param p the packet
+   */
+  PointToPointTestItem (Ptr<Packet> p)
+    : QueueDiscItem (p, Mac48Address::GetBroadcast (), 0x800)
+  {
+  }
+  virtual void AddHeader (void)
+  {
+  }
+  virtual bool Mark (void)
+  {
+    return false;
+  }
+};
+
+/**
+ * \brief Test the transmission of a burst of packets by a PointToPointNetDevice
+ *
+ * The device queue must only be stopped by its queue limits once the whole
+ * burst is enqueued, and every packet of the burst must be received.
+ */
+class PointToPointBurstTest : public TestCase
+{
+public:
+  PointToPointBurstTest ();
+
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Send a burst of packets to the device specified
+   * \param device the device
+   * \param nPackets the number of packets of the burst
+   */
+  void SendBurst (Ptr<PointToPointNetDevice> device, uint32_t nPackets);
+  /**
+   * \brief Count the packets received
+   * \param device the receiving device
+   * \param packet the packet
+   * \param protocol the protocol number
+   * \param from the sender address
+   * \return true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from);
+
+  uint32_t m_nSent;       //!< Number of packets accepted by the device
+  uint32_t m_nReceived;   //!< Number of packets received
+  uint32_t m_nStops;      //!< Number of times the device queue was stopped
+  Ptr<NetDeviceQueue> m_txq;  //!< The device queue of the sender
+};
+
+PointToPointBurstTest::PointToPointBurstTest ()
+  : TestCase ("PointToPoint transmission of a burst of packets"),
+    m_nSent (0),
+    m_nReceived (0),
+    m_nStops (0)
+{
+}
+
+void
+PointToPointBurstTest::SendBurst (Ptr<PointToPointNetDevice> device, uint32_t nPackets)
+{
+  std::vector<Ptr<QueueDiscItem> > items;
+  for (uint32_t i = 0; i < nPackets; i++)
+    {
+      items.push_back (Create<PointToPointTestItem> (Create<Packet> (1000)));
+    }
+  m_nSent = device->SendBurst (items);
+  if (m_txq->IsStopped ())
+    {
+      m_nStops++;
+    }
+}
+
+bool
+PointToPointBurstTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                                uint16_t protocol, const Address &from)
+{
+  m_nReceived++;
+  return true;
+}
+
+void
+PointToPointBurstTest::DoRun (void)
+{
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+
+  Ptr<Queue<Packet> > queueA = CreateObject<DropTailQueue<Packet> > ();
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetQueue (queueA);
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+  devB->SetReceiveCallback (MakeCallback (&PointToPointBurstTest::Receive, this));
+
+  Ptr<NetDeviceQueueInterface> ndqi = CreateObject<NetDeviceQueueInterface> ();
+  ndqi->GetTxQueue (0)->ConnectQueueTraces (queueA);
+  devA->AggregateObject (ndqi);
+  m_txq = ndqi->GetTxQueue (0);
+  Ptr<DynamicQueueLimits> dql = CreateObjectWithAttributes<DynamicQueueLimits> ("MinLimit", UintegerValue (3000),
+                                                                                "MaxLimit", UintegerValue (3000));
+  m_txq->SetQueueLimits (dql);
+
+  Simulator::Schedule (Seconds (1.0), &PointToPointBurstTest::SendBurst, this, devA, 5);
+
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_nSent, 5, "The device must accept the whole burst");
+  NS_TEST_EXPECT_MSG_EQ (m_nStops, 1, "The queue limits must stop the device queue after the burst");
+  NS_TEST_EXPECT_MSG_EQ (m_nReceived, 5, "Every packet of the burst must be received");
+  NS_TEST_EXPECT_MSG_EQ (m_txq->IsStopped (), false, "The device queue must be woken once the burst is sent");
+
+  m_txq = 0;
+  Simulator::Destroy ();
+}
+
+/// Number of nodes of the chain of the multithreaded test
+static const uint32_t N_NODES = 4;
+
+/**
+ * \brief Test the MultithreadedSimulatorImpl on a chain of point-to-point
+ * links
+ *
+ * Packets are forwarded in both directions along a chain of nodes, which
+ * are split into partitions run by different threads. The packets must
+ * arrive at the same times as with the DefaultSimulatorImpl.
+ */
+class PointToPointMultithreadedTest : public TestCase
+{
+public:
+  PointToPointMultithreadedTest ();
+
+  virtual void DoRun (void);
+
+private:
+  /// A packet received at an end of the chain
+  struct Arrival
+  {
+    uint64_t ts;   //!< Arrival time in time steps
+    uint32_t size; //!< Packet size, identifying the packet
+    /**
+     * \param o the other arrival
+     * \return true if both arrivals are the same
+     */
+    bool operator== (const Arrival &o) const
+    {
+      return ts == o.ts && size == o.size;
+    }
+  };
+
+  /**
+   * \brief Build the chain, send the packets and record their arrivals
+   * \param impl the simulator implementation
+   * \param nPartitions the number of partitions the nodes are split into
+   */
+  void RunChain (std::string impl, uint32_t nPartitions);
+  /**
+   * \brief Forward a packet to the next node of the chain, or record it
+   * at an end of the chain
+   * \param device the receiving device
+   * \param packet the packet
+   * \param protocol the protocol number
+   * \param from the sender address
+   * \return true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from);
+  /**
+   * \brief Send a packet
+   * \param device the sending device
+   * \param size the packet size
+   */
+  static void Send (Ptr<NetDevice> device, uint32_t size);
+
+  std::vector<Ptr<NetDevice> > m_next;            //!< Device towards the next node, per node
+  std::vector<Ptr<NetDevice> > m_previous;        //!< Device towards the previous node, per node
+  std::vector<std::vector<Arrival> > m_arrivals;  //!< Packets received, per node
+  Time m_lookAhead;                               //!< Lookahead of the last run
+  uint32_t m_nPartitions;                         //!< Number of partitions of the last run
+};
+
+PointToPointMultithreadedTest::PointToPointMultithreadedTest ()
+  : TestCase ("PointToPoint links between partitions of the MultithreadedSimulatorImpl"),
+    m_nPartitions (0)
+{
+}
+
+void
+PointToPointMultithreadedTest::Send (Ptr<NetDevice> device, uint32_t size)
+{
+  device->Send (Create<Packet> (size), device->GetBroadcast (), 0x800);
+}
+
+bool
+PointToPointMultithreadedTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                                        uint16_t protocol, const Address &from)
+{
+  uint32_t node = device->GetNode ()->GetId ();
+  Ptr<NetDevice> out = (device == m_previous[node]) ? m_next[node] : m_previous[node];
+  if (out == 0)
+    {
+      // Only touched by the thread running the node
+      Arrival arrival = {static_cast<uint64_t> (Simulator::Now ().GetTimeStep ()), packet->GetSize ()};
+      m_arrivals[node].push_back (arrival);
+    }
+  else
+    {
+      out->Send (packet->Copy (), out->GetBroadcast (), protocol);
+    }
+  return true;
+}
+
+void
+PointToPointMultithreadedTest::RunChain (std::string impl, uint32_t nPartitions)
+{
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue (impl));
+
+  m_next.assign (N_NODES, Ptr<NetDevice> ());
+  m_previous.assign (N_NODES, Ptr<NetDevice> ());
+  m_arrivals.assign (N_NODES, std::vector<Arrival> ());
+  std::vector<Ptr<Node> > nodes;
+  for (uint32_t i = 0; i < N_NODES; ++i)
+    {
+      nodes.push_back (CreateObject<Node> (i * nPartitions / N_NODES));
+    }
+  for (uint32_t i = 0; i + 1 < N_NODES; ++i)
+    {
+      Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+      channel->SetAttribute ("Delay", TimeValue (MicroSeconds (10 * (i + 1))));
+      Ptr<PointToPointNetDevice> devices[2];
+      for (uint32_t j = 0; j < 2; ++j)
+        {
+          devices[j] = CreateObject<PointToPointNetDevice> ();
+          devices[j]->SetAddress (Mac48Address::Allocate ());
+          devices[j]->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+          devices[j]->SetAttribute ("DataRate", DataRateValue (DataRate ("100Mbps")));
+          nodes[i + j]->AddDevice (devices[j]);
+          devices[j]->Attach (channel);
+          devices[j]->SetReceiveCallback (MakeCallback (&PointToPointMultithreadedTest::Receive, this));
+        }
+      m_next[i] = devices[0];
+      m_previous[i + 1] = devices[1];
+    }
+
+  // Packets of different sizes, sent from both ends at the same times
+  for (uint32_t k = 0; k < 50; ++k)
+    {
+      Simulator::ScheduleWithContext (0, MicroSeconds (7 * k), &Send, m_next[0], 100 + k);
+      Simulator::ScheduleWithContext (N_NODES - 1, MicroSeconds (7 * k), &Send, m_previous[N_NODES - 1], 1000 + k);
+    }
+
+  Simulator::Stop (MilliSeconds (10));
+  Simulator::Run ();
+
+  Ptr<MultithreadedSimulatorImpl> simulator = DynamicCast<MultithreadedSimulatorImpl> (Simulator::GetImplementation ());
+  if (simulator != 0)
+    {
+      m_lookAhead = simulator->GetLookAhead ();
+      m_nPartitions = simulator->GetNPartitions ();
+    }
+  Simulator::Destroy ();
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+}
+
+void
+PointToPointMultithreadedTest::DoRun (void)
+{
+  RunChain ("ns3::DefaultSimulatorImpl", 1);
+  std::vector<std::vector<Arrival> > expected = m_arrivals;
+  NS_TEST_ASSERT_MSG_EQ (expected[0].size (), 50, "Packets lost towards the first node");
+  NS_TEST_ASSERT_MSG_EQ (expected[N_NODES - 1].size (), 50, "Packets lost towards the last node");
+
+  for (uint32_t nPartitions = 1; nPartitions <= N_NODES; nPartitions *= 2)
+    {
+      RunChain ("ns3::MultithreadedSimulatorImpl", nPartitions);
+      NS_TEST_ASSERT_MSG_EQ (m_nPartitions, nPartitions, "Wrong number of partitions");
+      if (nPartitions == N_NODES)
+        {
+          NS_TEST_ASSERT_MSG_EQ (m_lookAhead, MicroSeconds (10), "Lookahead is not the smallest delay");
+        }
+      for (uint32_t i = 0; i < N_NODES; ++i)
+        {
+          NS_TEST_ASSERT_MSG_EQ ((m_arrivals[i] == expected[i]), true,
+                                 "Packets received by node " << i << " with " << nPartitions << " partitions differ");
+        }
+    }
+}
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -110,6 +421,8 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointBurstTest, TestCase::QUICK);
+  AddTestCase (new PointToPointMultithreadedTest, TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
@@ -0,0 +1,285 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "replication-runner.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/simulator.h"
+#include "ns3/fatal-error.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ReplicationRunner");
+
+ReplicationRunner::ReplicationRunner ()
+  : m_replications (1),
+    m_workers (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+ReplicationRunner::AddParameter (std::string name, const std::vector<std::string> &values)
+{
+  NS_LOG_FUNCTION (this << name << values.size ());
+  NS_ASSERT_MSG (!values.empty (), "No value given for parameter " << name);
+  m_names.push_back (name);
+  m_values.push_back (values);
+}
+
+void
+ReplicationRunner::SetReplications (uint32_t n)
+{
+  NS_LOG_FUNCTION (this << n);
+  NS_ASSERT (n > 0);
+  m_replications = n;
+}
+
+void
+ReplicationRunner::SetWorkers (uint32_t n)
+{
+  NS_LOG_FUNCTION (this << n);
+  m_workers = n;
+}
+
+uint32_t
+ReplicationRunner::GetNPoints (void) const
+{
+  uint32_t n = 1;
+  for (std::vector<std::vector<std::string> >::const_iterator it = m_values.begin ();
+       it != m_values.end (); ++it)
+    {
+      n *= it->size ();
+    }
+  return n;
+}
+
+ReplicationRunner::Point
+ReplicationRunner::GetPoint (uint32_t index) const
+{
+  NS_ASSERT (index < GetNPoints ());
+  // The last parameter varies fastest
+  Point point;
+  for (uint32_t i = m_names.size (); i > 0; i--)
+    {
+      const std::vector<std::string> &values = m_values[i - 1];
+      point[m_names[i - 1]] = values[index % values.size ()];
+      index /= values.size ();
+    }
+  return point;
+}
+
+std::string
+ReplicationRunner::RunReplication (Replication replication, const Point &point, uint32_t run)
+{
+  for (Point::const_iterator it = point.begin (); it != point.end (); ++it)
+    {
+      if (it->first.find ("::") != std::string::npos)
+        {
+          Config::SetDefault (it->first, StringValue (it->second));
+        }
+    }
+  RngSeedManager::SetRun (run);
+  std::string results = replication (point);
+  Simulator::Destroy ();
+  return results;
+}
+
+uint32_t
+ReplicationRunner::Run (Replication replication, std::string filename) const
+{
+  NS_LOG_FUNCTION (this << filename);
+
+  uint32_t workers = m_workers;
+  if (workers == 0)
+    {
+      long n = sysconf (_SC_NPROCESSORS_ONLN);
+      workers = (n > 0 ? static_cast<uint32_t> (n) : 1);
+    }
+  uint32_t nPoints = GetNPoints ();
+  uint32_t nJobs = nPoints * m_replications;
+  NS_LOG_INFO ("Running " << nJobs << " replications with " << workers << " workers");
+
+  /// A worker process running a replication
+  struct Worker
+  {
+    pid_t pid;          //!< Process id
+    int fd;             //!< Read end of the pipe receiving the results
+    uint32_t job;       //!< Index of the replication
+    std::string output; //!< Results received so far
+  };
+  std::vector<Worker> running;
+  std::vector<std::string> results (nJobs);
+  std::vector<int> status (nJobs, 0);
+
+  // Do not let the workers flush what the parent has buffered
+  std::cout.flush ();
+  std::cerr.flush ();
+
+  uint32_t next = 0;
+  while (next < nJobs || !running.empty ())
+    {
+      while (running.size () < workers && next < nJobs)
+        {
+          int fds[2];
+          if (pipe (fds) != 0)
+            {
+              NS_FATAL_ERROR ("pipe () failed: " << std::strerror (errno));
+            }
+          Point point = GetPoint (next / m_replications);
+          uint32_t run = next % m_replications + 1;
+          pid_t pid = fork ();
+          if (pid < 0)
+            {
+              NS_FATAL_ERROR ("fork () failed: " << std::strerror (errno));
+            }
+          if (pid == 0)
+            {
+              close (fds[0]);
+              std::string output = RunReplication (replication, point, run);
+              const char *data = output.data ();
+              std::size_t left = output.size ();
+              while (left > 0)
+                {
+                  ssize_t written = write (fds[1], data, left);
+                  if (written < 0 && errno == EINTR)
+                    {
+                      continue;
+                    }
+                  if (written <= 0)
+                    {
+                      _exit (1);
+                    }
+                  data += written;
+                  left -= written;
+                }
+              close (fds[1]);
+              std::cout.flush ();
+              std::cerr.flush ();
+              // Skip the static destructors, which belong to the parent
+              _exit (0);
+            }
+          close (fds[1]);
+          Worker worker;
+          worker.pid = pid;
+          worker.fd = fds[0];
+          worker.job = next;
+          running.push_back (worker);
+          NS_LOG_LOGIC ("Started replication " << next << " in process " << pid);
+          next++;
+        }
+
+      // Wait for results from any of the running workers; they are read
+      // as they come, so that a worker never blocks on a full pipe
+      std::vector<struct pollfd> fds (running.size ());
+      for (std::size_t i = 0; i < running.size (); i++)
+        {
+          fds[i].fd = running[i].fd;
+          fds[i].events = POLLIN;
+          fds[i].revents = 0;
+        }
+      if (poll (fds.data (), fds.size (), -1) < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+          NS_FATAL_ERROR ("poll () failed: " << std::strerror (errno));
+        }
+      for (std::size_t i = fds.size (); i > 0; i--)
+        {
+          if (fds[i - 1].revents == 0)
+            {
+              continue;
+            }
+          Worker &worker = running[i - 1];
+          char buffer[4096];
+          ssize_t n = read (worker.fd, buffer, sizeof (buffer));
+          if (n > 0)
+            {
+              worker.output.append (buffer, n);
+              continue;
+            }
+          if (n < 0 && errno == EINTR)
+            {
+              continue;
+            }
+          // End of the results: collect the worker
+          close (worker.fd);
+          int wstatus = 0;
+          while (waitpid (worker.pid, &wstatus, 0) < 0 && errno == EINTR)
+            {
+            }
+          status[worker.job] = (WIFEXITED (wstatus) ? WEXITSTATUS (wstatus) : 128 + WTERMSIG (wstatus));
+          results[worker.job] = worker.output;
+          NS_LOG_LOGIC ("Replication " << worker.job << " ended with status " << status[worker.job]);
+          running.erase (running.begin () + (i - 1));
+        }
+    }
+
+  std::ofstream out (filename.c_str ());
+  if (!out.is_open ())
+    {
+      NS_FATAL_ERROR ("Cannot open " << filename);
+    }
+  out << "#";
+  for (std::vector<std::string>::const_iterator it = m_names.begin (); it != m_names.end (); ++it)
+    {
+      out << " " << *it;
+    }
+  out << " run results" << std::endl;
+
+  uint32_t failed = 0;
+  for (uint32_t job = 0; job < nJobs; job++)
+    {
+      Point point = GetPoint (job / m_replications);
+      std::string values;
+      for (std::vector<std::string>::const_iterator it = m_names.begin (); it != m_names.end (); ++it)
+        {
+          values += point[*it] + " ";
+        }
+      uint32_t run = job % m_replications + 1;
+      if (status[job] != 0)
+        {
+          out << "# " << values << run << " failed with status " << status[job] << std::endl;
+          failed++;
+          continue;
+        }
+      // Strip the trailing newline, if any, of the results
+      std::string &result = results[job];
+      while (!result.empty () && result[result.size () - 1] == '\n')
+        {
+          result.erase (result.size () - 1);
+        }
+      out << values << run << " " << result << std::endl;
+    }
+  out.close ();
+  return failed;
+}
+
+} // namespace ns3
@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef REPLICATION_RUNNER_H
+#define REPLICATION_RUNNER_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "ns3/callback.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup stats
+ * \brief Run the independent replications of a parameter sweep in parallel
+ *
+ * The sweep is the cartesian product of the values given to each parameter
+ * with AddParameter, and every point of the sweep is replicated
+ * SetReplications times. The replications are run by up to SetWorkers
+ * worker processes at a time, all started from the process calling Run:
+ * the TypeIds and the attribute defaults set so far are inherited by the
+ * workers, so that they are neither registered nor parsed again, and every
+ * replication starts from the same pristine global state (node list,
+ * Config defaults, global routing, ...) whatever the replications run
+ * before it. Running replications in threads of the same process would
+ * not be possible, since this state is shared by all the threads.
+ *
+ * In the worker, the values of the point are applied to the attributes
+ * named by the parameters with Config::SetDefault; parameters whose name
+ * is not an attribute path (i.e. has no "::") are only passed to the
+ * replication. The run number of the random number generator is set to the
+ * index of the replication, starting from 1, with RngSeedManager::SetRun,
+ * so that every replication of a point uses independent random streams and
+ * the same replication of different points uses the same ones.
+ *
+ * The replication is a callback building and running one simulation, which
+ * returns its results as a string. Run writes the results to a single file,
+ * one line per replication in the order of the sweep whatever the order in
+ * which they complete: the values of the parameters, the run number and the
+ * string returned by the replication, separated by spaces. The file starts
+ * with a comment line naming the columns, and a replication which fails
+ * (e.g., because of an assert) is reported by a comment line.
+ *
+ * Run must be called before any simulation is run by the calling process,
+ * as the workers would otherwise inherit its events.
+ */
+class ReplicationRunner
+{
+public:
+  /// Values of the parameters of a point of the sweep, indexed by name
+  typedef std::map<std::string, std::string> Point;
+  /// Callback running one replication of a point and returning its results
+  typedef Callback<std::string, const Point &> Replication;
+
+  ReplicationRunner ();
+
+  /**
+   * \brief Add a parameter to the sweep
+   *
+   * \param name the parameter name, a path as accepted by Config::SetDefault
+   *        for the parameters which are attributes
+   * \param values the values taken by the parameter
+   */
+  void AddParameter (std::string name, const std::vector<std::string> &values);
+  /**
+   * \param n the number of replications of each point of the sweep
+   */
+  void SetReplications (uint32_t n);
+  /**
+   * \param n the maximum number of replications run at the same time; zero
+   *        (the default) means the number of online processors
+   */
+  void SetWorkers (uint32_t n);
+  /**
+   * \return the number of points of the sweep
+   */
+  uint32_t GetNPoints (void) const;
+  /**
+   * \param index the index of the point, lower than GetNPoints
+   * \return the values of the parameters at the point
+   */
+  Point GetPoint (uint32_t index) const;
+
+  /**
+   * \brief Run all the replications of all the points of the sweep
+   *
+   * \param replication the callback running one replication
+   * \param filename the name of the file the results are written to
+   * \return the number of replications which failed
+   */
+  uint32_t Run (Replication replication, std::string filename) const;
+
+private:
+  /**
+   * \brief Run a replication in the worker process
+   *
+   * \param replication the callback running one replication
+   * \param point the point of the sweep
+   * \param run the run number
+   * \return the results of the replication
+   */
+  static std::string RunReplication (Replication replication, const Point &point, uint32_t run);
+
+  /// Names of the parameters, in the order they were added
+  std::vector<std::string> m_names;
+  /// Values of the parameters, in the order they were added
+  std::vector<std::vector<std::string> > m_values;
+  uint32_t m_replications; //!< Number of replications of each point
+  uint32_t m_workers;      //!< Maximum number of replications run at the same time
+};
+
+} // namespace ns3
+
+#endif /* REPLICATION_RUNNER_H */
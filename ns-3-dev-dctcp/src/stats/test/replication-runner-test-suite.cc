@@ -0,0 +1,190 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+#include "ns3/test.h"
+#include "ns3/replication-runner.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/double.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup stats-tests
+ *
+ * \brief Test the replications of a sweep run in parallel
+ */
+class ReplicationRunnerTestCase : public TestCase
+{
+public:
+  ReplicationRunnerTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Run one replication: draw a uniform value whose maximum is an attribute
+   * default set by the runner
+   * \param point the point of the sweep
+   * \return the results of the replication
+   */
+  static std::string Replicate (const ReplicationRunner::Point &point);
+  /**
+   * Read the lines of a file
+   * \param filename the file name
+   * \return the lines of the file
+   */
+  static std::vector<std::string> ReadLines (std::string filename);
+};
+
+ReplicationRunnerTestCase::ReplicationRunnerTestCase ()
+  : TestCase ("Run the replications of a sweep in worker processes")
+{
+}
+
+std::string
+ReplicationRunnerTestCase::Replicate (const ReplicationRunner::Point &point)
+{
+  if (point.find ("x")->second == "fail")
+    {
+      _exit (3);
+    }
+  Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
+  // Run a simulation so that its state is inherited by no other replication
+  Simulator::Schedule (Seconds (uniform->GetValue ()), &Simulator::Stop);
+  Simulator::Run ();
+  std::ostringstream oss;
+  oss << point.find ("x")->second << " " << RngSeedManager::GetRun () << " "
+      << uniform->GetValue () << " " << Simulator::GetEventCount ();
+  return oss.str ();
+}
+
+std::vector<std::string>
+ReplicationRunnerTestCase::ReadLines (std::string filename)
+{
+  std::vector<std::string> lines;
+  std::ifstream in (filename.c_str ());
+  std::string line;
+  while (std::getline (in, line))
+    {
+      lines.push_back (line);
+    }
+  return lines;
+}
+
+void
+ReplicationRunnerTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("replication-runner.dat");
+
+  std::vector<std::string> max;
+  max.push_back ("10");
+  max.push_back ("20");
+  std::vector<std::string> x;
+  x.push_back ("a");
+  x.push_back ("b");
+  x.push_back ("c");
+
+  ReplicationRunner runner;
+  runner.AddParameter ("ns3::UniformRandomVariable::Max", max);
+  runner.AddParameter ("x", x);
+  runner.SetReplications (4);
+  NS_TEST_ASSERT_MSG_EQ (runner.GetNPoints (), 6, "Wrong number of points");
+  NS_TEST_ASSERT_MSG_EQ (runner.GetPoint (1)["x"], "b", "The last parameter should vary fastest");
+  NS_TEST_ASSERT_MSG_EQ (runner.GetPoint (3)["ns3::UniformRandomVariable::Max"], "20", "Wrong point");
+
+  // A single worker runs the replications one after the other
+  runner.SetWorkers (1);
+  uint32_t failed = runner.Run (MakeCallback (&ReplicationRunnerTestCase::Replicate), filename);
+  NS_TEST_ASSERT_MSG_EQ (failed, 0, "No replication should fail");
+  std::vector<std::string> serial = ReadLines (filename);
+  NS_TEST_ASSERT_MSG_EQ (serial.size (), 1 + 6 * 4, "Wrong number of lines");
+  NS_TEST_ASSERT_MSG_EQ (serial[0], "# ns3::UniformRandomVariable::Max x run results", "Wrong header");
+
+  for (uint32_t job = 0; job < 6 * 4; job++)
+    {
+      std::istringstream iss (serial[job + 1]);
+      std::string maxValue, xValue, xResult;
+      uint32_t run, runResult, events;
+      double value;
+      iss >> maxValue >> xValue >> run >> xResult >> runResult >> value >> events;
+      NS_TEST_ASSERT_MSG_EQ (maxValue, max[job / 12], "Results not in the order of the sweep");
+      NS_TEST_ASSERT_MSG_EQ (xValue, x[(job / 4) % 3], "Results not in the order of the sweep");
+      NS_TEST_ASSERT_MSG_EQ (xResult, xValue, "Parameter not passed to the replication");
+      NS_TEST_ASSERT_MSG_EQ (run, job % 4 + 1, "Wrong run number");
+      NS_TEST_ASSERT_MSG_EQ (runResult, run, "Run number not set in the replication");
+      NS_TEST_ASSERT_MSG_EQ ((value >= 0 && value < std::atof (maxValue.c_str ())), true,
+                             "Attribute default not set in the replication");
+      NS_TEST_ASSERT_MSG_EQ (events, 1, "The replication did not start from a pristine simulator");
+    }
+
+  // The same run number gives the same draws at every point, and a different
+  // run number different draws
+  std::istringstream first (serial[1]), sameRun (serial[1 + 12]), otherRun (serial[2]);
+  std::string ignore;
+  double value1, value2, value3;
+  first >> ignore >> ignore >> ignore >> ignore >> ignore >> value1;
+  sameRun >> ignore >> ignore >> ignore >> ignore >> ignore >> value2;
+  otherRun >> ignore >> ignore >> ignore >> ignore >> ignore >> value3;
+  NS_TEST_ASSERT_MSG_EQ_TOL (value2, 2 * value1, 1e-5, "Different streams for the same run");
+  NS_TEST_ASSERT_MSG_NE (value3, value1, "Same streams for different runs");
+
+  // Running in parallel gives the same results
+  runner.SetWorkers (4);
+  failed = runner.Run (MakeCallback (&ReplicationRunnerTestCase::Replicate), filename);
+  NS_TEST_ASSERT_MSG_EQ (failed, 0, "No replication should fail");
+  std::vector<std::string> parallel = ReadLines (filename);
+  NS_TEST_ASSERT_MSG_EQ ((parallel == serial), true, "Results differ when run in parallel");
+
+  // A failing replication is reported and does not stop the others
+  x.push_back ("fail");
+  ReplicationRunner failing;
+  failing.AddParameter ("x", x);
+  failing.SetWorkers (2);
+  failed = failing.Run (MakeCallback (&ReplicationRunnerTestCase::Replicate), filename);
+  NS_TEST_ASSERT_MSG_EQ (failed, 1, "The failing replication was not detected");
+  std::vector<std::string> lines = ReadLines (filename);
+  NS_TEST_ASSERT_MSG_EQ (lines.size (), 5, "Wrong number of lines");
+  NS_TEST_ASSERT_MSG_EQ (lines[4], "# fail 1 failed with status 3", "Failure not reported");
+
+  std::remove (filename.c_str ());
+}
+
+/**
+ * \ingroup stats-tests
+ *
+ * \brief The replication runner TestSuite
+ */
+class ReplicationRunnerTestSuite : public TestSuite
+{
+public:
+  ReplicationRunnerTestSuite ();
+};
+
+ReplicationRunnerTestSuite::ReplicationRunnerTestSuite ()
+  : TestSuite ("replication-runner", UNIT)
+{
+  AddTestCase (new ReplicationRunnerTestCase, TestCase::QUICK);
+}
+
+/// Static variable for test initialization
+static ReplicationRunnerTestSuite g_replicationRunnerTestSuite;
@@ -0,0 +1,200 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * HULL on a two-tier fat tree: 2 spine and 2 leaf switches, and 64 hosts,
+ * 32 under every leaf. Every host under the first leaf sends a DCTCP flow
+ * to a host under the second leaf, every receiver getting two flows, and
+ * every port of the switches has a PhantomQueueDisc.
+ *
+ * With --threads=N (N > 0), the simulation is run by the
+ * MultithreadedSimulatorImpl with N partitions: the hosts are split into N
+ * consecutive ranges, every leaf going with its first host, and the
+ * spines are spread over the partitions. With --threads=0, it is run by the
+ * DefaultSimulatorImpl. The goodput, the number of marked and dropped
+ * packets, the number of events and the wall clock time taken by the
+ * simulation are printed.
+ *
+ *    ./waf --run "hull-fat-tree --threads=4"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/traffic-control-module.h"
+
+#include <iostream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("HullFatTree");
+
+static const uint32_t N_SPINES = 2;          //!< Number of spine switches
+static const uint32_t N_LEAVES = 2;          //!< Number of leaf switches
+static const uint32_t N_HOSTS_PER_LEAF = 32; //!< Number of hosts under every leaf
+
+int main (int argc, char *argv[])
+{
+  uint32_t threads = 0;
+  std::string hostLinkBw = "1Gbps";
+  std::string fabricLinkBw = "10Gbps";
+  std::string linkDelay = "10us";
+  uint32_t queueLimitBytes = 150000;
+  double stopTime = 0.5;
+
+  CommandLine cmd;
+  cmd.AddValue ("threads", "Number of threads running the simulation (0 for the sequential simulator)", threads);
+  cmd.AddValue ("hostLinkBw", "Rate of the links between hosts and leaves", hostLinkBw);
+  cmd.AddValue ("fabricLinkBw", "Rate of the links between leaves and spines", fabricLinkBw);
+  cmd.AddValue ("linkDelay", "Delay of all the links", linkDelay);
+  cmd.AddValue ("queueLimitBytes", "Max bytes allowed in every queue disc", queueLimitBytes);
+  cmd.AddValue ("stopTime", "Duration of the simulation in seconds", stopTime);
+  cmd.Parse (argc, argv);
+
+  // Must be chosen before the nodes are created
+  if (threads > 0)
+    {
+      GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::MultithreadedSimulatorImpl"));
+    }
+  uint32_t nPartitions = std::max (threads, 1u);
+
+  Config::SetDefault ("ns3::TcpL4Protocol::SocketType", StringValue ("ns3::TcpDctcp"));
+  Config::SetDefault ("ns3::TcpSocketBase::EcnMode", StringValue ("ClassicEcn"));
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1000));
+  Config::SetDefault ("ns3::TcpSocket::DelAckCount", UintegerValue (1));
+  Config::SetDefault ("ns3::PhantomQueueDisc::LinkDelay", StringValue (linkDelay));
+
+  uint32_t nHosts = N_LEAVES * N_HOSTS_PER_LEAF;
+  NodeContainer hosts;
+  for (uint32_t h = 0; h < nHosts; ++h)
+    {
+      hosts.Add (CreateObject<Node> (h * nPartitions / nHosts));
+    }
+  NodeContainer leaves;
+  for (uint32_t l = 0; l < N_LEAVES; ++l)
+    {
+      leaves.Add (CreateObject<Node> (l * N_HOSTS_PER_LEAF * nPartitions / nHosts));
+    }
+  NodeContainer spines;
+  for (uint32_t s = 0; s < N_SPINES; ++s)
+    {
+      spines.Add (CreateObject<Node> (s % nPartitions));
+    }
+
+  InternetStackHelper stack;
+  stack.Install (hosts);
+  stack.Install (leaves);
+  stack.Install (spines);
+
+  PointToPointHelper hostLink;
+  hostLink.SetDeviceAttribute ("DataRate", StringValue (hostLinkBw));
+  hostLink.SetChannelAttribute ("Delay", StringValue (linkDelay));
+  PointToPointHelper fabricLink;
+  fabricLink.SetDeviceAttribute ("DataRate", StringValue (fabricLinkBw));
+  fabricLink.SetChannelAttribute ("Delay", StringValue (linkDelay));
+
+  TrafficControlHelper tchHost;
+  tchHost.SetRootQueueDisc ("ns3::PhantomQueueDisc",
+                            "MaxSize", QueueSizeValue (QueueSize (QueueSizeUnit::BYTES, queueLimitBytes)),
+                            "LinkBandwidth", StringValue (hostLinkBw));
+  TrafficControlHelper tchFabric;
+  tchFabric.SetRootQueueDisc ("ns3::PhantomQueueDisc",
+                              "MaxSize", QueueSizeValue (QueueSize (QueueSizeUnit::BYTES, queueLimitBytes)),
+                              "LinkBandwidth", StringValue (fabricLinkBw));
+
+  // Every link has its own subnet; the queue discs are installed on the
+  // ports of the switches only
+  Ipv4AddressHelper address ("10.0.0.0", "255.255.255.252");
+  QueueDiscContainer queueDiscs;
+  std::vector<Ipv4Address> hostAddresses;
+  for (uint32_t h = 0; h < nHosts; ++h)
+    {
+      NetDeviceContainer devices = hostLink.Install (hosts.Get (h), leaves.Get (h / N_HOSTS_PER_LEAF));
+      queueDiscs.Add (tchHost.Install (devices.Get (1)));
+      hostAddresses.push_back (address.Assign (devices).GetAddress (0));
+      address.NewNetwork ();
+    }
+  for (uint32_t l = 0; l < N_LEAVES; ++l)
+    {
+      for (uint32_t s = 0; s < N_SPINES; ++s)
+        {
+          NetDeviceContainer devices = fabricLink.Install (leaves.Get (l), spines.Get (s));
+          queueDiscs.Add (tchFabric.Install (devices));
+          address.Assign (devices);
+          address.NewNetwork ();
+        }
+    }
+
+  uint16_t port = 5001;
+  Address sinkLocalAddress (InetSocketAddress (Ipv4Address::GetAny (), port));
+  PacketSinkHelper packetSinkHelper ("ns3::TcpSocketFactory", sinkLocalAddress);
+  ApplicationContainer sinkApps;
+  for (uint32_t h = N_HOSTS_PER_LEAF; h < nHosts; ++h)
+    {
+      sinkApps.Add (packetSinkHelper.Install (hosts.Get (h)));
+    }
+  sinkApps.Start (Seconds (0.0));
+  sinkApps.Stop (Seconds (stopTime));
+
+  // The senders start at random times, drawn here by the main thread
+  Ptr<UniformRandomVariable> startTime = CreateObject<UniformRandomVariable> ();
+  startTime->SetAttribute ("Min", DoubleValue (0.01));
+  startTime->SetAttribute ("Max", DoubleValue (0.02));
+  BulkSendHelper clientHelper ("ns3::TcpSocketFactory", Address ());
+  clientHelper.SetAttribute ("MaxBytes", UintegerValue (0));
+  for (uint32_t h = 0; h < N_HOSTS_PER_LEAF; ++h)
+    {
+      Ipv4Address remote = hostAddresses[N_HOSTS_PER_LEAF + h / 2];
+      clientHelper.SetAttribute ("Remote", AddressValue (InetSocketAddress (remote, port)));
+      ApplicationContainer clientApp = clientHelper.Install (hosts.Get (h));
+      clientApp.Start (Seconds (startTime->GetValue ()));
+      clientApp.Stop (Seconds (stopTime));
+    }
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  Simulator::Stop (Seconds (stopTime));
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  int64_t wallTime = clock.End ();
+
+  uint64_t totalRxBytes = 0;
+  for (uint32_t i = 0; i < sinkApps.GetN (); i++)
+    {
+      totalRxBytes += DynamicCast<PacketSink> (sinkApps.Get (i))->GetTotalRx ();
+    }
+  uint32_t marks = 0;
+  uint32_t drops = 0;
+  for (uint32_t i = 0; i < queueDiscs.GetN (); i++)
+    {
+      QueueDisc::Stats st = queueDiscs.Get (i)->GetStats ();
+      marks += st.GetNMarkedPackets (PhantomQueueDisc::FORCED_MARK);
+      drops += st.nTotalDroppedPackets;
+    }
+
+  std::cout << "Threads: " << threads
+            << ", goodput: " << totalRxBytes * 8 / (stopTime - 0.01) / 1e6 << " Mbps"
+            << ", marks: " << marks
+            << ", drops: " << drops
+            << ", events: " << Simulator::GetEventCount ()
+            << ", wall time: " << wallTime << " ms" << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
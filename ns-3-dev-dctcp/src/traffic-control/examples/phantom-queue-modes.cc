@@ -0,0 +1,350 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Compare the admission and marking modes of the PhantomQueueDisc, and ECN
+ * marking at enqueue and at dequeue, on a dumbbell where DCTCP flows share
+ * the bottleneck:
+ *
+ * - PhantomPackets: packet-mode admission, phantom queue marking
+ * - PhantomBytes: byte-mode admission, phantom queue marking
+ * - Instantaneous: byte-mode admission, DCTCP-style marking based on the
+ *   instantaneous occupancy of the real queue
+ * - PhantomDequeue: packet-mode admission, phantom queue checked at dequeue
+ * - SojournDequeue: packet-mode admission, sojourn time checked at dequeue
+ * - RedEnqueue: RedQueueDisc with a DCTCP-like step on the instantaneous
+ *   queue, at enqueue
+ * - RedDequeue: RedQueueDisc, sojourn time checked at dequeue
+ *
+ * The marking modes other than Instantaneous use the same threshold:
+ * markingThreshold bytes for the phantom queue, the number of packets of
+ * that many bytes for RED at enqueue, and the transmission time of that many
+ * bytes on the bottleneck for the sojourn time.  A packet marked at enqueue
+ * carries the state of the queue when it arrived, hence a congestion signal
+ * which is late by the time it spent in the queue; a packet marked at
+ * dequeue carries the state of the queue when it leaves.
+ *
+ * By default all the modes are run in sequence; use --mode to run one only.
+ * For each mode, the goodput, the number of marked and dropped packets, the
+ * average and maximum occupancy of the bottleneck queue, the average sojourn
+ * time of the packets and the wall clock time taken by the run are printed.
+ *
+ * With --columnarTraces, the occupancy of the bottleneck queue, the
+ * occupancy of the phantom queue and the congestion window and RTT of the
+ * first sender are written to binary columnar trace files named after the
+ * mode (see ColumnarTraceFile), e.g. PhantomBytes-BytesInQueue.col.
+ *
+ *    ./waf --run "phantom-queue-modes --nLeaf=8"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/point-to-point-layout-module.h"
+#include "ns3/traffic-control-module.h"
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("PhantomQueueModes");
+
+/// Statistics about the occupancy of the bottleneck queue
+struct QueueOccupancy
+{
+  uint64_t sum;        //!< Sum of the samples in bytes
+  uint32_t max;        //!< Largest sample in bytes
+  uint32_t nSamples;   //!< Number of samples
+  Time sojournSum;     //!< Sum of the sojourn times of the packets
+  uint32_t nSojourns;  //!< Number of packets dequeued
+};
+
+static void
+SampleQueue (Ptr<QueueDisc> queue, Time interval, QueueOccupancy *occupancy)
+{
+  uint32_t bytes = queue->GetNBytes ();
+  occupancy->sum += bytes;
+  occupancy->max = std::max (occupancy->max, bytes);
+  occupancy->nSamples++;
+  Simulator::Schedule (interval, &SampleQueue, queue, interval, occupancy);
+}
+
+static void
+SojournTime (QueueOccupancy *occupancy, Time sojourn)
+{
+  occupancy->sojournSum += sojourn;
+  occupancy->nSojourns++;
+}
+
+static void
+ConnectColumnarTraces (std::string mode, Ptr<QueueDisc> queue, Ptr<Node> sender,
+                       std::vector<Ptr<ColumnarTraceFile> > *files)
+{
+  Ptr<ColumnarTraceFile> file = Create<ColumnarTraceFile> (mode + "-BytesInQueue.col", "BytesInQueue");
+  queue->TraceConnectWithoutContext ("BytesInQueue", file->MakeSink<uint32_t> ());
+  files->push_back (file);
+
+  Ptr<PhantomQueueDisc> phantomQueueDisc = DynamicCast<PhantomQueueDisc> (queue);
+  if (phantomQueueDisc)
+    {
+      file = Create<ColumnarTraceFile> (mode + "-VirtualQueue.col", "VirtualQueue");
+      phantomQueueDisc->GetPhantomQueue ()->TraceConnectWithoutContext ("VirtualQueue", file->MakeSink<uint32_t> ());
+      files->push_back (file);
+    }
+
+  std::ostringstream socket;
+  socket << "/NodeList/" << sender->GetId () << "/$ns3::TcpL4Protocol/SocketList/0/";
+  file = Create<ColumnarTraceFile> (mode + "-CongestionWindow.col", "CongestionWindow");
+  Config::ConnectWithoutContext (socket.str () + "CongestionWindow", file->MakeSink<uint32_t> ());
+  files->push_back (file);
+  file = Create<ColumnarTraceFile> (mode + "-RTT.col", "RTT", ColumnarTraceFile::GetValueTypeOf<Time> ());
+  Config::ConnectWithoutContext (socket.str () + "RTT", file->MakeSink<Time> ());
+  files->push_back (file);
+}
+
+static void
+RunMode (std::string mode, uint32_t nLeaf, uint32_t pktSize, uint32_t queueLimitPackets,
+         double markingThreshold, std::string bottleNeckLinkBw, std::string bottleNeckLinkDelay,
+         double stopTime, bool columnarTraces)
+{
+  QueueSize maxSize (QueueSizeUnit::PACKETS, queueLimitPackets);
+  Time sojournThreshold = DataRate (bottleNeckLinkBw).CalculateBytesTxTime (markingThreshold);
+  double redThreshold = std::max (1.0, std::floor (markingThreshold / pktSize));
+
+  TrafficControlHelper tchBottleneck;
+  if (mode == "PhantomPackets")
+    {
+      tchBottleneck.SetRootQueueDisc ("ns3::PhantomQueueDisc",
+                                      "MaxSize", QueueSizeValue (maxSize),
+                                      "MarkingMode", EnumValue (PhantomQueueDisc::PHANTOM_QUEUE_MARKING));
+    }
+  else if (mode == "PhantomBytes")
+    {
+      tchBottleneck.SetRootQueueDisc ("ns3::PhantomQueueDisc",
+                                      "MaxSize", QueueSizeValue (QueueSize (QueueSizeUnit::BYTES, queueLimitPackets * pktSize)),
+                                      "MarkingMode", EnumValue (PhantomQueueDisc::PHANTOM_QUEUE_MARKING));
+    }
+  else if (mode == "Instantaneous")
+    {
+      tchBottleneck.SetRootQueueDisc ("ns3::PhantomQueueDisc",
+                                      "MaxSize", QueueSizeValue (QueueSize (QueueSizeUnit::BYTES, queueLimitPackets * pktSize)),
+                                      "MarkingMode", EnumValue (PhantomQueueDisc::INSTANTANEOUS_QUEUE_MARKING));
+    }
+  else if (mode == "PhantomDequeue")
+    {
+      tchBottleneck.SetRootQueueDisc ("ns3::PhantomQueueDisc",
+                                      "MaxSize", QueueSizeValue (maxSize),
+                                      "MarkingMode", EnumValue (PhantomQueueDisc::PHANTOM_QUEUE_MARKING),
+                                      "MarkOnDequeue", BooleanValue (true));
+    }
+  else if (mode == "SojournDequeue")
+    {
+      tchBottleneck.SetRootQueueDisc ("ns3::PhantomQueueDisc",
+                                      "MaxSize", QueueSizeValue (maxSize),
+                                      "MarkingMode", EnumValue (PhantomQueueDisc::SOJOURN_TIME_MARKING),
+                                      "SojournMarkingThreshold", TimeValue (sojournThreshold));
+    }
+  else if (mode == "RedEnqueue" || mode == "RedDequeue")
+    {
+      // With a weight of 1 and equal thresholds, RED marks every packet
+      // arriving to a queue of redThreshold packets or more, as DCTCP needs
+      tchBottleneck.SetRootQueueDisc ("ns3::RedQueueDisc",
+                                      "MaxSize", QueueSizeValue (maxSize),
+                                      "MeanPktSize", UintegerValue (pktSize),
+                                      "QW", DoubleValue (1),
+                                      "MinTh", DoubleValue (redThreshold),
+                                      "MaxTh", DoubleValue (redThreshold),
+                                      "UseEcn", BooleanValue (true),
+                                      "UseHardDrop", BooleanValue (false),
+                                      "MarkOnDequeue", BooleanValue (mode == "RedDequeue"),
+                                      "SojournMarkingThreshold", TimeValue (sojournThreshold));
+    }
+  else
+    {
+      NS_ABORT_MSG ("Invalid mode: use PhantomPackets, PhantomBytes, Instantaneous, PhantomDequeue, "
+                    "SojournDequeue, RedEnqueue or RedDequeue");
+    }
+
+  PointToPointHelper bottleNeckLink;
+  bottleNeckLink.SetDeviceAttribute  ("DataRate", StringValue (bottleNeckLinkBw));
+  bottleNeckLink.SetChannelAttribute ("Delay", StringValue (bottleNeckLinkDelay));
+
+  PointToPointHelper pointToPointLeaf;
+  pointToPointLeaf.SetDeviceAttribute    ("DataRate", StringValue ("1Gbps"));
+  pointToPointLeaf.SetChannelAttribute   ("Delay", StringValue ("10us"));
+
+  PointToPointDumbbellHelper d (nLeaf, pointToPointLeaf,
+                                nLeaf, pointToPointLeaf,
+                                bottleNeckLink);
+
+  InternetStackHelper stack;
+  d.InstallStack (stack);
+
+  QueueDiscContainer queueDiscs = tchBottleneck.Install (d.GetLeft ()->GetDevice (0));
+
+  d.AssignIpv4Addresses (Ipv4AddressHelper ("10.1.1.0", "255.255.255.0"),
+                         Ipv4AddressHelper ("10.2.1.0", "255.255.255.0"),
+                         Ipv4AddressHelper ("10.3.1.0", "255.255.255.0"));
+
+  // Bulk senders on the left, sinks on the right
+  uint16_t port = 5001;
+  Address sinkLocalAddress (InetSocketAddress (Ipv4Address::GetAny (), port));
+  PacketSinkHelper packetSinkHelper ("ns3::TcpSocketFactory", sinkLocalAddress);
+  ApplicationContainer sinkApps;
+  for (uint32_t i = 0; i < d.RightCount (); ++i)
+    {
+      sinkApps.Add (packetSinkHelper.Install (d.GetRight (i)));
+    }
+  sinkApps.Start (Seconds (0.0));
+  sinkApps.Stop (Seconds (stopTime));
+
+  BulkSendHelper clientHelper ("ns3::TcpSocketFactory", Address ());
+  clientHelper.SetAttribute ("MaxBytes", UintegerValue (0));
+  ApplicationContainer clientApps;
+  for (uint32_t i = 0; i < d.LeftCount (); ++i)
+    {
+      AddressValue remoteAddress (InetSocketAddress (d.GetRightIpv4Address (i), port));
+      clientHelper.SetAttribute ("Remote", remoteAddress);
+      clientApps.Add (clientHelper.Install (d.GetLeft (i)));
+    }
+  clientApps.Start (Seconds (0.1));
+  clientApps.Stop (Seconds (stopTime));
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  QueueOccupancy occupancy = {0, 0, 0, Seconds (0), 0};
+  Simulator::Schedule (Seconds (0.1), &SampleQueue, queueDiscs.Get (0), MicroSeconds (100), &occupancy);
+  queueDiscs.Get (0)->TraceConnectWithoutContext ("SojournTime", MakeBoundCallback (&SojournTime, &occupancy));
+
+  // The sockets are created when the senders start
+  std::vector<Ptr<ColumnarTraceFile> > files;
+  if (columnarTraces)
+    {
+      Simulator::Schedule (Seconds (0.1) + NanoSeconds (1), &ConnectColumnarTraces,
+                           mode, queueDiscs.Get (0), d.GetLeft (0), &files);
+    }
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Stop (Seconds (stopTime));
+  Simulator::Run ();
+  int64_t elapsed = clock.End ();
+
+  for (std::vector<Ptr<ColumnarTraceFile> >::iterator it = files.begin (); it != files.end (); ++it)
+    {
+      (*it)->Flush ();
+    }
+
+  uint64_t totalRxBytes = 0;
+  for (uint32_t i = 0; i < sinkApps.GetN (); i++)
+    {
+      totalRxBytes += DynamicCast<PacketSink> (sinkApps.Get (i))->GetTotalRx ();
+    }
+
+  QueueDisc::Stats st = queueDiscs.Get (0)->GetStats ();
+  std::cout << std::setw (16) << mode
+            << std::setw (14) << totalRxBytes * 8 / (stopTime - 0.1) / 1e6
+            << std::setw (10) << st.nTotalMarkedPackets
+            << std::setw (10) << st.nTotalDroppedPackets
+            << std::setw (14) << (occupancy.nSamples ? occupancy.sum / occupancy.nSamples : 0)
+            << std::setw (12) << occupancy.max
+            << std::setw (16) << (occupancy.nSojourns ? occupancy.sojournSum.GetMicroSeconds () / occupancy.nSojourns : 0)
+            << std::setw (10) << elapsed << std::endl;
+
+  Simulator::Destroy ();
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t    nLeaf = 4;
+  uint32_t    pktSize = 1000;
+  uint32_t    queueDiscLimitPackets = 100;
+  uint32_t    queueMarkingThreshold = 20;
+  double      drainRateFraction = 0.95;
+  double      markingThreshold = 3000;
+  std::string bottleNeckLinkBw = "100Mbps";
+  std::string bottleNeckLinkDelay = "10us";
+  double      stopTime = 2.0;
+  std::string mode = "All";
+  bool        columnarTraces = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("mode", "PhantomPackets, PhantomBytes, Instantaneous, PhantomDequeue, SojournDequeue, "
+                "RedEnqueue, RedDequeue or All", mode);
+  cmd.AddValue ("nLeaf", "Number of left and right side leaf nodes", nLeaf);
+  cmd.AddValue ("pktSize", "TCP segment size", pktSize);
+  cmd.AddValue ("queueDiscLimitPackets", "Max packets allowed in the queue disc", queueDiscLimitPackets);
+  cmd.AddValue ("queueMarkingThreshold", "Marking threshold (packets) of the Instantaneous mode", queueMarkingThreshold);
+  cmd.AddValue ("drainRateFraction", "Drain rate of the phantom queue as a fraction of the link rate", drainRateFraction);
+  cmd.AddValue ("markingThreshold", "Marking threshold (bytes) of the phantom queue, converted for the "
+                "sojourn time and RED modes", markingThreshold);
+  cmd.AddValue ("bottleNeckLinkBw", "Bottleneck link bandwidth", bottleNeckLinkBw);
+  cmd.AddValue ("bottleNeckLinkDelay", "Bottleneck link delay", bottleNeckLinkDelay);
+  cmd.AddValue ("stopTime", "Duration of every run in seconds", stopTime);
+  cmd.AddValue ("columnarTraces", "Write the queue and TCP traces to columnar trace files", columnarTraces);
+  cmd.Parse (argc, argv);
+
+  Config::SetDefault ("ns3::TcpL4Protocol::SocketType", StringValue ("ns3::TcpDctcp"));
+  Config::SetDefault ("ns3::TcpSocketBase::EcnMode", StringValue ("ClassicEcn"));
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (pktSize));
+  Config::SetDefault ("ns3::TcpSocket::DelAckCount", UintegerValue (1));
+
+  Config::SetDefault ("ns3::PhantomQueueDisc::LinkBandwidth", StringValue (bottleNeckLinkBw));
+  Config::SetDefault ("ns3::PhantomQueueDisc::LinkDelay", StringValue (bottleNeckLinkDelay));
+  Config::SetDefault ("ns3::PhantomQueueDisc::DrainRateFraction", DoubleValue (drainRateFraction));
+  Config::SetDefault ("ns3::PhantomQueueDisc::MarkingthreShold", DoubleValue (markingThreshold));
+  Config::SetDefault ("ns3::PhantomQueueDisc::QueueMarkingThreshold",
+                      QueueSizeValue (QueueSize (QueueSizeUnit::PACKETS, queueMarkingThreshold)));
+  Config::SetDefault ("ns3::RedQueueDisc::LinkBandwidth", StringValue (bottleNeckLinkBw));
+  Config::SetDefault ("ns3::RedQueueDisc::LinkDelay", StringValue (bottleNeckLinkDelay));
+
+  std::vector<std::string> modes;
+  if (mode == "All")
+    {
+      modes.push_back ("PhantomPackets");
+      modes.push_back ("PhantomBytes");
+      modes.push_back ("Instantaneous");
+      modes.push_back ("PhantomDequeue");
+      modes.push_back ("SojournDequeue");
+      modes.push_back ("RedEnqueue");
+      modes.push_back ("RedDequeue");
+    }
+  else
+    {
+      modes.push_back (mode);
+    }
+
+  std::cout << std::setw (16) << "Mode"
+            << std::setw (14) << "Goodput(Mbps)"
+            << std::setw (10) << "Marks"
+            << std::setw (10) << "Drops"
+            << std::setw (14) << "AvgQueue(B)"
+            << std::setw (12) << "MaxQueue(B)"
+            << std::setw (16) << "AvgSojourn(us)"
+            << std::setw (10) << "Wall(ms)" << std::endl;
+
+  for (std::vector<std::string>::const_iterator it = modes.begin (); it != modes.end (); ++it)
+    {
+      RunMode (*it, nLeaf, pktSize, queueDiscLimitPackets, markingThreshold, bottleNeckLinkBw,
+               bottleNeckLinkDelay, stopTime, columnarTraces);
+    }
+
+  return 0;
+}
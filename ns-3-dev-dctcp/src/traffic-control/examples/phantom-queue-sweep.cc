@@ -0,0 +1,218 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Sweep the parameters of HULL (the drain rate and the marking threshold of
+ * the PhantomQueueDisc, and the gain of the DCTCP senders) on a dumbbell
+ * where DCTCP flows share the bottleneck.
+ *
+ * Every point of the sweep is replicated with independent random start
+ * times of the flows, and the replications are run in parallel by a
+ * ReplicationRunner. For each replication, the goodput, the number of
+ * marked and dropped packets and the average occupancy of the bottleneck
+ * queue are written to a single file, one line per replication:
+ *
+ *    ./waf --run "phantom-queue-sweep --drainRateFraction=0.9,0.95
+ *                 --markingThreshold=1500,3000,6000 --replications=5"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/point-to-point-layout-module.h"
+#include "ns3/traffic-control-module.h"
+#include "ns3/replication-runner.h"
+
+#include <iostream>
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("PhantomQueueSweep");
+
+uint32_t g_nLeaf = 4;                      //!< Number of senders and receivers
+uint32_t g_queueLimitBytes = 100000;       //!< Size of the bottleneck queue
+std::string g_bottleNeckLinkBw = "100Mbps"; //!< Rate of the bottleneck
+std::string g_bottleNeckLinkDelay = "10us"; //!< Delay of the bottleneck
+double g_stopTime = 2.0;                   //!< Duration of every replication
+
+/// Statistics about the occupancy of the bottleneck queue
+struct QueueOccupancy
+{
+  uint64_t sum;      //!< Sum of the samples in bytes
+  uint32_t nSamples; //!< Number of samples
+};
+
+static void
+SampleQueue (Ptr<QueueDisc> queue, Time interval, QueueOccupancy *occupancy)
+{
+  occupancy->sum += queue->GetNBytes ();
+  occupancy->nSamples++;
+  Simulator::Schedule (interval, &SampleQueue, queue, interval, occupancy);
+}
+
+static std::string
+RunReplication (const ReplicationRunner::Point &point)
+{
+  // The parameters of the PhantomQueueDisc and TcpDctcp have been set as
+  // attribute defaults by the runner
+  TrafficControlHelper tchBottleneck;
+  tchBottleneck.SetRootQueueDisc ("ns3::PhantomQueueDisc",
+                                  "MaxSize", QueueSizeValue (QueueSize (QueueSizeUnit::BYTES, g_queueLimitBytes)),
+                                  "LinkBandwidth", StringValue (g_bottleNeckLinkBw),
+                                  "LinkDelay", StringValue (g_bottleNeckLinkDelay));
+
+  PointToPointHelper bottleNeckLink;
+  bottleNeckLink.SetDeviceAttribute  ("DataRate", StringValue (g_bottleNeckLinkBw));
+  bottleNeckLink.SetChannelAttribute ("Delay", StringValue (g_bottleNeckLinkDelay));
+
+  PointToPointHelper pointToPointLeaf;
+  pointToPointLeaf.SetDeviceAttribute    ("DataRate", StringValue ("1Gbps"));
+  pointToPointLeaf.SetChannelAttribute   ("Delay", StringValue ("10us"));
+
+  PointToPointDumbbellHelper d (g_nLeaf, pointToPointLeaf,
+                                g_nLeaf, pointToPointLeaf,
+                                bottleNeckLink);
+
+  InternetStackHelper stack;
+  d.InstallStack (stack);
+
+  QueueDiscContainer queueDiscs = tchBottleneck.Install (d.GetLeft ()->GetDevice (0));
+
+  d.AssignIpv4Addresses (Ipv4AddressHelper ("10.1.1.0", "255.255.255.0"),
+                         Ipv4AddressHelper ("10.2.1.0", "255.255.255.0"),
+                         Ipv4AddressHelper ("10.3.1.0", "255.255.255.0"));
+
+  uint16_t port = 5001;
+  Address sinkLocalAddress (InetSocketAddress (Ipv4Address::GetAny (), port));
+  PacketSinkHelper packetSinkHelper ("ns3::TcpSocketFactory", sinkLocalAddress);
+  ApplicationContainer sinkApps;
+  for (uint32_t i = 0; i < d.RightCount (); ++i)
+    {
+      sinkApps.Add (packetSinkHelper.Install (d.GetRight (i)));
+    }
+  sinkApps.Start (Seconds (0.0));
+  sinkApps.Stop (Seconds (g_stopTime));
+
+  // The senders start at random times, which differ between replications
+  Ptr<UniformRandomVariable> startTime = CreateObject<UniformRandomVariable> ();
+  startTime->SetAttribute ("Min", DoubleValue (0.1));
+  startTime->SetAttribute ("Max", DoubleValue (0.2));
+  BulkSendHelper clientHelper ("ns3::TcpSocketFactory", Address ());
+  clientHelper.SetAttribute ("MaxBytes", UintegerValue (0));
+  for (uint32_t i = 0; i < d.LeftCount (); ++i)
+    {
+      AddressValue remoteAddress (InetSocketAddress (d.GetRightIpv4Address (i), port));
+      clientHelper.SetAttribute ("Remote", remoteAddress);
+      ApplicationContainer clientApp = clientHelper.Install (d.GetLeft (i));
+      clientApp.Start (Seconds (startTime->GetValue ()));
+      clientApp.Stop (Seconds (g_stopTime));
+    }
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  QueueOccupancy occupancy = {0, 0};
+  Simulator::Schedule (Seconds (0.2), &SampleQueue, queueDiscs.Get (0), MicroSeconds (100), &occupancy);
+
+  Simulator::Stop (Seconds (g_stopTime));
+  Simulator::Run ();
+
+  uint64_t totalRxBytes = 0;
+  for (uint32_t i = 0; i < sinkApps.GetN (); i++)
+    {
+      totalRxBytes += DynamicCast<PacketSink> (sinkApps.Get (i))->GetTotalRx ();
+    }
+
+  QueueDisc::Stats st = queueDiscs.Get (0)->GetStats ();
+  std::ostringstream oss;
+  oss << totalRxBytes * 8 / (g_stopTime - 0.1) / 1e6
+      << " " << st.GetNMarkedPackets (PhantomQueueDisc::FORCED_MARK)
+      << " " << st.nTotalDroppedPackets
+      << " " << (occupancy.nSamples ? occupancy.sum / occupancy.nSamples : 0);
+
+  Simulator::Destroy ();
+  return oss.str ();
+}
+
+/**
+ * Split a comma separated list of values
+ * \param list the list
+ * \return the values
+ */
+static std::vector<std::string>
+SplitValues (std::string list)
+{
+  std::vector<std::string> values;
+  std::istringstream iss (list);
+  std::string value;
+  while (std::getline (iss, value, ','))
+    {
+      values.push_back (value);
+    }
+  return values;
+}
+
+int main (int argc, char *argv[])
+{
+  std::string drainRateFraction = "0.9,0.95";
+  std::string markingThreshold = "1500,3000,6000";
+  std::string dctcpShiftG = "0.0625";
+  uint32_t replications = 3;
+  uint32_t workers = 0;
+  std::string output = "phantom-queue-sweep.dat";
+
+  CommandLine cmd;
+  cmd.AddValue ("drainRateFraction", "Comma separated drain rates of the phantom queue, as fractions of the link rate", drainRateFraction);
+  cmd.AddValue ("markingThreshold", "Comma separated marking thresholds (bytes) of the phantom queue", markingThreshold);
+  cmd.AddValue ("dctcpShiftG", "Comma separated gains of the DCTCP senders", dctcpShiftG);
+  cmd.AddValue ("replications", "Number of replications of every point", replications);
+  cmd.AddValue ("workers", "Number of replications run at the same time (0 for the number of processors)", workers);
+  cmd.AddValue ("output", "File the results are written to", output);
+  cmd.AddValue ("nLeaf", "Number of left and right side leaf nodes", g_nLeaf);
+  cmd.AddValue ("queueLimitBytes", "Max bytes allowed in the queue disc", g_queueLimitBytes);
+  cmd.AddValue ("bottleNeckLinkBw", "Bottleneck link bandwidth", g_bottleNeckLinkBw);
+  cmd.AddValue ("bottleNeckLinkDelay", "Bottleneck link delay", g_bottleNeckLinkDelay);
+  cmd.AddValue ("stopTime", "Duration of every replication in seconds", g_stopTime);
+  cmd.Parse (argc, argv);
+
+  Config::SetDefault ("ns3::TcpL4Protocol::SocketType", StringValue ("ns3::TcpDctcp"));
+  Config::SetDefault ("ns3::TcpSocketBase::EcnMode", StringValue ("ClassicEcn"));
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1000));
+  Config::SetDefault ("ns3::TcpSocket::DelAckCount", UintegerValue (1));
+
+  ReplicationRunner runner;
+  runner.AddParameter ("ns3::PhantomQueueDisc::DrainRateFraction", SplitValues (drainRateFraction));
+  runner.AddParameter ("ns3::PhantomQueueDisc::MarkingthreShold", SplitValues (markingThreshold));
+  runner.AddParameter ("ns3::TcpDctcp::DctcpShiftG", SplitValues (dctcpShiftG));
+  runner.SetReplications (replications);
+  runner.SetWorkers (workers);
+
+  std::cout << "Running " << runner.GetNPoints () << " points, " << replications
+            << " replications each; columns: goodput(Mbps) marks drops avgQueue(B)" << std::endl;
+  SystemWallClockMs clock;
+  clock.Start ();
+  uint32_t failed = runner.Run (MakeCallback (&RunReplication), output);
+  std::cout << "Results written to " << output << " in " << clock.End () << " ms";
+  if (failed > 0)
+    {
+      std::cout << ", " << failed << " replications failed";
+    }
+  std::cout << std::endl;
+
+  return (failed > 0 ? 1 : 0);
+}
@@ -0,0 +1,401 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Fair queueing with per-flow pacing, modelled on the Linux sch_fq packet
+ * scheduler.
+ */
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/socket.h"
+#include "ns3/drop-tail-queue.h"
+#include "fq-pacing-queue-disc.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FqPacingQueueDisc");
+
+NS_OBJECT_ENSURE_REGISTERED (FqPacingQueueDisc);
+
+TypeId FqPacingQueueDisc::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::FqPacingQueueDisc")
+    .SetParent<QueueDisc> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<FqPacingQueueDisc> ()
+    .AddAttribute ("MaxSize",
+                   "The maximum number of packets accepted by this queue disc",
+                   QueueSizeValue (QueueSize ("10000p")),
+                   MakeQueueSizeAccessor (&QueueDisc::SetMaxSize,
+                                          &QueueDisc::GetMaxSize),
+                   MakeQueueSizeChecker ())
+    .AddAttribute ("FlowLimit",
+                   "The maximum number of packets of a flow",
+                   UintegerValue (100),
+                   MakeUintegerAccessor (&FqPacingQueueDisc::m_flowLimit),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("Quantum",
+                   "The credit in bytes given to the flows at every round",
+                   UintegerValue (3028),
+                   MakeUintegerAccessor (&FqPacingQueueDisc::m_quantum),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("InitialQuantum",
+                   "The credit in bytes of the flows when they become active",
+                   UintegerValue (15140),
+                   MakeUintegerAccessor (&FqPacingQueueDisc::m_initialQuantum),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Rate",
+                   "The pacing rate of the packets without pacing rate tag, zero not to pace them",
+                   DataRateValue (DataRate (0)),
+                   MakeDataRateAccessor (&FqPacingQueueDisc::m_rate),
+                   MakeDataRateChecker ())
+    .AddAttribute ("MaxRate",
+                   "The maximum pacing rate of the flows, zero for no maximum",
+                   DataRateValue (DataRate (0)),
+                   MakeDataRateAccessor (&FqPacingQueueDisc::m_maxRate),
+                   MakeDataRateChecker ())
+    .AddAttribute ("Perturbation",
+                   "The salt used as an additional input to the hash function used to classify packets",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&FqPacingQueueDisc::m_perturbation),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+FqPacingQueueDisc::FqPacingQueueDisc ()
+  : QueueDisc (QueueDiscSizePolicy::MULTIPLE_QUEUES, QueueSizeUnit::PACKETS)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+FqPacingQueueDisc::~FqPacingQueueDisc ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+FqPacingQueueDisc::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_id.Cancel ();
+  m_flowTable.clear ();
+  m_flowIndex.clear ();
+  m_freeFlows.clear ();
+  m_newFlows.clear ();
+  m_oldFlows.clear ();
+  m_throttled.clear ();
+  QueueDisc::DoDispose ();
+}
+
+uint32_t
+FqPacingQueueDisc::GetNThrottledFlows (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_throttled.size ();
+}
+
+uint32_t
+FqPacingQueueDisc::GetNFlows (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_flowIndex.size ();
+}
+
+uint32_t
+FqPacingQueueDisc::FlowIndex (Ptr<const QueueDiscItem> item, Time now)
+{
+  uint32_t hash = item->Hash (m_perturbation);
+  std::unordered_map<uint32_t, uint32_t>::const_iterator it = m_flowIndex.find (hash);
+  if (it != m_flowIndex.end ())
+    {
+      return it->second;
+    }
+
+  if (m_freeFlows.empty ())
+    {
+      CollectFlows (now);
+    }
+
+  uint32_t index;
+  if (m_freeFlows.empty ())
+    {
+      // every entry is in use, create a new one with its queue
+      FlowState flow;
+      flow.m_queue = CreateObjectWithAttributes<DropTailQueue<QueueDiscItem> >
+          ("MaxSize", QueueSizeValue (GetMaxSize ()));
+      AddInternalQueue (flow.m_queue);
+      index = m_flowTable.size ();
+      m_flowTable.push_back (flow);
+    }
+  else
+    {
+      index = m_freeFlows.back ();
+      m_freeFlows.pop_back ();
+    }
+
+  NS_LOG_LOGIC ("Flow " << index << " allocated to hash " << hash);
+  FlowState &flow = m_flowTable[index];
+  flow.m_hash = hash;
+  flow.m_credit = m_initialQuantum;
+  flow.m_timeNext = Seconds (0);
+  flow.m_status = INACTIVE;
+  m_flowIndex[hash] = index;
+  return index;
+}
+
+void
+FqPacingQueueDisc::CollectFlows (Time now)
+{
+  NS_LOG_FUNCTION (this << now);
+
+  // a flow which may send again keeps no state worth keeping
+  for (uint32_t index = 0; index < m_flowTable.size (); index++)
+    {
+      FlowState &flow = m_flowTable[index];
+      if (flow.m_status == INACTIVE && flow.m_timeNext <= now)
+        {
+          NS_ASSERT (flow.m_queue->IsEmpty ());
+          m_flowIndex.erase (flow.m_hash);
+          flow.m_status = FREE;
+          m_freeFlows.push_back (index);
+        }
+    }
+}
+
+DataRate
+FqPacingQueueDisc::GetPacketRate (Ptr<const QueueDiscItem> item) const
+{
+  DataRate rate = m_rate;
+  SocketPacingRateTag pacingRateTag;
+  if (item->GetPacket ()->PeekPacketTag (pacingRateTag))
+    {
+      rate = pacingRateTag.GetPacingRate ();
+    }
+
+  // as in Linux, the maximum rate also applies to the packets not paced
+  if (m_maxRate.GetBitRate () > 0 && (rate.GetBitRate () == 0 || rate > m_maxRate))
+    {
+      rate = m_maxRate;
+    }
+  return rate;
+}
+
+void
+FqPacingQueueDisc::Unthrottle (Time now)
+{
+  NS_LOG_FUNCTION (this << now);
+
+  while (!m_throttled.empty () && m_throttled.begin ()->first <= now)
+    {
+      uint32_t index = m_throttled.begin ()->second;
+      m_throttled.erase (m_throttled.begin ());
+      NS_LOG_LOGIC ("Flow " << index << " is no longer throttled");
+      m_flowTable[index].m_status = OLD_FLOW;
+      m_oldFlows.push_back (index);
+    }
+}
+
+void
+FqPacingQueueDisc::ScheduleWakeUp (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_throttled.empty ())
+    {
+      return;
+    }
+
+  // a single event wakes the queue disc up for all the throttled flows
+  Time next = m_throttled.begin ()->first;
+  if (m_id.IsRunning () && m_wakeTime <= next)
+    {
+      return;
+    }
+
+  m_id.Cancel ();
+  m_wakeTime = next;
+  m_id = Simulator::Schedule (next - Simulator::Now (), &QueueDisc::Run, this);
+  NS_LOG_LOGIC ("Waking Event Scheduled at " << next);
+}
+
+bool
+FqPacingQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  if (GetCurrentSize () + item > GetMaxSize ())
+    {
+      NS_LOG_LOGIC ("Queue disc limit exceeded -- dropping packet");
+      DropBeforeEnqueue (item, LIMIT_EXCEEDED_DROP);
+      return false;
+    }
+
+  uint32_t index = FlowIndex (item, Simulator::Now ());
+  FlowState &flow = m_flowTable[index];
+
+  if (flow.m_queue->GetNPackets () >= m_flowLimit)
+    {
+      NS_LOG_LOGIC ("Flow limit exceeded -- dropping packet");
+      DropBeforeEnqueue (item, FLOW_LIMIT_DROP);
+      return false;
+    }
+
+  bool retval = flow.m_queue->Enqueue (item);
+
+  // If Queue::Enqueue fails, QueueDisc::DropBeforeEnqueue is called by the
+  // internal queue because QueueDisc::AddInternalQueue sets the trace callback
+
+  if (retval && flow.m_status == INACTIVE)
+    {
+      NS_LOG_LOGIC ("Flow " << index << " becomes active");
+      flow.m_status = NEW_FLOW;
+      flow.m_credit = std::max<int32_t> (flow.m_credit, m_quantum);
+      m_newFlows.push_back (index);
+    }
+
+  NS_LOG_LOGIC ("Number packets flow " << index << ": " << flow.m_queue->GetNPackets ());
+
+  return retval;
+}
+
+Ptr<QueueDiscItem>
+FqPacingQueueDisc::DoDequeue (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Time now = Simulator::Now ();
+  Unthrottle (now);
+
+  while (true)
+    {
+      std::list<uint32_t> *head = &m_newFlows;
+      if (head->empty ())
+        {
+          head = &m_oldFlows;
+        }
+      if (head->empty ())
+        {
+          NS_LOG_LOGIC ("No flow may send");
+          ScheduleWakeUp ();
+          return 0;
+        }
+
+      uint32_t index = head->front ();
+      FlowState &flow = m_flowTable[index];
+
+      if (flow.m_credit <= 0)
+        {
+          flow.m_credit += m_quantum;
+          flow.m_status = OLD_FLOW;
+          head->pop_front ();
+          m_oldFlows.push_back (index);
+          continue;
+        }
+
+      if (flow.m_queue->IsEmpty ())
+        {
+          head->pop_front ();
+          // a new flow which has nothing left to send goes through the old
+          // flows, so that flows can not starve the old ones by going idle
+          if (head == &m_newFlows && !m_oldFlows.empty ())
+            {
+              flow.m_status = OLD_FLOW;
+              m_oldFlows.push_back (index);
+            }
+          else
+            {
+              NS_LOG_LOGIC ("Flow " << index << " becomes inactive");
+              flow.m_status = INACTIVE;
+            }
+          continue;
+        }
+
+      if (flow.m_timeNext > now)
+        {
+          NS_LOG_LOGIC ("Flow " << index << " throttled until " << flow.m_timeNext);
+          head->pop_front ();
+          flow.m_status = THROTTLED;
+          m_throttled.insert (std::make_pair (flow.m_timeNext, index));
+          continue;
+        }
+
+      Ptr<QueueDiscItem> item = flow.m_queue->Dequeue ();
+      flow.m_credit -= item->GetSize ();
+
+      DataRate rate = GetPacketRate (item);
+      if (rate.GetBitRate () > 0)
+        {
+          Time delay = rate.CalculateBytesTxTime (item->GetSize ());
+          // as in Linux, a packet dequeued late shortens the delay of the
+          // next one, by half of the delay at most
+          if (!flow.m_timeNext.IsZero () && now > flow.m_timeNext)
+            {
+              delay -= Min (delay / 2, now - flow.m_timeNext);
+            }
+          flow.m_timeNext = now + delay;
+        }
+
+      // the pacing rate only matters to the first queue disc on the path
+      SocketPacingRateTag pacingRateTag;
+      item->GetPacket ()->RemovePacketTag (pacingRateTag);
+
+      NS_LOG_LOGIC ("Popped from flow " << index << ": " << item);
+      return item;
+    }
+}
+
+bool
+FqPacingQueueDisc::CheckConfig (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (GetNQueueDiscClasses () > 0)
+    {
+      NS_LOG_ERROR ("FqPacingQueueDisc cannot have classes");
+      return false;
+    }
+
+  if (GetNPacketFilters () > 0)
+    {
+      NS_LOG_ERROR ("FqPacingQueueDisc cannot have packet filters");
+      return false;
+    }
+
+  if (GetNInternalQueues () > 0)
+    {
+      NS_LOG_ERROR ("FqPacingQueueDisc cannot have internal queues");
+      return false;
+    }
+
+  return true;
+}
+
+void
+FqPacingQueueDisc::InitializeParams (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_flowTable.clear ();
+  m_flowIndex.clear ();
+  m_freeFlows.clear ();
+  m_newFlows.clear ();
+  m_oldFlows.clear ();
+  m_throttled.clear ();
+  m_wakeTime = Seconds (0);
+  m_id = EventId ();
+}
+
+} // namespace ns3
@@ -0,0 +1,192 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Fair queueing with per-flow pacing, modelled on the Linux sch_fq packet
+ * scheduler.
+ */
+#ifndef FQ_PACING_QUEUE_DISC_H
+#define FQ_PACING_QUEUE_DISC_H
+
+#include "ns3/queue-disc.h"
+#include "ns3/nstime.h"
+#include "ns3/data-rate.h"
+#include "ns3/event-id.h"
+#include <vector>
+#include <list>
+#include <set>
+#include <unordered_map>
+
+namespace ns3 {
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief Fair queueing with per-flow pacing
+ *
+ * Like the Linux sch_fq packet scheduler, this queue disc identifies the
+ * flows by the hash of the 5-tuple of their packets, stores the packets of
+ * every flow in a queue of its own, and serves the flows with a deficit
+ * round robin, the flows which just became active being served first.
+ *
+ * Every flow is released at its pacing rate: the rate carried by the
+ * SocketPacingRateTag of its packets, which TCP sockets with pacing enabled
+ * add, or else the configured rate, in both cases capped by the maximum
+ * rate.  Once a packet is dequeued, the next packet of its flow can not be
+ * dequeued before the transmission time of the packet at this rate has
+ * elapsed.  Flows which have to wait are throttled: they leave the round
+ * robin and are kept sorted by the time of their next packet.  A single
+ * event per queue disc wakes it up when the earliest throttled flow may
+ * send, so that the sockets leaving the pacing to the queue disc (see the
+ * PacingByQueueDisc attribute of TcpSocketState) do not need a pacing timer
+ * of their own.
+ *
+ * The entries of the flow table are allocated to the flows on their first
+ * packet, and reused once the flows have no packet left and may send again.
+ */
+class FqPacingQueueDisc : public QueueDisc
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief FqPacingQueueDisc Constructor
+   *
+   * Create a fair queueing pacing queue disc
+   */
+  FqPacingQueueDisc ();
+
+  /**
+   * \brief Destructor
+   *
+   * Destructor
+   */
+  virtual ~FqPacingQueueDisc ();
+
+  /**
+   * \brief Get the number of flows currently throttled.
+   *
+   * \returns The number of flows waiting for their next packet to be released.
+   */
+  uint32_t GetNThrottledFlows (void) const;
+
+  /**
+   * \brief Get the number of flows having an entry in the flow table.
+   *
+   * \returns The number of flows known to the queue disc.
+   */
+  uint32_t GetNFlows (void) const;
+
+  // Reasons for dropping packets
+  static constexpr const char* LIMIT_EXCEEDED_DROP = "Queue disc limit exceeded";  //!< Packet dropped due to queue disc limit exceeded
+  static constexpr const char* FLOW_LIMIT_DROP = "Flow limit exceeded";            //!< Packet dropped due to flow limit exceeded
+
+protected:
+  /**
+   * \brief Dispose of the object
+   */
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Scheduling state of a flow
+   */
+  enum FlowStatus
+  {
+    FREE,       //!< The entry of the flow table is not allocated to a flow
+    INACTIVE,   //!< The flow has no packet to send
+    NEW_FLOW,   //!< The flow is in the list of new flows
+    OLD_FLOW,   //!< The flow is in the list of old flows
+    THROTTLED   //!< The flow waits for the time of its next packet
+  };
+
+  /**
+   * \brief Per-flow state kept by the flow table
+   */
+  struct FlowState
+  {
+    Ptr<InternalQueue> m_queue;  //!< Queue of the packets of the flow
+    uint32_t m_hash;             //!< Hash identifying the flow
+    int32_t m_credit;            //!< Bytes the flow may send in the current round
+    Time m_timeNext;             //!< Earliest time of the next packet of the flow
+    FlowStatus m_status;         //!< Scheduling state of the flow
+  };
+
+  virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
+  virtual Ptr<QueueDiscItem> DoDequeue (void);
+  virtual bool CheckConfig (void);
+  virtual void InitializeParams (void);
+
+  /**
+   * \brief Classify a packet into the flow table, allocating an entry to
+   *        its flow if needed
+   * \param item the packet
+   * \param now the current time
+   * \return the index of the flow table entry
+   */
+  uint32_t FlowIndex (Ptr<const QueueDiscItem> item, Time now);
+
+  /**
+   * \brief Free the entries of the flows which have no packet left and
+   *        may send again
+   * \param now the current time
+   */
+  void CollectFlows (Time now);
+
+  /**
+   * \brief Get the pacing rate of a packet
+   * \param item the packet
+   * \return the rate, zero if the packet is not paced
+   */
+  DataRate GetPacketRate (Ptr<const QueueDiscItem> item) const;
+
+  /**
+   * \brief Move the throttled flows whose next packet may be sent to the
+   *        list of old flows
+   * \param now the current time
+   */
+  void Unthrottle (Time now);
+
+  /**
+   * \brief Make sure the queue disc is woken up when the earliest throttled
+   *        flow may send, rescheduling the wake up event if it is later
+   */
+  void ScheduleWakeUp (void);
+
+  /* parameters for the fq pacing queue disc */
+  uint32_t m_flowLimit;        //!< Maximum number of packets of a flow
+  uint32_t m_quantum;          //!< Credit given to the flows at every round
+  uint32_t m_initialQuantum;   //!< Credit of the flows when they become active
+  DataRate m_rate;             //!< Pacing rate of the packets without pacing rate tag
+  DataRate m_maxRate;          //!< Maximum pacing rate of the flows
+  uint32_t m_perturbation;     //!< Hash perturbation value
+
+  /* variables stored by the fq pacing queue disc */
+  std::vector<FlowState> m_flowTable;                 //!< Flow table
+  std::unordered_map<uint32_t, uint32_t> m_flowIndex; //!< Flow table entries, by hash of the flows
+  std::vector<uint32_t> m_freeFlows;                  //!< Free flow table entries
+  std::list<uint32_t> m_newFlows;                     //!< Flows which just became active
+  std::list<uint32_t> m_oldFlows;                     //!< Flows served in round robin
+  std::set<std::pair<Time, uint32_t> > m_throttled;   //!< Throttled flows, by time of their next packet
+  EventId m_id;                                       //!< EventId of the scheduled queue waking event
+  Time m_wakeTime;                                    //!< Time of the queue waking event, if scheduled
+};
+
+} // namespace ns3
+
+#endif /* FQ_PACING_QUEUE_DISC_H */
@@ -0,0 +1,383 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Pacer, the end-host packet pacer of HULL (High-bandwidth Ultra-Low Latency)
+ */
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
+#include "ns3/drop-tail-queue.h"
+#include "ns3/net-device-queue-interface.h"
+#include "pacer-queue-disc.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PacerQueueDisc");
+
+NS_OBJECT_ENSURE_REGISTERED (PacerQueueDisc);
+
+TypeId PacerQueueDisc::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PacerQueueDisc")
+    .SetParent<QueueDisc> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<PacerQueueDisc> ()
+    .AddAttribute ("MaxSize",
+                   "The maximum number of packets accepted by this queue disc",
+                   QueueSizeValue (QueueSize ("1000p")),
+                   MakeQueueSizeAccessor (&QueueDisc::SetMaxSize,
+                                          &QueueDisc::GetMaxSize),
+                   MakeQueueSizeChecker ())
+    .AddAttribute ("Rate",
+                   "Initial rate of the token bucket",
+                   DataRateValue (DataRate ("1Gbps")),
+                   MakeDataRateAccessor (&PacerQueueDisc::m_initialRate),
+                   MakeDataRateChecker ())
+    .AddAttribute ("MinRate",
+                   "Lower bound of the token bucket rate when the rate is adapted",
+                   DataRateValue (DataRate ("10Mbps")),
+                   MakeDataRateAccessor (&PacerQueueDisc::m_minRate),
+                   MakeDataRateChecker ())
+    .AddAttribute ("Burst",
+                   "Size of the token bucket in bytes",
+                   UintegerValue (3000),
+                   MakeUintegerAccessor (&PacerQueueDisc::m_burst),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("AdaptiveRate",
+                   "True to adapt the token bucket rate to the rate of the associated flows",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&PacerQueueDisc::m_adaptive),
+                   MakeBooleanChecker ())
+    .AddAttribute ("Eta",
+                   "Weight given to the measured rate of the associated flows",
+                   DoubleValue (0.125),
+                   MakeDoubleAccessor (&PacerQueueDisc::m_eta),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("Beta",
+                   "Weight (in 1/s) given to the backlog of the paced queue",
+                   DoubleValue (16),
+                   MakeDoubleAccessor (&PacerQueueDisc::m_beta),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("UpdateInterval",
+                   "Interval between two updates of the token bucket rate",
+                   TimeValue (MicroSeconds (10)),
+                   MakeTimeAccessor (&PacerQueueDisc::m_updateInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("MeasurementInterval",
+                   "Interval over which the rate of every flow is measured",
+                   TimeValue (MilliSeconds (1)),
+                   MakeTimeAccessor (&PacerQueueDisc::m_measureInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("LargeFlowRate",
+                   "Rate above which a flow is associated with the pacer",
+                   DataRateValue (DataRate ("100Mbps")),
+                   MakeDataRateAccessor (&PacerQueueDisc::m_largeFlowRate),
+                   MakeDataRateChecker ())
+    .AddAttribute ("Flows",
+                   "The number of entries of the flow table",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&PacerQueueDisc::m_flows),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("Perturbation",
+                   "The salt used as an additional input to the hash function used to classify packets",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&PacerQueueDisc::m_perturbation),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddTraceSource ("PacingRate",
+                     "Rate of the token bucket in bps",
+                     MakeTraceSourceAccessor (&PacerQueueDisc::m_rate),
+                     "ns3::TracedValueCallback::Double")
+    .AddTraceSource ("Tokens",
+                     "Number of tokens in the token bucket in bytes",
+                     MakeTraceSourceAccessor (&PacerQueueDisc::m_tokens),
+                     "ns3::TracedValueCallback::Uint32")
+  ;
+  return tid;
+}
+
+PacerQueueDisc::PacerQueueDisc ()
+  : QueueDisc (QueueDiscSizePolicy::MULTIPLE_QUEUES, QueueSizeUnit::PACKETS),
+    m_nAssociated (0),
+    m_pacedArrivals (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PacerQueueDisc::~PacerQueueDisc ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+PacerQueueDisc::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_flowTable.clear ();
+  QueueDisc::DoDispose ();
+}
+
+DataRate
+PacerQueueDisc::GetPacingRate (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return DataRate (static_cast<uint64_t> (m_rate.Get ()));
+}
+
+uint32_t
+PacerQueueDisc::GetNAssociatedFlows (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_nAssociated;
+}
+
+uint32_t
+PacerQueueDisc::FlowIndex (Ptr<const QueueDiscItem> item) const
+{
+  return item->Hash (m_perturbation) % m_flows;
+}
+
+void
+PacerQueueDisc::UpdateAssociation (FlowState &flow, Time now)
+{
+  NS_LOG_FUNCTION (this << now);
+
+  Time elapsed = now - flow.m_windowStart;
+  if (elapsed < m_measureInterval)
+    {
+      return;
+    }
+
+  // the flow is large if it sent more than LargeFlowRate allows over the
+  // last window, which may be longer than one interval if the flow was idle
+  bool large = (flow.m_bytes * 8 > m_largeFlowRate.GetBitRate () * elapsed.GetSeconds ());
+
+  if (large && !flow.m_associated)
+    {
+      NS_LOG_DEBUG ("Associating flow with the pacer");
+      m_nAssociated++;
+    }
+  else if (!large && flow.m_associated)
+    {
+      NS_LOG_DEBUG ("Disassociating flow from the pacer");
+      m_nAssociated--;
+    }
+
+  flow.m_associated = large;
+  flow.m_bytes = 0;
+  flow.m_windowStart = now;
+}
+
+void
+PacerQueueDisc::UpdatePacingRate (Time now)
+{
+  NS_LOG_FUNCTION (this << now);
+
+  if (!m_adaptive || now - m_lastUpdate < m_updateInterval)
+    {
+      return;
+    }
+
+  int64_t nIntervals = (now - m_lastUpdate).GetTimeStep () / m_updateInterval.GetTimeStep ();
+  // the arrivals were counted over all the elapsed intervals, hence they
+  // are spread evenly over them
+  double measured = m_pacedArrivals * 8 / (m_updateInterval * nIntervals).GetSeconds ();
+  double backlog = GetInternalQueue (PACED_QUEUE)->GetNBytes () * 8;
+  double rate = m_rate;
+
+  // after a long idle period the contribution of the old rate vanishes,
+  // hence there is no need to iterate over every elapsed interval
+  for (int64_t i = 0; i < std::min<int64_t> (nIntervals, 64); i++)
+    {
+      rate = (1 - m_eta) * rate + m_eta * measured + m_beta * backlog;
+    }
+
+  m_rate = std::max (rate, static_cast<double> (m_minRate.GetBitRate ()));
+  m_pacedArrivals = 0;
+  m_lastUpdate += m_updateInterval * nIntervals;
+
+  NS_LOG_LOGIC ("Token bucket rate updated to " << m_rate << " bps");
+}
+
+bool
+PacerQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  if (GetCurrentSize () + item > GetMaxSize ())
+    {
+      NS_LOG_LOGIC ("Queue disc limit exceeded -- dropping packet");
+      DropBeforeEnqueue (item, LIMIT_EXCEEDED_DROP);
+      return false;
+    }
+
+  Time now = Simulator::Now ();
+  UpdatePacingRate (now);
+
+  FlowState &flow = m_flowTable[FlowIndex (item)];
+  UpdateAssociation (flow, now);
+  flow.m_bytes += item->GetSize ();
+
+  // packets of a flow that is no longer associated keep going through the
+  // pacer until its backlog is drained, so as to avoid reordering
+  uint32_t band = BYPASS_QUEUE;
+  if (flow.m_associated || flow.m_pacedBacklog > 0)
+    {
+      band = PACED_QUEUE;
+    }
+
+  bool retval = GetInternalQueue (band)->Enqueue (item);
+
+  // If Queue::Enqueue fails, QueueDisc::DropBeforeEnqueue is called by the
+  // internal queue because QueueDisc::AddInternalQueue sets the trace callback
+
+  if (retval && band == PACED_QUEUE)
+    {
+      flow.m_pacedBacklog++;
+      m_pacedArrivals += item->GetSize ();
+    }
+
+  NS_LOG_LOGIC ("Number packets band " << band << ": " << GetInternalQueue (band)->GetNPackets ());
+
+  return retval;
+}
+
+Ptr<QueueDiscItem>
+PacerQueueDisc::DoDequeue (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Time now = Simulator::Now ();
+  UpdatePacingRate (now);
+
+  Ptr<QueueDiscItem> item = GetInternalQueue (BYPASS_QUEUE)->Dequeue ();
+  if (item)
+    {
+      NS_LOG_LOGIC ("Popped from the bypass queue: " << item);
+      return item;
+    }
+
+  Ptr<const QueueDiscItem> itemPeek = GetInternalQueue (PACED_QUEUE)->Peek ();
+  if (!itemPeek)
+    {
+      NS_LOG_LOGIC ("Queue empty");
+      return 0;
+    }
+
+  double delta = (now - m_timeCheckPoint).GetSeconds ();
+  int64_t toks = m_tokens + round (delta * m_rate / 8);
+
+  if (toks > m_burst)
+    {
+      toks = m_burst;
+    }
+  toks -= itemPeek->GetSize ();
+
+  if (toks >= 0)
+    {
+      item = GetInternalQueue (PACED_QUEUE)->Dequeue ();
+      m_timeCheckPoint = now;
+      m_tokens = toks;
+
+      FlowState &flow = m_flowTable[FlowIndex (item)];
+      NS_ASSERT (flow.m_pacedBacklog > 0);
+      flow.m_pacedBacklog--;
+
+      NS_LOG_LOGIC ("Popped from the paced queue: " << item << "; " << m_tokens << " tokens left");
+      return item;
+    }
+
+  // the packet is blocked, wake the queue disc when enough tokens are available
+  if (m_id.IsExpired ())
+    {
+      Time requiredDelayTime = GetPacingRate ().CalculateBytesTxTime (-toks);
+      m_id = Simulator::Schedule (requiredDelayTime, &QueueDisc::Run, this);
+      NS_LOG_LOGIC ("Waking Event Scheduled in " << requiredDelayTime);
+    }
+
+  return 0;
+}
+
+bool
+PacerQueueDisc::CheckConfig (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (GetNQueueDiscClasses () > 0)
+    {
+      NS_LOG_ERROR ("PacerQueueDisc cannot have classes");
+      return false;
+    }
+
+  if (GetNPacketFilters () > 0)
+    {
+      NS_LOG_ERROR ("PacerQueueDisc cannot have packet filters");
+      return false;
+    }
+
+  if (GetNInternalQueues () == 0)
+    {
+      // create a DropTail queue for the bypass band and one for the paced band
+      for (uint8_t i = 0; i < 2; i++)
+        {
+          AddInternalQueue (CreateObjectWithAttributes<DropTailQueue<QueueDiscItem> >
+                            ("MaxSize", QueueSizeValue (GetMaxSize ())));
+        }
+    }
+
+  if (GetNInternalQueues () != 2)
+    {
+      NS_LOG_ERROR ("PacerQueueDisc needs 2 internal queues");
+      return false;
+    }
+
+  Ptr<NetDeviceQueueInterface> ndqi = GetNetDeviceQueueInterface ();
+  Ptr<NetDevice> dev;
+  // if the NetDeviceQueueInterface object is aggregated to a
+  // NetDevice, check that the bucket can hold a packet of MTU size
+  if (ndqi && (dev = ndqi->GetObject<NetDevice> ()) && m_burst < dev->GetMtu ())
+    {
+      NS_LOG_ERROR ("The size of the token bucket (" << m_burst << ") must not be "
+                    << "smaller than the MTU (" << dev->GetMtu () << ")");
+      return false;
+    }
+
+  if (m_initialRate.GetBitRate () == 0)
+    {
+      NS_LOG_ERROR ("The rate of the token bucket must be positive");
+      return false;
+    }
+
+  return true;
+}
+
+void
+PacerQueueDisc::InitializeParams (void)
+{
+  NS_LOG_FUNCTION (this);
+  FlowState init = {Seconds (0), 0, 0, false};
+  m_flowTable.assign (m_flows, init);
+  m_nAssociated = 0;
+  m_pacedArrivals = 0;
+  // the token bucket is full at the beginning
+  m_rate = m_initialRate.GetBitRate ();
+  m_tokens = m_burst;
+  m_lastUpdate = Seconds (0);
+  m_timeCheckPoint = Seconds (0);
+  m_id = EventId ();
+}
+
+} // namespace ns3
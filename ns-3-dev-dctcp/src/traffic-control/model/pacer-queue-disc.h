@@ -0,0 +1,168 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Pacer, the end-host packet pacer of HULL (High-bandwidth Ultra-Low Latency)
+ *
+ * This implementation is based on the hardware pacer described in
+ * M. Alizadeh et al., "Less is More: Trading a little Bandwidth for
+ * Ultra-Low Latency in the Data Center", NSDI 2012.
+ */
+#ifndef PACER_QUEUE_DISC_H
+#define PACER_QUEUE_DISC_H
+
+#include "ns3/queue-disc.h"
+#include "ns3/nstime.h"
+#include "ns3/data-rate.h"
+#include "ns3/traced-value.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/event-id.h"
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief The HULL end-host pacer queue disc
+ *
+ * Incoming packets are hashed into a flow table and the rate of every flow
+ * is measured over a measurement interval. Flows whose rate exceeds the
+ * large flow threshold are associated with the pacer, i.e., their packets
+ * are stored in the paced internal queue and released through a token bucket.
+ * Packets of the other flows are stored in the bypass internal queue, which
+ * is served with strict priority.
+ *
+ * The token bucket rate is periodically adapted as in HULL:
+ * R_tb = (1 - eta) R_tb + eta R_meas + beta Q_tb, where R_meas is the
+ * arrival rate of the associated flows and Q_tb is the backlog of the
+ * paced queue.
+ */
+class PacerQueueDisc : public QueueDisc
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief PacerQueueDisc Constructor
+   *
+   * Create a pacer queue disc
+   */
+  PacerQueueDisc ();
+
+  /**
+   * \brief Destructor
+   *
+   * Destructor
+   */
+  virtual ~PacerQueueDisc ();
+
+  /**
+   * \brief Get the current rate of the token bucket.
+   *
+   * \returns The token bucket rate.
+   */
+  DataRate GetPacingRate (void) const;
+
+  /**
+   * \brief Get the number of flows currently associated with the pacer.
+   *
+   * \returns The number of large flows.
+   */
+  uint32_t GetNAssociatedFlows (void) const;
+
+  // Reasons for dropping packets
+  static constexpr const char* LIMIT_EXCEEDED_DROP = "Queue disc limit exceeded";  //!< Packet dropped due to queue disc limit exceeded
+
+protected:
+  /**
+   * \brief Dispose of the object
+   */
+  virtual void DoDispose (void);
+
+private:
+  /// Index of the internal queue storing the packets of small flows
+  static const uint32_t BYPASS_QUEUE = 0;
+  /// Index of the internal queue storing the packets of associated flows
+  static const uint32_t PACED_QUEUE = 1;
+
+  /**
+   * \brief Per-flow state kept by the flow table
+   */
+  struct FlowState
+  {
+    Time m_windowStart;       //!< Start of the current measurement window
+    uint64_t m_bytes;         //!< Bytes received in the current measurement window
+    uint32_t m_pacedBacklog;  //!< Packets of this flow stored in the paced queue
+    bool m_associated;        //!< Whether the flow is associated with the pacer
+  };
+
+  virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
+  virtual Ptr<QueueDiscItem> DoDequeue (void);
+  virtual bool CheckConfig (void);
+  virtual void InitializeParams (void);
+
+  /**
+   * \brief Classify a packet into the flow table
+   * \param item the packet
+   * \return the index of the flow table entry
+   */
+  uint32_t FlowIndex (Ptr<const QueueDiscItem> item) const;
+
+  /**
+   * \brief Update the flow association based on the rate measured over the
+   *        last measurement window, if such window is over
+   * \param flow the flow table entry
+   * \param now the current time
+   */
+  void UpdateAssociation (FlowState &flow, Time now);
+
+  /**
+   * \brief Adapt the token bucket rate for every update interval elapsed
+   *        since the last update
+   * \param now the current time
+   */
+  void UpdatePacingRate (Time now);
+
+  /* parameters for the pacer queue disc */
+  DataRate m_initialRate;      //!< Initial rate of the token bucket
+  DataRate m_minRate;          //!< Lower bound of the token bucket rate
+  uint32_t m_burst;            //!< Size of the token bucket in bytes
+  bool m_adaptive;             //!< True to adapt the token bucket rate as in HULL
+  double m_eta;                //!< Weight of the measured rate in the rate update
+  double m_beta;               //!< Weight (in 1/s) of the paced backlog in the rate update
+  Time m_updateInterval;       //!< Interval between token bucket rate updates
+  Time m_measureInterval;      //!< Per-flow rate measurement window
+  DataRate m_largeFlowRate;    //!< Rate above which a flow is associated with the pacer
+  uint32_t m_flows;            //!< Number of flow table entries
+  uint32_t m_perturbation;     //!< Hash perturbation value
+
+  /* variables stored by the pacer queue disc */
+  std::vector<FlowState> m_flowTable;  //!< Flow table
+  TracedValue<double> m_rate;          //!< Current token bucket rate in bps
+  TracedValue<uint32_t> m_tokens;      //!< Current number of tokens in bytes
+  uint32_t m_nAssociated;              //!< Number of flows associated with the pacer
+  uint64_t m_pacedArrivals;            //!< Bytes entering the paced queue in the current update interval
+  Time m_lastUpdate;                   //!< Start of the current update interval
+  Time m_timeCheckPoint;               //!< Time of the last token bucket refill
+  EventId m_id;                        //!< EventId of the scheduled queue waking event when enough tokens are available
+};
+
+} // namespace ns3
+
+#endif /* PACER_QUEUE_DISC_H */
@@ -0,0 +1,168 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/trace-source-accessor.h"
+#include "phantom-queue.h"
+#include <limits>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PhantomQueue");
+
+NS_OBJECT_ENSURE_REGISTERED (PhantomQueue);
+
+TypeId PhantomQueue::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PhantomQueue")
+    .SetParent<Object> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<PhantomQueue> ()
+    .AddAttribute ("DrainRate",
+                   "The rate at which the phantom queue is drained",
+                   DataRateValue (DataRate ("1425kbps")),
+                   MakeDataRateAccessor (&PhantomQueue::SetDrainRate,
+                                         &PhantomQueue::GetDrainRate),
+                   MakeDataRateChecker ())
+    .AddAttribute ("MarkingThreshold",
+                   "The occupancy (in bytes) above which packets are marked",
+                   UintegerValue (6000),
+                   MakeUintegerAccessor (&PhantomQueue::SetMarkingThreshold,
+                                         &PhantomQueue::GetMarkingThreshold),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddTraceSource ("VirtualQueue",
+                     "Occupancy of the phantom queue in bytes",
+                     MakeTraceSourceAccessor (&PhantomQueue::m_vq),
+                     "ns3::TracedValueCallback::Uint32")
+  ;
+  return tid;
+}
+
+PhantomQueue::PhantomQueue ()
+  : m_vq (0),
+    m_residue (0),
+    m_lastUpdate (0),
+    m_nPorts (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PhantomQueue::~PhantomQueue ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+PhantomQueue::SetDrainRate (DataRate rate)
+{
+  NS_LOG_FUNCTION (this << rate);
+  // drain at the old rate up to now, so that the new rate only applies from now on
+  Drain (Simulator::Now ().GetNanoSeconds ());
+  m_drainRate = rate;
+}
+
+DataRate
+PhantomQueue::GetDrainRate (void) const
+{
+  return m_drainRate;
+}
+
+void
+PhantomQueue::SetMarkingThreshold (uint32_t threshold)
+{
+  NS_LOG_FUNCTION (this << threshold);
+  m_threshold = threshold;
+}
+
+uint32_t
+PhantomQueue::GetMarkingThreshold (void) const
+{
+  return m_threshold;
+}
+
+void
+PhantomQueue::Attach (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_nPorts++;
+}
+
+uint32_t
+PhantomQueue::GetNPorts (void) const
+{
+  return m_nPorts;
+}
+
+void
+PhantomQueue::Drain (int64_t now)
+{
+  if (now <= m_lastUpdate)
+    {
+      return;
+    }
+
+  uint64_t elapsed = now - m_lastUpdate;
+  uint64_t rate = m_drainRate.GetBitRate ();
+  m_lastUpdate = now;
+
+  if (m_vq.Get () == 0 || rate == 0)
+    {
+      m_residue = 0;
+      return;
+    }
+
+  // bit-nanoseconds still needed to empty the phantom queue. Checking this
+  // first also bounds elapsed * rate, which hence cannot overflow
+  uint64_t needed = m_vq * DataRate::BIT_NS_PER_BYTE - m_residue;
+  if (elapsed >= (needed + rate - 1) / rate)
+    {
+      m_vq = 0;
+      m_residue = 0;
+      return;
+    }
+
+  uint64_t credit = elapsed * rate + m_residue;
+  m_vq -= credit / DataRate::BIT_NS_PER_BYTE;
+  m_residue = credit % DataRate::BIT_NS_PER_BYTE;
+}
+
+bool
+PhantomQueue::Enqueue (uint32_t bytes)
+{
+  NS_LOG_FUNCTION (this << bytes);
+
+  Drain (Simulator::Now ().GetNanoSeconds ());
+
+  // saturate rather than wrap around; such an occupancy is meaningless anyway
+  uint32_t maxVq = std::numeric_limits<int32_t>::max ();
+  uint32_t vq = m_vq;
+  m_vq = (bytes > maxVq - vq ? maxVq : vq + bytes);
+
+  NS_LOG_LOGIC ("Phantom queue occupancy " << m_vq << " bytes");
+  return m_vq > m_threshold;
+}
+
+uint32_t
+PhantomQueue::GetOccupancy (void)
+{
+  NS_LOG_FUNCTION (this);
+  Drain (Simulator::Now ().GetNanoSeconds ());
+  return m_vq;
+}
+
+} // namespace ns3
@@ -0,0 +1,131 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PHANTOM_QUEUE_H
+#define PHANTOM_QUEUE_H
+
+#include "ns3/object.h"
+#include "ns3/data-rate.h"
+#include "ns3/traced-value.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief The virtual queue (phantom queue) of HULL
+ *
+ * A phantom queue is a counter that is incremented by the size of every packet
+ * sent on the ports it is attached to and is drained at a rate lower than the
+ * link capacity. A single phantom queue can be attached to multiple ports
+ * (i.e., multiple PhantomQueueDisc instances), thus modelling a phantom queue
+ * associated with a shared buffer.
+ *
+ * The occupancy is drained lazily, only when a packet arrives or the occupancy
+ * is read, hence no event is ever scheduled. Draining uses integer arithmetic
+ * on nanoseconds and bits: the fraction of byte not yet drained is carried
+ * over to the next update, so that no error accumulates over time.
+ */
+class PhantomQueue : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief PhantomQueue Constructor
+   */
+  PhantomQueue ();
+
+  virtual ~PhantomQueue ();
+
+  /**
+   * \brief Set the drain rate of the phantom queue.
+   *
+   * \param rate The drain rate.
+   */
+  void SetDrainRate (DataRate rate);
+
+  /**
+   * \brief Get the drain rate of the phantom queue.
+   *
+   * \returns The drain rate.
+   */
+  DataRate GetDrainRate (void) const;
+
+  /**
+   * \brief Set the occupancy above which packets are marked.
+   *
+   * \param threshold The marking threshold in bytes.
+   */
+  void SetMarkingThreshold (uint32_t threshold);
+
+  /**
+   * \brief Get the occupancy above which packets are marked.
+   *
+   * \returns The marking threshold in bytes.
+   */
+  uint32_t GetMarkingThreshold (void) const;
+
+  /**
+   * \brief Account for a packet sent on one of the attached ports.
+   *
+   * \param bytes The size of the packet in bytes.
+   * \returns True if the packet has to be marked.
+   */
+  bool Enqueue (uint32_t bytes);
+
+  /**
+   * \brief Get the current occupancy of the phantom queue.
+   *
+   * \returns The occupancy in bytes, drained up to the current time.
+   */
+  uint32_t GetOccupancy (void);
+
+  /**
+   * \brief Notify that a port has been attached to this phantom queue.
+   */
+  void Attach (void);
+
+  /**
+   * \brief Get the number of ports attached to this phantom queue.
+   *
+   * \returns The number of attached ports.
+   */
+  uint32_t GetNPorts (void) const;
+
+private:
+  /**
+   * \brief Drain the phantom queue up to the given time.
+   *
+   * \param now The current time in nanoseconds.
+   */
+  void Drain (int64_t now);
+
+  DataRate m_drainRate;          //!< Drain rate
+  uint32_t m_threshold;          //!< Marking threshold in bytes
+  TracedValue<uint32_t> m_vq;    //!< Occupancy in bytes
+  uint64_t m_residue;            //!< Bit-nanoseconds drained but not yet worth a byte
+  int64_t m_lastUpdate;          //!< Time of the last drain in nanoseconds
+  uint32_t m_nPorts;             //!< Number of attached ports
+};
+
+} // namespace ns3
+
+#endif /* PHANTOM_QUEUE_H */
@@ -1,8 +1,10 @@
 #include "ns3/log.h"
 #include "ns3/enum.h"
 #include "ns3/uinteger.h"
+#include "ns3/boolean.h"
 #include "ns3/double.h"
 #include "ns3/simulator.h"
+#include "ns3/pointer.h"
 #include "ns3/abort.h"
 #include "pq-queue-disc.h"
 #include "ns3/drop-tail-queue.h"
@@ -26,7 +28,7 @@ TypeId PhantomQueueDisc::GetTypeId (void)
                                           &QueueDisc::GetMaxSize),
                    MakeQueueSizeChecker ())
     .AddAttribute ("LinkBandwidth", 
-                   "The PQ link bandwidth",
+                   "The PQ link bandwidth. Ignored if PhantomQueue is set",
                    DataRateValue (DataRate ("1.5Mbps")),
                    MakeDataRateAccessor (&PhantomQueueDisc::m_linkBandwidth),
                    MakeDataRateChecker ())
@@ -36,15 +38,53 @@ TypeId PhantomQueueDisc::GetTypeId (void)
                    MakeTimeAccessor (&PhantomQueueDisc::m_linkDelay),
                    MakeTimeChecker ())
     .AddAttribute ("DrainRateFraction",
-                   "fraction of total bandwidth set as drain rate",
+                   "fraction of total bandwidth set as drain rate. Ignored if PhantomQueue is set",
                    DoubleValue (0.95),
                    MakeDoubleAccessor (&PhantomQueueDisc::m_drain_rate_fraction),
                    MakeDoubleChecker<double> ())
     .AddAttribute ("MarkingthreShold",
-                   "Marking threshold of phantom Queue",
+                   "Marking threshold of phantom Queue. Ignored if PhantomQueue is set",
                    DoubleValue (6000),
                    MakeDoubleAccessor (&PhantomQueueDisc::m_marking_threshold),
                    MakeDoubleChecker<double> ())
+    .AddAttribute ("MarkingMode",
+                   "Whether packets are marked based on the phantom queue, "
+                   "on the instantaneous occupancy of the real queue or on "
+                   "their sojourn time in the real queue",
+                   EnumValue (PHANTOM_QUEUE_MARKING),
+                   MakeEnumAccessor (&PhantomQueueDisc::m_markingMode),
+                   MakeEnumChecker (PHANTOM_QUEUE_MARKING, "PhantomQueue",
+                                    INSTANTANEOUS_QUEUE_MARKING, "InstantaneousQueue",
+                                    SOJOURN_TIME_MARKING, "SojournTime"))
+    .AddAttribute ("MarkOnDequeue",
+                   "True to take the marking decisions in PhantomQueue and "
+                   "InstantaneousQueue marking modes when packets are dequeued, "
+                   "rather than when they are enqueued",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PhantomQueueDisc::m_markOnDequeue),
+                   MakeBooleanChecker ())
+    .AddAttribute ("SojournMarkingThreshold",
+                   "Sojourn time above which packets are marked at dequeue "
+                   "in SojournTime marking mode",
+                   TimeValue (MicroSeconds (10)),
+                   MakeTimeAccessor (&PhantomQueueDisc::m_sojournMarkingThreshold),
+                   MakeTimeChecker ())
+    .AddAttribute ("QueueMarkingThreshold",
+                   "Occupancy of the real queue above which packets are marked "
+                   "in InstantaneousQueue marking mode",
+                   QueueSizeValue (QueueSize ("20p")),
+                   MakeQueueSizeAccessor (&PhantomQueueDisc::m_queueMarkingThreshold),
+                   MakeQueueSizeChecker ())
+    .AddAttribute ("PhantomQueue",
+                   "The phantom queue this port is attached to. It may be shared by "
+                   "multiple ports. If null, a phantom queue draining at "
+                   "DrainRateFraction times LinkBandwidth is created. Otherwise, the "
+                   "DrainRateFraction, LinkBandwidth and MarkingthreShold attributes "
+                   "are ignored, and a warning is logged if they differ from the "
+                   "settings of the phantom queue",
+                   PointerValue (),
+                   MakePointerAccessor (&PhantomQueueDisc::m_phantomQueue),
+                   MakePointerChecker<PhantomQueue> ())
       ;
   return tid;
 }
@@ -64,41 +104,51 @@ void
 PhantomQueueDisc::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  m_phantomQueue = 0;
   QueueDisc::DoDispose ();
 }
 
+Ptr<PhantomQueue>
+PhantomQueueDisc::GetPhantomQueue (void) const
+{
+  return m_phantomQueue;
+}
+
 
 
 bool
 PhantomQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
 {
   NS_LOG_FUNCTION (this << item);
-  uint32_t nQueued = GetInternalQueue (0)->GetCurrentSize ().GetValue ();
 
-  if(item->GetSize()+nQueued>GetInternalQueue (0)->GetMaxSize().GetValue())
+  // the occupancy and the limit are both expressed in the unit of MaxSize,
+  // hence admission is either packet-accurate or byte-accurate
+  if (GetCurrentSize () + item > GetMaxSize ())
   {
     DropBeforeEnqueue (item, FORCED_DROP);
     return false;
   }
 
-  Time now=Simulator::Now();
-
-  m_vq=m_vq-((now-m_lastSet).GetSeconds()*m_drain_rate.GetBitRate()/8);
-
-  if(m_vq<0)
+  bool mark = false;
+  if (m_markingMode == INSTANTANEOUS_QUEUE_MARKING)
   {
-    m_vq=0;
+    // compare the occupancy seen by the arriving packet in the unit of the threshold
+    uint32_t occupancy = (m_queueMarkingThreshold.GetUnit () == QueueSizeUnit::PACKETS
+                          ? GetInternalQueue (0)->GetNPackets ()
+                          : GetInternalQueue (0)->GetNBytes ());
+    mark = (occupancy > m_queueMarkingThreshold.GetValue ());
+  }
+  else if (m_markingMode == PHANTOM_QUEUE_MARKING)
+  {
+    // the phantom queue accounts for the arrivals whenever the decision is taken
+    mark = m_phantomQueue->Enqueue (item->GetSize ());
   }
 
-  m_vq+=item->GetSize();
-
-  if(m_vq>m_marking_threshold)
+  if (mark && !m_markOnDequeue)
   {
     Mark (item, FORCED_MARK);
   }
 
-  m_lastSet=now;
-
   bool retval = GetInternalQueue (0)->Enqueue (item);
   NS_LOG_LOGIC ("Number packets " << GetInternalQueue (0)->GetNPackets ());
   NS_LOG_LOGIC ("Number bytes " << GetInternalQueue (0)->GetNBytes ());
@@ -112,16 +162,37 @@ PhantomQueueDisc::InitializeParams (void)
 {
   NS_LOG_FUNCTION (this);
   NS_LOG_INFO ("Initializing PQ params.");
-  m_drain_rate=m_linkBandwidth.GetBitRate()*(m_drain_rate_fraction);
-  //m_marking_threshold=6000;
-  m_vq=0;
-  m_lastSet=Simulator::Now ();
+  DataRate drainRate (m_linkBandwidth.GetBitRate () * m_drain_rate_fraction);
+  if (!m_phantomQueue)
+  {
+    m_phantomQueue = CreateObject<PhantomQueue> ();
+    m_phantomQueue->SetDrainRate (drainRate);
+    m_phantomQueue->SetMarkingThreshold (m_marking_threshold);
+  }
+  else
+  {
+    // the settings of a shared phantom queue are those of its creator
+    if (m_phantomQueue->GetDrainRate () != drainRate)
+      {
+        NS_LOG_WARN ("The drain rate of the phantom queue (" << m_phantomQueue->GetDrainRate ()
+                     << ") differs from DrainRateFraction times LinkBandwidth (" << drainRate
+                     << "), which are ignored");
+      }
+    if (m_phantomQueue->GetMarkingThreshold () != static_cast<uint32_t> (m_marking_threshold))
+      {
+        NS_LOG_WARN ("The marking threshold of the phantom queue (" << m_phantomQueue->GetMarkingThreshold ()
+                     << ") differs from MarkingthreShold (" << m_marking_threshold
+                     << "), which is ignored");
+      }
+  }
+  m_phantomQueue->Attach ();
   m_idle = 1;
   m_idleTime = NanoSeconds (0);
   NS_LOG_DEBUG ("\tm_delay " << m_linkDelay.GetSeconds () 
-                             << "; vq " << m_vq
-                             <<"; marking_thresh "<<m_marking_threshold
-                             <<"; drain_rate"<< m_drain_rate<<std::endl);
+                             << "; vq " << m_phantomQueue->GetOccupancy ()
+                             <<"; marking_thresh "<<m_phantomQueue->GetMarkingThreshold ()
+                             <<"; drain_rate"<< m_phantomQueue->GetDrainRate ()
+                             <<"; ports "<< m_phantomQueue->GetNPorts ()<<std::endl);
 }
 
 
@@ -142,12 +213,42 @@ PhantomQueueDisc::DoDequeue (void)
       m_idle = 0;
       Ptr<QueueDiscItem> item = GetInternalQueue (0)->Dequeue ();
       NS_LOG_LOGIC ("Popped " << item);
+      if (CheckDequeueMark (item))
+        {
+          Mark (item, DEQUEUE_MARK);
+        }
       NS_LOG_LOGIC ("Number packets " << GetInternalQueue (0)->GetNPackets ());
       NS_LOG_LOGIC ("Number bytes " << GetInternalQueue (0)->GetNBytes ());
       return item;
     }
 }
 
+bool
+PhantomQueueDisc::CheckDequeueMark (Ptr<const QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  // the signal given at dequeue reflects the state of the queue when the
+  // packet leaves it, rather than when it arrived
+  if (m_markingMode == SOJOURN_TIME_MARKING)
+    {
+      return (Simulator::Now () - item->GetTimeStamp () > m_sojournMarkingThreshold);
+    }
+  if (!m_markOnDequeue)
+    {
+      return false;
+    }
+  if (m_markingMode == INSTANTANEOUS_QUEUE_MARKING)
+    {
+      // the occupancy left behind the departing packet
+      uint32_t occupancy = (m_queueMarkingThreshold.GetUnit () == QueueSizeUnit::PACKETS
+                            ? GetInternalQueue (0)->GetNPackets ()
+                            : GetInternalQueue (0)->GetNBytes ());
+      return (occupancy > m_queueMarkingThreshold.GetValue ());
+    }
+  return (m_phantomQueue->GetOccupancy () > m_phantomQueue->GetMarkingThreshold ());
+}
+
 Ptr<const QueueDiscItem>
 PhantomQueueDisc::DoPeek (void)
 {
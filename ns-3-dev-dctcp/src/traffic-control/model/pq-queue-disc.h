@@ -58,14 +58,15 @@
  * [0] S.Floyd, K.Fall http://icir.org/floyd/papers/redsims.ps
  */
 
-#ifndef RED_QUEUE_DISC_H
-#define RED_QUEUE_DISC_H
+#ifndef PQ_QUEUE_DISC_H
+#define PQ_QUEUE_DISC_H
 
 #include "ns3/queue-disc.h"
 #include "ns3/nstime.h"
 #include "ns3/boolean.h"
 #include "ns3/data-rate.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/phantom-queue.h"
 
 namespace ns3 {
 
@@ -98,6 +99,16 @@ public:
    */ 
   virtual ~PhantomQueueDisc ();
 
+  /**
+   * \brief Marking modes
+   */
+  enum MarkingMode
+  {
+    PHANTOM_QUEUE_MARKING,       //!< Mark when the phantom queue exceeds MarkingthreShold
+    INSTANTANEOUS_QUEUE_MARKING, //!< Mark when the real queue exceeds QueueMarkingThreshold, as DCTCP does
+    SOJOURN_TIME_MARKING,        //!< Mark at dequeue when the sojourn time exceeds SojournMarkingThreshold
+  };
+
   /** 
    * \brief Drop types
    */
@@ -119,12 +130,20 @@ public:
   */
   int64_t AssignStreams (int64_t stream);
 
+  /**
+   * \brief Get the phantom queue this queue disc is attached to
+   *
+   * \return the phantom queue
+   */
+  Ptr<PhantomQueue> GetPhantomQueue (void) const;
+
   // Reasons for dropping packets
   static constexpr const char* UNFORCED_DROP = "Unforced drop";  //!< Early probability drops
   static constexpr const char* FORCED_DROP = "Forced drop";      //!< Forced drops, m_qAvg > m_maxTh
   // Reasons for marking packets
   static constexpr const char* UNFORCED_MARK = "Unforced mark";  //!< Early probability marks
   static constexpr const char* FORCED_MARK = "Forced mark";      //!< Forced marks, m_qAvg > m_maxTh
+  static constexpr const char* DEQUEUE_MARK = "Dequeue mark";    //!< Marks decided at dequeue
 
 protected:
   /**
@@ -148,14 +167,22 @@ private:
    */
   virtual void InitializeParams (void);
 
+  /**
+   * \brief Check whether a packet leaving the queue disc has to be marked
+   * \param item the packet
+   * \return true if the packet has to be marked
+   */
+  bool CheckDequeueMark (Ptr<const QueueDiscItem> item);
+
 
- 
   // ** Phantom Queue
   double m_drain_rate_fraction;
-  DataRate m_drain_rate;
   double m_marking_threshold;
-  double m_vq;
-  Time m_lastSet;           //!< Last time m_curMaxP was updated
+  MarkingMode m_markingMode;             //!< Marking mode
+  QueueSize m_queueMarkingThreshold;     //!< Marking threshold of the real queue
+  bool m_markOnDequeue;                  //!< True if the marking decisions are taken at dequeue
+  Time m_sojournMarkingThreshold;        //!< Sojourn time above which packets are marked
+  Ptr<PhantomQueue> m_phantomQueue; //!< Phantom queue, possibly shared with other ports
   DataRate m_linkBandwidth; //!< Link bandwidth
   Time m_linkDelay;         //!< Link delay
   uint32_t m_idle;          //!< 0/1 idle status
@@ -164,4 +191,4 @@ private:
 
 }; // namespace ns3
 
-#endif // RED_QUEUE_DISC_H
+#endif // PQ_QUEUE_DISC_H
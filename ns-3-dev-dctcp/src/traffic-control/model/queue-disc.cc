@@ -383,6 +383,7 @@ QueueDisc::DoDispose (void)
   m_classes.clear ();
   m_devQueueIface = 0;
   m_send = nullptr;
+  m_sendBurst = nullptr;
   m_requeued = 0;
   m_internalQueueDbeFunctor = nullptr;
   m_internalQueueDadFunctor = nullptr;
@@ -558,6 +559,20 @@ QueueDisc::GetSendCallback (void) const
   return m_send;
 }
 
+void
+QueueDisc::SetSendBurstCallback (SendBurstCallback func)
+{
+  NS_LOG_FUNCTION (this);
+  m_sendBurst = func;
+}
+
+QueueDisc::SendBurstCallback
+QueueDisc::GetSendBurstCallback (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_sendBurst;
+}
+
 void
 QueueDisc::SetQuota (const uint32_t quota)
 {
@@ -951,9 +966,10 @@ QueueDisc::Run (void)
   if (RunBegin ())
     {
       uint32_t quota = m_quota;
-      while (Restart ())
+      uint32_t nPackets;
+      while (Restart (quota, nPackets))
         {
-          quota -= 1;
+          quota -= nPackets;
           if (quota <= 0)
             {
               /// \todo netif_schedule (q);
@@ -985,16 +1001,25 @@ QueueDisc::RunEnd (void)
 }
 
 bool
-QueueDisc::Restart (void)
+QueueDisc::Restart (uint32_t quota, uint32_t &nPackets)
 {
-  NS_LOG_FUNCTION (this);
+  NS_LOG_FUNCTION (this << quota);
+  // As in Linux, requeued packets are sent alone
+  bool requeued = (m_requeued != 0);
   Ptr<QueueDiscItem> item = DequeuePacket();
+  nPackets = 0;
   if (item == 0)
     {
       NS_LOG_LOGIC ("No packet to send");
       return false;
     }
 
+  if (!requeued && m_sendBurst && m_devQueueIface && m_devQueueIface->GetNTxQueues () == 1)
+    {
+      return TransmitBurst (item, quota, nPackets);
+    }
+
+  nPackets = 1;
   return Transmit (item);
 }
 
@@ -1110,4 +1135,56 @@ QueueDisc::Transmit (Ptr<QueueDiscItem> item)
   return true;
 }
 
+bool
+QueueDisc::TransmitBurst (Ptr<QueueDiscItem> item, uint32_t quota, uint32_t &nPackets)
+{
+  NS_LOG_FUNCTION (this << item << quota);
+
+  // The device queue is not stopped, as DequeuePacket checked it.  The burst
+  // must fit in the device queue, which is only checked once the whole burst
+  // is enqueued, and may exceed the queue limits by one packet at most, as
+  // when packets are sent one at a time
+  Ptr<NetDeviceQueue> txq = m_devQueueIface->GetTxQueue (0);
+  uint32_t maxPackets = std::min (quota, txq->GetAvailablePackets ());
+  if (maxPackets <= 1)
+    {
+      nPackets = 1;
+      return Transmit (item);
+    }
+
+  int32_t bytes = txq->GetAvailableBytes () - static_cast<int32_t> (item->GetSize ());
+  m_burst.clear ();
+  m_burst.push_back (item);
+  while (bytes >= 0 && m_burst.size () < maxPackets)
+    {
+      Ptr<QueueDiscItem> next = Dequeue ();
+      if (next == 0)
+        {
+          break;
+        }
+      next->AddHeader ();
+      bytes -= next->GetSize ();
+      m_burst.push_back (next);
+    }
+  nPackets = m_burst.size ();
+  NS_LOG_LOGIC ("Sending a burst of " << nPackets << " packets");
+
+  // a single queue device makes no use of the priority tag
+  SocketPriorityTag priorityTag;
+  for (std::vector<Ptr<QueueDiscItem> >::iterator it = m_burst.begin (); it != m_burst.end (); ++it)
+    {
+      (*it)->GetPacket ()->RemovePacketTag (priorityTag);
+    }
+  m_sendBurst (m_burst);
+  m_burst.clear ();
+
+  // as in Transmit, the packets sent to the netdevice are never requeued
+  if (GetNPackets () == 0 || txq->IsStopped ())
+    {
+      return false;
+    }
+
+  return true;
+}
+
 } // namespace ns3
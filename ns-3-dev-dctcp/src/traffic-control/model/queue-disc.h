@@ -372,6 +372,26 @@ public:
    */
   SendCallback GetSendCallback (void) const;
 
+  /// Callback invoked to send a burst of packets to the receiving object when Run is called
+  typedef std::function<void (const std::vector<Ptr<QueueDiscItem> > &)> SendBurstCallback;
+
+  /**
+   * \param func the callback to send a burst of packets to the receiving object.
+   *
+   * Set the callback used by the TransmitBurst method (called eventually by the
+   * Run method) to send a burst of packets to the receiving object.  If no such
+   * callback is set, packets are sent one at a time.
+   */
+  void SetSendBurstCallback (SendBurstCallback func);
+
+  /**
+   * \return the callback to send a burst of packets to the receiving object.
+   *
+   * Get the callback used by the TransmitBurst method (called eventually by the
+   * Run method) to send a burst of packets to the receiving object.
+   */
+  SendBurstCallback GetSendBurstCallback (void) const;
+
   /**
    * \brief Set the maximum number of dequeue operations following a packet enqueue
    * \param quota the maximum number of dequeue operations following a packet enqueue.
@@ -639,10 +659,13 @@ private:
 
   /**
    * Modelled after the Linux function qdisc_restart (net/sched/sch_generic.c)
-   * Dequeue a packet (by calling DequeuePacket) and send it to the device (by calling Transmit).
-   * \return true if a packet is successfully sent to the device.
+   * Dequeue a packet (by calling DequeuePacket) and send it to the device (by calling
+   * Transmit), or a burst of packets (by calling TransmitBurst).
+   * \param quota the maximum number of packets to send
+   * \param nPackets set to the number of packets sent
+   * \return true if the packets are successfully sent to the device.
    */
-  bool Restart (void);
+  bool Restart (uint32_t quota, uint32_t &nPackets);
 
   /**
    * Modelled after the Linux function dequeue_skb (net/sched/sch_generic.c)
@@ -666,6 +689,19 @@ private:
    */
   bool Transmit (Ptr<QueueDiscItem> item);
 
+  /**
+   * Modelled after the Linux functions try_bulk_dequeue_skb and sch_direct_xmit
+   * (net/sched/sch_generic.c)
+   * Dequeues the packets which may follow the given one in a burst, as allowed by
+   * the room in the device queue and by its queue limits, and sends all of them
+   * to the device in a single call.
+   * \param item the first packet of the burst
+   * \param quota the maximum number of packets in the burst
+   * \param nPackets set to the number of packets sent
+   * \return true if the device queue is not stopped and the queue disc is not empty
+   */
+  bool TransmitBurst (Ptr<QueueDiscItem> item, uint32_t quota, uint32_t &nPackets);
+
   /**
    *  \brief Perform the actions required when the queue disc is notified of
    *         a packet enqueue
@@ -695,6 +731,8 @@ private:
   uint32_t m_quota;                 //!< Maximum number of packets dequeued in a qdisc run
   Ptr<NetDeviceQueueInterface> m_devQueueIface;   //!< NetDevice queue interface
   SendCallback m_send;              //!< Callback used to send a packet to the receiving object
+  SendBurstCallback m_sendBurst;    //!< Callback used to send a burst of packets to the receiving object
+  std::vector<Ptr<QueueDiscItem> > m_burst;  //!< Packets of the burst being sent
   bool m_running;                   //!< The queue disc is performing multiple dequeue operations
   Ptr<QueueDiscItem> m_requeued;    //!< The last packet that failed to be transmitted
   bool m_peeked;                    //!< A packet was dequeued because Peek was called
@@ -218,6 +218,17 @@ TypeId RedQueueDisc::GetTypeId (void)
                    BooleanValue (true),
                    MakeBooleanAccessor (&RedQueueDisc::m_useHardDrop),
                    MakeBooleanChecker ())
+    .AddAttribute ("MarkOnDequeue",
+                   "True to mark packets at dequeue, when their sojourn time exceeds "
+                   "SojournMarkingThreshold, rather than at enqueue (requires UseEcn)",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RedQueueDisc::m_markOnDequeue),
+                   MakeBooleanChecker ())
+    .AddAttribute ("SojournMarkingThreshold",
+                   "Sojourn time above which packets are marked at dequeue in MarkOnDequeue mode",
+                   TimeValue (MilliSeconds (1)),
+                   MakeTimeAccessor (&RedQueueDisc::m_sojournMarkingThreshold),
+                   MakeTimeChecker ())
   ;
 
   return tid;
@@ -408,7 +419,7 @@ RedQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
 
   if (dropType == DTYPE_UNFORCED)
     {
-      if (!m_useEcn || !Mark (item, UNFORCED_MARK))
+      if (!m_useEcn || !EnqueueMark (item, UNFORCED_MARK))
         {
           NS_LOG_DEBUG ("\t Dropping due to Prob Mark " << m_qAvg);
           DropBeforeEnqueue (item, UNFORCED_DROP);
@@ -418,7 +429,7 @@ RedQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
     }
   else if (dropType == DTYPE_FORCED)
     {
-      if (m_useHardDrop || !m_useEcn || !Mark (item, FORCED_MARK))
+      if (m_useHardDrop || !m_useEcn || !EnqueueMark (item, FORCED_MARK))
         {
           NS_LOG_DEBUG ("\t Dropping due to Hard Mark " << m_qAvg);
           DropBeforeEnqueue (item, FORCED_DROP);
@@ -807,6 +818,27 @@ RedQueueDisc::ModifyP (double p, uint32_t size)
   return p;
 }
 
+bool
+RedQueueDisc::EnqueueMark (Ptr<QueueDiscItem> item, const char* reason)
+{
+  NS_LOG_FUNCTION (this << item << reason);
+  if (!m_markOnDequeue)
+    {
+      return Mark (item, reason);
+    }
+
+  // The congestion signal is given at dequeue, from the sojourn time of the
+  // packet, so the packets which can be marked are admitted unmarked.  The
+  // others, including those whose DS field cannot be read, are dropped, as
+  // they would be if marked at enqueue.
+  uint8_t tos;
+  if (!item->GetUint8Value (QueueItem::IP_DSFIELD, tos))
+    {
+      return false;
+    }
+  return (tos & 0x3) != 0;
+}
+
 Ptr<QueueDiscItem>
 RedQueueDisc::DoDequeue (void)
 {
@@ -827,6 +859,15 @@ RedQueueDisc::DoDequeue (void)
 
       NS_LOG_LOGIC ("Popped " << item);
 
+      if (m_markOnDequeue)
+        {
+          Time sojourn = Simulator::Now () - item->GetTimeStamp ();
+          if (sojourn > m_sojournMarkingThreshold && Mark (item, DEQUEUE_MARK))
+            {
+              NS_LOG_DEBUG ("\t Marking due to sojourn time " << sojourn);
+            }
+        }
+
       NS_LOG_LOGIC ("Number packets " << GetInternalQueue (0)->GetNPackets ());
       NS_LOG_LOGIC ("Number bytes " << GetInternalQueue (0)->GetNBytes ());
 
@@ -886,6 +927,12 @@ RedQueueDisc::CheckConfig (void)
       NS_LOG_ERROR ("m_isAdaptMaxP and m_isFengAdaptive cannot be simultaneously true");
     }
 
+  if (m_markOnDequeue && !m_useEcn)
+    {
+      NS_LOG_ERROR ("Marking on dequeue requires ECN to be enabled");
+      return false;
+    }
+
   return true;
 }
 
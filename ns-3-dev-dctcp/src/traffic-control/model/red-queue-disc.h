@@ -198,6 +198,7 @@ public:
   // Reasons for marking packets
   static constexpr const char* UNFORCED_MARK = "Unforced mark";  //!< Early probability marks
   static constexpr const char* FORCED_MARK = "Forced mark";      //!< Forced marks, m_qAvg > m_maxTh
+  static constexpr const char* DEQUEUE_MARK = "Dequeue mark";    //!< Marks at dequeue, sojourn time > threshold
 
 protected:
   /**
@@ -258,6 +259,14 @@ private:
    * \returns Prob. of packet drop
    */
   double ModifyP (double p, uint32_t size);
+  /**
+   * \brief Apply the mark decided at enqueue.  In MarkOnDequeue mode, the
+   * packet is not marked: it is only checked that it could be
+   * \param item queue item
+   * \param reason the reason for marking
+   * \returns true if the packet can be admitted rather than dropped
+   */
+  bool EnqueueMark (Ptr<QueueDiscItem> item, const char* reason);
 
   // ** Variables supplied by user
   uint32_t m_meanPktSize;   //!< Avg pkt size
@@ -286,6 +295,8 @@ private:
   Time m_linkDelay;         //!< Link delay
   bool m_useEcn;            //!< True if ECN is used (packets are marked instead of being dropped)
   bool m_useHardDrop;       //!< True if packets are always dropped above max threshold
+  bool m_markOnDequeue;     //!< True if packets are marked at dequeue, based on their sojourn time
+  Time m_sojournMarkingThreshold; //!< Sojourn time above which packets are marked at dequeue
 
   // ** Variables maintained by RED
   double m_vA;              //!< 1.0 / (m_maxTh - m_minTh)
@@ -186,6 +186,8 @@ TrafficControlLayer::ScanDevices (void)
               q->SetNetDeviceQueueInterface (ndqi);
               q->SetSendCallback ([dev] (Ptr<QueueDiscItem> item)
                                   { dev->Send (item->GetPacket (), item->GetAddress (), item->GetProtocol ()); });
+              q->SetSendBurstCallback ([dev] (const std::vector<Ptr<QueueDiscItem> > &items)
+                                       { dev->SendBurst (items); });
             }
         }
     }
@@ -250,6 +252,7 @@ TrafficControlLayer::DeleteRootQueueDiscOnDevice (Ptr<NetDevice> device)
     {
       q->SetNetDeviceQueueInterface (nullptr);
       q->SetSendCallback (nullptr);
+      q->SetSendBurstCallback (nullptr);
     }
   ndi->second.m_queueDiscsToWake.clear ();
 
@@ -0,0 +1,316 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/fq-pacing-queue-disc.h"
+#include "ns3/packet.h"
+#include "ns3/socket.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Fq Pacing Queue Disc Test Item
+ */
+class FqPacingQueueDiscTestItem : public QueueDiscItem {
+public:
+  /**
+   * Constructor
+   *
+   * \param p the packet
+   * \param addr the address
+   * \param flow the flow the packet belongs to
+   */
+  FqPacingQueueDiscTestItem (Ptr<Packet> p, const Address & addr, uint32_t flow);
+  virtual ~FqPacingQueueDiscTestItem ();
+  virtual void AddHeader (void);
+  virtual bool Mark (void);
+  virtual uint32_t Hash (uint32_t perturbation) const;
+
+  /**
+   * \return the flow the packet belongs to
+   */
+  uint32_t GetFlow (void) const;
+
+private:
+  FqPacingQueueDiscTestItem ();
+  /**
+   * \brief Copy constructor
+   * Disable default implementation to avoid misuse
+   */
+  FqPacingQueueDiscTestItem (const FqPacingQueueDiscTestItem &);
+  /**
+   * \brief Assignment operator
+   * \return this object
+   * Disable default implementation to avoid misuse
+   */
+  FqPacingQueueDiscTestItem &operator = (const FqPacingQueueDiscTestItem &);
+  uint32_t m_flow; //!< the flow the packet belongs to
+};
+
+FqPacingQueueDiscTestItem::FqPacingQueueDiscTestItem (Ptr<Packet> p, const Address & addr, uint32_t flow)
+  : QueueDiscItem (p, addr, 0),
+    m_flow (flow)
+{
+}
+
+FqPacingQueueDiscTestItem::~FqPacingQueueDiscTestItem ()
+{
+}
+
+void
+FqPacingQueueDiscTestItem::AddHeader (void)
+{
+}
+
+bool
+FqPacingQueueDiscTestItem::Mark (void)
+{
+  return false;
+}
+
+uint32_t
+FqPacingQueueDiscTestItem::Hash (uint32_t perturbation) const
+{
+  return m_flow;
+}
+
+uint32_t
+FqPacingQueueDiscTestItem::GetFlow (void) const
+{
+  return m_flow;
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Fq Pacing Queue Disc Test Case
+ */
+class FqPacingQueueDiscTestCase : public TestCase
+{
+public:
+  FqPacingQueueDiscTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * Create a queue disc whose transmitted packets are recorded
+   * \param rate the Rate attribute
+   * \param maxRate the MaxRate attribute
+   * \return the queue disc
+   */
+  Ptr<FqPacingQueueDisc> CreateQueueDisc (DataRate rate, DataRate maxRate);
+  /**
+   * Enqueue a number of packets of the given flow
+   * \param queue the queue disc
+   * \param flow the flow the packets belong to
+   * \param nPkts the number of packets to enqueue
+   * \param rate the pacing rate carried by the packets, zero for none
+   */
+  void Enqueue (Ptr<FqPacingQueueDisc> queue, uint32_t flow, uint32_t nPkts, DataRate rate);
+  /**
+   * Record a packet transmitted by the queue disc
+   * \param item the packet
+   */
+  void Sent (Ptr<QueueDiscItem> item);
+  /**
+   * Check the times the packets of a flow were transmitted at
+   * \param flow the flow
+   * \param interval the expected interval between the packets of the flow
+   * \param nPkts the expected number of packets of the flow
+   */
+  void CheckTimes (uint32_t flow, Time interval, uint32_t nPkts);
+
+  uint32_t m_pktSize;                //!< the packet size
+  std::vector<uint32_t> m_flows;     //!< the flows of the transmitted packets
+  std::vector<Time> m_times;         //!< the times the packets were transmitted at
+  bool m_tagged;                     //!< true if a transmitted packet kept its pacing rate tag
+};
+
+FqPacingQueueDiscTestCase::FqPacingQueueDiscTestCase ()
+  : TestCase ("Sanity check on the fq pacing queue disc implementation"),
+    m_pktSize (1000),
+    m_tagged (false)
+{
+}
+
+Ptr<FqPacingQueueDisc>
+FqPacingQueueDiscTestCase::CreateQueueDisc (DataRate rate, DataRate maxRate)
+{
+  Ptr<FqPacingQueueDisc> queue = CreateObject<FqPacingQueueDisc> ();
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("Rate", DataRateValue (rate)), true,
+                         "Verify that we can actually set the attribute Rate");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MaxRate", DataRateValue (maxRate)), true,
+                         "Verify that we can actually set the attribute MaxRate");
+  queue->SetSendCallback ([this] (Ptr<QueueDiscItem> item) { Sent (item); });
+  m_flows.clear ();
+  m_times.clear ();
+  return queue;
+}
+
+void
+FqPacingQueueDiscTestCase::Enqueue (Ptr<FqPacingQueueDisc> queue, uint32_t flow, uint32_t nPkts, DataRate rate)
+{
+  Address dest;
+  for (uint32_t i = 0; i < nPkts; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (m_pktSize);
+      if (rate.GetBitRate () > 0)
+        {
+          SocketPacingRateTag pacingRateTag;
+          pacingRateTag.SetPacingRate (rate);
+          p->AddPacketTag (pacingRateTag);
+        }
+      queue->Enqueue (Create<FqPacingQueueDiscTestItem> (p, dest, flow));
+    }
+}
+
+void
+FqPacingQueueDiscTestCase::Sent (Ptr<QueueDiscItem> item)
+{
+  m_flows.push_back (DynamicCast<FqPacingQueueDiscTestItem> (item)->GetFlow ());
+  m_times.push_back (Simulator::Now ());
+  SocketPacingRateTag pacingRateTag;
+  m_tagged |= item->GetPacket ()->PeekPacketTag (pacingRateTag);
+}
+
+void
+FqPacingQueueDiscTestCase::CheckTimes (uint32_t flow, Time interval, uint32_t nPkts)
+{
+  uint32_t n = 0;
+  for (uint32_t i = 0; i < m_flows.size (); i++)
+    {
+      if (m_flows[i] == flow)
+        {
+          NS_TEST_EXPECT_MSG_EQ (m_times[i], interval * n, "Packet " << n << " of flow " << flow
+                                 << " transmitted at the wrong time");
+          n++;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (n, nPkts, "Wrong number of packets transmitted for flow " << flow);
+}
+
+void
+FqPacingQueueDiscTestCase::DoRun (void)
+{
+  // test 1: every flow is released at the rate of its tag, the queue disc
+  // waking itself up when the next packet may be sent
+  /* 1000 bytes take 1ms at 8Mbps and 2ms at 4Mbps. A flow which is not
+     tagged is not paced. */
+  Ptr<FqPacingQueueDisc> queue = CreateQueueDisc (DataRate (0), DataRate (0));
+  queue->Initialize ();
+  Enqueue (queue, 1, 5, DataRate ("8Mbps"));
+  Enqueue (queue, 2, 5, DataRate ("4Mbps"));
+  Enqueue (queue, 3, 5, DataRate (0));
+  queue->Run ();
+  Simulator::Run ();
+  CheckTimes (1, MilliSeconds (1), 5);
+  CheckTimes (2, MilliSeconds (2), 5);
+  CheckTimes (3, Seconds (0), 5);
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 0, "All the packets should have been transmitted");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNThrottledFlows (), 0, "No flow should be throttled");
+  NS_TEST_EXPECT_MSG_EQ (m_tagged, false, "The pacing rate tags should have been removed");
+  // the wake up events of the queue disc are shared by the flows
+  NS_TEST_EXPECT_MSG_LT (Simulator::GetEventCount (), 10, "Too many wake up events");
+  Simulator::Destroy ();
+
+  // test 2: the packets without tag are paced at the configured rate, and
+  // the maximum rate caps the rate of all the packets
+  queue = CreateQueueDisc (DataRate ("4Mbps"), DataRate ("8Mbps"));
+  queue->Initialize ();
+  Enqueue (queue, 1, 5, DataRate ("100Mbps"));
+  Enqueue (queue, 2, 5, DataRate (0));
+  queue->Run ();
+  Simulator::Run ();
+  CheckTimes (1, MilliSeconds (1), 5);
+  CheckTimes (2, MilliSeconds (2), 5);
+  Simulator::Destroy ();
+
+  // test 3: flows are served in round robin, one quantum at a time
+  queue = CreateQueueDisc (DataRate (0), DataRate (0));
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("Quantum", UintegerValue (m_pktSize)), true,
+                         "Verify that we can actually set the attribute Quantum");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("InitialQuantum", UintegerValue (m_pktSize)), true,
+                         "Verify that we can actually set the attribute InitialQuantum");
+  queue->Initialize ();
+  Enqueue (queue, 1, 3, DataRate (0));
+  Enqueue (queue, 2, 3, DataRate (0));
+  queue->Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_flows.size (), 6, "All the packets should have been transmitted");
+  for (uint32_t i = 0; i < m_flows.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_flows[i], 1 + i % 2, "The flows should alternate");
+    }
+  Simulator::Destroy ();
+
+  // test 4: a flow can not hold more than FlowLimit packets
+  queue = CreateQueueDisc (DataRate (0), DataRate (0));
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("FlowLimit", UintegerValue (3)), true,
+                         "Verify that we can actually set the attribute FlowLimit");
+  queue->Initialize ();
+  Enqueue (queue, 1, 5, DataRate (0));
+  Enqueue (queue, 2, 2, DataRate (0));
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 5, "There should be five packets in there");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetStats ().GetNDroppedPackets (FqPacingQueueDisc::FLOW_LIMIT_DROP), 2,
+                         "Two packets of flow 1 should have been dropped");
+  Simulator::Destroy ();
+
+  // test 5: the entries of the flows which may send again are reused
+  queue = CreateQueueDisc (DataRate ("8Mbps"), DataRate (0));
+  queue->Initialize ();
+  for (uint32_t flow = 0; flow < 10; flow++)
+    {
+      Enqueue (queue, flow, 2, DataRate (0));
+    }
+  queue->Run ();
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNFlows (), 10, "There should be ten flows");
+  // the flows sent their last packet at 1ms, they may send again at 2ms:
+  // a flow arriving at 1.5ms needs a new entry, a flow arriving at 2ms
+  // reuses one
+  Simulator::Schedule (MicroSeconds (500), &FqPacingQueueDiscTestCase::Enqueue, this,
+                       queue, 10, 1, DataRate (0));
+  Simulator::Schedule (MicroSeconds (500), &FqPacingQueueDisc::Run, queue);
+  Simulator::Schedule (MilliSeconds (1), &FqPacingQueueDiscTestCase::Enqueue, this,
+                       queue, 11, 1, DataRate (0));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNInternalQueues (), 11, "The entries of the old flows should be reused");
+  // flows 9 and 10, which sent the last packets, stay in the round robin
+  // until it finds them empty
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNFlows (), 3, "The old flows should have been freed");
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Fq Pacing Queue Disc Test Suite
+ */
+static class FqPacingQueueDiscTestSuite : public TestSuite
+{
+public:
+  FqPacingQueueDiscTestSuite ()
+    : TestSuite ("fq-pacing-queue-disc", UNIT)
+  {
+    AddTestCase (new FqPacingQueueDiscTestCase (), TestCase::QUICK);
+  }
+} g_fqPacingQueueDiscTestSuite; ///< the test suite
@@ -0,0 +1,273 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/pacer-queue-disc.h"
+#include "ns3/packet.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Pacer Queue Disc Test Item
+ */
+class PacerQueueDiscTestItem : public QueueDiscItem {
+public:
+  /**
+   * Constructor
+   *
+   * \param p the packet
+   * \param addr the address
+   * \param flow the flow the packet belongs to
+   */
+  PacerQueueDiscTestItem (Ptr<Packet> p, const Address & addr, uint32_t flow);
+  virtual ~PacerQueueDiscTestItem ();
+  virtual void AddHeader (void);
+  virtual bool Mark (void);
+  virtual uint32_t Hash (uint32_t perturbation) const;
+
+private:
+  PacerQueueDiscTestItem ();
+  /**
+   * \brief Copy constructor
+   * Disable default implementation to avoid misuse
+   */
+  PacerQueueDiscTestItem (const PacerQueueDiscTestItem &);
+  /**
+   * \brief Assignment operator
+   * \return this object
+   * Disable default implementation to avoid misuse
+   */
+  PacerQueueDiscTestItem &operator = (const PacerQueueDiscTestItem &);
+  uint32_t m_flow; //!< the flow the packet belongs to
+};
+
+PacerQueueDiscTestItem::PacerQueueDiscTestItem (Ptr<Packet> p, const Address & addr, uint32_t flow)
+  : QueueDiscItem (p, addr, 0),
+    m_flow (flow)
+{
+}
+
+PacerQueueDiscTestItem::~PacerQueueDiscTestItem ()
+{
+}
+
+void
+PacerQueueDiscTestItem::AddHeader (void)
+{
+}
+
+bool
+PacerQueueDiscTestItem::Mark (void)
+{
+  return false;
+}
+
+uint32_t
+PacerQueueDiscTestItem::Hash (uint32_t perturbation) const
+{
+  return m_flow;
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Pacer Queue Disc Test Case
+ */
+class PacerQueueDiscTestCase : public TestCase
+{
+public:
+  PacerQueueDiscTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * Enqueue a number of packets of the given flow
+   * \param queue the queue disc
+   * \param flow the flow the packets belong to
+   * \param nPkts the number of packets to enqueue
+   */
+  void Enqueue (Ptr<PacerQueueDisc> queue, uint32_t flow, uint32_t nPkts);
+  /**
+   * Dequeue a packet and check whether it was blocked by the token bucket
+   * \param queue the queue disc
+   * \param flag true if a packet is expected to be dequeued
+   * \param printStatement the string to be printed in the NS_TEST_EXPECT_MSG_EQ
+   */
+  void DequeueAndCheck (Ptr<PacerQueueDisc> queue, bool flag, std::string printStatement);
+  /**
+   * Check the number of flows associated with the pacer
+   * \param queue the queue disc
+   * \param nFlows the expected number of associated flows
+   */
+  void CheckAssociated (Ptr<PacerQueueDisc> queue, uint32_t nFlows);
+  /**
+   * Check that the token bucket rate is larger than the given value
+   * \param queue the queue disc
+   * \param rate the rate
+   */
+  void CheckRateAbove (Ptr<PacerQueueDisc> queue, DataRate rate);
+  uint32_t m_pktSize; //!< the packet size
+};
+
+PacerQueueDiscTestCase::PacerQueueDiscTestCase ()
+  : TestCase ("Sanity check on the pacer queue disc implementation"),
+    m_pktSize (1000)
+{
+}
+
+void
+PacerQueueDiscTestCase::Enqueue (Ptr<PacerQueueDisc> queue, uint32_t flow, uint32_t nPkts)
+{
+  Address dest;
+  for (uint32_t i = 0; i < nPkts; i++)
+    {
+      queue->Enqueue (Create<PacerQueueDiscTestItem> (Create<Packet> (m_pktSize), dest, flow));
+    }
+}
+
+void
+PacerQueueDiscTestCase::DequeueAndCheck (Ptr<PacerQueueDisc> queue, bool flag, std::string printStatement)
+{
+  Ptr<QueueDiscItem> item = queue->Dequeue ();
+  NS_TEST_EXPECT_MSG_EQ ((item != 0), flag, printStatement);
+}
+
+void
+PacerQueueDiscTestCase::CheckAssociated (Ptr<PacerQueueDisc> queue, uint32_t nFlows)
+{
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNAssociatedFlows (), nFlows, "Unexpected number of associated flows");
+}
+
+void
+PacerQueueDiscTestCase::CheckRateAbove (Ptr<PacerQueueDisc> queue, DataRate rate)
+{
+  NS_TEST_EXPECT_MSG_GT (queue->GetPacingRate (), rate, "The token bucket rate should have increased");
+}
+
+void
+PacerQueueDiscTestCase::DoRun (void)
+{
+  // test 1: packets of flows that are not associated bypass the token bucket
+  Ptr<PacerQueueDisc> queue = CreateObject<PacerQueueDisc> ();
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("Burst", UintegerValue (m_pktSize)), true,
+                         "Verify that we can actually set the attribute Burst");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("Rate", DataRateValue (DataRate ("8kbps"))), true,
+                         "Verify that we can actually set the attribute Rate");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("AdaptiveRate", BooleanValue (false)), true,
+                         "Verify that we can actually set the attribute AdaptiveRate");
+  queue->Initialize ();
+
+  Enqueue (queue, 1, 5);
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 5, "There should be five packets in there");
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      DequeueAndCheck (queue, true, "Packets of small flows should not be paced");
+    }
+  CheckAssociated (queue, 0);
+
+  // test 2: a flow exceeding the large flow rate is associated with the pacer
+  /* With a 1ms measurement interval and a 1Mbps threshold, a flow sending more
+     than 125 bytes per millisecond is large. Flow 1 sends 10 packets at time 0,
+     which are not paced, then 10 more packets after 2 ms. By then flow 1 is
+     associated, hence only the packet allowed by the token bucket is dequeued.
+     Flow 2 sends a single packet, stays small and bypasses the pacer. */
+  queue = CreateObject<PacerQueueDisc> ();
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("Burst", UintegerValue (m_pktSize)), true,
+                         "Verify that we can actually set the attribute Burst");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("Rate", DataRateValue (DataRate ("800kbps"))), true,
+                         "Verify that we can actually set the attribute Rate");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("AdaptiveRate", BooleanValue (false)), true,
+                         "Verify that we can actually set the attribute AdaptiveRate");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MeasurementInterval", TimeValue (MilliSeconds (1))), true,
+                         "Verify that we can actually set the attribute MeasurementInterval");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("LargeFlowRate", DataRateValue (DataRate ("1Mbps"))), true,
+                         "Verify that we can actually set the attribute LargeFlowRate");
+  queue->Initialize ();
+
+  Simulator::Schedule (MilliSeconds (1), &PacerQueueDiscTestCase::Enqueue, this, queue, 1, 10);
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      Simulator::Schedule (MilliSeconds (1), &PacerQueueDiscTestCase::DequeueAndCheck, this,
+                           queue, true, "Flow 1 should not be paced yet");
+    }
+  Simulator::Schedule (MilliSeconds (3), &PacerQueueDiscTestCase::Enqueue, this, queue, 1, 10);
+  Simulator::Schedule (MilliSeconds (3), &PacerQueueDiscTestCase::Enqueue, this, queue, 2, 1);
+  Simulator::Schedule (MilliSeconds (3), &PacerQueueDiscTestCase::CheckAssociated, this, queue, 1);
+  Simulator::Schedule (MilliSeconds (3), &PacerQueueDiscTestCase::DequeueAndCheck, this,
+                       queue, true, "The packet of flow 2 should bypass the pacer");
+  Simulator::Schedule (MilliSeconds (3), &PacerQueueDiscTestCase::DequeueAndCheck, this,
+                       queue, true, "The token bucket should allow one packet of flow 1");
+  Simulator::Schedule (MilliSeconds (3), &PacerQueueDiscTestCase::DequeueAndCheck, this,
+                       queue, false, "The second packet of flow 1 should be blocked");
+  // 1000 bytes at 800kbps take 10ms
+  Simulator::Schedule (MilliSeconds (13), &PacerQueueDiscTestCase::DequeueAndCheck, this,
+                       queue, true, "Enough tokens should be available after 10ms");
+  Simulator::Schedule (MilliSeconds (13), &PacerQueueDiscTestCase::DequeueAndCheck, this,
+                       queue, false, "The token bucket should be empty again");
+  Simulator::Stop (MilliSeconds (14));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  // test 3: the token bucket rate grows with the rate of the associated flows
+  queue = CreateObject<PacerQueueDisc> ();
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("Burst", UintegerValue (m_pktSize)), true,
+                         "Verify that we can actually set the attribute Burst");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("Rate", DataRateValue (DataRate ("800kbps"))), true,
+                         "Verify that we can actually set the attribute Rate");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MinRate", DataRateValue (DataRate ("800kbps"))), true,
+                         "Verify that we can actually set the attribute MinRate");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("UpdateInterval", TimeValue (MilliSeconds (1))), true,
+                         "Verify that we can actually set the attribute UpdateInterval");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("LargeFlowRate", DataRateValue (DataRate ("1Mbps"))), true,
+                         "Verify that we can actually set the attribute LargeFlowRate");
+  queue->Initialize ();
+
+  Simulator::Schedule (MilliSeconds (1), &PacerQueueDiscTestCase::Enqueue, this, queue, 1, 10);
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      Simulator::Schedule (MilliSeconds (1), &PacerQueueDiscTestCase::DequeueAndCheck, this,
+                           queue, true, "Flow 1 should not be paced yet");
+    }
+  Simulator::Schedule (MicroSeconds (3000), &PacerQueueDiscTestCase::Enqueue, this, queue, 1, 10);
+  Simulator::Schedule (MicroSeconds (4500), &PacerQueueDiscTestCase::Enqueue, this, queue, 1, 1);
+  Simulator::Schedule (MicroSeconds (4500), &PacerQueueDiscTestCase::CheckRateAbove, this,
+                       queue, DataRate ("8Mbps"));
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Pacer Queue Disc Test Suite
+ */
+static class PacerQueueDiscTestSuite : public TestSuite
+{
+public:
+  PacerQueueDiscTestSuite ()
+    : TestSuite ("pacer-queue-disc", UNIT)
+  {
+    AddTestCase (new PacerQueueDiscTestCase (), TestCase::QUICK);
+  }
+} g_pacerQueueDiscTestSuite; ///< the test suite
@@ -0,0 +1,449 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/pq-queue-disc.h"
+#include "ns3/phantom-queue.h"
+#include "ns3/packet.h"
+#include "ns3/uinteger.h"
+#include "ns3/pointer.h"
+#include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Phantom Queue Disc Test Item
+ */
+class PhantomQueueDiscTestItem : public QueueDiscItem {
+public:
+  /**
+   * Constructor
+   *
+   * \param p the packet
+   * \param addr the address
+   */
+  PhantomQueueDiscTestItem (Ptr<Packet> p, const Address & addr);
+  virtual ~PhantomQueueDiscTestItem ();
+  virtual void AddHeader (void);
+  virtual bool Mark (void);
+
+private:
+  PhantomQueueDiscTestItem ();
+  /**
+   * \brief Copy constructor
+   * Disable default implementation to avoid misuse
+   */
+  PhantomQueueDiscTestItem (const PhantomQueueDiscTestItem &);
+  /**
+   * \brief Assignment operator
+   * \return this object
+   * Disable default implementation to avoid misuse
+   */
+  PhantomQueueDiscTestItem &operator = (const PhantomQueueDiscTestItem &);
+};
+
+PhantomQueueDiscTestItem::PhantomQueueDiscTestItem (Ptr<Packet> p, const Address & addr)
+  : QueueDiscItem (p, addr, 0)
+{
+}
+
+PhantomQueueDiscTestItem::~PhantomQueueDiscTestItem ()
+{
+}
+
+void
+PhantomQueueDiscTestItem::AddHeader (void)
+{
+}
+
+bool
+PhantomQueueDiscTestItem::Mark (void)
+{
+  return true;
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Phantom Queue Drain Test Case
+ */
+class PhantomQueueDrainTestCase : public TestCase
+{
+public:
+  PhantomQueueDrainTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * Check the occupancy of the phantom queue
+   * \param pq the phantom queue
+   * \param expected the expected occupancy in bytes
+   */
+  void CheckOccupancy (Ptr<PhantomQueue> pq, uint32_t expected);
+  /**
+   * Enqueue bytes into the phantom queue and check the marking decision
+   * \param pq the phantom queue
+   * \param bytes the number of bytes
+   * \param mark whether the packet is expected to be marked
+   */
+  void EnqueueAndCheck (Ptr<PhantomQueue> pq, uint32_t bytes, bool mark);
+};
+
+PhantomQueueDrainTestCase::PhantomQueueDrainTestCase ()
+  : TestCase ("Check the lazy drain of the phantom queue")
+{
+}
+
+void
+PhantomQueueDrainTestCase::CheckOccupancy (Ptr<PhantomQueue> pq, uint32_t expected)
+{
+  NS_TEST_EXPECT_MSG_EQ (pq->GetOccupancy (), expected, "Unexpected occupancy at " << Simulator::Now ());
+}
+
+void
+PhantomQueueDrainTestCase::EnqueueAndCheck (Ptr<PhantomQueue> pq, uint32_t bytes, bool mark)
+{
+  NS_TEST_EXPECT_MSG_EQ (pq->Enqueue (bytes), mark, "Unexpected marking decision at " << Simulator::Now ());
+}
+
+void
+PhantomQueueDrainTestCase::DoRun (void)
+{
+  // 1Mbps drains one byte every 8 us
+  Ptr<PhantomQueue> pq = CreateObject<PhantomQueue> ();
+  pq->SetDrainRate (DataRate ("1Mbps"));
+  pq->SetMarkingThreshold (1500);
+
+  Simulator::Schedule (MicroSeconds (1000), &PhantomQueueDrainTestCase::EnqueueAndCheck, this, pq, 1000, false);
+  // half a byte drained: the fraction must be carried over, not lost
+  Simulator::Schedule (MicroSeconds (1004), &PhantomQueueDrainTestCase::CheckOccupancy, this, pq, 1000);
+  Simulator::Schedule (MicroSeconds (1008), &PhantomQueueDrainTestCase::CheckOccupancy, this, pq, 999);
+  for (uint32_t i = 1; i <= 100; i++)
+    {
+      Simulator::Schedule (MicroSeconds (1008 + i), &PhantomQueueDrainTestCase::CheckOccupancy, this, pq,
+                           999 - i / 8);
+    }
+  Simulator::Schedule (MicroSeconds (5000), &PhantomQueueDrainTestCase::CheckOccupancy, this, pq, 500);
+  Simulator::Schedule (MicroSeconds (5000), &PhantomQueueDrainTestCase::EnqueueAndCheck, this, pq, 1000, false);
+  Simulator::Schedule (MicroSeconds (5000), &PhantomQueueDrainTestCase::EnqueueAndCheck, this, pq, 1, true);
+  Simulator::Schedule (Seconds (1), &PhantomQueueDrainTestCase::CheckOccupancy, this, pq, 0);
+
+  // a change of the drain rate only applies from now on
+  Simulator::Schedule (MicroSeconds (1000000), &PhantomQueueDrainTestCase::EnqueueAndCheck, this, pq, 1000, false);
+  Simulator::Schedule (MicroSeconds (1000800), &PhantomQueue::SetDrainRate, pq, DataRate ("2Mbps"));
+  Simulator::Schedule (MicroSeconds (1001600), &PhantomQueueDrainTestCase::CheckOccupancy, this, pq, 700);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Shared Phantom Queue Test Case
+ */
+class PhantomQueueSharedTestCase : public TestCase
+{
+public:
+  PhantomQueueSharedTestCase ();
+  virtual void DoRun (void);
+};
+
+PhantomQueueSharedTestCase::PhantomQueueSharedTestCase ()
+  : TestCase ("Check a phantom queue shared by multiple ports")
+{
+}
+
+void
+PhantomQueueSharedTestCase::DoRun (void)
+{
+  uint32_t pktSize = 1000;
+  Address dest;
+
+  Ptr<PhantomQueue> pq = CreateObject<PhantomQueue> ();
+  pq->SetMarkingThreshold (2500);
+
+  Ptr<PhantomQueueDisc> port1 = CreateObject<PhantomQueueDisc> ();
+  Ptr<PhantomQueueDisc> port2 = CreateObject<PhantomQueueDisc> ();
+  Ptr<PhantomQueueDisc> port3 = CreateObject<PhantomQueueDisc> ();
+  Ptr<PhantomQueueDisc> ports[] = {port1, port2, port3};
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (ports[i]->SetAttributeFailSafe ("MaxSize", QueueSizeValue (QueueSize ("100000B"))),
+                             true, "Verify that we can actually set the attribute MaxSize");
+      NS_TEST_EXPECT_MSG_EQ (ports[i]->SetAttributeFailSafe ("MarkingthreShold", DoubleValue (2500)),
+                             true, "Verify that we can actually set the attribute MarkingthreShold");
+    }
+  NS_TEST_EXPECT_MSG_EQ (port1->SetAttributeFailSafe ("PhantomQueue", PointerValue (pq)),
+                         true, "Verify that we can actually set the attribute PhantomQueue");
+  NS_TEST_EXPECT_MSG_EQ (port2->SetAttributeFailSafe ("PhantomQueue", PointerValue (pq)),
+                         true, "Verify that we can actually set the attribute PhantomQueue");
+  port1->Initialize ();
+  port2->Initialize ();
+  port3->Initialize ();
+
+  NS_TEST_EXPECT_MSG_EQ (pq->GetNPorts (), 2, "Two ports should be attached to the shared phantom queue");
+  NS_TEST_EXPECT_MSG_EQ ((port3->GetPhantomQueue () != pq), true, "The third port should have its own phantom queue");
+
+  // the bytes sent on both ports add up in the shared phantom queue
+  port1->Enqueue (Create<PhantomQueueDiscTestItem> (Create<Packet> (pktSize), dest));
+  port2->Enqueue (Create<PhantomQueueDiscTestItem> (Create<Packet> (pktSize), dest));
+  port3->Enqueue (Create<PhantomQueueDiscTestItem> (Create<Packet> (pktSize), dest));
+  port3->Enqueue (Create<PhantomQueueDiscTestItem> (Create<Packet> (pktSize), dest));
+  port1->Enqueue (Create<PhantomQueueDiscTestItem> (Create<Packet> (pktSize), dest));
+  port3->Enqueue (Create<PhantomQueueDiscTestItem> (Create<Packet> (pktSize), dest));
+
+  NS_TEST_EXPECT_MSG_EQ (pq->GetOccupancy (), 3 * pktSize, "Unexpected occupancy of the shared phantom queue");
+  NS_TEST_EXPECT_MSG_EQ (port3->GetPhantomQueue ()->GetOccupancy (), 3 * pktSize,
+                         "Unexpected occupancy of the dedicated phantom queue");
+  NS_TEST_EXPECT_MSG_EQ (port1->GetStats ().GetNMarkedPackets (PhantomQueueDisc::FORCED_MARK), 1,
+                         "The second packet on port 1 should be marked");
+  NS_TEST_EXPECT_MSG_EQ (port2->GetStats ().GetNMarkedPackets (PhantomQueueDisc::FORCED_MARK), 0,
+                         "There should be no marked packets on port 2");
+  NS_TEST_EXPECT_MSG_EQ (port3->GetStats ().GetNMarkedPackets (PhantomQueueDisc::FORCED_MARK), 1,
+                         "The third packet on port 3 should be marked");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Phantom Queue Disc Admission and Marking Modes Test Case
+ */
+class PhantomQueueDiscModesTestCase : public TestCase
+{
+public:
+  PhantomQueueDiscModesTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * Enqueue packets until the queue disc is full and check admission
+   * \param size the maximum size of the queue disc
+   * \param pktSize the packet size
+   * \param expected the expected number of enqueued packets
+   */
+  void RunAdmissionTest (QueueSize size, uint32_t pktSize, uint32_t expected);
+};
+
+PhantomQueueDiscModesTestCase::PhantomQueueDiscModesTestCase ()
+  : TestCase ("Check the admission and marking modes of the phantom queue disc")
+{
+}
+
+void
+PhantomQueueDiscModesTestCase::RunAdmissionTest (QueueSize size, uint32_t pktSize, uint32_t expected)
+{
+  Address dest;
+  Ptr<PhantomQueueDisc> queue = CreateObject<PhantomQueueDisc> ();
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MaxSize", QueueSizeValue (size)),
+                         true, "Verify that we can actually set the attribute MaxSize");
+  queue->Initialize ();
+
+  for (uint32_t i = 0; i < expected + 5; i++)
+    {
+      queue->Enqueue (Create<PhantomQueueDiscTestItem> (Create<Packet> (pktSize), dest));
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), expected, "Unexpected number of packets admitted with MaxSize " << size);
+  NS_TEST_EXPECT_MSG_EQ (queue->GetStats ().GetNDroppedPackets (PhantomQueueDisc::FORCED_DROP), 5,
+                         "Unexpected number of dropped packets with MaxSize " << size);
+}
+
+void
+PhantomQueueDiscModesTestCase::DoRun (void)
+{
+  // packet mode: the limit counts packets, whatever their size
+  RunAdmissionTest (QueueSize ("25p"), 1000, 25);
+  // byte mode: the limit counts bytes
+  RunAdmissionTest (QueueSize ("25000B"), 1000, 25);
+  RunAdmissionTest (QueueSize ("25000B"), 500, 50);
+
+  // instantaneous marking: packets arriving when the real queue holds more
+  // than 2 packets are marked, the phantom queue plays no role
+  Address dest;
+  Ptr<PhantomQueueDisc> queue = CreateObject<PhantomQueueDisc> ();
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MarkingMode", EnumValue (PhantomQueueDisc::INSTANTANEOUS_QUEUE_MARKING)),
+                         true, "Verify that we can actually set the attribute MarkingMode");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("QueueMarkingThreshold", QueueSizeValue (QueueSize ("2p"))),
+                         true, "Verify that we can actually set the attribute QueueMarkingThreshold");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MarkingthreShold", DoubleValue (0)),
+                         true, "Verify that we can actually set the attribute MarkingthreShold");
+  queue->Initialize ();
+
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      queue->Enqueue (Create<PhantomQueueDiscTestItem> (Create<Packet> (1000), dest));
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetStats ().GetNMarkedPackets (PhantomQueueDisc::FORCED_MARK), 2,
+                         "The fourth and fifth packets should be marked");
+  queue->Dequeue ();
+  queue->Dequeue ();
+  queue->Dequeue ();
+  queue->Enqueue (Create<PhantomQueueDiscTestItem> (Create<Packet> (1000), dest));
+  NS_TEST_EXPECT_MSG_EQ (queue->GetStats ().GetNMarkedPackets (PhantomQueueDisc::FORCED_MARK), 2,
+                         "No packet should be marked once the queue is drained");
+
+  // byte threshold
+  queue = CreateObject<PhantomQueueDisc> ();
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MarkingMode", EnumValue (PhantomQueueDisc::INSTANTANEOUS_QUEUE_MARKING)),
+                         true, "Verify that we can actually set the attribute MarkingMode");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("QueueMarkingThreshold", QueueSizeValue (QueueSize ("1500B"))),
+                         true, "Verify that we can actually set the attribute QueueMarkingThreshold");
+  queue->Initialize ();
+
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      queue->Enqueue (Create<PhantomQueueDiscTestItem> (Create<Packet> (1000), dest));
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetStats ().GetNMarkedPackets (PhantomQueueDisc::FORCED_MARK), 3,
+                         "Packets arriving to more than 1500 bytes should be marked");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Phantom Queue Disc Dequeue Marking Test Case
+ */
+class PhantomQueueDiscDequeueMarkingTestCase : public TestCase
+{
+public:
+  PhantomQueueDiscDequeueMarkingTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * Enqueue packets of 1000 bytes
+   * \param queue the queue disc
+   * \param nPkt the number of packets
+   */
+  void Enqueue (Ptr<PhantomQueueDisc> queue, uint32_t nPkt);
+  /**
+   * Dequeue packets
+   * \param queue the queue disc
+   * \param nPkt the number of packets
+   */
+  void Dequeue (Ptr<PhantomQueueDisc> queue, uint32_t nPkt);
+  /**
+   * Enqueue 5 packets at once, dequeue 2 of them at once and the others at
+   * the given time, and check the number of packets marked
+   * \param queue the queue disc
+   * \param later the time of the last dequeues
+   * \param expected the expected number of packets marked at dequeue
+   */
+  void RunMarkingTest (Ptr<PhantomQueueDisc> queue, Time later, uint32_t expected);
+};
+
+PhantomQueueDiscDequeueMarkingTestCase::PhantomQueueDiscDequeueMarkingTestCase ()
+  : TestCase ("Check the marking of packets at dequeue by the phantom queue disc")
+{
+}
+
+void
+PhantomQueueDiscDequeueMarkingTestCase::Enqueue (Ptr<PhantomQueueDisc> queue, uint32_t nPkt)
+{
+  Address dest;
+  for (uint32_t i = 0; i < nPkt; i++)
+    {
+      queue->Enqueue (Create<PhantomQueueDiscTestItem> (Create<Packet> (1000), dest));
+    }
+}
+
+void
+PhantomQueueDiscDequeueMarkingTestCase::Dequeue (Ptr<PhantomQueueDisc> queue, uint32_t nPkt)
+{
+  for (uint32_t i = 0; i < nPkt; i++)
+    {
+      queue->Dequeue ();
+    }
+}
+
+void
+PhantomQueueDiscDequeueMarkingTestCase::RunMarkingTest (Ptr<PhantomQueueDisc> queue, Time later, uint32_t expected)
+{
+  queue->Initialize ();
+  Enqueue (queue, 5);
+  NS_TEST_EXPECT_MSG_EQ (queue->GetStats ().GetNMarkedPackets (PhantomQueueDisc::FORCED_MARK), 0,
+                         "No packet should be marked at enqueue");
+  Dequeue (queue, 2);
+  Simulator::Schedule (later, &PhantomQueueDiscDequeueMarkingTestCase::Dequeue, this, queue, 3);
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (queue->GetStats ().GetNMarkedPackets (PhantomQueueDisc::DEQUEUE_MARK), expected,
+                         "Unexpected number of packets marked at dequeue");
+  Simulator::Destroy ();
+}
+
+void
+PhantomQueueDiscDequeueMarkingTestCase::DoRun (void)
+{
+  // sojourn time: only the packets which stayed more than 1ms are marked
+  Ptr<PhantomQueueDisc> queue = CreateObject<PhantomQueueDisc> ();
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MarkingMode", EnumValue (PhantomQueueDisc::SOJOURN_TIME_MARKING)),
+                         true, "Verify that we can actually set the attribute MarkingMode");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("SojournMarkingThreshold", TimeValue (MilliSeconds (1))),
+                         true, "Verify that we can actually set the attribute SojournMarkingThreshold");
+  RunMarkingTest (queue, MilliSeconds (2), 3);
+
+  // real queue at dequeue: the packets leaving more than 2 packets behind
+  // them are marked, i.e., the first two
+  queue = CreateObject<PhantomQueueDisc> ();
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MarkingMode", EnumValue (PhantomQueueDisc::INSTANTANEOUS_QUEUE_MARKING)),
+                         true, "Verify that we can actually set the attribute MarkingMode");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("QueueMarkingThreshold", QueueSizeValue (QueueSize ("2p"))),
+                         true, "Verify that we can actually set the attribute QueueMarkingThreshold");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MarkOnDequeue", BooleanValue (true)),
+                         true, "Verify that we can actually set the attribute MarkOnDequeue");
+  RunMarkingTest (queue, MilliSeconds (2), 2);
+
+  // phantom queue at dequeue: 5000 bytes at first, above the threshold, then
+  // 2000 bytes once drained at 1 byte per microsecond for 3ms
+  queue = CreateObject<PhantomQueueDisc> ();
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("LinkBandwidth", DataRateValue (DataRate ("8Mbps"))),
+                         true, "Verify that we can actually set the attribute LinkBandwidth");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("DrainRateFraction", DoubleValue (1)),
+                         true, "Verify that we can actually set the attribute DrainRateFraction");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MarkingthreShold", DoubleValue (2500)),
+                         true, "Verify that we can actually set the attribute MarkingthreShold");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MarkOnDequeue", BooleanValue (true)),
+                         true, "Verify that we can actually set the attribute MarkOnDequeue");
+  RunMarkingTest (queue, MilliSeconds (3), 2);
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Phantom Queue Disc Test Suite
+ */
+static class PhantomQueueDiscTestSuite : public TestSuite
+{
+public:
+  PhantomQueueDiscTestSuite ()
+    : TestSuite ("phantom-queue-disc", UNIT)
+  {
+    AddTestCase (new PhantomQueueDrainTestCase (), TestCase::QUICK);
+    AddTestCase (new PhantomQueueSharedTestCase (), TestCase::QUICK);
+    AddTestCase (new PhantomQueueDiscModesTestCase (), TestCase::QUICK);
+    AddTestCase (new PhantomQueueDiscDequeueMarkingTestCase (), TestCase::QUICK);
+  }
+} g_phantomQueueDiscTestSuite; ///< the test suite
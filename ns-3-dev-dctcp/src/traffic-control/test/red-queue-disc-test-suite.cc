@@ -50,6 +50,7 @@ public:
   virtual ~RedQueueDiscTestItem ();
   virtual void AddHeader (void);
   virtual bool Mark(void);
+  virtual bool GetUint8Value (Uint8Values field, uint8_t &value) const;
 
 private:
   RedQueueDiscTestItem ();
@@ -92,6 +93,49 @@ RedQueueDiscTestItem::Mark (void)
   return false;
 }
 
+bool
+RedQueueDiscTestItem::GetUint8Value (Uint8Values field, uint8_t &value) const
+{
+  // ECT(0) codepoint for the ECN capable packets
+  value = (m_ecnCapablePacket ? 0x2 : 0);
+  return (field == IP_DSFIELD);
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Red Queue Disc Test Item whose DS field cannot be read
+ */
+class RedQueueDiscNoDsFieldTestItem : public QueueDiscItem {
+public:
+  /**
+   * Constructor
+   *
+   * \param p packet
+   * \param addr address
+   */
+  RedQueueDiscNoDsFieldTestItem (Ptr<Packet> p, const Address & addr);
+  virtual void AddHeader (void);
+  virtual bool Mark(void);
+};
+
+RedQueueDiscNoDsFieldTestItem::RedQueueDiscNoDsFieldTestItem (Ptr<Packet> p, const Address & addr)
+  : QueueDiscItem (p, addr, 0)
+{
+}
+
+void
+RedQueueDiscNoDsFieldTestItem::AddHeader (void)
+{
+}
+
+bool
+RedQueueDiscNoDsFieldTestItem::Mark (void)
+{
+  return false;
+}
+
 /**
  * \ingroup traffic-control-test
  * \ingroup tests
@@ -515,6 +559,165 @@ RedQueueDiscTestCase::DoRun (void)
 
 }
 
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Red Queue Disc Dequeue Marking Test Case
+ */
+class RedQueueDiscDequeueMarkingTestCase : public TestCase
+{
+public:
+  RedQueueDiscDequeueMarkingTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * Enqueue function
+   * \param queue the queue disc
+   * \param nPkt the number of packets
+   * \param ecnCapable ECN capable flag
+   */
+  void Enqueue (Ptr<RedQueueDisc> queue, uint32_t nPkt, bool ecnCapable);
+  /**
+   * Dequeue function
+   * \param queue the queue disc
+   * \param nPkt the number of packets
+   */
+  void Dequeue (Ptr<RedQueueDisc> queue, uint32_t nPkt);
+};
+
+RedQueueDiscDequeueMarkingTestCase::RedQueueDiscDequeueMarkingTestCase ()
+  : TestCase ("Check the marking of packets at dequeue based on their sojourn time")
+{
+}
+
+void
+RedQueueDiscDequeueMarkingTestCase::Enqueue (Ptr<RedQueueDisc> queue, uint32_t nPkt, bool ecnCapable)
+{
+  Address dest;
+  for (uint32_t i = 0; i < nPkt; i++)
+    {
+      queue->Enqueue (Create<RedQueueDiscTestItem> (Create<Packet> (1000), dest, ecnCapable));
+    }
+}
+
+void
+RedQueueDiscDequeueMarkingTestCase::Dequeue (Ptr<RedQueueDisc> queue, uint32_t nPkt)
+{
+  for (uint32_t i = 0; i < nPkt; i++)
+    {
+      queue->Dequeue ();
+    }
+}
+
+void
+RedQueueDiscDequeueMarkingTestCase::DoRun (void)
+{
+  Ptr<RedQueueDisc> queue = CreateObject<RedQueueDisc> ();
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MinTh", DoubleValue (2)), true,
+                         "Verify that we can actually set the attribute MinTh");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MaxTh", DoubleValue (5)), true,
+                         "Verify that we can actually set the attribute MaxTh");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MaxSize", QueueSizeValue (QueueSize ("100p"))),
+                         true, "Verify that we can actually set the attribute MaxSize");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("QW", DoubleValue (1)), true,
+                         "Verify that we can actually set the attribute QW");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("UseEcn", BooleanValue (true)), true,
+                         "Verify that we can actually set the attribute UseEcn");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("UseHardDrop", BooleanValue (false)), true,
+                         "Verify that we can actually set the attribute UseHardDrop");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MarkOnDequeue", BooleanValue (true)), true,
+                         "Verify that we can actually set the attribute MarkOnDequeue");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("SojournMarkingThreshold", TimeValue (MilliSeconds (1))),
+                         true, "Verify that we can actually set the attribute SojournMarkingThreshold");
+  queue->Initialize ();
+
+  // the average queue exceeds the thresholds, but the ECN capable packets
+  // are neither marked nor dropped at enqueue
+  Enqueue (queue, 10, true);
+  QueueDisc::Stats st = queue->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (st.GetNMarkedPackets (RedQueueDisc::UNFORCED_MARK) + st.GetNMarkedPackets (RedQueueDisc::FORCED_MARK),
+                         0, "No packet should be marked at enqueue");
+  NS_TEST_EXPECT_MSG_EQ (st.GetNDroppedPackets (RedQueueDisc::UNFORCED_DROP) + st.GetNDroppedPackets (RedQueueDisc::FORCED_DROP),
+                         0, "No ECN capable packet should be dropped");
+
+  // only the packets which stayed more than 1ms in the queue are marked
+  Simulator::Schedule (MicroSeconds (500), &RedQueueDiscDequeueMarkingTestCase::Dequeue, this, queue, 4);
+  Simulator::Schedule (MilliSeconds (2), &RedQueueDiscDequeueMarkingTestCase::Dequeue, this, queue, 6);
+  Simulator::Run ();
+  st = queue->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (st.GetNMarkedPackets (RedQueueDisc::DEQUEUE_MARK), 6,
+                         "The packets dequeued after 2ms should be marked");
+
+  // the packets which are not ECN capable are still dropped at enqueue
+  Enqueue (queue, 10, false);
+  st = queue->GetStats ();
+  NS_TEST_EXPECT_MSG_GT (st.GetNDroppedPackets (RedQueueDisc::UNFORCED_DROP) + st.GetNDroppedPackets (RedQueueDisc::FORCED_DROP),
+                         0, "Packets which are not ECN capable should be dropped");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Red Queue Disc Dequeue Marking Test Case for packets without DS field
+ */
+class RedQueueDiscDequeueMarkingNoDsFieldTestCase : public TestCase
+{
+public:
+  RedQueueDiscDequeueMarkingNoDsFieldTestCase ();
+  virtual void DoRun (void);
+};
+
+RedQueueDiscDequeueMarkingNoDsFieldTestCase::RedQueueDiscDequeueMarkingNoDsFieldTestCase ()
+  : TestCase ("Check that packets without DS field are dropped when marking at dequeue")
+{
+}
+
+void
+RedQueueDiscDequeueMarkingNoDsFieldTestCase::DoRun (void)
+{
+  Ptr<RedQueueDisc> queue = CreateObject<RedQueueDisc> ();
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MinTh", DoubleValue (2)), true,
+                         "Verify that we can actually set the attribute MinTh");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MaxTh", DoubleValue (5)), true,
+                         "Verify that we can actually set the attribute MaxTh");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MaxSize", QueueSizeValue (QueueSize ("100p"))),
+                         true, "Verify that we can actually set the attribute MaxSize");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("QW", DoubleValue (1)), true,
+                         "Verify that we can actually set the attribute QW");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("UseEcn", BooleanValue (true)), true,
+                         "Verify that we can actually set the attribute UseEcn");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("UseHardDrop", BooleanValue (false)), true,
+                         "Verify that we can actually set the attribute UseHardDrop");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MarkOnDequeue", BooleanValue (true)), true,
+                         "Verify that we can actually set the attribute MarkOnDequeue");
+  queue->Initialize ();
+
+  // the packets whose DS field cannot be read could not be marked at
+  // dequeue, hence they are dropped once the average queue exceeds MinTh
+  Address dest;
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      queue->Enqueue (Create<RedQueueDiscNoDsFieldTestItem> (Create<Packet> (1000), dest));
+    }
+  QueueDisc::Stats st = queue->GetStats ();
+  NS_TEST_EXPECT_MSG_GT (st.GetNDroppedPackets (RedQueueDisc::UNFORCED_DROP) + st.GetNDroppedPackets (RedQueueDisc::FORCED_DROP),
+                         0, "Packets without DS field should be dropped");
+  NS_TEST_EXPECT_MSG_LT (queue->GetNPackets (), 10, "Packets without DS field should not all be admitted");
+
+  while (queue->Dequeue ())
+    {
+    }
+  st = queue->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (st.GetNMarkedPackets (RedQueueDisc::DEQUEUE_MARK), 0,
+                         "Packets without DS field cannot be marked");
+
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup traffic-control-test
  * \ingroup tests
@@ -528,5 +731,7 @@ public:
     : TestSuite ("red-queue-disc", UNIT)
   {
     AddTestCase (new RedQueueDiscTestCase (), TestCase::QUICK);
+    AddTestCase (new RedQueueDiscDequeueMarkingTestCase (), TestCase::QUICK);
+    AddTestCase (new RedQueueDiscDequeueMarkingNoDsFieldTestCase (), TestCase::QUICK);
   }
 } g_redQueueTestSuite; ///< the test suite
@@ -363,6 +363,123 @@ TcFlowControlTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Traffic Control Bulk Dequeue Test Case
+ */
+class TcBulkDequeueTestCase : public TestCase
+{
+public:
+  TcBulkDequeueTestCase ();
+  virtual ~TcBulkDequeueTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Instruct a node to send a specified number of packets
+   * \param n the node
+   * \param nPackets the number of packets to send
+   */
+  void SendPackets (Ptr<Node> n, uint16_t nPackets);
+  /**
+   * Record a burst of packets dequeued by the queue disc, and send it
+   * \param dev the device
+   * \param items the packets of the burst
+   */
+  void SendBurst (Ptr<NetDevice> dev, const std::vector<Ptr<QueueDiscItem> > &items);
+  std::vector<uint32_t> m_bursts;   //!< the sizes of the bursts sent to the device
+};
+
+TcBulkDequeueTestCase::TcBulkDequeueTestCase ()
+  : TestCase ("Test the bulk dequeue of packets within the queue limits")
+{
+}
+
+TcBulkDequeueTestCase::~TcBulkDequeueTestCase ()
+{
+}
+
+void
+TcBulkDequeueTestCase::SendPackets (Ptr<Node> n, uint16_t nPackets)
+{
+  Ptr<TrafficControlLayer> tc = n->GetObject<TrafficControlLayer> ();
+  for (uint16_t i = 0; i < nPackets; i++)
+    {
+      tc->Send (n->GetDevice (0), Create<QueueDiscTestItem> (Create<Packet> (1000)));
+    }
+}
+
+void
+TcBulkDequeueTestCase::SendBurst (Ptr<NetDevice> dev, const std::vector<Ptr<QueueDiscItem> > &items)
+{
+  m_bursts.push_back (items.size ());
+  dev->SendBurst (items);
+}
+
+void
+TcBulkDequeueTestCase::DoRun (void)
+{
+  NodeContainer n;
+  n.Create (2);
+
+  n.Get (0)->AggregateObject (CreateObject<TrafficControlLayer> ());
+  n.Get (1)->AggregateObject (CreateObject<TrafficControlLayer> ());
+
+  SimpleNetDeviceHelper simple;
+
+  NetDeviceContainer rxDevC = simple.Install (n.Get (1));
+
+  simple.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("1Mb/s")));
+  simple.SetQueue ("ns3::DropTailQueue", "MaxSize", StringValue ("100p"));
+
+  Ptr<NetDevice> txDev;
+  txDev = simple.Install (n.Get (0), DynamicCast<SimpleChannel> (rxDevC.Get (0)->GetChannel ())).Get (0);
+
+  // BQL with a fixed limit of 3000 bytes
+  TrafficControlHelper tch = TrafficControlHelper::Default ();
+  tch.SetQueueLimits ("ns3::DynamicQueueLimits", "MinLimit", UintegerValue (3000),
+                      "MaxLimit", UintegerValue (3000));
+  tch.Install (txDev);
+  n.Get (0)->GetObject<TrafficControlLayer> ()->Initialize ();
+
+  Ptr<QueueDisc> qdisc = n.Get (0)->GetObject<TrafficControlLayer> ()->GetRootQueueDiscOnDevice (txDev);
+  qdisc->SetSendBurstCallback (std::bind (&TcBulkDequeueTestCase::SendBurst, this, txDev,
+                                          std::placeholders::_1));
+
+  // the packets accumulate in the queue disc while the device queue is stopped
+  Ptr<NetDeviceQueue> txq = txDev->GetObject<NetDeviceQueueInterface> ()->GetTxQueue (0);
+  Simulator::Schedule (Time (Seconds (0)), &NetDeviceQueue::Stop, txq);
+  Simulator::Schedule (Time (Seconds (0)), &TcBulkDequeueTestCase::SendPackets, this, n.Get (0), 10);
+  Simulator::Schedule (Time (MilliSeconds (1)), &NetDeviceQueue::Wake, txq);
+  Simulator::Stop (Time (MilliSeconds (2)));
+  Simulator::Run ();
+
+  // once woken, the queue disc sends a first packet on its own, as the limit
+  // of the queue limits is only set once some bytes are transmitted.  Then,
+  // the device queue accepts 1000-byte packets until the 3000 bytes of the
+  // limit are exceeded, and the queue disc dequeues the four of them in a
+  // single burst
+  NS_TEST_ASSERT_MSG_EQ (m_bursts.size (), 2, "The packets must be sent in two bursts");
+  NS_TEST_EXPECT_MSG_EQ (m_bursts[0], 1, "Unexpected number of packets in the first burst");
+  NS_TEST_EXPECT_MSG_EQ (m_bursts[1], 4, "Unexpected number of packets in the second burst");
+  NS_TEST_EXPECT_MSG_EQ (qdisc->GetNPackets (), 5, "There must be 5 packets in the queue disc");
+  NS_TEST_EXPECT_MSG_EQ (txq->IsStopped (), true, "The queue limits must stop the device queue");
+
+  // all the packets are eventually sent
+  Simulator::Stop (Time (Seconds (1)));
+  Simulator::Run ();
+  uint32_t nSent = 0;
+  for (std::vector<uint32_t>::const_iterator it = m_bursts.begin (); it != m_bursts.end (); ++it)
+    {
+      nSent += *it;
+    }
+  NS_TEST_EXPECT_MSG_EQ (nSent, 10, "All the packets must be sent to the device");
+  NS_TEST_EXPECT_MSG_EQ (qdisc->GetNPackets (), 0, "The queue disc must be empty");
+
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup traffic-control-test
  * \ingroup tests
@@ -377,5 +494,6 @@ public:
   {
     AddTestCase (new TcFlowControlTestCase (QueueSizeUnit::PACKETS), TestCase::QUICK);
     AddTestCase (new TcFlowControlTestCase (QueueSizeUnit::BYTES), TestCase::QUICK);
+    AddTestCase (new TcBulkDequeueTestCase (), TestCase::QUICK);
   }
 } g_tcFlowControlTestSuite; ///< the test suite
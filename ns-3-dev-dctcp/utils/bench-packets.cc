@@ -26,6 +26,7 @@
 #include "ns3/system-wall-clock-ms.h"
 #include "ns3/packet.h"
 #include "ns3/packet-metadata.h"
+#include "ns3/packet-pool.h"
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -343,6 +344,7 @@ static void
 runBench (void (*bench) (uint32_t), uint32_t n, uint32_t minIterations, char const *name)
 {
   uint64_t minDelay = std::numeric_limits<uint64_t>::max();
+  PacketPool::ResetStats ();
   for (uint32_t i = 0; i < minIterations; i++)
     {
       uint64_t delay = runBenchOneIteration(bench, n);
@@ -351,9 +353,12 @@ runBench (void (*bench) (uint32_t), uint32_t n, uint32_t minIterations, char con
   double ps = n;
   ps *= 1000;
   ps /= minDelay;
+  PacketPool::Stats stats = PacketPool::GetStats ();
   std::cout << ps << " packets/s"
             << " (" << minDelay << " ms elapsed)\t"
             << name
+            << "\t(pool hits " << stats.hits
+            << ", misses " << stats.misses << ")"
             << std::endl;
 }
 
@@ -0,0 +1,138 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the storage of packet queues.
+// A queue is filled up to the given depth, then 'n' packets are enqueued
+// and dequeued in turn, so that the queue stays at that depth.
+// Sample usage:  ./waf --run 'bench-queue --n=1000000 --depth=1000'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/packet.h"
+#include "ns3/ring-buffer.h"
+#include "ns3/drop-tail-queue.h"
+#include <iostream>
+#include <list>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <stdlib.h> // for exit ()
+
+using namespace ns3;
+
+/// Packets enqueued by the benchmarks, created once
+static std::vector<Ptr<Packet> > g_packets;
+
+/**
+ * Enqueue and dequeue packets through a standard container
+ *
+ * \tparam Container the container type
+ * \param n the number of packets to enqueue and dequeue
+ * \param depth the number of packets in the queue
+ */
+template <typename Container>
+static void
+benchContainer (uint32_t n, uint32_t depth)
+{
+  Container c;
+  uint32_t nPackets = g_packets.size ();
+  for (uint32_t i = 0; i < depth; i++)
+    {
+      c.insert (c.end (), g_packets[i % nPackets]);
+    }
+  for (uint32_t i = 0; i < n; i++)
+    {
+      c.insert (c.end (), g_packets[i % nPackets]);
+      c.erase (c.begin ());
+    }
+}
+
+/**
+ * Enqueue and dequeue packets through a DropTailQueue
+ *
+ * \param n the number of packets to enqueue and dequeue
+ * \param depth the number of packets in the queue
+ */
+static void
+benchDropTailQueue (uint32_t n, uint32_t depth)
+{
+  Ptr<DropTailQueue<Packet> > q = CreateObject<DropTailQueue<Packet> > ();
+  q->SetMaxSize (QueueSize (QueueSizeUnit::PACKETS, depth + 1));
+  uint32_t nPackets = g_packets.size ();
+  for (uint32_t i = 0; i < depth; i++)
+    {
+      q->Enqueue (g_packets[i % nPackets]);
+    }
+  for (uint32_t i = 0; i < n; i++)
+    {
+      q->Enqueue (g_packets[i % nPackets]);
+      q->Dequeue ();
+    }
+}
+
+static void
+runBench (void (*bench) (uint32_t, uint32_t), uint32_t n, uint32_t depth,
+          uint32_t minIterations, char const *name)
+{
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max ();
+  for (uint32_t i = 0; i < minIterations; i++)
+    {
+      SystemWallClockMs time;
+      time.Start ();
+      (*bench) (n, depth);
+      minDelay = std::min (minDelay, static_cast<uint64_t> (time.End ()));
+    }
+  double ps = n;
+  ps *= 1000;
+  ps /= std::max<uint64_t> (minDelay, 1);
+  std::cout << ps << " packets/s"
+            << " (" << minDelay << " ms elapsed)\t"
+            << name
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 0;
+  uint32_t depth = 1000;
+  uint32_t minIterations = 1;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the storage of packet queues");
+  cmd.AddValue ("n", "number of packets enqueued and dequeued", n);
+  cmd.AddValue ("depth", "number of packets in the queue", depth);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.Parse (argc, argv);
+
+  if (n == 0)
+    {
+      std::cerr << "Error-- number of packets must be specified " <<
+        "by command-line argument --n=(number of packets)" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-queue with n=" << n << " depth=" << depth << std::endl;
+
+  for (uint32_t i = 0; i < 1024; i++)
+    {
+      g_packets.push_back (Create<Packet> (1500));
+    }
+
+  runBench (&benchContainer<std::list<Ptr<Packet> > >, n, depth, minIterations, "std::list");
+  runBench (&benchContainer<RingBuffer<Ptr<Packet> > >, n, depth, minIterations, "RingBuffer");
+  runBench (&benchDropTailQueue, n, depth, minIterations, "DropTailQueue");
+
+  return 0;
+}
@@ -55,6 +55,15 @@ public:
   {
   }
 
+  /**
+   * Set the number of timeouts removed and scheduled again by the events
+   * \param timeouts the number of timeouts
+   */
+  void SetTimeouts (const uint32_t timeouts)
+  {
+    m_timeouts.resize (timeouts);
+  }
+
   /**
    * Set random stream
    * \param stream the random variable stream
@@ -87,11 +96,14 @@ public:
 private:
   /// callback function
   void Cb (void);
+  /// timeout function
+  void Timeout (void);
 
   Ptr<RandomVariableStream> m_rand; ///< random variable
   uint32_t m_population; ///< population
   uint32_t m_total; ///< total
   uint32_t m_count; ///< count 
+  std::vector<EventId> m_timeouts; ///< timeouts far in the future
 };
 
 void
@@ -141,9 +153,21 @@ Bench::Cb (void)
 
   Time after = NanoSeconds (m_rand->GetValue ());
   Simulator::Schedule (after, &Bench::Cb, this);
+  if (!m_timeouts.empty ())
+    {
+      // like a retransmission timeout, removed before it expires
+      EventId &timeout = m_timeouts[m_count % m_timeouts.size ()];
+      Simulator::Remove (timeout);
+      timeout = Simulator::Schedule (Seconds (1) + after, &Bench::Timeout, this);
+    }
   ++m_count;
 }
 
+void
+Bench::Timeout (void)
+{
+}
+
 
 Ptr<RandomVariableStream>
 GetRandomStream (std::string filename)
@@ -205,12 +229,14 @@ int main (int argc, char *argv[])
 
   bool schedCal  = false;
   bool schedHeap = false;
+  bool schedLadder = false;
   bool schedList = false;
   bool schedMap  = true;
 
   uint32_t pop   =  100000;
   uint32_t total = 1000000;
   uint32_t runs  =       1;
+  uint32_t timeouts =     0;
   std::string filename = "";
 
   CommandLine cmd;
@@ -224,12 +250,14 @@ int main (int argc, char *argv[])
              "to be ascii, giving the relative event times in ns.");
   cmd.AddValue ("cal",   "use CalendarSheduler",          schedCal);
   cmd.AddValue ("heap",  "use HeapScheduler",             schedHeap);
+  cmd.AddValue ("ladder", "use LadderScheduler",          schedLadder);
   cmd.AddValue ("list",  "use ListSheduler",              schedList);
   cmd.AddValue ("map",   "use MapScheduler (default)",    schedMap);
   cmd.AddValue ("debug", "enable debugging output",       g_debug);
   cmd.AddValue ("pop",   "event population size (default 1E5)",         pop);
   cmd.AddValue ("total", "total number of events to run (default 1E6)", total);
   cmd.AddValue ("runs",  "number of runs (default 1)",    runs);
+  cmd.AddValue ("timeouts", "number of far away timeouts removed and scheduled again by the events (default 0)", timeouts);
   cmd.AddValue ("file",  "file of relative event times",  filename);
   cmd.AddValue ("prec",  "printed output precision",      g_fwidth);
   cmd.Parse (argc, argv);
@@ -249,6 +277,10 @@ int main (int argc, char *argv[])
     {
       factory.SetTypeId ("ns3::ListScheduler");
     }
+  if (schedLadder)
+    {
+      factory.SetTypeId ("ns3::LadderScheduler");
+    }
   Simulator::SetScheduler (factory);
 
   LOGME (std::setprecision (g_fwidth - 6));
@@ -261,6 +293,7 @@ int main (int argc, char *argv[])
 
   Bench *bench = new Bench (pop, total);
   bench->SetRandomStream (GetRandomStream (filename));
+  bench->SetTimeouts (timeouts);
 
   // table header
   LOG ("");
@@ -0,0 +1,155 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the creation of objects with
+// many attributes: 'n' TCP sockets are created on a node, each one
+// constructing its attributes and those of its congestion control, RTT
+// estimator and buffers.  Their attributes and trace sources are then
+// looked up by name.
+// Sample usage:  ./waf --run 'bench-tcp-socket --n=100000'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/node.h"
+#include "ns3/socket.h"
+#include "ns3/uinteger.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/internet-stack-helper.h"
+#include <iostream>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <stdlib.h> // for exit ()
+
+using namespace ns3;
+
+/// The node of the sockets
+static Ptr<Node> g_node;
+/// The sockets created by benchCreate
+static std::vector<Ptr<Socket> > g_sockets;
+
+/**
+ * A trace sink
+ * \param oldValue the previous value
+ * \param newValue the new value
+ */
+static void
+CwndSink (uint32_t oldValue, uint32_t newValue)
+{
+}
+
+/**
+ * Create TCP sockets, replacing those of the previous iteration
+ *
+ * \param n the number of sockets
+ */
+static void
+benchCreate (uint32_t n)
+{
+  g_sockets.clear ();
+  g_sockets.reserve (n);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      g_sockets.push_back (Socket::CreateSocket (g_node, TcpSocketFactory::GetTypeId ()));
+    }
+}
+
+/**
+ * Get and set attributes of the sockets by name
+ *
+ * \param n the number of sockets
+ */
+static void
+benchAttributes (uint32_t n)
+{
+  UintegerValue value;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      // Attributes of TcpSocket, the parent of the socket type
+      g_sockets[i]->GetAttribute ("SegmentSize", value);
+      g_sockets[i]->SetAttribute ("SndBufSize", value);
+      g_sockets[i]->SetAttribute ("RcvBufSize", value);
+      g_sockets[i]->GetAttribute ("InitialCwnd", value);
+    }
+}
+
+/**
+ * Connect and disconnect a trace source of the sockets by name
+ *
+ * \param n the number of sockets
+ */
+static void
+benchTraceSources (uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      g_sockets[i]->TraceConnectWithoutContext ("CongestionWindow", MakeCallback (&CwndSink));
+      g_sockets[i]->TraceDisconnectWithoutContext ("CongestionWindow", MakeCallback (&CwndSink));
+    }
+}
+
+static void
+runBench (void (*bench) (uint32_t), uint32_t n, uint32_t minIterations,
+          char const *name)
+{
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max ();
+  for (uint32_t i = 0; i < minIterations; i++)
+    {
+      SystemWallClockMs time;
+      time.Start ();
+      (*bench) (n);
+      minDelay = std::min (minDelay, static_cast<uint64_t> (time.End ()));
+    }
+  double usPerSocket = minDelay * 1e3 / n;
+  std::cout << usPerSocket << " us/socket"
+            << " (" << minDelay << " ms elapsed)\t"
+            << name
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 0;
+  uint32_t minIterations = 1;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the creation of TCP sockets");
+  cmd.AddValue ("n", "number of sockets created", n);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.Parse (argc, argv);
+
+  if (n == 0)
+    {
+      std::cerr << "Error-- number of sockets must be specified " <<
+        "by command-line argument --n=(number of sockets)" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-tcp-socket with n=" << n << std::endl;
+
+  g_node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (g_node);
+
+  runBench (&benchCreate, n, minIterations, "create");
+  runBench (&benchAttributes, n, minIterations, "get and set 4 attributes");
+  runBench (&benchTraceSources, n, minIterations, "connect and disconnect a trace source");
+
+  g_sockets.clear ();
+  g_node->Dispose ();
+  g_node = 0;
+
+  return 0;
+}
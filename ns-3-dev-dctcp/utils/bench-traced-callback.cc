@@ -0,0 +1,166 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the cost of the trace sources hit
+// by every packet.  Every packet goes through as many trace sources as a
+// packet crossing a queue disc and a device (Enqueue, Dequeue, Mark, Drop,
+// Tx and Rx), with 0, 1 or 2 sinks connected to each source.  The
+// TracedCallback is compared with a chain of Callbacks kept in a std::list.
+// Sample usage:  ./waf --run 'bench-traced-callback --n=10000000'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/traced-callback.h"
+#include "ns3/packet.h"
+#include <iostream>
+#include <list>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <stdlib.h> // for exit ()
+
+using namespace ns3;
+
+/// Number of trace sources hit by every packet
+static const uint32_t N_SOURCES = 6;
+
+/// Packets traced by the benchmarks, created once
+static std::vector<Ptr<const Packet> > g_packets;
+/// Number of calls to the sinks
+static uint64_t g_nCalls = 0;
+
+/**
+ * A trace sink
+ * \param packet the traced packet
+ */
+static void
+Sink (Ptr<const Packet> packet)
+{
+  g_nCalls++;
+}
+
+/**
+ * A chain of Callbacks kept in a std::list
+ */
+class ListTracedCallback
+{
+public:
+  /**
+   * Append a Callback to the chain
+   * \param callback the Callback
+   */
+  void ConnectWithoutContext (Callback<void, Ptr<const Packet> > callback)
+  {
+    m_callbackList.push_back (callback);
+  }
+  /**
+   * Invoke the chain of Callbacks
+   * \param packet the traced packet
+   */
+  void operator() (Ptr<const Packet> packet) const
+  {
+    for (std::list<Callback<void, Ptr<const Packet> > >::const_iterator i = m_callbackList.begin ();
+         i != m_callbackList.end (); i++)
+      {
+        (*i)(packet);
+      }
+  }
+private:
+  std::list<Callback<void, Ptr<const Packet> > > m_callbackList; //!< the chain of Callbacks
+};
+
+/**
+ * Trace packets through trace sources
+ *
+ * \tparam Traced the type of the trace sources
+ * \param n the number of packets
+ * \param nSinks the number of sinks connected to every trace source
+ */
+template <typename Traced>
+static void
+benchTraced (uint32_t n, uint32_t nSinks)
+{
+  Traced sources[N_SOURCES];
+  for (uint32_t i = 0; i < N_SOURCES; i++)
+    {
+      for (uint32_t j = 0; j < nSinks; j++)
+        {
+          sources[i].ConnectWithoutContext (MakeCallback (&Sink));
+        }
+    }
+  uint32_t nPackets = g_packets.size ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<const Packet> packet = g_packets[i % nPackets];
+      for (uint32_t j = 0; j < N_SOURCES; j++)
+        {
+          sources[j] (packet);
+        }
+    }
+}
+
+static void
+runBench (void (*bench) (uint32_t, uint32_t), uint32_t n, uint32_t nSinks,
+          uint32_t minIterations, char const *name)
+{
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max ();
+  for (uint32_t i = 0; i < minIterations; i++)
+    {
+      SystemWallClockMs time;
+      time.Start ();
+      (*bench) (n, nSinks);
+      minDelay = std::min (minDelay, static_cast<uint64_t> (time.End ()));
+    }
+  double nsPerPacket = minDelay * 1e6 / n;
+  std::cout << nsPerPacket << " ns/packet"
+            << " (" << minDelay << " ms elapsed)\t"
+            << name << ", " << nSinks << " sink(s)"
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 0;
+  uint32_t minIterations = 1;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the cost of the trace sources hit by every packet");
+  cmd.AddValue ("n", "number of packets traced", n);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.Parse (argc, argv);
+
+  if (n == 0)
+    {
+      std::cerr << "Error-- number of packets must be specified " <<
+        "by command-line argument --n=(number of packets)" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-traced-callback with n=" << n
+            << " and " << N_SOURCES << " trace sources per packet" << std::endl;
+
+  for (uint32_t i = 0; i < 1024; i++)
+    {
+      g_packets.push_back (Create<Packet> (1500));
+    }
+
+  for (uint32_t nSinks = 0; nSinks <= 2; nSinks++)
+    {
+      runBench (&benchTraced<ListTracedCallback>, n, nSinks, minIterations, "std::list");
+      runBench (&benchTraced<TracedCallback<Ptr<const Packet> > >, n, nSinks, minIterations, "TracedCallback");
+    }
+
+  return 0;
+}